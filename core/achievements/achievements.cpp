@@ -38,7 +38,7 @@
 #include <utility>
 #include <xxhash.h>
 #include <functional>
-#include "util/worker_thread.h"
+#include "util/task_pool.h"
 #include "util/periodic_thread.h"
 
 namespace achievements
@@ -111,7 +111,7 @@ private:
 	std::string cachePath;
 	std::unordered_map<u64, std::string> cacheMap;
 	std::mutex cacheMutex;
-	WorkerThread taskThread {"RA-background"};
+	TaskQueue taskThread {"RA-background", TaskPool::Background};
 
 	PeriodicThread idleThread { "RA-idle", [this]() {
 		if (active)
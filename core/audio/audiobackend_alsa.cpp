@@ -3,6 +3,7 @@
 #include <alsa/asoundlib.h>
 #include "cfg/cfg.h"
 #include "cfg/option.h"
+#include "profiler/metrics.h"
 
 class AlsaAudioBackend : public AudioBackend
 {
@@ -266,6 +267,7 @@ public:
 			if (rc == -EPIPE)
 			{
 				// EPIPE means underrun
+				metrics::audioUnderruns.inc();
 				// Write some silence then our samples
 				const size_t silence_size = buffer_size - samples;
 				void *silence = alloca(silence_size * 4);
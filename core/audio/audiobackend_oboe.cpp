@@ -25,6 +25,7 @@
 #include <atomic>
 #include <memory>
 #include "stdclass.h"
+#include "profiler/metrics.h"
 
 class OboeBackend : AudioBackend
 {
@@ -42,8 +43,11 @@ class OboeBackend : AudioBackend
 		oboe::DataCallbackResult onAudioReady(oboe::AudioStream *audioStream, void *audioData, int32_t numFrames) override
 		{
 			if (!backend->ringBuffer.read((u8 *)audioData, numFrames * 4))
+			{
 				// underrun
+				metrics::audioUnderruns.inc();
 				memset(audioData, 0, numFrames * 4);
+			}
 			backend->pushWait.Set();
 
 			return oboe::DataCallbackResult::Continue;
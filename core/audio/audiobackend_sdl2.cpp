@@ -4,6 +4,8 @@
 #include "audiostream.h"
 #include "cfg/option.h"
 #include "stdclass.h"
+#include "profiler/fc_profiler.h"
+#include "profiler/metrics.h"
 
 #include <algorithm>
 #include <atomic>
@@ -27,16 +29,25 @@ class SDLAudioBackend : AudioBackend
 
 	static void audioCallback(void* userdata, Uint8* stream, int len)
 	{
-		SDLAudioBackend *backend = (SDLAudioBackend *)userdata;
+		fc_profiler::startThread("audio", true);
+		fillStream((SDLAudioBackend *)userdata, stream, len);
+		fc_profiler::endThread();
+	}
+
+	static void fillStream(SDLAudioBackend *backend, Uint8* stream, int len)
+	{
+		FC_PROFILE_SCOPE;
 
 		backend->stream_mutex.lock();
 		// Wait until there's enough samples to feed the kraken
 		unsigned oslen = len / sizeof(uint32_t);
 		unsigned islen = backend->needs_resampling ? std::ceil(oslen / backend->audioCvt.len_ratio) : oslen;
 
+		fc_profiler::counter("Audio buffer", backend->sample_count);
 		if (backend->sample_count < islen)
 		{
 			// No data, just output a bit of silence for the underrun
+			metrics::audioUnderruns.inc();
 			memset(stream, 0, len);
 			backend->stream_mutex.unlock();
 			backend->read_wait.Set();
@@ -7,6 +7,8 @@
 
 #include "cfg/cfg.h"
 #include "stdclass.h"
+#include "profiler/benchmark.h"
+#include "input/movie.h"
 
 static int setconfig(char *arg[], int cl)
 {
@@ -80,6 +82,15 @@ static int showhelp()
 	printf("-config	section:key=value     add a virtual config value;\n");
 	printf("                              virtual config values won't be saved to the .cfg file\n");
 	printf("                              unless a different value is written to them\n");
+	printf("-benchmark frames             run the content headless for the given number of frames\n");
+	printf("                              and print performance statistics as JSON\n");
+	printf("-benchmark-input file         replay the given input script during the benchmark\n");
+	printf("-benchmark-state slot         load the given savestate slot before the benchmark\n");
+	printf("-benchmark-output file        write the benchmark results to the given file\n");
+	printf("-benchmark-renderer soft|none render the frames with the software renderer during the benchmark\n");
+	printf("-benchmark-dump file.png      save the last frame rendered by the software renderer\n");
+	printf("-record-movie file            record the inputs and periodic state hashes to the given movie file\n");
+	printf("-play-movie file              play back the given movie file and check the state hashes\n");
 	printf("-help                         display this help\n");
 
 	exit(0);
@@ -103,6 +114,29 @@ void ParseCommandLine(int argc,char* argv[])
 			cl-=as;
 			arg+=as;
 		}
+		else if (strncmp(*arg, "-benchmark", 10) == 0 || strncmp(*arg, "--benchmark", 11) == 0)
+		{
+			int as = benchmark::parseArgs(arg, cl);
+			cl -= as;
+			arg += as;
+		}
+		else if (stricmp(*arg, "-record-movie") == 0 || stricmp(*arg, "--record-movie") == 0
+				|| stricmp(*arg, "-play-movie") == 0 || stricmp(*arg, "--play-movie") == 0)
+		{
+			if (cl < 1)
+			{
+				WARN_LOG(COMMON, "%s : missing parameter", *arg);
+			}
+			else
+			{
+				if (strstr(*arg, "record") != nullptr)
+					movie::record(arg[1]);
+				else
+					movie::play(arg[1]);
+				cl--;
+				arg++;
+			}
+		}
 #if defined(__APPLE__)
 		else if (!strncmp(*arg, "-NSDocumentRevisions", 20))
 		{
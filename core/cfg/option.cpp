@@ -97,6 +97,7 @@ Option<int> CrosshairSize("rend.CrosshairSize", 40);
 Option<int> SkipFrame("ta.skip");
 Option<int> MaxThreads("pvr.MaxThreads", 3);
 Option<int> AutoSkipFrame("pvr.AutoSkipFrame", 0);
+Option<int> FastForwardFrames("pvr.FastForwardFrames", 0);
 Option<int> RenderResolution("rend.Resolution", 480);
 Option<bool> VSync("rend.vsync", true);
 Option<int64_t> PixelBufferSize("rend.PixelBufferSize", 512_MB);
@@ -129,6 +130,8 @@ Option<bool> GDBWaitForConnection("Debug.GDBWaitForConnection");
 Option<bool> UseReios("UseReios");
 Option<bool> FastGDRomLoad("FastGDRomLoad", false);
 Option<bool> RamMod32MB("Dreamcast.RamMod32MB", false);
+Option<bool> HugePages("HugePages", false);
+Option<bool> PinThreads("PinThreads", false);
 
 Option<bool> OpenGlChecks("OpenGlChecks", false, "validate");
 
@@ -140,6 +143,7 @@ Option<bool, false> DiscordPresence("DiscordPresence", true);
 Option<bool, false> UseSafFilePicker("UseSafFilePicker", true);
 #endif
 OptionString LogServer("LogServer", "", "log");
+Option<int, false> MetricsPort("MetricsPort", 0);
 
 // Profiler
 Option<bool> ProfilerEnabled("Profiler.Enabled");
@@ -163,6 +167,9 @@ Option<int> GGPOAnalogAxes("GGPOAnalogAxes", 0, "network");
 Option<bool> GGPOChat("GGPOChat", true, "network");
 Option<bool> GGPOChatTimeoutToggle("GGPOChatTimeoutToggle", true, "network");
 Option<int> GGPOChatTimeout("GGPOChatTimeout", 10, "network");
+Option<bool> GGPOSpectate("GGPOSpectate", false, "network");
+OptionString GGPOSpectators("GGPOSpectators", "", "network");
+Option<int> GGPORelayDelay("GGPORelayDelay", 0, "network");
 Option<bool> NetworkOutput("NetworkOutput", false, "network");
 Option<int> MultiboardSlaves("MultiboardSlaves", 1, "network");
 Option<bool> BattleCableEnable("BattleCable", false, "network");
@@ -458,6 +458,7 @@ extern Option<int> CrosshairSize;
 extern Option<int> SkipFrame;
 extern Option<int> MaxThreads;
 extern Option<int> AutoSkipFrame;		// 0: none, 1: some, 2: more
+extern Option<int> FastForwardFrames;	// Render one frame out of N when fast-forwarding. 0: as fast as the display refreshes
 extern Option<int> RenderResolution;
 extern Option<bool> VSync;
 extern Option<int64_t> PixelBufferSize;
@@ -485,6 +486,8 @@ extern Option<bool> GDBWaitForConnection;
 extern Option<bool> UseReios;
 extern Option<bool> FastGDRomLoad;
 extern Option<bool> RamMod32MB;
+extern Option<bool> HugePages;	// Back guest RAM, VRAM and ARAM with transparent huge pages (linux only)
+extern Option<bool> PinThreads;	// Run the emulator and render threads on dedicated cores
 
 extern Option<bool> OpenGlChecks;
 
@@ -496,6 +499,7 @@ extern Option<bool, false> DiscordPresence;
 extern Option<bool, false> UseSafFilePicker;
 #endif
 extern OptionString LogServer;
+extern Option<int, false> MetricsPort;	// localhost port of the metrics exporter, 0 to disable
 
 // Profiling
 extern Option<bool> ProfilerEnabled;
@@ -519,6 +523,9 @@ extern Option<int> GGPOAnalogAxes;
 extern Option<bool> GGPOChat;
 extern Option<bool> GGPOChatTimeoutToggle;
 extern Option<int> GGPOChatTimeout;
+extern Option<bool> GGPOSpectate;
+extern OptionString GGPOSpectators;
+extern Option<int> GGPORelayDelay;
 extern Option<bool> NetworkOutput;
 extern Option<int> MultiboardSlaves;
 extern Option<bool> BattleCableEnable;
@@ -447,6 +447,30 @@ GGPO_API GGPOErrorCode __cdecl ggpo_start_spectating(GGPOSession **session,
 													 const void *verification,
 													 int verification_size);
 
+/*
+ * ggpo_start_relay --
+ *
+ * Start a relay session. A relay is a spectator which serves the confirmed inputs
+ * it receives from the host to its own spectators, so that the players only need to
+ * serve the relay. Spectators are added with ggpo_add_player using the
+ * GGPO_PLAYERTYPE_SPECTATOR type and connect to the relay with ggpo_start_spectating.
+ *
+ * The parameters are the same as ggpo_start_spectating with the addition of:
+ *
+ * delay - The number of frames the inputs are held before being forwarded to spectators.
+ */
+GGPO_API GGPOErrorCode __cdecl ggpo_start_relay(GGPOSession **session,
+                                                GGPOSessionCallbacks *cb,
+                                                const char *game,
+                                                int num_players,
+                                                int input_size,
+                                                unsigned short local_port,
+                                                char *host_ip,
+                                                unsigned short host_port,
+                                                int delay,
+                                                const void *verification,
+                                                int verification_size);
+
 /*
  * ggpo_close_session --
  * Used to close a session.  You must call ggpo_close_session to
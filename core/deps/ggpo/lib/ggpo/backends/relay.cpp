@@ -0,0 +1,224 @@
+/* -----------------------------------------------------------------------
+ * GGPO.net (http://ggpo.net)  -  Copyright 2009 GroundStorm Studios, LLC.
+ *
+ * Use of this software is governed by the MIT license that can be found
+ * in the LICENSE file.
+ */
+
+#include "relay.h"
+
+/*
+ * Maximum number of inputs in flight to a given spectator. The UDP protocol
+ * output queue holds 64 inputs.
+ */
+#define RELAY_MAX_PENDING_INPUTS    32
+
+/*
+ * Maximum number of inputs kept for the spectators that haven't connected yet
+ * (10 minutes at 60 fps). Spectators connecting later can't catch up.
+ */
+#define RELAY_MAX_KEPT_INPUTS       (60 * 60 * 10)
+
+static const int DEFAULT_DISCONNECT_TIMEOUT        = 5000;
+static const int DEFAULT_DISCONNECT_NOTIFY_START   = 750;
+
+RelayBackend::RelayBackend(GGPOSessionCallbacks *cb,
+                           const char* gamename,
+                           uint16 localport,
+                           int num_players,
+                           int input_size,
+                           char *hostip,
+                           u_short hostport,
+                           int delay,
+                           const void *verification,
+                           int verification_size) :
+   SpectatorBackend(cb, gamename, localport, num_players, input_size, hostip, hostport, verification, verification_size),
+   _delay(MAX(delay, 0)),
+   _disconnect_timeout(DEFAULT_DISCONNECT_TIMEOUT),
+   _disconnect_notify_start(DEFAULT_DISCONNECT_NOTIFY_START),
+   _first_input_frame(0),
+   _num_spectators(0)
+{
+   if (verification_size > 0)
+      _verification.assign((const uint8 *)verification, (const uint8 *)verification + verification_size);
+   memset(_local_connect_status, 0, sizeof(_local_connect_status));
+   for (unsigned i = 0; i < ARRAY_SIZE(_local_connect_status); i++) {
+      _local_connect_status[i].last_frame = -1;
+   }
+}
+
+GGPOErrorCode
+RelayBackend::AddPlayer(GGPOPlayer *player,
+                        GGPOPlayerHandle *handle)
+{
+   if (player->type != GGPO_PLAYERTYPE_SPECTATOR) {
+      return GGPO_ERRORCODE_UNSUPPORTED;
+   }
+   if (_num_spectators == GGPO_MAX_SPECTATORS) {
+      return GGPO_ERRORCODE_TOO_MANY_SPECTATORS;
+   }
+   int queue = _num_spectators++;
+
+   if (!_verification.empty())
+      _spectators[queue].SetVerificationData(&_verification[0], (int)_verification.size());
+   _spectators[queue].Init(&_udp, _poll, queue + 1000, player->u.remote.ip_address, player->u.remote.port, _local_connect_status);
+   _spectators[queue].SetDisconnectTimeout(_disconnect_timeout);
+   _spectators[queue].SetDisconnectNotifyStart(_disconnect_notify_start);
+   _spectators[queue].Synchronize();
+   _next_spectator_frame[queue] = _first_input_frame;
+   if (handle != nullptr)
+      *handle = QueueToSpectatorHandle(queue);
+
+   return GGPO_OK;
+}
+
+GGPOErrorCode
+RelayBackend::SetDisconnectTimeout(int timeout)
+{
+   _disconnect_timeout = timeout;
+   for (int i = 0; i < _num_spectators; i++) {
+      _spectators[i].SetDisconnectTimeout(timeout);
+   }
+   return GGPO_OK;
+}
+
+GGPOErrorCode
+RelayBackend::SetDisconnectNotifyStart(int timeout)
+{
+   _disconnect_notify_start = timeout;
+   for (int i = 0; i < _num_spectators; i++) {
+      _spectators[i].SetDisconnectNotifyStart(timeout);
+   }
+   return GGPO_OK;
+}
+
+GGPOErrorCode
+RelayBackend::DoPoll(int timeout)
+{
+   SpectatorBackend::DoPoll(timeout);
+
+   UdpProtocol::Event evt;
+   for (int i = 0; i < _num_spectators; i++) {
+      while (_spectators[i].GetEvent(evt)) {
+         OnUdpProtocolSpectatorEvent(evt, i);
+      }
+   }
+   ForwardInputs();
+   DiscardAckedInputs();
+
+   return GGPO_OK;
+}
+
+void
+RelayBackend::ForwardInputs(void)
+{
+   /*
+    * Only release the inputs that are at least _delay frames old.
+    */
+   int last_frame = _first_input_frame + (int)_received_inputs.size() - 1 - _delay;
+
+   for (int i = 0; i < _num_spectators; i++) {
+      UdpProtocol &spectator = _spectators[i];
+      // inputs sent before the spectator is running would be dropped
+      if (!spectator.IsRunning()) {
+         continue;
+      }
+      int &next_frame = _next_spectator_frame[i];
+      if (next_frame < _first_input_frame) {
+         Log("relay | spectator %d connected too late, missing frames %d to %d.", i, next_frame, _first_input_frame - 1);
+         spectator.Disconnect();
+         continue;
+      }
+      int max_frame = MIN(last_frame, spectator.GetLastAckedFrame() + RELAY_MAX_PENDING_INPUTS);
+      while (next_frame <= max_frame) {
+         spectator.SendInput(_received_inputs[next_frame - _first_input_frame]);
+         next_frame++;
+      }
+   }
+   _local_connect_status[0].last_frame = last_frame;
+}
+
+void
+RelayBackend::DiscardAckedInputs(void)
+{
+   /*
+    * Keep the inputs that haven't been acknowledged by all the spectators
+    * still connected, including the ones that haven't connected yet.
+    */
+   int first_needed = _first_input_frame + (int)_received_inputs.size();
+   for (int i = 0; i < _num_spectators; i++) {
+      if (!_spectators[i].IsDisconnected()) {
+         first_needed = MIN(first_needed, _spectators[i].GetLastAckedFrame() + 1);
+      }
+   }
+   first_needed = MAX(first_needed, _first_input_frame + (int)_received_inputs.size() - RELAY_MAX_KEPT_INPUTS);
+   while (_first_input_frame < first_needed && !_received_inputs.empty()) {
+      _received_inputs.pop_front();
+      _first_input_frame++;
+   }
+}
+
+void
+RelayBackend::OnUdpProtocolEvent(UdpProtocol::Event &evt)
+{
+   if (evt.type == UdpProtocol::Event::Input)
+   {
+      GameInput& input = evt.u.input.input;
+      // Inputs are received in order
+      if (input.frame == _first_input_frame + (int)_received_inputs.size()) {
+         _received_inputs.push_back(input);
+      }
+   }
+   else if (evt.type == UdpProtocol::Event::AppData && evt.u.app_data.spectators)
+   {
+      for (int i = 0; i < _num_spectators; i++) {
+         if (_spectators[i].IsRunning()) {
+            _spectators[i].SendAppData(evt.u.app_data.data, evt.u.app_data.size, true);
+         }
+      }
+   }
+   SpectatorBackend::OnUdpProtocolEvent(evt);
+}
+
+void
+RelayBackend::OnUdpProtocolSpectatorEvent(UdpProtocol::Event &evt, int queue)
+{
+   GGPOEvent info;
+   GGPOPlayerHandle handle = QueueToSpectatorHandle(queue);
+
+   switch (evt.type) {
+   case UdpProtocol::Event::Connected:
+      info.code = GGPO_EVENTCODE_CONNECTED_TO_PEER;
+      info.u.connected.player = handle;
+      _callbacks.on_event(&info);
+      break;
+   case UdpProtocol::Event::Synchronzied:
+      info.code = GGPO_EVENTCODE_SYNCHRONIZED_WITH_PEER;
+      info.u.synchronized.player = handle;
+      _callbacks.on_event(&info);
+      break;
+   case UdpProtocol::Event::Disconnected:
+      _spectators[queue].Disconnect();
+      info.code = GGPO_EVENTCODE_DISCONNECTED_FROM_PEER;
+      info.u.disconnected.player = handle;
+      _callbacks.on_event(&info);
+      break;
+   default:
+      break;
+   }
+}
+
+void
+RelayBackend::OnMsg(sockaddr_in &from, UdpMsg *msg, int len)
+{
+   if (_host.HandlesMsg(from, msg)) {
+      _host.OnMsg(msg, len);
+      return;
+   }
+   for (int i = 0; i < _num_spectators; i++) {
+      if (_spectators[i].HandlesMsg(from, msg)) {
+         _spectators[i].OnMsg(msg, len);
+         return;
+      }
+   }
+}
@@ -0,0 +1,56 @@
+/* -----------------------------------------------------------------------
+ * GGPO.net (http://ggpo.net)  -  Copyright 2009 GroundStorm Studios, LLC.
+ *
+ * Use of this software is governed by the MIT license that can be found
+ * in the LICENSE file.
+ */
+
+#ifndef _RELAY_H
+#define _RELAY_H
+
+#include "spectator.h"
+#include <deque>
+#include <vector>
+
+/*
+ * A relay is a spectator of a player host that serves the confirmed inputs
+ * it receives to its own spectators, so that the players only have to serve
+ * a single spectator. Inputs are forwarded with a fixed delay in frames.
+ * Received inputs are kept until all spectators have acknowledged them, so that
+ * spectators can join at any time until then. At most 10 minutes of inputs are kept.
+ */
+class RelayBackend : public SpectatorBackend {
+public:
+   RelayBackend(GGPOSessionCallbacks *cb, const char *gamename, uint16 localport, int num_players, int input_size, char *hostip, u_short hostport,
+		   int delay, const void *verification, int verification_size);
+
+public:
+   GGPOErrorCode DoPoll(int timeout) override;
+   GGPOErrorCode AddPlayer(GGPOPlayer *player, GGPOPlayerHandle *handle) override;
+   GGPOErrorCode SetDisconnectTimeout(int timeout) override;
+   GGPOErrorCode SetDisconnectNotifyStart(int timeout) override;
+
+public:
+   void OnMsg(sockaddr_in &from, UdpMsg *msg, int len) override;
+
+protected:
+   GGPOPlayerHandle QueueToSpectatorHandle(int queue) { return (GGPOPlayerHandle)(queue + 1000); }
+   void OnUdpProtocolEvent(UdpProtocol::Event &e) override;
+   void OnUdpProtocolSpectatorEvent(UdpProtocol::Event &e, int queue);
+   void ForwardInputs(void);
+   void DiscardAckedInputs(void);
+
+protected:
+   std::vector<uint8>      _verification;
+   int                     _delay;
+   int                     _disconnect_timeout;
+   int                     _disconnect_notify_start;
+   std::deque<GameInput>   _received_inputs;
+   int                     _first_input_frame;     // frame of _received_inputs[0]
+   UdpMsg::connect_status  _local_connect_status[UDP_MSG_MAX_PLAYERS];
+   UdpProtocol             _spectators[GGPO_MAX_SPECTATORS];
+   int                     _next_spectator_frame[GGPO_MAX_SPECTATORS];
+   int                     _num_spectators;
+};
+
+#endif
@@ -43,7 +43,7 @@ protected:
    void PollUdpProtocolEvents(void);
    void CheckInitialSync(void);
 
-   void OnUdpProtocolEvent(UdpProtocol::Event &e);
+   virtual void OnUdpProtocolEvent(UdpProtocol::Event &e);
 
 protected:
    GGPOSessionCallbacks  _callbacks;
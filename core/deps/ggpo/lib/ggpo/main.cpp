@@ -8,6 +8,7 @@
 #include "backends/p2p.h"
 #include "backends/synctest.h"
 #include "backends/spectator.h"
+#include "backends/relay.h"
 #include "ggpo_types.h"
 #include "ggponet.h"
 
@@ -248,6 +249,36 @@ GGPOErrorCode ggpo_start_spectating(GGPOSession **session,
 	}
 }
 
+GGPOErrorCode ggpo_start_relay(GGPOSession **session,
+                               GGPOSessionCallbacks *cb,
+                               const char *game,
+                               int num_players,
+                               int input_size,
+                               unsigned short local_port,
+                               char *host_ip,
+                               unsigned short host_port,
+                               int delay,
+                               const void *verification,
+                               int verification_size)
+{
+	try {
+	   *session= (GGPOSession *)new RelayBackend(cb,
+	                                             game,
+	                                             local_port,
+	                                             num_players,
+	                                             input_size,
+	                                             host_ip,
+	                                             host_port,
+	                                             delay,
+	                                             verification,
+	                                             verification_size);
+	   return GGPO_OK;
+	} catch (const GGPOException& e) {
+	   ERROR_LOG(NETWORK, "GGPOException in ggpo_start_relay: %s", e.what());
+	   return e.ggpoError;
+	}
+}
+
 GGPOErrorCode ggpo_send_message(GGPOSession *ggpo,
                                 const void *msg,
                                 int len,
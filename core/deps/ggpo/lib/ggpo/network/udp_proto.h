@@ -78,6 +78,7 @@ public:
    bool IsInitialized() { return _udp != NULL; }
    bool IsSynchronized() { return _current_state == Running; }
    bool IsRunning() { return _current_state == Running; }
+   bool IsDisconnected() { return _current_state == Disconnected; }
    void SendInput(GameInput &input);
    void SendInputAck();
    bool HandlesMsg(sockaddr_in &from, UdpMsg *msg);
@@ -90,6 +91,7 @@ public:
    void GGPONetworkStats(Stats *stats);
    void SetLocalFrameNumber(int num);
    int RecommendFrameDelay();
+   int GetLastAckedFrame() { return _last_acked_input.frame; }
    void SetVerificationData(const void *verification, int verification_size) {
 	   ASSERT(verification_size <= MAX_VERIFICATION_SIZE);
 	   this->verification.resize(verification_size);
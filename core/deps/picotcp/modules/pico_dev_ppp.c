@@ -618,7 +618,9 @@ static int pico_ppp_send(struct pico_device *dev, void *buf, int len)
     pico_ppp_data_buffer[i++] = (uint8_t)((fcs & 0xFF00u) >> 8);
     pico_ppp_data_buffer[i++] = PPPF_FLAG_SEQ;
 
-    ppp_serial_send_escape(ppp, pico_ppp_data_buffer, i);
+    /* Serial line busy: the frame stays in the device queue and is sent again later */
+    if (ppp_serial_send_escape(ppp, pico_ppp_data_buffer, i) <= 0)
+        return 0;
     return len;
 }
 
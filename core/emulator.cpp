@@ -41,6 +41,8 @@
 #include "serialize.h"
 #include "hw/pvr/pvr.h"
 #include "profiler/fc_profiler.h"
+#include "input/movie.h"
+#include "util/task_pool.h"
 #include "oslib/storage.h"
 #include "wsi/context.h"
 #include <chrono>
@@ -721,6 +723,7 @@ void Emulator::unloadGame()
 	try {
 		stop();
 	} catch (...) { }
+	movie::stop();
 	if (state == Loaded || state == Error)
 	{
 #ifndef LIBRETRO
@@ -968,14 +971,17 @@ void Emulator::start()
 		getSh4Executor()->Start();
 		threadResult = std::async(std::launch::async, [this] {
 				ThreadName _("Flycast-emu");
+				TaskPool::setThreadRole(TaskPool::ThreadRole::Emulator);
 				InitAudio();
 
 				try {
 					while (state == Running || singleStep || stepRangeTo != 0)
 					{
+						fc_profiler::startThread("emu");
 						startTime = sh4_sched_now64();
 						renderTimeout = false;
 						runInternal();
+						fc_profiler::endThread();
 						if (!ggpo::nextFrame())
 							break;
 					}
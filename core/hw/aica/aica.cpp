@@ -7,6 +7,7 @@
 #include "hw/sh4/sh4_sched.h"
 #include "hw/arm7/arm7.h"
 #include "hw/arm7/arm_mem.h"
+#include "profiler/benchmark.h"
 
 namespace aica
 {
@@ -86,6 +87,7 @@ constexpr int AICA_TICK = 4535;		// 44.1 KHz
 
 static int AicaUpdate(int tag, int cycles, int jitter, void *arg)
 {
+	benchmark::ScopedTimer _(benchmark::Section::Aica);
 	arm::run(1);
 
 	return AICA_TICK;
@@ -1501,8 +1501,12 @@ void AICA_Sample()
 
 	if (config::DSPEnabled)
 	{
+		// The DSP writes its ring buffer to AICA RAM so it must always run
 		dsp::step();
 
+		// Nothing can be heard when fast-forwarding
+		if (settings.input.fastForwardMode)
+			return;
 		for (int i=0;i<16;i++)
 			VolumePan(*(s16*)&DSPData->EFREG[i], dsp_out_vol[i].EFSDL, dsp_out_vol[i].EFPAN, mixl, mixr);
 	}
@@ -20,10 +20,24 @@
 #include "rtl8139c.h"
 #include "hw/holly/holly_intc.h"
 #include "network/netservice.h"
+#include "hw/sh4/sh4_sched.h"
 #include "serialize.h"
+#include "util/spsc_ring.h"
+#include <array>
 
 static RTL8139State *rtl8139device;
 
+// Frames received by the network thread, waiting to be delivered to the rtl8139
+struct EthFrame
+{
+	u32 size;
+	u8 data[1518];	// max ethernet frame size including vlan tag
+};
+static SpscRing<EthFrame, 32> rxFrames;
+static int rxSchedId = -1;
+// Retry delay when the rtl8139 can't receive the pending frames
+constexpr int RX_POLL_CYCLES = SH4_MAIN_CLOCK / 10000;
+
 // 1400 - 1600 GAPSPCI bridge registers
 // 1600 - 1700 standard PCI config
 // 1700 - 1800 rtl8139c I/O ports
@@ -64,8 +78,24 @@ void pci_set_irq(PCIDevice *pci_dev, int level)
 	setInterrupt();
 }
 
+static int rxPoll(int tag, int cycles, int jitter, void *arg)
+{
+	while (EthFrame *frame = rxFrames.front())
+	{
+		if (!rtl8139_can_receive(rtl8139device))
+			break;
+		rtl8139_receive(rtl8139device, frame->data, frame->size);
+		rxFrames.popFront();
+	}
+	// The network thread schedules the callback again when it receives a frame
+	if (rxFrames.empty())
+		return 0;
+	return RX_POLL_CYCLES;
+}
+
 void bba_Init()
 {
+	rxSchedId = sh4_sched_register(0, rxPoll);
 	NICConf nicConf = { 0xc, 0xa, 0xf, 0xe, 0, 0 };
 	rtl8139device = rtl8139_init(&nicConf);
 	pci_rtl8139_realize(PCI_DEVICE(rtl8139device));
@@ -82,6 +112,9 @@ void bba_Term()
 		net::modbba::stop();
 		rtl8139_destroy(rtl8139device);
 		rtl8139device = nullptr;
+		sh4_sched_unregister(rxSchedId);
+		rxSchedId = -1;
+		rxFrames.clear();
 	}
 }
 
@@ -182,6 +215,8 @@ void bba_WriteMem(u32 addr, u32 data, u32 sz)
 				INFO_LOG(NETWORK, "BBA: GAPS reset");
 				rtl8139_reset(rtl8139device);
 				net::modbba::stop();
+				sh4_sched_request(rxSchedId, -1);
+				rxFrames.clear();
 			}
 			break;
 
@@ -213,23 +248,59 @@ ssize_t qemu_send_packet(RTL8139State *s, const uint8_t *buf, int size)
 	return size;
 }
 
+// Called by the network thread
 int bba_recv_frame(const u8 *data, u32 len)
 {
-	if (!rtl8139_can_receive(rtl8139device))
+	if (len > sizeof(EthFrame::data))
+	{
+		WARN_LOG(NETWORK, "BBA: oversized frame dropped (%d bytes)", len);
+		return 1;
+	}
+	EthFrame *frame = rxFrames.reserve();
+	if (frame == nullptr)
 		return 0;
-	rtl8139_receive(rtl8139device, data, len);
+	frame->size = len;
+	memcpy(frame->data, data, len);
+	rxFrames.commit();
+	sh4_sched_request_async(rxSchedId);
 
 	return 1;
 }
 
 void pci_dma_read(PCIDevice *dev, dma_addr_t addr, void *buf, dma_addr_t len)
 {
-	memcpy(buf, &GAPS_ram[addr & GAPSPCI_RAM_MASK], len);
+	addr &= GAPSPCI_RAM_MASK;
+	if (addr + len > GAPSPCI_RAM_SIZE)
+	{
+		// wrap around
+		memcpy(buf, &GAPS_ram[addr], GAPSPCI_RAM_SIZE - addr);
+		memcpy((u8 *)buf + (GAPSPCI_RAM_SIZE - addr), &GAPS_ram[0], len - (GAPSPCI_RAM_SIZE - addr));
+	}
+	else {
+		memcpy(buf, &GAPS_ram[addr], len);
+	}
 }
 
 void pci_dma_write(PCIDevice *dev, dma_addr_t addr, const void *buf, dma_addr_t len)
 {
-	memcpy(&GAPS_ram[addr & GAPSPCI_RAM_MASK], buf, len);
+	addr &= GAPSPCI_RAM_MASK;
+	if (addr + len > GAPSPCI_RAM_SIZE)
+	{
+		// wrap around
+		memcpy(&GAPS_ram[addr], buf, GAPSPCI_RAM_SIZE - addr);
+		memcpy(&GAPS_ram[0], (const u8 *)buf + (GAPSPCI_RAM_SIZE - addr), len - (GAPSPCI_RAM_SIZE - addr));
+	}
+	else {
+		memcpy(&GAPS_ram[addr], buf, len);
+	}
+}
+
+void *pci_dma_map(PCIDevice *dev, dma_addr_t addr, dma_addr_t len)
+{
+	addr &= GAPSPCI_RAM_MASK;
+	if (addr + len > GAPSPCI_RAM_SIZE)
+		return nullptr;
+	return &GAPS_ram[addr];
 }
 
 void bba_Serialize(Serializer& ser)
@@ -247,33 +318,44 @@ void bba_Deserialize(Deserializer& deser)
 	deser >> GAPS_ram;
 	deser >> dmaOffset;
 	deser >> interruptPending;
+	// Frames received before the state was loaded must not be delivered
+	rxFrames.clear();
     // returns true if the receiver is enabled and the network stack must be started
     if (rtl8139_deserialize(rtl8139device, deser))
         net::modbba::start();
+    sh4_sched_request(rxSchedId, -1);
+}
+
+// CRC-32 (polynomial 0x04c11db7) computed msb first, but with data bits fed lsb first
+static constexpr std::array<u32, 256> makeCrcTable()
+{
+	std::array<u32, 256> table{};
+	for (u32 i = 0; i < 256; i++)
+	{
+		u32 crc = i << 24;
+		for (int j = 0; j < 8; j++)
+			crc = (crc << 1) ^ ((crc & 0x80000000) ? 0x04c11db7 : 0);
+		table[i] = crc;
+	}
+	return table;
 }
+static constexpr std::array<u32, 256> crcTable = makeCrcTable();
 
-#define POLYNOMIAL_BE 0x04c11db6
+static constexpr u8 reverseBits(u8 b)
+{
+	b = (b & 0xf0) >> 4 | (b & 0x0f) << 4;
+	b = (b & 0xcc) >> 2 | (b & 0x33) << 2;
+	b = (b & 0xaa) >> 1 | (b & 0x55) << 1;
+	return b;
+}
 
 uint32_t net_crc32(const uint8_t *p, int len)
 {
-    uint32_t crc;
-    int carry, i, j;
-    uint8_t b;
-
-    crc = 0xffffffff;
-    for (i = 0; i < len; i++) {
-        b = *p++;
-        for (j = 0; j < 8; j++) {
-            carry = ((crc & 0x80000000L) ? 1 : 0) ^ (b & 0x01);
-            crc <<= 1;
-            b >>= 1;
-            if (carry) {
-                crc = ((crc ^ POLYNOMIAL_BE) | carry);
-            }
-        }
-    }
+	u32 crc = 0xffffffff;
+	for (int i = 0; i < len; i++)
+		crc = (crc << 8) ^ crcTable[(crc >> 24) ^ reverseBits(p[i])];
 
-    return crc;
+	return crc;
 }
 
 /*
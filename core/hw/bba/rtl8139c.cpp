@@ -1365,13 +1365,22 @@ static int rtl8139_transmit_one(RTL8139State *s, int descriptor)
     DPRINTF("+++ transmit reading %d bytes from host memory at 0x%08x",
         txsize, s->TxAddr[descriptor]);
 
-    pci_dma_read(d, s->TxAddr[descriptor], txbuffer, txsize);
+    /* avoid copying the frame if it's contiguous in host memory
+     * (the loopback mode writes it back into the same memory) */
+    uint8_t *txdata = nullptr;
+    if (TxLoopBack != (s->TxConfig & TxLoopBack))
+        txdata = (uint8_t *)pci_dma_map(d, s->TxAddr[descriptor], txsize);
+    if (txdata == nullptr)
+    {
+        pci_dma_read(d, s->TxAddr[descriptor], txbuffer, txsize);
+        txdata = txbuffer;
+    }
 
     /* Mark descriptor as transferred */
     s->TxStatus[descriptor] |= TxHostOwns;
     s->TxStatus[descriptor] |= TxStatOK;
 
-    rtl8139_transfer_frame(s, txbuffer, txsize, 0);
+    rtl8139_transfer_frame(s, txdata, txsize, 0);
 
     DPRINTF("+++ transmitted %d bytes from descriptor %d", txsize,
         descriptor);
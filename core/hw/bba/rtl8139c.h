@@ -170,6 +170,8 @@ void pci_register_bar(PCIDevice *pci_dev, int region_num, uint8_t type, MemoryRe
 
 void pci_dma_read(PCIDevice *dev, dma_addr_t addr, void *buf, dma_addr_t len);
 void pci_dma_write(PCIDevice *dev, dma_addr_t addr, const void *buf, dma_addr_t len);
+// Returns a direct pointer to host memory, or nullptr if the region isn't contiguous
+void *pci_dma_map(PCIDevice *dev, dma_addr_t addr, dma_addr_t len);
 
 #define g_malloc malloc
 #define g_free free
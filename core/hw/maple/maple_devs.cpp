@@ -2,6 +2,7 @@
 #include "maple_cfg.h"
 #include "maple_helper.h"
 #include "maple_if.h"
+#include "vmu_file.h"
 #ifdef LIBRETRO
 #include "../../../shell/libretro/vmu_network.h"
 #endif
@@ -343,8 +344,8 @@ u8 vmu_default[] = {
 
 struct maple_sega_vmu: maple_base
 {
-	FILE *file = nullptr;
-	u8 flash_data[128_KB];
+	VmuFile file;
+	u8 flash_data[VmuFile::Size];
 	u8 lcd_data[192];
 	u8 lcd_data_decoded[48*32];
 	bool fullSaveNeeded = false;
@@ -378,13 +379,9 @@ struct maple_sega_vmu: maple_base
 
 	virtual bool fullSave()
 	{
-		if (file == nullptr)
+		if (!file.isOpen())
 			return false;
-		if (std::fseek(file, 0, SEEK_SET) != 0) {
-			ERROR_LOG(MAPLE, "VMU %s: I/O error", logical_port);
-			return false;
-		}
-		if (std::fwrite(flash_data, sizeof(flash_data), 1, file) != 1) {
+		if (!file.write(flash_data, 0, sizeof(flash_data))) {
 			ERROR_LOG(MAPLE, "Failed to write the VMU %s to disk", logical_port);
 			return false;
 		}
@@ -425,20 +422,17 @@ struct maple_sega_vmu: maple_base
         }
         // Open or create the vmu file to save to
         std::string wpath = hostfs::getVmuPath(logical_port, true);
-        file = nowide::fopen(wpath.c_str(), "rb+");
-        if (file == nullptr)
+        bool created;
+        if (!file.open(wpath, flash_data, created))
         {
-            file = nowide::fopen(wpath.c_str(), "wb+");
-			if (file == nullptr) {
-                ERROR_LOG(MAPLE, "Failed to create VMU save file \"%s\"", wpath.c_str());
-			}
-			else if (rfile != nullptr)
-			{
-				// VMU file is being renamed so save it fully now
-				// and delete the old file
-				if (fullSave())
-					nowide::remove(rpath.c_str());
-			}
+            ERROR_LOG(MAPLE, "Failed to create VMU save file \"%s\"", wpath.c_str());
+        }
+        else if (created && rfile != nullptr)
+        {
+            // VMU file is being renamed so save it fully now
+            // and delete the old file
+            if (fullSave() && file.flush())
+                nowide::remove(rpath.c_str());
         }
 
 		u8 sum = 0;
@@ -451,12 +445,6 @@ struct maple_sega_vmu: maple_base
 		fullSaveNeeded = false;
 	}
 
-	~maple_sega_vmu() override
-	{
-		if (file != nullptr)
-			std::fclose(file);
-	}
-
 
 u32 dma(u32 cmd) override
 {
@@ -714,14 +702,14 @@ u32 dma(u32 cmd) override
 						}
 						rptr(&flash_data[write_adr],write_len);
 
-						if (file != nullptr)
+						if (file.isOpen())
 						{
+							// The file is written in the background
 							if (fullSaveNeeded) {
 								if (!fullSave())
 									return MDRE_FileError;
 							}
-							else if (std::fseek(file, write_adr, SEEK_SET) != 0
-									|| std::fwrite(&flash_data[write_adr], write_len, 1, file) != 1)
+							else if (!file.write(flash_data, write_adr, write_len))
 							{
 								ERROR_LOG(MAPLE, "Failed to save VMU %s: I/O error", logical_port);
 								return MDRE_FileError; // I/O error
@@ -2157,6 +2145,7 @@ std::shared_ptr<maple_device> maple_Create(MapleDeviceType type)
 
 #if (defined(_WIN32) || defined(__linux__) || (defined(__APPLE__) && defined(TARGET_OS_MAC))) && !defined(TARGET_UWP) && defined(USE_SDL) && !defined(LIBRETRO)
 #include "sdl/dreamlink.h"
+#include "util/task_pool.h"
 #include <list>
 #include <memory>
 
@@ -2172,30 +2161,26 @@ struct DreamLinkVmu : public maple_sega_vmu
 
 	std::list<u8> blocksToWrite;
 	std::mutex writeMutex;
-	std::condition_variable writeCv;
-	std::thread writeThread;
+	TaskQueue writeQueue { "DreamLinkVmu", TaskPool::Background };
 
 	static u64 lastNotifyTime;
 	static u64 lastErrorNotifyTime;
 
 	DreamLinkVmu(std::shared_ptr<DreamLink> dreamlink) :
-		dreamlink(dreamlink),
-		writeThread([this](){writeEntrypoint();})
+		dreamlink(dreamlink)
 	{
 		// Initialize useRealVmuMemory with our config setting
 		useRealVmuMemory = config::UsePhysicalVmuMemory;
 	}
 
 	virtual ~DreamLinkVmu() {
-		running = false;
-
 		// Entering lock context
 		{
 			std::unique_lock<std::mutex> lock(writeMutex);
-			writeCv.notify_all();
+			running = false;
 		}
 
-		writeThread.join();
+		writeQueue.stop();
 	}
 
 	void OnSetup() override
@@ -2209,11 +2194,7 @@ struct DreamLinkVmu : public maple_sega_vmu
 		if (useRealVmuMemory)
 		{
 			// Ensure file is not being used
-			if (file != nullptr)
-			{
-				std::fclose(file);
-				file = nullptr;
-			}
+			file.close();
 
 			memset(flash_data, 0, sizeof(flash_data));
 			memset(lcd_data, 0, sizeof(lcd_data));
@@ -2303,7 +2284,7 @@ struct DreamLinkVmu : public maple_sega_vmu
 							if (std::find(blocksToWrite.begin(), blocksToWrite.end(), lastWriteBlock) == blocksToWrite.end())
 							{
 								blocksToWrite.push_back(lastWriteBlock);
-								writeCv.notify_all();
+								writeQueue.run([this]() { writeBlocks(); });
 							}
 						}
 
@@ -2403,8 +2384,8 @@ struct DreamLinkVmu : public maple_sega_vmu
 	}
 
 private:
-	//! Thread entrypoint for write operations
-	void writeEntrypoint()
+	//! Writes the pending blocks to the physical VMU. Runs on the task pool.
+	void writeBlocks()
 	{
 		while (true)
 		{
@@ -2413,9 +2394,7 @@ private:
 			// Entering lock context
 			{
 				std::unique_lock<std::mutex> lock(writeMutex);
-				writeCv.wait(lock, [this](){ return (!running || !blocksToWrite.empty()); });
-
-				if (!running)
+				if (!running || blocksToWrite.empty())
 				{
 					break;
 				}
@@ -6,6 +6,7 @@
 #include "hw/sh4/sh4_mem.h"
 #include "hw/sh4/sh4_sched.h"
 #include "network/ggpo.h"
+#include "input/movie.h"
 #include "hw/naomi/card_reader.h"
 
 #include <memory>
@@ -163,6 +164,8 @@ static void maple_DoDma()
 #endif
 
 	ggpo::getInput(mapleInputState);
+	if (movie::active())
+		movie::processInput(mapleInputState);
 	// TODO put this elsewhere and let the card readers handle being called multiple times
 	if (settings.platform.isNaomi())
 	{
@@ -0,0 +1,167 @@
+/*
+	Copyright 2026 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "vmu_file.h"
+#include <nowide/cstdio.hpp>
+#include <cerrno>
+#include <cstring>
+#ifdef _WIN32
+#include <windows.h>
+#include <io.h>
+#include <nowide/convert.hpp>
+#else
+#include <unistd.h>
+#endif
+
+// Make sure the file content has reached the disk
+static bool syncFile(FILE *f)
+{
+	if (std::fflush(f) != 0)
+		return false;
+#ifdef _WIN32
+	return _commit(_fileno(f)) == 0;
+#else
+	return fsync(fileno(f)) == 0;
+#endif
+}
+
+static bool replaceFile(const std::string& from, const std::string& to)
+{
+#ifdef _WIN32
+	return MoveFileExW(nowide::widen(from).c_str(), nowide::widen(to).c_str(),
+			MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+	return std::rename(from.c_str(), to.c_str()) == 0;
+#endif
+}
+
+bool VmuFile::open(const std::string& path, const u8 *flash, bool& created)
+{
+	close();
+	FILE *f = nowide::fopen(path.c_str(), "rb");
+	created = f == nullptr;
+	if (created)
+		// Make sure the file can be created
+		f = nowide::fopen(path.c_str(), "wb");
+	if (f == nullptr)
+		return false;
+	std::fclose(f);
+
+	std::lock_guard<std::mutex> _(mutex);
+	this->path = path;
+	memcpy(image, flash, sizeof(image));
+	dirtyBlocks.reset();
+	commitFailed = false;
+	return true;
+}
+
+void VmuFile::close()
+{
+	if (!isOpen())
+		return;
+	if (!flush())
+		WARN_LOG(MAPLE, "VMU file %s closed with unsaved changes", path.c_str());
+	std::lock_guard<std::mutex> _(mutex);
+	path.clear();
+	dirtyBlocks.reset();
+}
+
+bool VmuFile::write(const u8 *flash, u32 offset, u32 size)
+{
+	verify(offset + size <= Size);
+	std::lock_guard<std::mutex> _(mutex);
+	if (!isOpen())
+		return false;
+	memcpy(&image[offset], &flash[offset], size);
+	for (u32 block = offset / BlockSize; block * BlockSize < offset + size; block++)
+		dirtyBlocks.set(block);
+	stats.writes++;
+	scheduleCommit();
+	// Report the failure of the previous commit. This data is part of the next one anyway.
+	return !commitFailed;
+}
+
+// Must be called with the mutex held
+void VmuFile::scheduleCommit()
+{
+	if (commitScheduled)
+		return;
+	commitScheduled = true;
+	commitQueue.run([this]() {
+		commit();
+	});
+}
+
+void VmuFile::commit()
+{
+	std::bitset<Size / BlockSize> blocks;
+	std::string path;
+	{
+		std::lock_guard<std::mutex> _(mutex);
+		path = this->path;
+		memcpy(commitBuffer, image, sizeof(commitBuffer));
+		blocks = dirtyBlocks;
+		dirtyBlocks.reset();
+		// Any later write needs a new commit
+		commitScheduled = false;
+	}
+	const std::string tmpPath = path + ".tmp";
+	FILE *f = nowide::fopen(tmpPath.c_str(), "wb");
+	bool success = f != nullptr
+			&& std::fwrite(commitBuffer, sizeof(commitBuffer), 1, f) == 1
+			&& syncFile(f);
+	if (f != nullptr)
+		std::fclose(f);
+	success = success && replaceFile(tmpPath, path);
+	if (!success)
+	{
+		ERROR_LOG(MAPLE, "Failed to save the VMU file %s: errno %d", path.c_str(), errno);
+		nowide::remove(tmpPath.c_str());
+	}
+	std::lock_guard<std::mutex> _(mutex);
+	commitFailed = !success;
+	if (success)
+	{
+		stats.commits++;
+		stats.blocks += blocks.count();
+	}
+	else
+	{
+		// Retried by the next commit
+		dirtyBlocks |= blocks;
+	}
+}
+
+bool VmuFile::flush()
+{
+	{
+		std::lock_guard<std::mutex> _(mutex);
+		// Retry the blocks of a failed commit
+		if (dirtyBlocks.any())
+			scheduleCommit();
+	}
+	commitQueue.stop();
+	std::lock_guard<std::mutex> _(mutex);
+	return !commitFailed;
+}
+
+VmuFile::Stats VmuFile::getStats() const
+{
+	std::lock_guard<std::mutex> _(mutex);
+	return stats;
+}
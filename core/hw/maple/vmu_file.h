@@ -0,0 +1,84 @@
+/*
+	Copyright 2026 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include "types.h"
+#include "util/task_pool.h"
+#include <bitset>
+#include <mutex>
+#include <string>
+
+//
+// Write-behind storage of a VMU flash image.
+// Writes only update an in-memory copy of the image, which is committed to disk by a background task.
+// A commit writes the whole image to a temporary file that then replaces the VMU file, so that a crash
+// never leaves a partially written file behind. Writes received while a commit is in progress are
+// coalesced into the next one. The blocks of a failed commit stay dirty and are committed again
+// by the next write, flush or close.
+//
+class VmuFile
+{
+public:
+	static constexpr u32 Size = 128_KB;
+	static constexpr u32 BlockSize = 512;
+
+	struct Stats
+	{
+		u64 writes;			// write requests
+		u64 commits;		// successful file commits
+		u64 blocks;			// dirty blocks committed
+	};
+
+	~VmuFile() {
+		close();
+	}
+
+	// Opens the given file, creating it if needed. created is set if the file didn't exist.
+	// flash is the current content of the VMU.
+	bool open(const std::string& path, const u8 *flash, bool& created);
+	// Commits the pending writes and closes the file
+	void close();
+	bool isOpen() const {
+		return !path.empty();
+	}
+
+	// Schedules the write of the given range of the flash image.
+	// Returns false if the file isn't open or if the last commit failed.
+	// Failed writes are retried by the next commit.
+	bool write(const u8 *flash, u32 offset, u32 size);
+	// Waits until the pending and previously failed writes are committed.
+	// Returns false if the last commit failed.
+	bool flush();
+
+	Stats getStats() const;
+
+private:
+	void scheduleCommit();
+	void commit();
+
+	std::string path;
+	u8 image[Size];
+	std::bitset<Size / BlockSize> dirtyBlocks;
+	bool commitScheduled = false;
+	bool commitFailed = false;
+	Stats stats {};
+	mutable std::mutex mutex;
+	// Only used by the commit task
+	u8 commitBuffer[Size];
+	TaskQueue commitQueue { "VmuFile", TaskPool::Background };
+};
@@ -123,6 +123,40 @@ static void DSPTestEnd();
 static u64 last_dial_time;
 static bool data_sent;
 
+// Transmitted and received bytes are exchanged with the network service in bursts
+constexpr u32 FIFO_SIZE = 16;
+static u8 txFifo[FIFO_SIZE];
+static u32 txCount;
+static u8 rxFifo[FIFO_SIZE];
+static u32 rxStart;
+static u32 rxCount;
+
+static void flushTxFifo()
+{
+	if (txCount > 0)
+	{
+		net::modbba::writeModem(txFifo, txCount);
+		txCount = 0;
+	}
+}
+
+static void receiveFifoByte()
+{
+	modem_regs.reg00 = rxFifo[rxStart++];
+	rxCount--;
+	modem_regs.reg1e.RDBF = 1;
+	if (modem_regs.reg04.FIFOEN)
+		SET_STATUS_BIT(0x0c, modem_regs.reg0c.RXFNE, 1);
+	SET_STATUS_BIT(0x01, modem_regs.reg01.RXHF, 1);
+}
+
+static void resetFifos()
+{
+	txCount = 0;
+	rxStart = 0;
+	rxCount = 0;
+}
+
 #ifndef NDEBUG
 static u64 last_comm_stats;
 static int sent_bytes;
@@ -285,23 +319,22 @@ static int modem_sched_func(int tag, int cycles, int jitter, void *arg)
 			// 38400 @ 10b: 260
 			callback_cycles = SH4_MAIN_CLOCK / 1000000 * 143;
 			modem_regs.reg1e.TDBE = 1;
+			flushTxFifo();
 
 			// Let WinCE send data first to avoid choking it
 			if (!modem_regs.reg1e.RDBF && data_sent)
 			{
-				int c = net::modbba::readModem();
-				if (c >= 0)
+				if (rxCount == 0)
 				{
-					//LOG("pppd received %02x", c);
+					// Fetch a whole burst if the receive FIFO is enabled
+					rxStart = 0;
+					rxCount = net::modbba::readModem(rxFifo, modem_regs.reg04.FIFOEN ? FIFO_SIZE : 1);
 #ifndef NDEBUG
-					recvd_bytes++;
+					recvd_bytes += rxCount;
 #endif
-					modem_regs.reg00 = c & 0xFF;
-					modem_regs.reg1e.RDBF = 1;
-					if (modem_regs.reg04.FIFOEN)
-						SET_STATUS_BIT(0x0c, modem_regs.reg0c.RXFNE, 1);
-					SET_STATUS_BIT(0x01, modem_regs.reg01.RXHF, 1);
 				}
+				if (rxCount > 0)
+					receiveFifoByte();
 			}
 
 			break;
@@ -363,6 +396,7 @@ static void NormalDefaultRegs()
 	modem_regs.reg1e.TDBE = 1;
 	connect_state = DISCONNECTED;
 	last_dial_time = 0;
+	resetFifos();
 }
 static void DSPTestEnd()
 {
@@ -434,6 +468,7 @@ static void modem_reset(u32 v)
 		memset(&modem_regs, 0, sizeof(modem_regs));
 		state = MS_RESET;
 		LOG("Modem reset start ...");
+		resetFifos();
 		net::modbba::stop();
 	}
 	else
@@ -517,7 +552,9 @@ static void ModemNormalWrite(u32 reg, u32 data)
 #ifndef NDEBUG
 			sent_bytes++;
 #endif
-			net::modbba::writeModem(data);
+			txFifo[txCount++] = data;
+			if (txCount == FIFO_SIZE)
+				flushTxFifo();
 			modem_regs.reg1e.TDBE = 0;
 		}
 		break;
@@ -672,9 +709,17 @@ u32 ModemReadMem_A0_006(u32 addr, u32 size)
 				if (reg == 0x00)	// RBUFFER
 				{
 					//LOG("Read RBUFFER = %X", data);
-					modem_regs.reg1e.RDBF = 0;
-					SET_STATUS_BIT(0x0c, modem_regs.reg0c.RXFNE, 0);
-					SET_STATUS_BIT(0x01, modem_regs.reg01.RXHF, 0);
+					if (modem_regs.reg04.FIFOEN && rxCount > 0)
+					{
+						// Next byte in the receive FIFO
+						receiveFifoByte();
+					}
+					else
+					{
+						modem_regs.reg1e.RDBF = 0;
+						SET_STATUS_BIT(0x0c, modem_regs.reg0c.RXFNE, 0);
+						SET_STATUS_BIT(0x01, modem_regs.reg01.RXHF, 0);
+					}
 					update_interrupt();
 				}
 				else if (reg == 0x16 || reg == 0x17)
@@ -747,6 +792,11 @@ void ModemSerialize(Serializer& ser)
 	ser << connect_state;
 	ser << last_dial_time;
 	ser << data_sent;
+	ser << txFifo;
+	ser << txCount;
+	ser << rxFifo;
+	ser << rxStart;
+	ser << rxCount;
 }
 void ModemDeserialize(Deserializer& deser)
 {
@@ -761,4 +811,15 @@ void ModemDeserialize(Deserializer& deser)
 		deser >> last_dial_time;
 		deser >> data_sent;
 	}
+	if (deser.version() >= Deserializer::V55)
+	{
+		deser >> txFifo;
+		deser >> txCount;
+		deser >> rxFifo;
+		deser >> rxStart;
+		deser >> rxCount;
+	}
+	else {
+		resetFifos();
+	}
 }
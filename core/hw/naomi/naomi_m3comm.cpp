@@ -32,7 +32,6 @@
 #include "emulator.h"
 #include "oslib/oslib.h"
 
-#include <chrono>
 #include <memory>
 
 constexpr u16 COMM_CTRL_CPU_RAM = 1 << 0;
@@ -91,7 +90,7 @@ bool NaomiM3Comm::receiveNetwork()
 	std::unique_ptr<u8[]> buf = std::make_unique<u8[]>(packet_size);
 
 	u16 packetNumber;
-	if (!naomiNetwork.receive(buf.get(), packet_size, &packetNumber))
+	if (!naomiNetwork.receive(buf.get(), packet_size, &packetNumber, 100))
 		return false;
 
 	*(u16*)&comm_ram[6] = swap16(packetNumber);
@@ -267,14 +266,9 @@ void NaomiM3Comm::vblank()
 	if ((comm_ctrl & COMM_CTRL_RESET) == 0 || comm_status1 == 0)
 		return;
 
-	using the_clock = std::chrono::high_resolution_clock;
-	the_clock::time_point start = the_clock::now();
 	try {
-		bool received = false;
-		do {
-			received = receiveNetwork();
-		} while (!received && the_clock::now() - start < std::chrono::milliseconds(100));
-		if (!received)
+		// Wait up to 100 ms for the previous node's data
+		if (!receiveNetwork())
 			INFO_LOG(NETWORK, "No data received");
 		sendNetwork();
 	} catch (const FlycastException& e) {
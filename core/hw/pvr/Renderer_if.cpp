@@ -9,8 +9,11 @@
 #include "hw/sh4/sh4_if.h"
 #include "hw/sh4/sh4_core.h"
 #include "profiler/fc_profiler.h"
+#include "profiler/benchmark.h"
+#include "profiler/metrics.h"
 #include "network/ggpo.h"
 
+#include <chrono>
 #include <mutex>
 #include <deque>
 
@@ -41,6 +44,19 @@ TA_context* _pvrrc;
 static bool presented;
 static u32 fbAddrHistory[2] { 1, 1 };
 
+// fast-forward frame skipping
+struct FastForwardSkipper
+{
+	u32 frameCount = 0;
+	std::chrono::steady_clock::time_point lastFrameTime;
+
+	bool skip();
+};
+// TA and framebuffer renders are paced independently
+static FastForwardSkipper ffTaSkipper;
+static FastForwardSkipper ffFramebufferSkipper;
+static bool ffFrameRendered;
+
 class PvrMessageQueue
 {
 	using lock_guard = std::lock_guard<std::mutex>;
@@ -77,6 +93,7 @@ public:
 						}
 					if (!dupe || type == Present) {
 						queue.push_back(msg);
+						fc_profiler::counter("Render queue", queue.size());
 						dupe = false;
 					}
 				}
@@ -234,6 +251,7 @@ private:
 		if (renderer->Present())
 		{
 			presented = true;
+			metrics::framesPresented.inc();
 			if (!config::ThreadedRendering && !ggpo::active())
 				emu.getSh4Executor()->Stop();
 #ifdef LIBRETRO
@@ -265,6 +283,7 @@ bool rend_single_frame(const bool& enabled)
 Renderer* rend_GLES2();
 Renderer* rend_GL4();
 Renderer* rend_norend();
+Renderer* rend_Software();
 Renderer* rend_Vulkan();
 Renderer* rend_OITVulkan();
 Renderer* rend_DirectX9();
@@ -276,6 +295,12 @@ static void rend_create_renderer()
 #ifdef NO_REND
 	renderer	 = rend_norend();
 #else
+	if (benchmark::active())
+	{
+		// The software renderer has no presentation path and is only used to measure rendering times
+		renderer = config::RendererType == RenderType::Software ? rend_Software() : rend_norend();
+		return;
+	}
 	switch (config::RendererType)
 	{
 	default:
@@ -418,6 +443,7 @@ void rend_start_render()
 	{
 		palette_update();
 		pend_rend = true;
+		ffFrameRendered |= !ctx->rend.isRTT;
 		pvrQueue.enqueue(PvrMessageQueue::Render);
 		if (!config::DelayFrameSwapping && !ctx->rend.isRTT && !config::EmulateFramebuffer)
 			pvrQueue.enqueue(PvrMessageQueue::Present);
@@ -449,7 +475,7 @@ void rend_vblank()
 	if (config::EmulateFramebuffer
 			|| (!render_called && fb_dirty && FB_R_CTRL.fb_enable))
 	{
-		if (rend_is_enabled())
+		if (rend_is_enabled() && !rend_fast_forward_skip(true))
 		{
 			FramebufferInfo fbInfo;
 			fbInfo.update();
@@ -497,7 +523,36 @@ void rend_set_fb_write_addr(u32 fb_w_sof1)
 void rend_swap_frame(u32 fb_r_sof)
 {
 	if (!config::EmulateFramebuffer && fb_r_sof == fb_w_cur && rend_is_enabled())
+	{
+		// Don't present the same frame again if it's been skipped
+		if (settings.input.fastForwardMode && !ffFrameRendered)
+			return;
+		ffFrameRendered = false;
 		pvrQueue.enqueue(PvrMessageQueue::Present);
+	}
+}
+
+bool FastForwardSkipper::skip()
+{
+	if (config::FastForwardFrames > 0)
+		return ++frameCount % config::FastForwardFrames != 0;
+
+	// Render as many frames as the display can show
+	using the_clock = std::chrono::steady_clock;
+	const float refreshRate = settings.display.refreshRate > 0.f ? settings.display.refreshRate : 60.f;
+	const auto period = std::chrono::duration_cast<the_clock::duration>(std::chrono::duration<float>(1.f / refreshRate));
+	const the_clock::time_point now = the_clock::now();
+	if (now - lastFrameTime < period)
+		return true;
+	lastFrameTime = now;
+	return false;
+}
+
+bool rend_fast_forward_skip(bool framebuffer)
+{
+	if (!settings.input.fastForwardMode)
+		return false;
+	return framebuffer ? ffFramebufferSkipper.skip() : ffTaSkipper.skip();
 }
 
 void rend_disable_rollback()
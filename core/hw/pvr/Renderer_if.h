@@ -21,6 +21,9 @@ void rend_start_rollback();
 void rend_allow_rollback();
 void rend_enable_renderer(bool enabled);
 bool rend_is_enabled();
+// Returns true if the current frame should be skipped because fast-forward is enabled.
+// TA renders and framebuffer renders (framebuffer = true) are counted separately.
+bool rend_fast_forward_skip(bool framebuffer = false);
 void rend_serialize(Serializer& ser);
 void rend_deserialize(Deserializer& deser);
 static void rend_updatePalette();
@@ -62,6 +62,9 @@
 #include "elan_struct.h"
 #include "network/ggpo.h"
 #include "cfg/option.h"
+#include "profiler/benchmark.h"
+#include "rend/soft/simd.h"
+#include "util/task_pool.h"
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
@@ -717,17 +720,80 @@ void convertVertex(const N2_VERTEX_VUB& vs, Vertex& vd)
 //			);
 }
 
+//
+// Vertices of the current list are processed in batches:
+// positions are first copied in SoA form to compute the bounding box and the near plane distances 4 at a time,
+// then vertices are decoded in one pass, on worker threads for large lists.
+//
+struct VertexBatch
+{
+	// Positions, padded to a multiple of 4 with the last vertex
+	std::vector<float> x;
+	std::vector<float> y;
+	std::vector<float> z;
+	// Signed distance to the near plane, negative if clipped
+	std::vector<float> dist;
+	std::vector<Vertex> vertices;
+	u32 count = 0;
+};
+static VertexBatch batch;
+// Lists with more vertices are decoded in parallel
+constexpr u32 ParallelDecodeMin = 4096;
+
+using soft::f32x4;
+
 template <typename T>
-static void boundingBox(const T* vertices, u32 count, glm::vec3& min, glm::vec3& max)
+static void loadPositions(const T* vertices, u32 count)
 {
-	min = { 1e38f, 1e38f, 1e38f };
-	max = { -1e38f, -1e38f, -1e38f };
+	const u32 padded = (count + 3) & ~3;
+	batch.count = count;
+	batch.x.resize(padded);
+	batch.y.resize(padded);
+	batch.z.resize(padded);
 	for (u32 i = 0; i < count; i++)
 	{
-		glm::vec3 pos{ vertices[i].x, vertices[i].y, vertices[i].z };
-		min = glm::min(min, pos);
-		max = glm::max(max, pos);
+		batch.x[i] = vertices[i].x;
+		batch.y[i] = vertices[i].y;
+		batch.z[i] = vertices[i].z;
 	}
+	for (u32 i = count; i < padded; i++)
+	{
+		batch.x[i] = batch.x[count - 1];
+		batch.y[i] = batch.y[count - 1];
+		batch.z[i] = batch.z[count - 1];
+	}
+}
+
+// Untransformed bounding box of the batch
+static void positionBounds(glm::vec3& lo, glm::vec3& hi)
+{
+	// The new value is the first operand so that NaN coordinates are ignored, like glm::min and glm::max
+	f32x4 minX(1e38f), minY(1e38f), minZ(1e38f);
+	f32x4 maxX(-1e38f), maxY(-1e38f), maxZ(-1e38f);
+	for (u32 i = 0; i < batch.count; i += 4)
+	{
+		const f32x4 x = f32x4::loadu(&batch.x[i]);
+		const f32x4 y = f32x4::loadu(&batch.y[i]);
+		const f32x4 z = f32x4::loadu(&batch.z[i]);
+		minX = min(x, minX);
+		minY = min(y, minY);
+		minZ = min(z, minZ);
+		maxX = max(x, maxX);
+		maxY = max(y, maxY);
+		maxZ = max(z, maxZ);
+	}
+	lo = { minX[0], minY[0], minZ[0] };
+	hi = { maxX[0], maxY[0], maxZ[0] };
+	for (int i = 1; i < 4; i++)
+	{
+		lo = glm::min(lo, glm::vec3(minX[i], minY[i], minZ[i]));
+		hi = glm::max(hi, glm::vec3(maxX[i], maxY[i], maxZ[i]));
+	}
+}
+
+static void boundingBox(glm::vec3& min, glm::vec3& max)
+{
+	positionBounds(min, max);
 	glm::vec4 center((min + max) / 2.f, 1);
 	glm::vec4 extents(max - glm::vec3(center), 0);
 	// transform
@@ -742,12 +808,15 @@ static void boundingBox(const T* vertices, u32 count, glm::vec3& min, glm::vec3&
 	max = glm::vec3(center) + newExtent;
 }
 
+// Also loads the vertex positions for sendVertices()
 template <typename T>
 static bool isBetweenNearAndFar(const T* vertices, u32 count, bool& needNearClipping)
 {
+	benchmark::ScopedTimer _(benchmark::Section::Elan);
+	loadPositions(vertices, count);
 	glm::vec3 min;
 	glm::vec3 max;
-	boundingBox(vertices, count, min, max);
+	boundingBox(min, max);
 	if (min.z > -nearPlane || max.z < -farPlane)
 		return false;
 
@@ -766,12 +835,11 @@ class TriangleStripClipper
 public:
 	TriangleStripClipper(bool enabled) : enabled(enabled) {}
 
-	void add(const Vertex& vtx)
+	// dist is the distance to the near plane, only used if clipping is enabled
+	void add(const Vertex& vtx, float dist)
 	{
 		if (enabled)
 		{
-			float z = vtx.x * curMatrix[0][2] + vtx.y * curMatrix[1][2] + vtx.z * curMatrix[2][2] + curMatrix[3][2];
-			float dist = -z - nearPlane;
 			clip(vtx, dist);
 			count++;
 		}
@@ -907,60 +975,102 @@ private:
 	bool dupeNext = false;
 };
 
+// Same computation as the view space z: x * m[0][2] + y * m[1][2] + z * m[2][2] + m[3][2]
+static void nearPlaneDistances()
+{
+	const u32 padded = (u32)batch.x.size();
+	batch.dist.resize(padded);
+	const f32x4 m0(curMatrix[0][2]);
+	const f32x4 m1(curMatrix[1][2]);
+	const f32x4 m2(curMatrix[2][2]);
+	const f32x4 m3(curMatrix[3][2]);
+	const f32x4 nearDist(nearPlane);
+	const f32x4 zero(0.f);
+	for (u32 i = 0; i < padded; i += 4)
+	{
+		const f32x4 z = f32x4::loadu(&batch.x[i]) * m0 + f32x4::loadu(&batch.y[i]) * m1
+				+ f32x4::loadu(&batch.z[i]) * m2 + m3;
+		(zero - z - nearDist).storeu(&batch.dist[i]);
+	}
+}
+
+template <typename T>
+static void decodeVertices(const T* vtx, u32 count)
+{
+	batch.vertices.resize(count);
+	const auto& decode = [vtx](int start, int end) {
+		for (int i = start; i < end; i++)
+			convertVertex(vtx[i], batch.vertices[i]);
+	};
+	if (count >= ParallelDecodeMin)
+		TaskPool::instance().parallelFor(0, count, decode, count / (ParallelDecodeMin / 2));
+	else
+		decode(0, count);
+}
+
+// The vertex positions must have been loaded by isBetweenNearAndFar()
 template <typename T>
 static void sendVertices(const ICHList *list, const T* vtx, bool needClipping)
 {
-	Vertex taVtx;
 	verify(list->vertexSize() > 0);
+	verify(batch.count == list->vtxCount);
+	benchmark::ScopedTimer _(benchmark::Section::Elan);
+
+	decodeVertices(vtx, list->vtxCount);
+	if (needClipping)
+		nearPlaneDistances();
+	const Vertex *vertices = batch.vertices.data();
+	const float *dist = needClipping ? batch.dist.data() : nullptr;
+	const auto& distance = [dist](u32 i) {
+		return dist != nullptr ? dist[i] : 0.f;
+	};
 
-	Vertex fanCenterVtx{};
-	Vertex fanLastVtx{};
+	u32 fanCenter = 0;
+	u32 fanLast = 0;
 	bool stripStart = true;
 	int outStripIndex = 0;
 	TriangleStripClipper clipper(needClipping);
 
 	for (u32 i = 0; i < list->vtxCount; i++)
 	{
-		convertVertex(*vtx, taVtx);
-
 		if (stripStart)
 		{
 			// Center vertex if triangle fan
 			//verify(vtx->header.isFirstOrSecond()); This fails for some strips: strip=1 fan=0 (soul surfer)
-			fanCenterVtx = taVtx;
 			if (outStripIndex > 0)
 			{
 				// use degenerate triangles to link strips
-				clipper.add(fanLastVtx);
-				clipper.add(taVtx);
+				clipper.add(vertices[fanLast], distance(fanLast));
+				clipper.add(vertices[i], distance(i));
 				outStripIndex += 2;
 				if (outStripIndex & 1)
 				{
-					clipper.add(taVtx);
+					clipper.add(vertices[i], distance(i));
 					outStripIndex++;
 				}
 			}
+			fanCenter = i;
 			stripStart = false;
 		}
 		else if (vtx->header.isFan())
 		{
 			// use degenerate triangles to link strips
-			clipper.add(fanLastVtx);
-			clipper.add(fanCenterVtx);
+			clipper.add(vertices[fanLast], distance(fanLast));
+			clipper.add(vertices[fanCenter], distance(fanCenter));
 			outStripIndex += 2;
 			if (outStripIndex & 1)
 			{
-				clipper.add(fanCenterVtx);
+				clipper.add(vertices[fanCenter], distance(fanCenter));
 				outStripIndex++;
 			}
 			// Triangle fan
-			clipper.add(fanCenterVtx);
-			clipper.add(fanLastVtx);
+			clipper.add(vertices[fanCenter], distance(fanCenter));
+			clipper.add(vertices[fanLast], distance(fanLast));
 			outStripIndex += 2;
 		}
-		clipper.add(taVtx);
+		clipper.add(vertices[i], distance(i));
 		outStripIndex++;
-		fanLastVtx = taVtx;
+		fanLast = i;
 		if (vtx->header.endOfStrip)
 			stripStart = true;
 
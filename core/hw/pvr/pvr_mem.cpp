@@ -10,6 +10,9 @@
 #include "hw/holly/sb.h"
 #include "hw/holly/holly_intc.h"
 #include "serialize.h"
+#include "yuv_convert.h"
+#include "profiler/benchmark.h"
+#include <algorithm>
 
 static u32 pvr_map32(u32 offset32);
 
@@ -47,80 +50,40 @@ void YUV_init()
 	YUV_index = 0;
 }
 
-static void YUV_Block8x8(const u8* inuv, const u8* iny, u8* out)
+// Convert count complete macroblocks
+static void YUV_ConvertMacroBlocks(const u8 *datap, u32 count)
 {
-	u8* line_out_0=out+0;
-	u8* line_out_1=out+YUV_x_size*2;
-
-	for (int y=0;y<8;y+=2)
+	benchmark::ScopedTimer _(benchmark::Section::YuvConvert);
+	benchmark::yuvConverted(count);
+	while (count != 0)
 	{
-		for (int x=0;x<8;x+=2)
+		// Blocks of the same row are contiguous in vram
+		u32 blocks = std::min(count, (YUV_x_size - YUV_x_curr) / 16);
+		if (YUV_blockcount > TA_YUV_TEX_CNT)
+			blocks = std::min(blocks, YUV_blockcount - TA_YUV_TEX_CNT);
+		yuv::convert(datap, &vram[YUV_dest], YUV_x_size * 2, blocks);
+		datap += blocks * yuv::MacroBlockSize;
+		count -= blocks;
+		TA_YUV_TEX_CNT += blocks;
+
+		YUV_dest += 32 * blocks;
+
+		YUV_x_curr += 16 * blocks;
+		if (YUV_x_curr == YUV_x_size)
 		{
-			u8 u=inuv[0];
-			u8 v=inuv[64];
-
-			line_out_0[0]=u;
-			line_out_0[1]=iny[0];
-			line_out_0[2]=v;
-			line_out_0[3]=iny[1];
-
-			line_out_1[0]=u;
-			line_out_1[1]=iny[8+0];
-			line_out_1[2]=v;
-			line_out_1[3]=iny[8+1];
-
-			inuv+=1;
-			iny+=2;
-
-			line_out_0+=4;
-			line_out_1+=4;
+			YUV_dest += 15 * YUV_x_size * 2;
+			YUV_x_curr = 0;
+			YUV_y_curr += 16;
+			if (YUV_y_curr == YUV_y_size)
+				YUV_y_curr = 0;
 		}
-		iny+=8;
-		inuv+=4;
-
-		line_out_0+=YUV_x_size*4-8*2;
-		line_out_1+=YUV_x_size*4-8*2;
-	}
-}
 
-static void YUV_Block384(const u8 *in, u8 *out)
-{
-	const u8 *inuv = in;
-	const u8 *iny = in + 128;
-	u8* p_out = out;
-
-	YUV_Block8x8(inuv+ 0,iny+  0,p_out);                    //(0,0)
-	YUV_Block8x8(inuv+ 4,iny+64,p_out+8*2);                 //(8,0)
-	YUV_Block8x8(inuv+32,iny+128,p_out+YUV_x_size*8*2);     //(0,8)
-	YUV_Block8x8(inuv+36,iny+192,p_out+YUV_x_size*8*2+8*2); //(8,8)
-}
-
-static void YUV_ConvertMacroBlock(const u8 *datap)
-{
-	//do shit
-	TA_YUV_TEX_CNT++;
-
-	YUV_Block384(datap, &vram[YUV_dest]);
-
-	YUV_dest+=32;
-
-	YUV_x_curr+=16;
-	if (YUV_x_curr==YUV_x_size)
-	{
-		YUV_dest+=15*YUV_x_size*2;
-		YUV_x_curr=0;
-		YUV_y_curr+=16;
-		if (YUV_y_curr==YUV_y_size)
+		if (YUV_blockcount == TA_YUV_TEX_CNT)
 		{
-			YUV_y_curr=0;
-		}
-	}
+			YUV_init();
 
-	if (YUV_blockcount==TA_YUV_TEX_CNT)
-	{
-		YUV_init();
-		
-		asic_RaiseInterrupt(holly_YUV_DMA);
+			asic_RaiseInterrupt(holly_YUV_DMA);
+		}
 	}
 }
 
@@ -146,20 +109,23 @@ static void YUV_data(const SQBuffer *data, u32 count)
 		if (YUV_index + count >= block_size)
 		{
 			//more or exactly one block remaining
-			u32 dr = block_size - YUV_index;				//remaining bytes til block end
 			if (YUV_index == 0)
 			{
-				// Avoid copy
-				YUV_ConvertMacroBlock((const u8 *)data);	//convert block
+				// Convert all the complete blocks in place
+				u32 blocks = count / block_size;
+				YUV_ConvertMacroBlocks((const u8 *)data, blocks);
+				data += blocks * block_size;
+				count -= blocks * block_size;
 			}
 			else
 			{
+				u32 dr = block_size - YUV_index;				//remaining bytes til block end
 				memcpy(&YUV_tempdata[YUV_index], data, dr * sizeof(SQBuffer));	//copy em
-				YUV_ConvertMacroBlock((const u8 *)&YUV_tempdata[0]);	//convert block
+				YUV_ConvertMacroBlocks((const u8 *)&YUV_tempdata[0], 1);	//convert block
 				YUV_index = 0;
+				data += dr;										//count em
+				count -= dr;
 			}
-			data += dr;											//count em
-			count -= dr;
 		}
 		else
 		{	//less that a whole block remaining
@@ -241,6 +207,35 @@ template void pvr_write32p<u16, true>(u32 addr, u16 data);
 template void pvr_write32p<u32, false>(u32 addr, u32 data);
 template void pvr_write32p<u32, true>(u32 addr, u32 data);
 
+void pvr_read32_block(u32 addr, u8 *dst, u32 size)
+{
+	while (size != 0)
+	{
+		// 32-bit words are contiguous in both paths
+		const u32 n = std::min(4 - (addr & 3), size);
+		memcpy(dst, &vram[pvr_map32(addr)], n);
+		addr += n;
+		dst += n;
+		size -= n;
+	}
+}
+
+void pvr_write32_block(u32 addr, const u8 *src, u32 size)
+{
+	const u32 vaddr = addr & VRAM_MASK;
+	if (vaddr < fb_watch_addr_end && vaddr + size > fb_watch_addr_start)
+		fb_dirty = true;
+
+	while (size != 0)
+	{
+		const u32 n = std::min(4 - (addr & 3), size);
+		memcpy(&vram[pvr_map32(addr)], src, n);
+		addr += n;
+		src += n;
+		size -= n;
+	}
+}
+
 void DYNACALL TAWrite(u32 address, const SQBuffer *data, u32 count)
 {
 	if ((address & 0x800000) == 0)
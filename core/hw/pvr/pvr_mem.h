@@ -21,6 +21,9 @@ void YUV_reset();
 // 32-bit vram path handlers
 template<typename T> T DYNACALL pvr_read32p(u32 addr);
 template<typename T, bool Internal = false> void DYNACALL pvr_write32p(u32 addr, T data);
+// Copy a block of memory from/to the 32-bit vram path
+void pvr_read32_block(u32 addr, u8 *dst, u32 size);
+void pvr_write32_block(u32 addr, const u8 *src, u32 size);
 // Area 4 handlers
 template<typename T, bool upper> T DYNACALL pvr_read_area4(u32 addr);
 template<typename T, bool upper> void DYNACALL pvr_write_area4(u32 addr, T data);
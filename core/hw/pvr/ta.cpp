@@ -571,24 +571,53 @@ void DYNACALL ta_vtx_data32(const SQBuffer *data)
 	ta_thd_data32_i((const simd256_t *)data);
 }
 
-void ta_vtx_data(const SQBuffer *data, u32 size)
+// Number of vertex parameters at the start of data that can be appended in one go.
+// Vertex parameters don't change the state in TAS_PLV32 (32B vertices), TAS_PLV64 and TAS_MLV64 (64B vertices),
+// so the FSM is only needed at list, polygon or vertex type boundaries.
+static u32 vertexRunLength(const SQBuffer *data, u32 size)
 {
-	while (size >= 4)
+	u32 step;
+	switch (ta_cur_state)
 	{
-		ta_thd_data32_i((simd256_t *)data);
-		data++;
-		ta_thd_data32_i((simd256_t *)data);
-		data++;
-		ta_thd_data32_i((simd256_t *)data);
-		data++;
-		ta_thd_data32_i((simd256_t *)data);
-		data++;
-		size -= 4;
+	case TAS_PLV32:
+		step = 1;
+		break;
+	case TAS_PLV64:
+	case TAS_MLV64:
+		// the second half of a 64B vertex can be anything
+		step = 2;
+		break;
+	default:
+		return 0;
 	}
+	if (ta_ctx == nullptr || ta_tad.thd_data == ta_tad.thd_root)
+		return 0;
+	// Leave the overflow case to ta_thd_data32_i
+	const u32 room = (TA_DATA_SIZE - (ta_tad.thd_data - ta_tad.thd_root)) / sizeof(SQBuffer);
+	size = std::min(size, room);
+
+	u32 count = 0;
+	while (count + step <= size && ((const PCW *)&data[count])->ParaType == ParamType_Vertex_Parameter)
+		count += step;
+	return count;
+}
 
+void ta_vtx_data(const SQBuffer *data, u32 size)
+{
 	while (size > 0)
 	{
-		ta_thd_data32_i((simd256_t *)data);
+		const u32 run = vertexRunLength(data, size);
+		if (run > 0)
+		{
+			memcpy(ta_tad.thd_data, data, run * sizeof(SQBuffer));
+			ta_tad.thd_data += run * sizeof(SQBuffer);
+			data += run;
+			size -= run;
+			if (size == 0)
+				break;
+		}
+		// List, polygon or vertex type boundary
+		ta_thd_data32_i((const simd256_t *)data);
 		data++;
 		size--;
 	}
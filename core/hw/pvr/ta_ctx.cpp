@@ -56,6 +56,10 @@ bool QueueRender(TA_context* ctx)
 		RenderCount++;
 		if (RenderCount % (config::SkipFrame + 1) != 0)
 			skipFrame = true;
+		else if (settings.input.fastForwardMode && !ctx->rend.isRTT && !config::EmulateFramebuffer)
+			// Don't wait for the previous render when fast-forwarding.
+			// Render-to-texture and emulated framebuffer frames are never skipped since the guest may use them.
+			skipFrame = rqueue != nullptr || rend_fast_forward_skip();
 		else if (config::ThreadedRendering && rqueue != nullptr
 				&& (config::AutoSkipFrame == 0 || (config::AutoSkipFrame == 1 && SH4FastEnough)))
 			// The previous render hasn't completed yet so we wait.
@@ -9,6 +9,7 @@
 #include "pvr_mem.h"
 #include "Renderer_if.h"
 #include "cfg/option.h"
+#include "profiler/benchmark.h"
 
 #include <algorithm>
 #include <utility>
@@ -259,23 +260,30 @@ case num : {\
 		return data+SZ32;
 	}
 		
+	// true if data is another vertex of the current run
+	static bool nextVertex(Ta_Dma* data, Ta_Dma* data_end)
+	{
+		return data < data_end && data->pcw.ParaType == ParamType_Vertex_Parameter
+				&& (!settings.platform.isNaomi2() || (data->pcw.full & 0x08000000) == 0);
+	}
+
 	static Ta_Dma* TACALL ta_mod_vol_data(Ta_Dma* data,Ta_Dma* data_end)
 	{
-		TA_VertexParam* vp=(TA_VertexParam*)data;
-		if (data == data_end - SZ32)
-		{
+		do {
+			TA_VertexParam* vp=(TA_VertexParam*)data;
 			AppendModVolVertexA(&vp->mvolA);
-			//32B more needed , 32B done :)
-			TaCmd=ta_modvolB_32;
-			return data+SZ32;
-		}
-		else
-		{
+			if (data == data_end - SZ32)
+			{
+				//32B more needed , 32B done :)
+				TaCmd=ta_modvolB_32;
+				return data+SZ32;
+			}
 			//all 64B done
-			AppendModVolVertexA(&vp->mvolA);
 			AppendModVolVertexB(&vp->mvolB);
-			return data+SZ64;
-		}
+			data += SZ64;
+		} while (nextVertex(data, data_end));
+
+		return data;
 	}
 	static Ta_Dma* TACALL ta_spriteB_data(Ta_Dma* data,Ta_Dma* data_end)
 	{
@@ -289,25 +297,20 @@ case num : {\
 	static Ta_Dma* TACALL ta_sprite_data(Ta_Dma* data,Ta_Dma* data_end)
 	{
 		verify(data->pcw.ParaType==ParamType_Vertex_Parameter);
-		if (data == data_end - SZ32)
-		{
-			//32B more needed , 32B done :)
-			TaCmd=ta_spriteB_data;
-
-			TA_VertexParam* vp=(TA_VertexParam*)data;
-
-			AppendSpriteVertexA(&vp->spr1A);
-			return data+SZ32;
-		}
-		else
-		{
+		do {
 			TA_VertexParam* vp=(TA_VertexParam*)data;
-
 			AppendSpriteVertexA(&vp->spr1A);
+			if (data == data_end - SZ32)
+			{
+				//32B more needed , 32B done :)
+				TaCmd=ta_spriteB_data;
+				return data+SZ32;
+			}
 			AppendSpriteVertexB(&vp->spr1B);
+			data += SZ64;
+		} while (nextVertex(data, data_end));
 
-			return data+SZ64;
-		}
+		return data;
 	}
 
 	template <u32 poly_type,u32 poly_size>
@@ -1159,7 +1162,8 @@ static void parseRenderPass(RenderPass& pass, const RenderPass& previousPass, re
 {
 	const bool perPixel = config::RendererType == RenderType::OpenGL_OIT
 			|| config::RendererType == RenderType::DirectX11_OIT
-			|| config::RendererType == RenderType::Vulkan_OIT;
+			|| config::RendererType == RenderType::Vulkan_OIT
+			|| config::RendererType == RenderType::Software;
 	const bool mergeTranslucent = config::PerStripSorting || perPixel;
 
 	if (config::RenderResolution > 480 && !config::EmulateFramebuffer && config::FixUpscaleBleedingEdge)
@@ -1316,6 +1320,7 @@ static void ta_parse_naomi2(TA_context* ctx, bool primRestart)
 
 void ta_parse(TA_context *ctx, bool primRestart)
 {
+	benchmark::ScopedTimer _(benchmark::Section::TaParse);
 	if (settings.platform.isNaomi2())
 		ta_parse_naomi2(ctx, primRestart);
 	else
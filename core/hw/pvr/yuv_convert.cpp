@@ -0,0 +1,213 @@
+/*
+	Copyright 2026 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "yuv_convert.h"
+
+#if HOST_CPU == CPU_X86 || HOST_CPU == CPU_X64
+#include <immintrin.h>
+#include <xbyak/xbyak_util.h>
+#define YUV_SIMD_X86
+#if defined(_MSC_VER) && !defined(__clang__)
+#define TARGET_SSE2
+#define TARGET_AVX2
+#else
+#define TARGET_SSE2 __attribute__((target("sse2")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#elif HOST_CPU == CPU_ARM64 || (HOST_CPU == CPU_ARM && defined(__ARM_NEON__))
+#include <arm_neon.h>
+#define YUV_SIMD_NEON
+#endif
+
+namespace yuv
+{
+
+// Offsets in a macroblock
+constexpr u32 UOffset = 0;
+constexpr u32 VOffset = 64;
+constexpr u32 YOffset = 128;
+
+static void block8x8(const u8 *inuv, const u8 *iny, u8 *out, u32 stride)
+{
+	u8 *line_out_0 = out;
+	u8 *line_out_1 = out + stride;
+
+	for (int y = 0; y < 8; y += 2)
+	{
+		for (int x = 0; x < 8; x += 2)
+		{
+			u8 u = inuv[0];
+			u8 v = inuv[VOffset];
+
+			line_out_0[0] = u;
+			line_out_0[1] = iny[0];
+			line_out_0[2] = v;
+			line_out_0[3] = iny[1];
+
+			line_out_1[0] = u;
+			line_out_1[1] = iny[8 + 0];
+			line_out_1[2] = v;
+			line_out_1[3] = iny[8 + 1];
+
+			inuv += 1;
+			iny += 2;
+
+			line_out_0 += 4;
+			line_out_1 += 4;
+		}
+		iny += 8;
+		inuv += 4;
+
+		line_out_0 += stride * 2 - 8 * 2;
+		line_out_1 += stride * 2 - 8 * 2;
+	}
+}
+
+void convertScalar(const u8 *in, u8 *out, u32 stride, u32 count)
+{
+	for (u32 i = 0; i < count; i++)
+	{
+		const u8 *inuv = in + UOffset;
+		const u8 *iny = in + YOffset;
+
+		block8x8(inuv +  0, iny +   0, out, stride);						// (0,0)
+		block8x8(inuv +  4, iny +  64, out + 8 * 2, stride);				// (8,0)
+		block8x8(inuv + 32, iny + 128, out + stride * 8, stride);			// (0,8)
+		block8x8(inuv + 36, iny + 192, out + stride * 8 + 8 * 2, stride);	// (8,8)
+
+		in += MacroBlockSize;
+		out += 16 * 2;
+	}
+}
+
+// Each output line uses one chroma line and one line of the two Y blocks on the left and right
+static inline u32 chromaLine(int line) {
+	return (line / 2) * 8;
+}
+static inline const u8 *lumaLine(const u8 *block, int line) {
+	return block + YOffset + (line >= 8 ? 128 : 0) + (line & 7) * 8;
+}
+
+#ifdef YUV_SIMD_X86
+// u, v: 8 chroma samples, y: 16 luma samples of an output line
+TARGET_SSE2
+static inline void packLineSSE2(__m128i u, __m128i v, __m128i y, u8 *out)
+{
+	const __m128i zero = _mm_setzero_si128();
+	// 16-bit words U | Y0 << 8 and V | Y1 << 8
+	const __m128i uy = _mm_or_si128(_mm_unpacklo_epi8(u, zero), _mm_slli_epi16(y, 8));
+	const __m128i vy = _mm_or_si128(_mm_unpacklo_epi8(v, zero), _mm_and_si128(y, _mm_set1_epi16((short)0xff00)));
+	_mm_storeu_si128((__m128i *)out, _mm_unpacklo_epi16(uy, vy));
+	_mm_storeu_si128((__m128i *)(out + 16), _mm_unpackhi_epi16(uy, vy));
+}
+
+TARGET_SSE2
+static void convertSSE2(const u8 *in, u8 *out, u32 stride, u32 count)
+{
+	for (u32 i = 0; i < count; i++)
+	{
+		for (int line = 0; line < 16; line++)
+		{
+			const __m128i u = _mm_loadl_epi64((const __m128i *)(in + UOffset + chromaLine(line)));
+			const __m128i v = _mm_loadl_epi64((const __m128i *)(in + VOffset + chromaLine(line)));
+			const u8 *y = lumaLine(in, line);
+			const __m128i yy = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i *)y),
+					_mm_loadl_epi64((const __m128i *)(y + 64)));
+			packLineSSE2(u, v, yy, out + line * stride);
+		}
+		in += MacroBlockSize;
+		out += 16 * 2;
+	}
+}
+
+// Two lines sharing the same chroma samples at once, one per 128-bit lane
+TARGET_AVX2
+static void convertAVX2(const u8 *in, u8 *out, u32 stride, u32 count)
+{
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i yMask = _mm256_set1_epi16((short)0xff00);
+	for (u32 i = 0; i < count; i++)
+	{
+		for (int line = 0; line < 16; line += 2)
+		{
+			const __m256i u = _mm256_broadcastsi128_si256(_mm_loadl_epi64((const __m128i *)(in + UOffset + chromaLine(line))));
+			const __m256i v = _mm256_broadcastsi128_si256(_mm_loadl_epi64((const __m128i *)(in + VOffset + chromaLine(line))));
+			const u8 *y0 = lumaLine(in, line);
+			const u8 *y1 = lumaLine(in, line + 1);
+			const __m128i yy0 = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i *)y0),
+					_mm_loadl_epi64((const __m128i *)(y0 + 64)));
+			const __m128i yy1 = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i *)y1),
+					_mm_loadl_epi64((const __m128i *)(y1 + 64)));
+			const __m256i yy = _mm256_inserti128_si256(_mm256_castsi128_si256(yy0), yy1, 1);
+
+			const __m256i uy = _mm256_or_si256(_mm256_unpacklo_epi8(u, zero), _mm256_slli_epi16(yy, 8));
+			const __m256i vy = _mm256_or_si256(_mm256_unpacklo_epi8(v, zero), _mm256_and_si256(yy, yMask));
+			const __m256i lo = _mm256_unpacklo_epi16(uy, vy);
+			const __m256i hi = _mm256_unpackhi_epi16(uy, vy);
+			_mm256_storeu_si256((__m256i *)(out + line * stride), _mm256_permute2x128_si256(lo, hi, 0x20));
+			_mm256_storeu_si256((__m256i *)(out + (line + 1) * stride), _mm256_permute2x128_si256(lo, hi, 0x31));
+		}
+		in += MacroBlockSize;
+		out += 16 * 2;
+	}
+}
+#endif
+
+#ifdef YUV_SIMD_NEON
+static void convertNEON(const u8 *in, u8 *out, u32 stride, u32 count)
+{
+	for (u32 i = 0; i < count; i++)
+	{
+		for (int line = 0; line < 16; line++)
+		{
+			const u8 *y = lumaLine(in, line);
+			// even and odd luma samples
+			const uint8x8x2_t yy = vuzp_u8(vld1_u8(y), vld1_u8(y + 64));
+			uint8x8x4_t uyvy;
+			uyvy.val[0] = vld1_u8(in + UOffset + chromaLine(line));
+			uyvy.val[1] = yy.val[0];
+			uyvy.val[2] = vld1_u8(in + VOffset + chromaLine(line));
+			uyvy.val[3] = yy.val[1];
+			vst4_u8(out + line * stride, uyvy);
+		}
+		in += MacroBlockSize;
+		out += 16 * 2;
+	}
+}
+#endif
+
+const std::vector<Converter>& converters()
+{
+	static const std::vector<Converter> list = []() {
+		std::vector<Converter> list { { "scalar", convertScalar } };
+#ifdef YUV_SIMD_X86
+		Xbyak::util::Cpu cpu;
+		if (cpu.has(Xbyak::util::Cpu::tSSE2))
+			list.push_back({ "sse2", convertSSE2 });
+		if (cpu.has(Xbyak::util::Cpu::tAVX2))
+			list.push_back({ "avx2", convertAVX2 });
+#endif
+#ifdef YUV_SIMD_NEON
+		list.push_back({ "neon", convertNEON });
+#endif
+		return list;
+	}();
+	return list;
+}
+
+}
@@ -0,0 +1,53 @@
+/*
+	Copyright 2026 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include "types.h"
+#include <vector>
+
+//
+// YUV420 to YUV422 macroblock conversion used by the TA YUV converter.
+// A 384-byte macroblock holds 8x8 U, 8x8 V and four 8x8 Y blocks (top left, top right, bottom left, bottom right).
+// It is converted to 16x16 UYVY texels.
+//
+namespace yuv
+{
+
+constexpr u32 MacroBlockSize = 384;
+
+// Convert count consecutive macroblocks, written side by side.
+// stride is the size in bytes of an output line.
+using ConvertFunc = void (*)(const u8 *in, u8 *out, u32 stride, u32 count);
+
+struct Converter
+{
+	const char *name;
+	ConvertFunc convert;
+};
+
+// Reference implementation
+void convertScalar(const u8 *in, u8 *out, u32 stride, u32 count);
+
+// Implementations supported by the host cpu, best last
+const std::vector<Converter>& converters();
+
+static inline void convert(const u8 *in, u8 *out, u32 stride, u32 count) {
+	converters().back().convert(in, out, stride, count);
+}
+
+}
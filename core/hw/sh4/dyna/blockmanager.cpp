@@ -16,6 +16,7 @@
 #include "hw/sh4/sh4_sched.h"
 #include "hw/sh4/modules/mmu.h"
 #include "oslib/virtmem.h"
+#include "profiler/metrics.h"
 
 #if defined(__unix__) && defined(DYNA_OPROF)
 #include <opagent.h>
@@ -177,6 +178,7 @@ void bm_AddBlock(RuntimeBlockInfo* blk)
 
 	verify((void*)bm_GetCode(block->addr) == (void*)ngen_FailedToFindBlock);
 	FPCA(block->addr) = (DynarecCodeEntryPtr)CC_RW2RX(block->code);
+	metrics::jitBlocksCompiled.inc();
 
 #ifdef DYNA_OPROF
 	if (oprofHandle)
@@ -216,6 +218,7 @@ void bm_DiscardBlock(RuntimeBlockInfo* block)
 
 	del_blocks.push_back(block_ptr);
 	block_ptr->Discard();
+	metrics::jitBlocksDiscarded.inc();
 }
 
 void bm_Periodical_1s()
@@ -297,6 +300,7 @@ void bm_ResetCache()
 		block->Discard();
 		del_blocks.push_back(block);
 	}
+	metrics::jitBlocksDiscarded.inc(blkmap.size());
 
 	blkmap.clear();
 	// blkmap includes temp blocks as well
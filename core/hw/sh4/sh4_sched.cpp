@@ -2,8 +2,10 @@
 #include "sh4_if.h"
 #include "sh4_sched.h"
 #include "serialize.h"
+#include "profiler/fc_profiler.h"
 
 #include <algorithm>
+#include <atomic>
 #include <vector>
 
 //sh4 scheduler
@@ -33,6 +35,8 @@ struct sched_list
 static u64 sh4_sched_ffb;
 static std::vector<sched_list> sch_list;
 static int sh4_sched_next_id = -1;
+// Callbacks requested by other threads, one bit per id
+static std::atomic<u64> asyncRequests;
 
 static u32 sh4_sched_now();
 
@@ -138,6 +142,12 @@ void sh4_sched_request(int id, int cycles)
 	sh4_sched_ffts();
 }
 
+void sh4_sched_request_async(int id)
+{
+	verify(id >= 0 && id < 64);
+	asyncRequests.fetch_or(1ull << id, std::memory_order_release);
+}
+
 bool sh4_sched_is_scheduled(int id)
 {
 	return sch_list[id].end != -1;
@@ -163,6 +173,7 @@ static void handle_cb(sched_list& sched)
 	int jitter = elapsd - remain;
 
 	sched.end = -1;
+	FC_PROFILE_TRACE_SCOPE("sh4_sched", &sched - &sch_list[0]);
 	int re_sch = sched.cb(sched.tag, remain, jitter, sched.arg);
 
 	if (re_sch > 0)
@@ -174,6 +185,14 @@ void sh4_sched_tick(int cycles)
 	if (Sh4cntx.sh4_sched_next >= 0)
 		return;
 
+	if (asyncRequests.load(std::memory_order_relaxed) != 0)
+	{
+		u64 ids = asyncRequests.exchange(0, std::memory_order_acquire);
+		for (int id = 0; ids != 0; id++, ids >>= 1)
+			if ((ids & 1) != 0 && id < (int)sch_list.size() && sch_list[id].cb != nullptr
+					&& !sh4_sched_is_scheduled(id))
+				sh4_sched_request(id, 0);
+	}
 	u32 fztime = sh4_sched_now() - cycles;
 	if (sh4_sched_next_id != -1)
 	{
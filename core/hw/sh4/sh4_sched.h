@@ -36,6 +36,12 @@ u64 sh4_sched_now64();
 */
 void sh4_sched_request(int id, int cycles);
 
+/*
+	Schedule a callback to be called at the next scheduler tick.
+	Unlike the other functions, this one can be called from any thread.
+*/
+void sh4_sched_request_async(int id);
+
 /*
 	Returns true if the callback is scheduled to be called in the future.
  */
@@ -0,0 +1,299 @@
+/*
+	Copyright 2026 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "movie.h"
+#include "emulator.h"
+#include "serialize.h"
+#include "hw/maple/maple_cfg.h"
+#include "hw/sh4/sh4_mem.h"
+#include "hw/pvr/pvr_mem.h"
+#include "hw/aica/aica_if.h"
+#include "oslib/oslib.h"
+#include <xxhash.h>
+#include <zlib.h>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+
+namespace movie
+{
+
+static_assert(std::is_trivially_copyable_v<MapleInputState>, "MapleInputState must be trivially copyable");
+
+#pragma pack(push, 1)
+struct Header
+{
+	char magic[8];
+	u32 version;
+	u32 hashInterval;
+	char gameId[128];
+	u64 stateSize;
+	u64 compressedStateSize;
+};
+
+struct Hashes
+{
+	u32 poll;
+	u64 ram;
+	u64 vram;
+	u64 aram;
+};
+#pragma pack(pop)
+
+constexpr char Magic[8] { 'F', 'L', 'Y', 'M', 'O', 'V', 'I', '1' };
+constexpr u32 Version = 1;
+constexpr u32 HashInterval = 60;	// hash the emulator state every second or so
+// Record tags
+constexpr u8 TagHashes = 'H';
+constexpr u8 TagInput = 'I';
+
+enum class Mode {
+	None,
+	Record,
+	Play
+};
+
+static Mode requestedMode = Mode::None;
+static Mode mode = Mode::None;
+static std::string path;
+static FILE *file;
+static u32 pollCount;
+static u32 hashInterval;
+static int divergence = -1;
+
+void record(const std::string& path)
+{
+	movie::path = path;
+	requestedMode = Mode::Record;
+}
+
+void play(const std::string& path)
+{
+	movie::path = path;
+	requestedMode = Mode::Play;
+}
+
+bool isRecording() {
+	return mode == Mode::Record;
+}
+
+bool isPlaying() {
+	return mode == Mode::Play;
+}
+
+int getDivergence() {
+	return divergence;
+}
+
+static Hashes hashState()
+{
+	Hashes hashes;
+	hashes.poll = pollCount;
+	hashes.ram = XXH3_64bits(&mem_b[0], RAM_SIZE);
+	hashes.vram = XXH3_64bits(&vram[0], VRAM_SIZE);
+	hashes.aram = XXH3_64bits(&aica::aica_ram[0], ARAM_SIZE);
+
+	return hashes;
+}
+
+static void fail(const char *msg)
+{
+	ERROR_LOG(INPUT, "Movie %s: %s", path.c_str(), msg);
+	os_notify("Movie error", 5000, msg);
+	std::fclose(file);
+	file = nullptr;
+	mode = Mode::None;
+}
+
+static void startRecording()
+{
+	Serializer ser;
+	dc_serialize(ser);
+	std::unique_ptr<u8[]> state(new u8[ser.size()]);
+	ser = Serializer(state.get(), ser.size());
+	dc_serialize(ser);
+
+	uLongf compressedSize = compressBound(ser.size());
+	std::unique_ptr<u8[]> compressed(new u8[compressedSize]);
+	if (compress2(compressed.get(), &compressedSize, state.get(), ser.size(), Z_BEST_SPEED) != Z_OK)
+	{
+		fail("state compression failed");
+		return;
+	}
+
+	Header header{};
+	memcpy(header.magic, Magic, sizeof(Magic));
+	header.version = Version;
+	header.hashInterval = HashInterval;
+	strncpy(header.gameId, settings.content.gameId.c_str(), sizeof(header.gameId) - 1);
+	header.stateSize = ser.size();
+	header.compressedStateSize = compressedSize;
+	if (std::fwrite(&header, sizeof(header), 1, file) != 1
+			|| std::fwrite(compressed.get(), 1, compressedSize, file) != compressedSize)
+	{
+		fail("I/O error");
+		return;
+	}
+	hashInterval = HashInterval;
+	INFO_LOG(INPUT, "Recording movie to %s", path.c_str());
+}
+
+static void startPlayback()
+{
+	Header header;
+	if (std::fread(&header, sizeof(header), 1, file) != 1
+			|| memcmp(header.magic, Magic, sizeof(Magic)) != 0
+			|| header.version != Version)
+	{
+		fail("invalid movie file");
+		return;
+	}
+	header.gameId[sizeof(header.gameId) - 1] = '\0';
+	if (settings.content.gameId != header.gameId)
+		WARN_LOG(INPUT, "Movie recorded with game %s but %s is running", header.gameId, settings.content.gameId.c_str());
+
+	std::unique_ptr<u8[]> compressed(new u8[header.compressedStateSize]);
+	std::unique_ptr<u8[]> state(new u8[header.stateSize]);
+	if (std::fread(compressed.get(), 1, header.compressedStateSize, file) != header.compressedStateSize)
+	{
+		fail("I/O error");
+		return;
+	}
+	uLongf stateSize = header.stateSize;
+	if (uncompress(state.get(), &stateSize, compressed.get(), header.compressedStateSize) != Z_OK
+			|| stateSize != header.stateSize)
+	{
+		fail("corrupted state");
+		return;
+	}
+	try {
+		Deserializer deser(state.get(), stateSize);
+		emu.loadstate(deser);
+	} catch (const Deserializer::Exception& e) {
+		fail(e.what());
+		return;
+	}
+	hashInterval = header.hashInterval;
+	INFO_LOG(INPUT, "Playing movie %s", path.c_str());
+}
+
+void start()
+{
+	if (requestedMode == Mode::None)
+		return;
+	mode = requestedMode;
+	requestedMode = Mode::None;
+	pollCount = 0;
+	divergence = -1;
+
+	file = nowide::fopen(path.c_str(), mode == Mode::Record ? "wb" : "rb");
+	if (file == nullptr)
+	{
+		ERROR_LOG(INPUT, "Can't open movie %s", path.c_str());
+		os_notify("Can't open movie file", 5000, path.c_str());
+		mode = Mode::None;
+		return;
+	}
+	if (mode == Mode::Record)
+		startRecording();
+	else
+		startPlayback();
+}
+
+void stop()
+{
+	if (file != nullptr)
+	{
+		if (mode == Mode::Record)
+			INFO_LOG(INPUT, "Movie recording stopped after %d polls", pollCount);
+		std::fclose(file);
+		file = nullptr;
+	}
+	mode = Mode::None;
+}
+
+static void checkHashes(const Hashes& recorded)
+{
+	if (divergence != -1)
+		// only the first divergence is meaningful
+		return;
+	const Hashes hashes = hashState();
+	const char *region;
+	if (hashes.ram != recorded.ram)
+		region = "RAM";
+	else if (hashes.vram != recorded.vram)
+		region = "VRAM";
+	else if (hashes.aram != recorded.aram)
+		region = "ARAM";
+	else
+		return;
+	divergence = recorded.poll;
+	ERROR_LOG(INPUT, "Movie diverged at poll %d: %s hash mismatch", recorded.poll, region);
+	os_notify("Movie playback diverged", 5000, region);
+}
+
+void processInput(MapleInputState inputState[4])
+{
+	constexpr size_t InputSize = sizeof(MapleInputState) * 4;
+	if (mode == Mode::Record)
+	{
+		if (pollCount % hashInterval == 0)
+		{
+			const Hashes hashes = hashState();
+			if (std::fwrite(&TagHashes, 1, 1, file) != 1
+					|| std::fwrite(&hashes, sizeof(hashes), 1, file) != 1)
+			{
+				fail("I/O error");
+				return;
+			}
+		}
+		if (std::fwrite(&TagInput, 1, 1, file) != 1
+				|| std::fwrite(inputState, InputSize, 1, file) != 1)
+		{
+			fail("I/O error");
+			return;
+		}
+	}
+	else if (mode == Mode::Play)
+	{
+		u8 tag;
+		if (std::fread(&tag, 1, 1, file) == 1 && tag == TagHashes)
+		{
+			Hashes hashes;
+			if (std::fread(&hashes, sizeof(hashes), 1, file) != 1) {
+				fail("truncated file");
+				return;
+			}
+			checkHashes(hashes);
+			if (std::fread(&tag, 1, 1, file) != 1)
+				tag = 0;
+		}
+		MapleInputState recorded[4];
+		if (tag != TagInput || std::fread(recorded, InputSize, 1, file) != 1)
+		{
+			INFO_LOG(INPUT, "Movie playback ended after %d polls", pollCount);
+			os_notify("Movie playback ended", 2000);
+			stop();
+			return;
+		}
+		memcpy(inputState, recorded, InputSize);
+	}
+	pollCount++;
+}
+
+}
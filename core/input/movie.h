@@ -0,0 +1,59 @@
+/*
+	Copyright 2026 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include "types.h"
+#include <string>
+
+struct MapleInputState;
+
+//
+// Input movies.
+// A movie holds the emulator state at the time recording started, followed by the controller inputs
+// of each maple DMA and periodic hashes of RAM, VRAM and ARAM.
+// Playing a movie back restores the state, feeds the recorded inputs and verifies the hashes,
+// which makes it a determinism check as well as a reproducible workload.
+//
+namespace movie
+{
+
+// Request the recording or playback of a movie. It begins with the next call to start().
+void record(const std::string& path);
+void play(const std::string& path);
+
+// Begin the requested recording or playback, if any. Must be called once the game is loaded
+// and before the emulator is started. Playback restores the recorded emulator state.
+void start();
+// Called when the game is unloaded
+void stop();
+
+bool isRecording();
+bool isPlaying();
+
+static inline bool active() {
+	return isRecording() || isPlaying();
+}
+
+// Record or replace the maple input states for the current DMA
+void processInput(MapleInputState inputState[4]);
+
+// Index of the first maple DMA at which the emulator state diverged from the recording,
+// or -1 if none was detected by the last playback.
+int getDivergence();
+
+}
@@ -10,6 +10,7 @@
 #include "oslib/directory.h"
 #include "oslib/oslib.h"
 #include "stdclass.h"
+#include "profiler/benchmark.h"
 
 #include <csignal>
 #include <string>
@@ -266,12 +267,16 @@ int main(int argc, char* argv[])
 	auto async = std::async(std::launch::async, uploadCrashes, "/tmp");
 #endif
 
-	mainui_loop();
+	int rc = 0;
+	if (benchmark::active())
+		rc = benchmark::run();
+	else
+		mainui_loop();
 
 	flycast_term();
 	os_UninstallFaultHandler();
 
-	return 0;
+	return rc;
 }
 
 [[noreturn]] void os_DebugBreak()
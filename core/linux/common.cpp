@@ -23,6 +23,7 @@
 #include "hw/mem/addrspace.h"
 #include "hw/mem/mem_watch.h"
 #include "emulator.h"
+#include "log/LogManager.h"
 
 #ifdef __SWITCH__
 #include <ucontext.h>
@@ -67,6 +68,8 @@ void fault_handler(int sn, siginfo_t * si, void *segfault_ctx)
 
 	ERROR_LOG(COMMON, "SIGSEGV @ %p invalid access to %p", (void *)ctx.pc, si->si_addr);
 #endif
+	// Write the buffered log messages before the process dies
+	LogManager::Flush();
 
 #ifdef __SWITCH__
 	MemoryInfo meminfo;
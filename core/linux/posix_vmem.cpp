@@ -10,16 +10,22 @@
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <cerrno>
+#include <cstdio>
+#include <cstring>
 #include <unistd.h>
 
 #include "hw/mem/addrspace.h"
 #include "hw/sh4/sh4_if.h"
 #include "oslib/virtmem.h"
+#include "cfg/option.h"
 
 #ifndef MAP_NOSYNC
 #define MAP_NOSYNC 0
 #endif
 
+// The guest memory is aligned on this boundary so that it can be backed by PMD-sized huge pages
+constexpr size_t HUGE_PAGE_SIZE = 2_MB;
+
 #ifdef __ANDROID__
 #include <linux/ashmem.h>
 
@@ -169,18 +175,21 @@ bool init(void **vmem_base_addr, void **sh4rcb_addr, size_t ramSize)
 		return false;
 
 	// Now try to allocate a contiguous piece of memory.
-	reserved_size = 512_MB + sizeof(Sh4RCB) + ARAM_SIZE_MAX + 0x10000;
+	reserved_size = 512_MB + sizeof(Sh4RCB) + ARAM_SIZE_MAX + HUGE_PAGE_SIZE;
 	reserved_base = mem_region_reserve(NULL, reserved_size);
 	if (!reserved_base) {
 		close(vmem_fd);
 		return false;
 	}
 
-	// Align pointer to 64KB too, some Linaro bug (no idea but let's just be safe I guess).
-	uintptr_t ptrint = (uintptr_t)reserved_base;
-	ptrint = (ptrint + 0x10000 - 1) & (~0xffff);
+	// Align the guest memory to the huge page size. The size of Sh4RCB is a multiple of 64KB
+	// so the context is aligned to 64KB too, some Linaro bug (no idea but let's just be safe I guess).
+	static_assert(sizeof(Sh4RCB) % 64_KB == 0, "sizeof(Sh4RCB) not multiple of 64KB");
+	uintptr_t ptrint = (uintptr_t)reserved_base + sizeof(Sh4RCB);
+	ptrint = (ptrint + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+	*vmem_base_addr = (void*)ptrint;
+	ptrint -= sizeof(Sh4RCB);
 	*sh4rcb_addr = (void*)ptrint;
-	*vmem_base_addr = (void*)(ptrint + sizeof(Sh4RCB));
 	const size_t fpcb_size = sizeof(((Sh4RCB *)NULL)->fpcb);
 	void *sh4rcb_base_ptr  = (void*)(ptrint + fpcb_size);
 
@@ -224,8 +233,45 @@ void ondemand_page(void *address, unsigned size_bytes) {
 	verify(rc);
 }
 
+// Ask the kernel to back a shared memory mapping with transparent huge pages.
+// Regions later write-protected with region_lock() are split back to 4 KB pages by the kernel,
+// the rest of the mapping keeps its huge pages.
+static void advise_huge_pages(void *p, size_t len)
+{
+#if defined(MADV_HUGEPAGE) && !defined(__ANDROID__)
+	if (madvise(p, len, MADV_HUGEPAGE) != 0)
+		WARN_LOG(VMEM, "madvise(MADV_HUGEPAGE) failed: errno %d", errno);
+#endif
+}
+
+static void check_huge_pages_support()
+{
+#if defined(MADV_HUGEPAGE) && !defined(__ANDROID__)
+	// Shared memory huge pages are only used if shmem_enabled is [always], [within_size], [advise] or [force]
+	FILE *f = fopen("/sys/kernel/mm/transparent_hugepage/shmem_enabled", "r");
+	if (f == nullptr)
+	{
+		WARN_LOG(VMEM, "Transparent huge pages aren't supported by this kernel");
+		return;
+	}
+	char line[128] {};
+	if (fgets(line, sizeof(line), f) != nullptr
+			&& (strstr(line, "[never]") != nullptr || strstr(line, "[deny]") != nullptr))
+		WARN_LOG(VMEM, "Shared memory huge pages are disabled. "
+				"Set /sys/kernel/mm/transparent_hugepage/shmem_enabled to advise to enable them");
+	else
+		INFO_LOG(VMEM, "Using transparent huge pages: shmem_enabled %s", line);
+	fclose(f);
+#else
+	WARN_LOG(VMEM, "Huge pages aren't supported on this platform");
+#endif
+}
+
 // Creates mappings to the underlying file including mirroring sections
 void create_mappings(const Mapping *vmem_maps, unsigned nummaps) {
+	const bool hugePages = config::HugePages;
+	if (hugePages)
+		check_huge_pages_support();
 	for (unsigned i = 0; i < nummaps; i++) {
 		// Ignore unmapped stuff, it is already reserved as PROT_NONE
 		if (!vmem_maps[i].memsize)
@@ -241,6 +287,8 @@ void create_mappings(const Mapping *vmem_maps, unsigned nummaps) {
 			void *p = mem_region_map_file((void*)(uintptr_t)vmem_fd, &addrspace::ram_base[offset],
 					vmem_maps[i].memsize, vmem_maps[i].memoffset, vmem_maps[i].allow_writes);
 			verify(p != nullptr);
+			if (hugePages && vmem_maps[i].memsize % HUGE_PAGE_SIZE == 0)
+				advise_huge_pages(p, vmem_maps[i].memsize);
 		}
 	}
 }
@@ -0,0 +1,466 @@
+/*
+	Copyright 2026 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "AsyncLog.h"
+#include "LogManager.h"
+#include "stdclass.h"
+#include "util/spsc_ring.h"
+#include "util/periodic_thread.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace AsyncLog
+{
+
+std::atomic<LogTypes::LOG_LEVELS> EnabledLevel[LogTypes::NUMBER_OF_LOGS];
+
+constexpr size_t RingSize = 1024;
+constexpr int FlushPeriodMs = 10;
+
+struct ThreadRing
+{
+	SpscRing<Record, RingSize> ring;
+	std::atomic<uint32_t> dropped { 0 };
+	std::atomic<bool> exited { false };
+};
+
+// Owned by each logging thread. The ring is shared with the registry so that
+// messages logged just before the thread exits are still written.
+struct RingOwner
+{
+	~RingOwner() {
+		if (ring)
+			ring->exited = true;
+	}
+	std::shared_ptr<ThreadRing> ring;
+};
+
+static std::mutex ringsMutex;
+static std::vector<std::shared_ptr<ThreadRing>> rings;
+static thread_local RingOwner ringOwner;
+
+static std::atomic<bool> running { false };
+static std::atomic<uint64_t> droppedCount { 0 };
+static void writeLog();
+static PeriodicThread writerThread("AsyncLog", writeLog);
+
+static ThreadRing& threadRing()
+{
+	if (!ringOwner.ring)
+	{
+		ringOwner.ring = std::make_shared<ThreadRing>();
+		std::lock_guard<std::mutex> _(ringsMutex);
+		rings.push_back(ringOwner.ring);
+	}
+	return *ringOwner.ring;
+}
+
+Record *Reserve(LogTypes::LOG_LEVELS level, LogTypes::LOG_TYPE type, const char *file, int line, const char *format)
+{
+	if (!running)
+		return nullptr;
+	ThreadRing& tr = threadRing();
+	Record *rec = tr.ring.reserve();
+	if (rec == nullptr)
+	{
+		tr.dropped.fetch_add(1, std::memory_order_relaxed);
+		return nullptr;
+	}
+	rec->format = format;
+	rec->file = file;
+	rec->time = getTimeMs();
+	rec->line = line;
+	rec->level = level;
+	rec->type = type;
+	rec->size = 0;
+
+	return rec;
+}
+
+void Commit(LogTypes::LOG_LEVELS level)
+{
+	ThreadRing& tr = *ringOwner.ring;
+	tr.ring.commit();
+	// Errors are written right away. Otherwise only wake up the writer when the ring is getting full.
+	if (level <= LogTypes::LERROR || tr.ring.size() >= RingSize * 3 / 4)
+		writerThread.notify();
+}
+
+// Strings are copied with their terminating nul, preceded by their original address and length
+void PutString(Record& rec, const char *s)
+{
+	const char *str = s != nullptr ? s : "(null)";
+	constexpr size_t header = 1 + sizeof(const char *) + sizeof(uint16_t);
+	if (rec.size + header + 1 > sizeof(rec.args)) {
+		rec.size = sizeof(rec.args);
+		return;
+	}
+	uint16_t len = (uint16_t)strnlen(str, sizeof(rec.args) - rec.size - header - 1);
+	uint8_t *p = &rec.args[rec.size];
+	*p++ = String;
+	std::memcpy(p, &s, sizeof(s));
+	p += sizeof(s);
+	std::memcpy(p, &len, sizeof(len));
+	p += sizeof(len);
+	std::memcpy(p, str, len);
+	p[len] = '\0';
+	rec.size += header + len + 1;
+}
+
+namespace {
+
+struct Arg
+{
+	ArgType type;
+	union {
+		int64_t i;
+		uint64_t u;
+		double d;
+		const void *p;
+	};
+	const char *str;
+};
+
+class ArgReader
+{
+public:
+	ArgReader(const Record& rec) : rec(rec) {}
+
+	bool next(Arg& arg)
+	{
+		if (pos >= rec.size)
+			return false;
+		arg.type = (ArgType)rec.args[pos++];
+		arg.str = nullptr;
+		switch (arg.type)
+		{
+		case Signed:
+		case Unsigned:
+			read(arg.u);
+			break;
+		case Double:
+			read(arg.d);
+			break;
+		case Pointer:
+			read(arg.p);
+			break;
+		case String:
+			{
+				read(arg.p);
+				uint16_t len;
+				read(len);
+				arg.str = (const char *)&rec.args[pos];
+				pos += len + 1;
+			}
+			break;
+		default:
+			return false;
+		}
+		return true;
+	}
+
+	int nextInt()
+	{
+		Arg arg;
+		if (!next(arg))
+			return 0;
+		return arg.type == Double ? (int)arg.d : (int)arg.i;
+	}
+
+private:
+	template<typename T>
+	void read(T& v) {
+		std::memcpy(&v, &rec.args[pos], sizeof(T));
+		pos += sizeof(T);
+	}
+
+	const Record& rec;
+	size_t pos = 0;
+};
+
+enum Length {
+	None, hh, h, l, ll, L
+};
+
+}
+
+static int64_t asSigned(const Arg& arg, Length length)
+{
+	int64_t v = arg.type == Double ? (int64_t)arg.d : arg.i;
+	switch (length)
+	{
+	case hh: return (signed char)v;
+	case h: return (short)v;
+	case None: return (int)v;
+	case l: return (long)v;
+	default: return v;
+	}
+}
+
+static uint64_t asUnsigned(const Arg& arg, Length length)
+{
+	uint64_t v = arg.type == Double ? (uint64_t)arg.d : arg.u;
+	switch (length)
+	{
+	case hh: return (unsigned char)v;
+	case h: return (unsigned short)v;
+	case None: return (unsigned int)v;
+	case l: return (unsigned long)v;
+	default: return v;
+	}
+}
+
+// printf-style formatting of a record. Each conversion is formatted separately with snprintf,
+// using the type implied by the format string.
+static void formatRecord(const Record& rec, char *out, size_t outSize)
+{
+	ArgReader reader(rec);
+	size_t o = 0;
+	auto append = [&](int n) {
+		if (n > 0)
+			o = std::min(o + n, outSize - 1);
+	};
+	const char *p = rec.format;
+	while (*p != '\0' && o < outSize - 1)
+	{
+		if (*p != '%' || p[1] == '%')
+		{
+			out[o++] = *p;
+			p += *p == '%' ? 2 : 1;
+			continue;
+		}
+		p++;
+		// Rebuild the conversion spec, replacing * by their value and dropping the length modifier
+		char spec[48] = "%";
+		size_t s = 1;
+		while (*p != '\0' && std::strchr("-+ #0'", *p) != nullptr && s < 8)
+			spec[s++] = *p++;
+		if (*p == '*') {
+			s += snprintf(&spec[s], sizeof(spec) - s, "%d", reader.nextInt());
+			p++;
+		}
+		while (*p >= '0' && *p <= '9' && s < 16)
+			spec[s++] = *p++;
+		if (*p == '.')
+		{
+			spec[s++] = *p++;
+			if (*p == '*') {
+				s += snprintf(&spec[s], sizeof(spec) - s, "%d", reader.nextInt());
+				p++;
+			}
+			while (*p >= '0' && *p <= '9' && s < 32)
+				spec[s++] = *p++;
+		}
+		Length length = None;
+		switch (*p)
+		{
+		case 'h':
+			p++;
+			length = h;
+			if (*p == 'h') {
+				p++;
+				length = hh;
+			}
+			break;
+		case 'l':
+			p++;
+			length = l;
+			if (*p == 'l') {
+				p++;
+				length = ll;
+			}
+			break;
+		case 'j':
+		case 'z':
+		case 't':
+			p++;
+			length = ll;
+			break;
+		case 'L':
+			p++;
+			length = L;
+			break;
+		}
+		const char conv = *p;
+		if (conv == '\0')
+			break;
+		p++;
+		Arg arg;
+		if (!reader.next(arg))
+		{
+			// Record truncated
+			append(snprintf(&out[o], outSize - o, "(...)"));
+			break;
+		}
+		const size_t remaining = outSize - o;
+		switch (conv)
+		{
+		case 'd':
+		case 'i':
+			spec[s++] = 'l';
+			spec[s++] = 'l';
+			spec[s++] = conv;
+			spec[s] = '\0';
+			append(snprintf(&out[o], remaining, spec, (long long)asSigned(arg, length)));
+			break;
+		case 'o':
+		case 'u':
+		case 'x':
+		case 'X':
+			spec[s++] = 'l';
+			spec[s++] = 'l';
+			spec[s++] = conv;
+			spec[s] = '\0';
+			append(snprintf(&out[o], remaining, spec, (unsigned long long)asUnsigned(arg, length)));
+			break;
+		case 'c':
+			spec[s++] = conv;
+			spec[s] = '\0';
+			append(snprintf(&out[o], remaining, spec, (int)asSigned(arg, None)));
+			break;
+		case 'f':
+		case 'F':
+		case 'e':
+		case 'E':
+		case 'g':
+		case 'G':
+		case 'a':
+		case 'A':
+			spec[s++] = conv;
+			spec[s] = '\0';
+			append(snprintf(&out[o], remaining, spec, arg.type == Double ? arg.d : (double)arg.i));
+			break;
+		case 's':
+			spec[s++] = conv;
+			spec[s] = '\0';
+			append(snprintf(&out[o], remaining, spec, arg.str != nullptr ? arg.str : "(?)"));
+			break;
+		case 'p':
+			spec[s++] = conv;
+			spec[s] = '\0';
+			append(snprintf(&out[o], remaining, spec, arg.p));
+			break;
+		default:
+			// %n and unknown conversions
+			break;
+		}
+	}
+	out[o] = '\0';
+}
+
+struct Message
+{
+	uint64_t time;
+	LogTypes::LOG_LEVELS level;
+	LogTypes::LOG_TYPE type;
+	const char *file;
+	int line;
+	std::string text;
+};
+
+static std::mutex writeMutex;
+static std::vector<Message> messages;
+// Set while this thread is writing messages. A listener may log or flush (fatal_error)
+// and must not wait for writeMutex again.
+static thread_local bool writing;
+
+// Drain all the rings. Several threads can call this function (writer thread and Flush)
+// so it's serialized to keep a single consumer per ring.
+static void writeLog()
+{
+	if (writing)
+		// The new messages will be written by the next pass
+		return;
+	std::lock_guard<std::mutex> _(writeMutex);
+	writing = true;
+	std::vector<std::shared_ptr<ThreadRing>> threadRings;
+	{
+		std::lock_guard<std::mutex> _(ringsMutex);
+		threadRings = rings;
+	}
+	uint64_t dropped = 0;
+	char text[1024];
+	for (const auto& tr : threadRings)
+	{
+		while (const Record *rec = tr->ring.front())
+		{
+			formatRecord(*rec, text, sizeof(text));
+			messages.push_back({ rec->time, (LogTypes::LOG_LEVELS)rec->level, (LogTypes::LOG_TYPE)rec->type,
+				rec->file, (int)rec->line, text });
+			tr->ring.popFront();
+		}
+		dropped += tr->dropped.exchange(0);
+	}
+	// Merge the messages of all threads
+	std::stable_sort(messages.begin(), messages.end(), [](const Message& a, const Message& b) {
+		return a.time < b.time;
+	});
+	LogManager *logManager = LogManager::GetInstance();
+	if (logManager != nullptr)
+	{
+		for (const Message& msg : messages)
+			logManager->LogFormatted(msg.level, msg.type, msg.file, msg.line, msg.time, msg.text.c_str());
+		if (dropped != 0)
+		{
+			droppedCount += dropped;
+			snprintf(text, sizeof(text), "%llu log messages dropped (%llu total)",
+					(unsigned long long)dropped, (unsigned long long)droppedCount.load());
+			logManager->LogFormatted(LogTypes::LWARNING, LogTypes::COMMON, __FILE__, __LINE__, getTimeMs(), text);
+		}
+	}
+	messages.clear();
+	writing = false;
+
+	// Forget the rings of terminated threads
+	std::lock_guard<std::mutex> lock(ringsMutex);
+	rings.erase(std::remove_if(rings.begin(), rings.end(), [](const auto& tr) {
+		return tr->exited && tr->ring.empty();
+	}), rings.end());
+}
+
+void Init()
+{
+	running = true;
+	writerThread.setPeriod(FlushPeriodMs);
+	writerThread.start();
+}
+
+void Term()
+{
+	running = false;
+	writerThread.stop();
+	writeLog();
+}
+
+void Flush()
+{
+	if (running)
+		writeLog();
+}
+
+uint64_t DroppedCount() {
+	return droppedCount;
+}
+
+}
@@ -0,0 +1,137 @@
+/*
+	Copyright 2026 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include "Log.h"
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <cstring>
+#include <type_traits>
+
+//
+// Deferred-formatting logger.
+// The call site only copies the format pointer and the arguments into a per-thread lock-free ring.
+// A background thread formats the messages and sends them to the log listeners.
+//
+namespace AsyncLog
+{
+
+// Highest level enabled for each log type. Maintained by LogManager and read by all logging threads.
+extern std::atomic<LogTypes::LOG_LEVELS> EnabledLevel[LogTypes::NUMBER_OF_LOGS];
+
+inline static bool IsEnabled(LogTypes::LOG_TYPE type, LogTypes::LOG_LEVELS level) {
+	return level <= EnabledLevel[type].load(std::memory_order_relaxed);
+}
+
+constexpr size_t RecordSize = 256;
+
+struct Record
+{
+	const char *format;
+	const char *file;
+	uint64_t time;
+	uint32_t line;
+	uint8_t level;
+	uint8_t type;
+	uint16_t size;
+	uint8_t args[RecordSize - 32];
+};
+static_assert(sizeof(Record) == RecordSize, "Unexpected log record size");
+
+enum ArgType : uint8_t {
+	Signed,
+	Unsigned,
+	Double,
+	Pointer,
+	String
+};
+
+// Returns a free record of the calling thread's ring with its header filled in,
+// or nullptr if the ring is full (the message is counted as dropped) or logging isn't running.
+Record *Reserve(LogTypes::LOG_LEVELS level, LogTypes::LOG_TYPE type, const char *file, int line, const char *format);
+// Publishes the last reserved record
+void Commit(LogTypes::LOG_LEVELS level);
+void PutString(Record& rec, const char *s);
+
+template<typename T>
+void PutValue(Record& rec, ArgType type, T value)
+{
+	if (rec.size + 1 + sizeof(T) > sizeof(rec.args)) {
+		rec.size = sizeof(rec.args);
+		return;
+	}
+	rec.args[rec.size] = type;
+	std::memcpy(&rec.args[rec.size + 1], &value, sizeof(T));
+	rec.size += 1 + sizeof(T);
+}
+
+template<typename T>
+void PutArg(Record& rec, T v)
+{
+	if constexpr (std::is_pointer_v<T>)
+	{
+		// Only char pointers are strings. Other byte pointers are often binary buffers logged with %p.
+		if constexpr (std::is_same_v<std::remove_cv_t<std::remove_pointer_t<T>>, char>)
+			PutString(rec, v);
+		else
+			PutValue(rec, Pointer, (const void *)v);
+	}
+	else if constexpr (std::is_null_pointer_v<T>)
+		PutValue(rec, Pointer, (const void *)nullptr);
+	else if constexpr (std::is_enum_v<T>)
+		PutArg(rec, static_cast<std::underlying_type_t<T>>(v));
+	else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>)
+		PutValue(rec, Signed, (int64_t)v);
+	else if constexpr (std::is_integral_v<T>)
+		PutValue(rec, Unsigned, (uint64_t)v);
+	else if constexpr (std::is_floating_point_v<T>)
+		PutValue(rec, Double, (double)v);
+	else
+		static_assert(!sizeof(T), "Unsupported log argument type");
+}
+
+template<typename... Args>
+void Log(LogTypes::LOG_LEVELS level, LogTypes::LOG_TYPE type, const char *file, int line,
+		const char *format, Args... args)
+{
+	Record *rec = Reserve(level, type, file, line, format);
+	if (rec == nullptr)
+		return;
+	(PutArg(*rec, args), ...);
+	Commit(level);
+}
+
+// Only used to have the compiler check the format string and arguments
+inline static void CheckFormat(const char *format, ...)
+#if defined(__GNUC__) && !defined(__MINGW32__)
+__attribute__((format(printf, 1, 2)))
+#endif
+;
+inline static void CheckFormat(const char *format, ...) {}
+
+// Start and stop the background thread
+void Init();
+void Term();
+// Format and dispatch all pending messages.
+// Does nothing if called from a log listener since the messages are already being written.
+void Flush();
+// Number of messages dropped because a ring was full
+uint64_t DroppedCount();
+
+}
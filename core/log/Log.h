@@ -65,6 +65,21 @@ __attribute__((format(printf, 5, 6)))
 #endif  // loglevel
 #endif  // logging
 
+#ifdef ASYNC_LOG
+#include "AsyncLog.h"
+
+// Disabled types and levels only cost a table lookup. Arguments aren't evaluated.
+#define GENERIC_LOG(t, v, ...)                                                                     \
+		do                                                                                               \
+		{                                                                                                \
+			if (v <= MAX_LOGLEVEL && AsyncLog::IsEnabled(t, v))                                            \
+			{                                                                                              \
+				if (false)                                                                                   \
+					AsyncLog::CheckFormat(__VA_ARGS__);                                                        \
+				AsyncLog::Log(v, t, __FILE__, __LINE__, __VA_ARGS__);                                        \
+			}                                                                                              \
+		} while (0)
+#else
 // Let the compiler optimize this out
 #define GENERIC_LOG(t, v, ...)                                                                     \
 		do                                                                                               \
@@ -72,6 +87,7 @@ __attribute__((format(printf, 5, 6)))
 			if (v <= MAX_LOGLEVEL)                                                                         \
 			GenericLog(v, t, __FILE__, __LINE__, __VA_ARGS__);                                           \
 		} while (0)
+#endif
 
 #define ERROR_LOG(t, ...)                                                                          \
 		do                                                                                               \
@@ -13,6 +13,9 @@
 #include <string>
 #include <fstream>
 
+#ifdef ASYNC_LOG
+#include "AsyncLog.h"
+#endif
 #include "ConsoleListener.h"
 #include "InMemoryListener.h"
 #include "NetworkListener.h"
@@ -138,6 +141,7 @@ LogManager::LogManager()
 		container.m_enable = cfgLoadBool("log", container.m_short_name, true);
 
 	m_path_cutoff_point = DeterminePathCutOffPoint();
+	UpdateEnabledLevels();
 
 	UpdateConfig();
 }
@@ -181,9 +185,8 @@ void LogManager::UpdateConfig()
 
 // Return the current time formatted as Minutes:Seconds:Milliseconds
 // in the form 00:00:000.
-static std::string GetTimeFormatted()
+static std::string GetTimeFormatted(u64 now)
 {
-	u64 now = getTimeMs();
 	u32 ms = (u32)(now % 1000);
 	now /= 1000;
 	u32 seconds = (u32)(now % 60);
@@ -207,15 +210,36 @@ void LogManager::LogWithFullPath(LogTypes::LOG_LEVELS level, LogTypes::LOG_TYPE
 	char temp[MAX_MSGLEN];
 	CharArrayFromFormatV(temp, MAX_MSGLEN, format, args);
 
+	Dispatch(level, type, file, line, getTimeMs(), temp);
+}
+
+void LogManager::LogFormatted(LogTypes::LOG_LEVELS level, LogTypes::LOG_TYPE type, const char* file,
+		int line, u64 time, const char* text)
+{
+	if (static_cast<bool>(m_listener_ids))
+		Dispatch(level, type, file + m_path_cutoff_point, line, time, text);
+}
+
+void LogManager::Dispatch(LogTypes::LOG_LEVELS level, LogTypes::LOG_TYPE type, const char* file,
+		int line, u64 time, const char* text)
+{
 	std::string msg =
-			StringFromFormat("%s %s:%u %c[%s]: %s\n", GetTimeFormatted().c_str(), file,
-					line, LogTypes::LOG_LEVEL_TO_CHAR[(int)level], GetShortName(type), temp);
+			StringFromFormat("%s %s:%u %c[%s]: %s\n", GetTimeFormatted(time).c_str(), file,
+					line, LogTypes::LOG_LEVEL_TO_CHAR[(int)level], GetShortName(type), text);
 
+	std::lock_guard<std::mutex> lock(m_listeners_lock);
 	for (auto listener_id : m_listener_ids)
 		if (m_listeners[listener_id])
 			m_listeners[listener_id]->Log(level, msg.c_str());
 }
 
+void LogManager::Flush()
+{
+#ifdef ASYNC_LOG
+	AsyncLog::Flush();
+#endif
+}
+
 LogTypes::LOG_LEVELS LogManager::GetLogLevel() const
 {
 	return m_level;
@@ -224,11 +248,23 @@ LogTypes::LOG_LEVELS LogManager::GetLogLevel() const
 void LogManager::SetLogLevel(LogTypes::LOG_LEVELS level)
 {
 	m_level = level;
+	UpdateEnabledLevels();
 }
 
 void LogManager::SetEnable(LogTypes::LOG_TYPE type, bool enable)
 {
 	m_log[type].m_enable = enable;
+	UpdateEnabledLevels();
+}
+
+// Cache the highest enabled level of each type so that disabled messages are filtered at the call site
+void LogManager::UpdateEnabledLevels()
+{
+#ifdef ASYNC_LOG
+	for (int type = 0; type < LogTypes::NUMBER_OF_LOGS; type++)
+		AsyncLog::EnabledLevel[type].store(m_log[type].m_enable ? std::max(m_level, LogTypes::LWARNING) : LogTypes::LWARNING,
+				std::memory_order_relaxed);
+#endif
 }
 
 bool LogManager::IsEnabled(LogTypes::LOG_TYPE type, LogTypes::LOG_LEVELS level) const
@@ -249,11 +285,13 @@ const char* LogManager::GetFullName(LogTypes::LOG_TYPE type) const
 
 void LogManager::RegisterListener(LogListener::LISTENER id, LogListener* listener)
 {
+	std::lock_guard<std::mutex> lock(m_listeners_lock);
 	m_listeners[id] = std::unique_ptr<LogListener>(listener);
 }
 
 void LogManager::EnableListener(LogListener::LISTENER id, bool enable)
 {
+	std::lock_guard<std::mutex> lock(m_listeners_lock);
 	m_listener_ids[id] = enable;
 }
 
@@ -273,10 +311,16 @@ LogManager* LogManager::GetInstance()
 void LogManager::Init()
 {
 	s_log_manager = new LogManager();
+#ifdef ASYNC_LOG
+	AsyncLog::Init();
+#endif
 }
 
 void LogManager::Shutdown()
 {
+#ifdef ASYNC_LOG
+	AsyncLog::Term();
+#endif
 	delete s_log_manager;
 	s_log_manager = nullptr;
 }
@@ -6,7 +6,9 @@
 
 #include <array>
 #include <cstdarg>
+#include <cstdint>
 #include <memory>
+#include <mutex>
 
 #include "BitSet.h"
 #include "Log.h"
@@ -41,6 +43,11 @@ public:
            const char* format, va_list args);
   void LogWithFullPath(LogTypes::LOG_LEVELS level, LogTypes::LOG_TYPE type, const char* file,
                        int line, const char* format, va_list args);
+  // Send an already formatted message to the listeners
+  void LogFormatted(LogTypes::LOG_LEVELS level, LogTypes::LOG_TYPE type, const char* file, int line,
+                    uint64_t time, const char* text);
+  // Write all pending asynchronous messages
+  static void Flush();
 
   LogTypes::LOG_LEVELS GetLogLevel() const;
   void SetLogLevel(LogTypes::LOG_LEVELS level);
@@ -69,6 +76,9 @@ private:
   };
 
   LogManager();
+  void UpdateEnabledLevels();
+  void Dispatch(LogTypes::LOG_LEVELS level, LogTypes::LOG_TYPE type, const char* file, int line,
+                uint64_t time, const char* text);
 
   LogManager(const LogManager&) = delete;
   LogManager& operator=(const LogManager&) = delete;
@@ -79,6 +89,7 @@ private:
   std::array<LogContainer, LogTypes::NUMBER_OF_LOGS> m_log{};
   std::array<std::unique_ptr<LogListener>, LogListener::NUMBER_OF_LISTENERS> m_listeners{};
   BitSet32 m_listener_ids;
+  std::mutex m_listeners_lock;
   size_t m_path_cutoff_point = 0;
   std::string logServer;
 };
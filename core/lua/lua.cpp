@@ -167,6 +167,7 @@ CONFIG_ACCESSORS(WidescreenGameHacks)
 CONFIG_ACCESSORS(SkipFrame)
 CONFIG_ACCESSORS(MaxThreads)
 CONFIG_ACCESSORS(AutoSkipFrame)
+CONFIG_ACCESSORS(FastForwardFrames)
 CONFIG_ACCESSORS(RenderResolution)
 CONFIG_ACCESSORS(VSync)
 CONFIG_ACCESSORS(PixelBufferSize)
@@ -494,6 +495,7 @@ static void luaRegister(lua_State *L)
 					CONFIG_PROPERTY(SkipFrame, int)
 					CONFIG_PROPERTY(MaxThreads, int)
 					CONFIG_PROPERTY(AutoSkipFrame, int)
+					CONFIG_PROPERTY(FastForwardFrames, int)
 					CONFIG_PROPERTY(RenderResolution, int)
 					CONFIG_PROPERTY(VSync, bool)
 					CONFIG_PROPERTY(PixelBufferSize, u64)
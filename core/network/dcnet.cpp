@@ -19,7 +19,7 @@
 #include "types.h"
 #include <asio.hpp>
 #include "netservice.h"
-#include "util/tsqueue.h"
+#include "util/spsc_ring.h"
 #include "oslib/oslib.h"
 #include "emulator.h"
 #include "hw/bba/bba.h"
@@ -40,7 +40,22 @@
 namespace net::modbba
 {
 
-static TsQueue<u8> toModem;
+static SpscRing<u8, 8192> toModem;
+// Set by the network thread when toModem is full
+static std::atomic<bool> toModemFull;
+static SpscRing<u8, 8192> fromModem;
+// Set while a task sending fromModem is queued on the network thread
+static std::atomic<bool> fromModemPosted;
+
+// Frames sent by the BBA, waiting to be written by the network thread
+struct EthFrame
+{
+	u32 size;
+	u8 data[1518];	// max ethernet frame size including vlan tag
+};
+static SpscRing<EthFrame, 32> fromBba;
+// Set while a task sending fromBba is queued on the network thread
+static std::atomic<bool> fromBbaPosted;
 
 class DCNetService : public Service
 {
@@ -51,6 +66,8 @@ public:
 	void writeModem(u8 b) override;
 	int readModem() override;
 	int modemAvailable() override;
+	void writeModem(const u8 *data, u32 len) override;
+	u32 readModem(u8 *data, u32 len) override;
 
 	void receiveEthFrame(const u8 *frame, u32 size) override;
 };
@@ -76,16 +93,22 @@ public:
 			fclose(dumpfp);
 	}
 
-	void send(u8 b)
+	// Send the bytes written by the modem
+	void send()
 	{
-		if (sendBufSize == sendBuffer.size()) {
-			WARN_LOG(NETWORK, "PPP output buffer overflow");
-			return;
-		}
-		sendBuffer[sendBufSize++] = b;
+		sendBufSize += fromModem.pop(&sendBuffer[sendBufSize], sendBuffer.size() - sendBufSize);
 		doSend();
 	}
 
+	// Called when the modem has read from a full toModem ring
+	void resumeDelivery()
+	{
+		if (!waitingForModem)
+			return;
+		waitingForModem = false;
+		deliver();
+	}
+
 private:
 	void receive()
 	{
@@ -100,15 +123,33 @@ private:
 					return;
 				}
 				pppdump(recvBuffer.data(), len, false);
-				for (size_t i = 0; i < len; i++)
-					toModem.push(recvBuffer[i]);
-				receive();
+				recvSize = len;
+				recvOffset = 0;
+				deliver();
 			});
 	}
 
+	void deliver()
+	{
+		recvOffset += toModem.push(&recvBuffer[recvOffset], recvSize - recvOffset);
+		if (recvOffset < recvSize)
+		{
+			// The modem is slower than the network. Wait until it reads from the ring.
+			toModemFull = true;
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			// The modem may have read before seeing the flag
+			recvOffset += toModem.push(&recvBuffer[recvOffset], recvSize - recvOffset);
+			if (recvOffset < recvSize) {
+				waitingForModem = true;
+				return;
+			}
+		}
+		receive();
+	}
+
 	void doSend()
 	{
-		if (sending)
+		if (sending || sendBufSize == 0)
 			return;
 		pppdump(sendBuffer.data(), sendBufSize, true);
 		sending = true;
@@ -123,10 +164,10 @@ private:
 				}
 				sending = false;
 				sendBufSize -= len;
-				if (sendBufSize > 0) {
+				if (sendBufSize > 0)
 					memmove(&sendBuffer[0], &sendBuffer[len], sendBufSize);
-					doSend();
-				}
+				// The modem may have written more while sending
+				send();
 			});
 	}
 
@@ -174,6 +215,9 @@ private:
 
 	SocketT socket;
 	std::array<u8, 1542> recvBuffer;
+	size_t recvSize = 0;
+	size_t recvOffset = 0;
+	bool waitingForModem = false;
 	std::array<u8, 1542> sendBuffer;
 	u32 sendBufSize = 0;
 	bool sending = false;
@@ -198,7 +242,8 @@ public:
 		os_notify("Connected to DCNet with Ethernet", 5000, endpointName.c_str());
 		receive();
 		u8 prolog[] = { 'D', 'C', 'N', 'E', 'T', 1 };
-		send(prolog, sizeof(prolog));
+		append(prolog, sizeof(prolog));
+		doSend();
 	}
 
 	~EthSocket() {
@@ -206,22 +251,30 @@ public:
 			fclose(dumpfp);
 	}
 
-	void send(const u8 *frame, u32 size)
+	// Send the frames queued in fromBba. The ones that don't fit are sent when the current write completes.
+	void send()
 	{
-		if (sendBufferIdx + size >= sendBuffer.size()) {
-			WARN_LOG(NETWORK, "Dropped out frame (buffer:%d + %d bytes). Increase send buffer size\n", sendBufferIdx, size);
-			return;
+		while (const EthFrame *frame = fromBba.front())
+		{
+			if (sendBufferIdx + 2 + frame->size > sendBuffer.size())
+				break;
+			append(frame->data, frame->size);
+			fromBba.popFront();
 		}
+		doSend();
+	}
+
+private:
+	void append(const u8 *frame, u32 size)
+	{
 		if (size >= 32) // skip prolog
 			ethdump(frame, size);
 		*(u16 *)&sendBuffer[sendBufferIdx] = size;
 		sendBufferIdx += 2;
 		memcpy(&sendBuffer[sendBufferIdx], frame, size);
 		sendBufferIdx += size;
-		doSend();
 	}
 
-private:
 	using iterator = asio::buffers_iterator<asio::const_buffers_1>;
 
 	std::pair<iterator, bool>
@@ -271,7 +324,7 @@ private:
 
 	void doSend()
 	{
-		if (sending)
+		if (sending || sendBufferIdx == 0)
 			return;
 		sending = true;
 		asio::async_write(socket, asio::buffer(sendBuffer, sendBufferIdx),
@@ -286,10 +339,9 @@ private:
 					return;
 				}
 				sendBufferIdx -= len;
-				if (sendBufferIdx != 0) {
+				if (sendBufferIdx != 0)
 					memmove(sendBuffer.data(), sendBuffer.data() + len, sendBufferIdx);
-					doSend();
-				}
+				send();
 			});
 	}
 
@@ -564,6 +616,13 @@ public:
 	{
 		if (thread.joinable())
 			return;
+		// The network thread isn't running so this is safe.
+		toModem.clear();
+		toModemFull = false;
+		fromModem.clear();
+		fromModemPosted = false;
+		fromBba.clear();
+		fromBbaPosted = false;
 		io_context = std::make_unique<asio::io_context>();
 		thread = std::thread(&DCNetThread::run, this);
 	}
@@ -580,22 +639,52 @@ public:
 		os_notify("DCNet disconnected", 3000);
 	}
 
-	void sendModem(u8 v)
+	void sendModem(const u8 *data, u32 len)
 	{
 		if (io_context == nullptr || pppSocket == nullptr)
 			return;
-		io_context->post([this, v]() {
-			pppSocket->send(v);
+		if (fromModem.push(data, len) != len)
+			WARN_LOG(NETWORK, "PPP output buffer overflow");
+		// A single task is queued at a time. It sends everything pushed before it runs.
+		if (!fromModemPosted.exchange(true))
+			io_context->post([this]() {
+				fromModemPosted.exchange(false);
+				if (pppSocket != nullptr)
+					pppSocket->send();
+			});
+	}
+	void resumeModemDelivery()
+	{
+		if (io_context == nullptr)
+			return;
+		io_context->post([this]() {
+			if (pppSocket != nullptr)
+				pppSocket->resumeDelivery();
 		});
 	}
 	void sendEthFrame(const u8 *frame, u32 len)
 	{
 		if (io_context != nullptr && ethSocket != nullptr)
 		{
-			std::vector<u8> vbuf(frame, frame + len);
-			io_context->post([this, vbuf]() {
-				ethSocket->send(vbuf.data(), vbuf.size());
-			});
+			if (len > sizeof(EthFrame::data)) {
+				WARN_LOG(NETWORK, "Oversized ethernet frame dropped (%d bytes)", len);
+				return;
+			}
+			EthFrame *ethFrame = fromBba.reserve();
+			if (ethFrame == nullptr) {
+				WARN_LOG(NETWORK, "Ethernet output buffer overflow");
+				return;
+			}
+			ethFrame->size = len;
+			memcpy(ethFrame->data, frame, len);
+			fromBba.commit();
+			// A single task is queued at a time. It sends everything pushed before it runs.
+			if (!fromBbaPosted.exchange(true))
+				io_context->post([this]() {
+					fromBbaPosted.exchange(false);
+					if (ethSocket != nullptr)
+						ethSocket->send();
+				});
 		}
 		else {
 			// restart the thread if previously stopped
@@ -631,15 +720,38 @@ void DCNetService::stop() {
 }
 
 void DCNetService::writeModem(u8 b) {
-	thread.sendModem(b);
+	thread.sendModem(&b, 1);
+}
+
+// Wake up the network thread if it's waiting for room in toModem
+static void modemRead()
+{
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (toModemFull.load(std::memory_order_relaxed)
+			&& toModem.size() <= toModem.capacity() / 2
+			&& toModemFull.exchange(false))
+		thread.resumeModemDelivery();
 }
 
 int DCNetService::readModem()
 {
-	if (toModem.empty())
+	u8 b;
+	if (!toModem.pop(b))
 		return -1;
-	else
-		return toModem.pop();
+	modemRead();
+	return b;
+}
+
+void DCNetService::writeModem(const u8 *data, u32 len) {
+	thread.sendModem(data, len);
+}
+
+u32 DCNetService::readModem(u8 *data, u32 len)
+{
+	const u32 count = toModem.pop(data, len);
+	if (count != 0)
+		modemRead();
+	return count;
 }
 
 int DCNetService::modemAvailable() {
@@ -712,7 +824,6 @@ void DCNetThread::connect(const asio::ip::address& address, const std::string& a
 
 void DCNetThread::run()
 {
-	toModem.clear();
 	try {
 		std::string hostname;
 #ifndef LIBRETRO
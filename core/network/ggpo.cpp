@@ -76,6 +76,7 @@ static void getLocalInput(MapleInputState inputState[4])
 #include "ui/gui_util.h"
 #include "hw/mem/mem_watch.h"
 #include <string.h>
+#include <atomic>
 #include <chrono>
 #include <thread>
 #include <mutex>
@@ -97,6 +98,8 @@ using namespace std::chrono;
 
 constexpr int MAX_PLAYERS = 2;
 constexpr int SERVER_PORT = 19713;
+// A spectator gives up when no input is received from the host for this long
+constexpr int SPECTATOR_TIMEOUT_MS = 10000;
 
 constexpr u32 BTN_TRIGGER_LEFT	= DC_BTN_BITMAPPED_LAST << 1;
 constexpr u32 BTN_TRIGGER_RIGHT	= DC_BTN_BITMAPPED_LAST << 2;
@@ -127,6 +130,9 @@ static bool absPointerPos;
 static bool keyboardGame;
 static bool mouseGame;
 static int inputSize;
+static bool spectating;
+// Set while stopSession() waits for the session lock
+static std::atomic<bool> sessionClosing;
 static void (*chatCallback)(int playerNum, const std::string& msg);
 
 struct MemPages
@@ -233,8 +239,13 @@ static bool on_event(GGPOEvent *info)
 		break;
 	case GGPO_EVENTCODE_DISCONNECTED_FROM_PEER:
 		INFO_LOG(NETWORK, "Disconnected from peer %d", info->u.disconnected.player);
+		if (info->u.disconnected.player >= 1000)
+		{
+			// Spectators can leave without ending the session
+			os_notify("Spectator disconnected", 2000);
+			break;
+		}
 		throw FlycastException("Disconnected from peer");
-		break;
 	case GGPO_EVENTCODE_TIMESYNC:
 		INFO_LOG(NETWORK, "Timesync: %d frames ahead", info->u.timesync.frames_ahead);
 		timesyncOccurred += 5;
@@ -470,36 +481,74 @@ static void on_message(u8 *msg, int len)
 	}
 }
 
-void startSession(int localPort, int localPlayerNum)
+static void parseAddress(const std::string& address, std::string& ip, u32& port, u32 defaultPort)
 {
-	GGPOSessionCallbacks cb{};
-	cb.begin_game      = begin_game;
-	cb.advance_frame   = advance_frame;
-	cb.load_game_state = load_game_state;
-	cb.save_game_state = save_game_state;
-	cb.free_buffer     = free_buffer;
-	cb.on_event        = on_event;
-	cb.log_game_state  = log_game_state;
-	cb.on_message      = on_message;
+	size_t colon = address.find(':');
+	ip = address.substr(0, colon);
+	if (ip.empty())
+		ip = "127.0.0.1";
+	if (colon == std::string::npos)
+		port = defaultPort;
+	else
+		port = atoi(address.substr(colon + 1).c_str());
+}
 
-#ifdef SYNC_TEST
-	GGPOErrorCode result = ggpo_start_synctest(&ggpoSession, &cb, settings.content.gameId.c_str(), MAX_PLAYERS, sizeof(kcode[0]), 1);
-	if (result != GGPO_OK)
+static VerificationData getVerificationData()
+{
+	VerificationData verif;
+	MD5Sum().add(settings.network.md5.bios)
+			.add(settings.network.md5.game)
+			.getDigest(verif.gameMD5);
+	auto& digest = settings.network.md5.savestate;
+	if (std::find_if(std::begin(digest), std::end(digest), [](u8 b) { return b != 0; }) != std::end(digest))
+		memcpy(verif.stateMD5, digest, sizeof(digest));
+	else
 	{
-		WARN_LOG(NETWORK, "GGPO start sync session failed: %d", result);
-		ggpoSession = nullptr;
-		throw FlycastException("GGPO start sync session failed");
+		MD5Sum().add(settings.network.md5.nvmem)
+				.add(settings.network.md5.nvmem2)
+				.add(settings.network.md5.eeprom)
+				.add(settings.network.md5.vmu)
+				.getDigest(verif.stateMD5);
 	}
-	ggpo_idle(ggpoSession, 0);
-	ggpo::localPlayerNum = localPlayerNum;
-	GGPOPlayer player{ sizeof(GGPOPlayer), GGPO_PLAYERTYPE_LOCAL, localPlayerNum + 1 };
-	result = ggpo_add_player(ggpoSession, &player, &localPlayer);
-	player.player_num = (1 - localPlayerNum) + 1;
-	result = ggpo_add_player(ggpoSession, &player, &remotePlayer);
-	synchronized = true;
-	analogAxes = 0;
-	NOTICE_LOG(NETWORK, "GGPO synctest session started");
-#else
+	return verif;
+}
+
+// Add the spectators (or relays) listed in the GGPOSpectators option.
+// Comma-separated list of ip[:port]. The port defaults to the local port of this instance.
+static void addSpectators(int localPort)
+{
+	const std::string& list = config::GGPOSpectators.get();
+	size_t start = 0;
+	while (start < list.length())
+	{
+		size_t end = list.find(',', start);
+		if (end == std::string::npos)
+			end = list.length();
+		std::string address = list.substr(start, end - start);
+		start = end + 1;
+		if (address.empty())
+			continue;
+
+		GGPOPlayer player{ sizeof(GGPOPlayer), GGPO_PLAYERTYPE_SPECTATOR };
+		std::string ip;
+		u32 port;
+		parseAddress(address, ip, port, localPort);
+		strcpy(player.u.remote.ip_address, ip.c_str());
+		player.u.remote.port = port;
+		GGPOPlayerHandle handle;
+		GGPOErrorCode result = ggpo_add_player(ggpoSession, &player, &handle);
+		if (result != GGPO_OK)
+		{
+			WARN_LOG(NETWORK, "GGPO cannot add spectator %s: %d", address.c_str(), result);
+			stopSession();
+			throw FlycastException("GGPO cannot add spectator");
+		}
+		INFO_LOG(NETWORK, "GGPO spectator %s:%d added", ip.c_str(), port);
+	}
+}
+
+static void setInputConfig()
+{
 	if (settings.platform.isConsole())
 		analogAxes = config::GGPOAnalogAxes;
 	else
@@ -528,22 +577,94 @@ void startSession(int localPort, int localPlayerNum)
 	}
 	inputSize = sizeof(kcode[0]) + analogAxes + (int)absPointerPos * sizeof(Inputs::u.absPos)
 		+ (int)keyboardGame * sizeof(Inputs::u.keys) + (int)mouseGame * sizeof(Inputs::u.relPos);
+}
 
-	VerificationData verif;
-	MD5Sum().add(settings.network.md5.bios)
-			.add(settings.network.md5.game)
-			.getDigest(verif.gameMD5);
-	auto& digest = settings.network.md5.savestate;
-	if (std::find_if(std::begin(digest), std::end(digest), [](u8 b) { return b != 0; }) != std::end(digest))
-		memcpy(verif.stateMD5, digest, sizeof(digest));
+static GGPOSessionCallbacks getCallbacks()
+{
+	GGPOSessionCallbacks cb{};
+	cb.begin_game      = begin_game;
+	cb.advance_frame   = advance_frame;
+	cb.load_game_state = load_game_state;
+	cb.save_game_state = save_game_state;
+	cb.free_buffer     = free_buffer;
+	cb.on_event        = on_event;
+	cb.log_game_state  = log_game_state;
+	cb.on_message      = on_message;
+	return cb;
+}
+
+//
+// Watch a game by receiving the confirmed inputs of player 1 or of a relay.
+// If spectators are configured, this instance also acts as a relay and forwards
+// the inputs to them, so that the players only need to serve a single spectator.
+//
+static void startSpectating(int localPort)
+{
+	GGPOSessionCallbacks cb = getCallbacks();
+	setInputConfig();
+	VerificationData verif = getVerificationData();
+
+	std::string hostIp;
+	u32 hostPort;
+	parseAddress(config::NetworkServer.get(), hostIp, hostPort, SERVER_PORT);
+	char ip[32];
+	strncpy(ip, hostIp.c_str(), sizeof(ip) - 1);
+	ip[sizeof(ip) - 1] = '\0';
+
+	GGPOErrorCode result;
+	if (config::GGPOSpectators.get().empty())
+		result = ggpo_start_spectating(&ggpoSession, &cb, settings.content.gameId.c_str(), MAX_PLAYERS, inputSize, localPort,
+				ip, hostPort, &verif, sizeof(verif));
 	else
+		result = ggpo_start_relay(&ggpoSession, &cb, settings.content.gameId.c_str(), MAX_PLAYERS, inputSize, localPort,
+				ip, hostPort, std::max(0, config::GGPORelayDelay.get()), &verif, sizeof(verif));
+	if (result != GGPO_OK)
 	{
-		MD5Sum().add(settings.network.md5.nvmem)
-				.add(settings.network.md5.nvmem2)
-				.add(settings.network.md5.eeprom)
-				.add(settings.network.md5.vmu)
-				.getDigest(verif.stateMD5);
+		WARN_LOG(NETWORK, "GGPO start spectating failed: %d", result);
+		ggpoSession = nullptr;
+		throw FlycastException("GGPO network initialization failed");
+	}
+	spectating = true;
+	ggpo::localPlayerNum = -1;
+	if (!config::GGPOSpectators.get().empty())
+	{
+		ggpo_set_disconnect_timeout(ggpoSession, 3000);
+		ggpo_set_disconnect_notify_start(ggpoSession, 1000);
+		addSpectators(localPort);
+	}
+	DEBUG_LOG(NETWORK, "GGPO spectator session started");
+}
+
+void startSession(int localPort, int localPlayerNum)
+{
+	spectating = false;
+	if (config::GGPOSpectate)
+	{
+		startSpectating(localPort);
+		return;
 	}
+	GGPOSessionCallbacks cb = getCallbacks();
+
+#ifdef SYNC_TEST
+	GGPOErrorCode result = ggpo_start_synctest(&ggpoSession, &cb, settings.content.gameId.c_str(), MAX_PLAYERS, sizeof(kcode[0]), 1);
+	if (result != GGPO_OK)
+	{
+		WARN_LOG(NETWORK, "GGPO start sync session failed: %d", result);
+		ggpoSession = nullptr;
+		throw FlycastException("GGPO start sync session failed");
+	}
+	ggpo_idle(ggpoSession, 0);
+	ggpo::localPlayerNum = localPlayerNum;
+	GGPOPlayer player{ sizeof(GGPOPlayer), GGPO_PLAYERTYPE_LOCAL, localPlayerNum + 1 };
+	result = ggpo_add_player(ggpoSession, &player, &localPlayer);
+	player.player_num = (1 - localPlayerNum) + 1;
+	result = ggpo_add_player(ggpoSession, &player, &remotePlayer);
+	synchronized = true;
+	analogAxes = 0;
+	NOTICE_LOG(NETWORK, "GGPO synctest session started");
+#else
+	setInputConfig();
+	VerificationData verif = getVerificationData();
 
 	GGPOErrorCode result = ggpo_start_session(&ggpoSession, &cb, settings.content.gameId.c_str(), MAX_PLAYERS, inputSize, localPort,
 			&verif, sizeof(verif));
@@ -571,22 +692,11 @@ void startSession(int localPort, int localPlayerNum)
 	}
 	ggpo_set_frame_delay(ggpoSession, localPlayer, config::GGPODelay.get());
 
-	size_t colon = config::NetworkServer.get().find(':');
-	std::string peerIp = config::NetworkServer.get().substr(0, colon);
-	if (peerIp.empty())
-		peerIp = "127.0.0.1";
+	std::string peerIp;
 	u32 peerPort;
-	if (colon == std::string::npos)
-	{
-		if (peerIp == "127.0.0.1")
-			peerPort = localPort ^ 1;
-		else
-			peerPort = SERVER_PORT;
-	}
-	else
-	{
-		peerPort = atoi(config::NetworkServer.get().substr(colon + 1).c_str());
-	}
+	parseAddress(config::NetworkServer.get(), peerIp, peerPort, SERVER_PORT);
+	if (peerIp == "127.0.0.1" && config::NetworkServer.get().find(':') == std::string::npos)
+		peerPort = localPort ^ 1;
 	player.type = GGPO_PLAYERTYPE_REMOTE;
 	strcpy(player.u.remote.ip_address, peerIp.c_str());
 	player.u.remote.port = peerPort;
@@ -598,13 +708,18 @@ void startSession(int localPort, int localPlayerNum)
 		stopSession();
 		throw FlycastException("GGPO cannot add remote player");
 	}
+	// Confirmed inputs are served to spectators by player 1 only
+	if (localPlayerNum == 0)
+		addSpectators(localPort);
 	DEBUG_LOG(NETWORK, "GGPO session started");
 #endif
 }
 
 void stopSession()
 {
+	sessionClosing = true;
 	std::lock_guard<std::recursive_mutex> lock(ggpoMutex);
+	sessionClosing = false;
 	if (ggpoSession == nullptr)
 		return;
 	ggpo_close_session(ggpoSession);
@@ -629,6 +744,24 @@ void getInput(MapleInputState inputState[4])
 	std::vector<u8> inputData(inputSize * MAX_PLAYERS);
 	// should not call any callback
 	GGPOErrorCode error = ggpo_synchronize_input(ggpoSession, (void *)&inputData[0], inputData.size(), nullptr);
+	const auto waitStart = steady_clock::now();
+	while (spectating && error == GGPO_ERRORCODE_PREDICTION_THRESHOLD)
+	{
+		// Spectators must wait for the confirmed inputs of the next frame
+		if (sessionClosing)
+			// the emulator is being stopped
+			return;
+		if (steady_clock::now() - waitStart > milliseconds(SPECTATOR_TIMEOUT_MS))
+		{
+			WARN_LOG(NETWORK, "GGPO spectator: no input received from the host for %d ms", SPECTATOR_TIMEOUT_MS);
+			stopSession();
+			throw FlycastException("GGPO host timed out");
+		}
+		std::this_thread::sleep_for(milliseconds(1));
+		error = ggpo_idle(ggpoSession, 0);
+		if (error == GGPO_OK)
+			error = ggpo_synchronize_input(ggpoSession, (void *)&inputData[0], inputData.size(), nullptr);
+	}
 	if (error != GGPO_OK)
 	{
 		stopSession();
@@ -702,6 +835,8 @@ bool nextFrame()
 		else
 			throw FlycastException("GGPO error");
 	}
+	if (spectating)
+		return active();
 
 	// may call save_game_state
 	do {
@@ -791,11 +926,13 @@ std::future<bool> startNetwork()
 			if (config::EnableUPnP)
 			{
 				miniupnp.Init();
-				miniupnp.AddPortMapping(SERVER_PORT, false);
+				miniupnp.AddPortMapping(config::GGPOSpectate ? config::LocalPort : SERVER_PORT, false);
 			}
 
 			try {
-				if (config::ActAsServer)
+				if (config::GGPOSpectate)
+					startSession(config::LocalPort, -1);
+				else if (config::ActAsServer)
 					startSession(SERVER_PORT, 0);
 				else
 					// Use SERVER_PORT-1 as local port if connecting to ourselves
@@ -831,7 +968,7 @@ std::future<bool> startNetwork()
 			getInput(state);
 		}
 #endif
-		if (active() && (settings.content.gameId == "VIRTUA FIGHTER 4 JAPAN"
+		if (active() && !spectating && (settings.content.gameId == "VIRTUA FIGHTER 4 JAPAN"
 				|| settings.content.gameId == "VF4 EVOLUTION JAPAN"
 				|| settings.content.gameId == "VF4 FINAL TUNED JAPAN"))
 		{
@@ -853,7 +990,7 @@ std::future<bool> startNetwork()
 
 void displayStats()
 {
-	if (!active())
+	if (!active() || spectating)
 		return;
 	GGPONetworkStats stats;
 	ggpo_get_network_stats(ggpoSession, remotePlayer, &stats);
@@ -22,6 +22,7 @@
 #include "oslib/oslib.h"
 
 #include <chrono>
+#include <memory>
 #include <thread>
 
 NaomiNetwork naomiNetwork;
@@ -87,6 +88,8 @@ bool NaomiNetwork::startNetwork()
 	slotId = 0;
 	slotCount = 0;
 	slaves.clear();
+	receivedPackets.clear();
+	ioFailed = false;
 
 	using namespace std::chrono;
 
@@ -263,13 +266,31 @@ bool NaomiNetwork::receive(const sockaddr_in *addr, const Packet *packet, u32 si
 		break;
 
 	case Data:
-		if (!receivedData.empty())
-			INFO_LOG(NETWORK, "Received packet overwritten");
-		receivedData.resize(size - packet->size(0));
-		memcpy(receivedData.data(), packet->data.payload, receivedData.size());
-		packetNumber = packet->data.packetNumber;
-		// TODO? sendAck(peer, port);
-		return true;
+		{
+			ReceivedPacket *slot = receivedPackets.reserve();
+			if (slot == nullptr)
+			{
+				// The latest packet wins: drop the oldest one.
+				// receive() only accesses the queue while holding receiveMutex.
+				std::lock_guard<std::mutex> _(receiveMutex);
+				if (receivedPackets.full())
+				{
+					INFO_LOG(NETWORK, "Receive queue full: oldest packet dropped");
+					receivedPackets.popFront();
+				}
+				slot = receivedPackets.reserve();
+			}
+			slot->size = size - packet->size(0);
+			memcpy(slot->payload, packet->data.payload, slot->size);
+			slot->packetNumber = packet->data.packetNumber;
+			{
+				std::lock_guard<std::mutex> _(receiveMutex);
+				receivedPackets.commit();
+			}
+			receiveCond.notify_one();
+			// TODO? sendAck(peer, port);
+			return true;
+		}
 
 	case Ack:
 		break;
@@ -288,6 +309,129 @@ bool NaomiNetwork::receive(const sockaddr_in *addr, const Packet *packet, u32 si
 	return false;
 }
 
+bool NaomiNetwork::receive(u8 *data, u32 size, u16 *packetNumber, int timeoutMs)
+{
+	if (!ioThreadRunning)
+		poll();
+	std::unique_lock<std::mutex> lock(receiveMutex);
+	if (receivedPackets.empty() && timeoutMs > 0)
+		receiveCond.wait_for(lock, std::chrono::milliseconds(timeoutMs), [this]() {
+			return !receivedPackets.empty() || ioFailed;
+		});
+	if (ioFailed)
+		throw Exception(ioError);
+	// The latest packet wins
+	while (receivedPackets.size() > 1)
+	{
+		INFO_LOG(NETWORK, "Received packet overwritten");
+		receivedPackets.popFront();
+	}
+	ReceivedPacket *packet = receivedPackets.front();
+	if (packet == nullptr)
+		return false;
+
+	size = std::min(size, packet->size);
+	memcpy(data, packet->payload, size);
+	*packetNumber = packet->packetNumber;
+	receivedPackets.popFront();
+
+	return true;
+}
+
+void NaomiNetwork::startIoThread()
+{
+	verify(!ioThread.joinable());
+	if (ioPackets == nullptr)
+		ioPackets = std::make_unique<Packet[]>(BatchSize);
+	ioThreadRunning = true;
+	ioThread = std::thread(&NaomiNetwork::ioThreadLoop, this);
+}
+
+void NaomiNetwork::stopIoThread()
+{
+	if (!ioThread.joinable())
+		return;
+	ioThreadRunning = false;
+	ioThread.join();
+}
+
+void NaomiNetwork::ioThreadLoop()
+{
+	ThreadName _("NaomiNetwork");
+	try {
+		while (ioThreadRunning)
+		{
+			fd_set readFds;
+			FD_ZERO(&readFds);
+			FD_SET(sock, &readFds);
+			// Short timeout so that the thread can be stopped
+			timeval tv { 0, 20000 };
+			int rc = select((int)sock + 1, &readFds, nullptr, nullptr, &tv);
+			if (rc < 0)
+			{
+				int error = get_last_error();
+				if (error == EINTR)
+					continue;
+				throw Exception("select error: errno " + std::to_string(error));
+			}
+			if (rc > 0)
+				readPackets();
+		}
+	} catch (const Exception& e) {
+		ERROR_LOG(NETWORK, "NaomiNetwork I/O error: %s", e.what());
+		{
+			std::lock_guard<std::mutex> _(receiveMutex);
+			ioError = e.what();
+			ioFailed = true;
+		}
+		receiveCond.notify_one();
+	}
+}
+
+#ifdef __linux__
+void NaomiNetwork::readPackets()
+{
+	// Read all pending datagrams in as few system calls as possible
+	Packet *packets = ioPackets.get();
+	sockaddr_in addrs[BatchSize];
+	iovec iovs[BatchSize];
+	mmsghdr msgs[BatchSize];
+	while (true)
+	{
+		for (unsigned i = 0; i < BatchSize; i++)
+		{
+			iovs[i].iov_base = &packets[i];
+			iovs[i].iov_len = sizeof(Packet);
+			msgs[i] = {};
+			msgs[i].msg_hdr.msg_name = &addrs[i];
+			msgs[i].msg_hdr.msg_namelen = sizeof(addrs[i]);
+			msgs[i].msg_hdr.msg_iov = &iovs[i];
+			msgs[i].msg_hdr.msg_iovlen = 1;
+		}
+		int count = recvmmsg(sock, msgs, BatchSize, MSG_DONTWAIT, nullptr);
+		if (count == -1)
+		{
+			int error = get_last_error();
+			if (error == L_EWOULDBLOCK || error == L_EAGAIN || error == EINTR)
+				break;
+			throw Exception("Receive error: errno " + std::to_string(error));
+		}
+		for (int i = 0; i < count; i++)
+		{
+			if (msgs[i].msg_len < packets[i].size(0))
+				throw Exception("Receive error: truncated packet");
+			receive(&addrs[i], &packets[i], msgs[i].msg_len);
+		}
+		if (count < (int)BatchSize)
+			break;
+	}
+}
+#else
+void NaomiNetwork::readPackets() {
+	poll();
+}
+#endif
+
 // Sets the game network config using MIE eeprom or bbsram:
 // Node -1 disables network
 // Node 0 is master, nodes 1+ are slave
@@ -23,10 +23,15 @@
 #include "cfg/option.h"
 #include "emulator.h"
 #include "oslib/oslib.h"
+#include "util/spsc_ring.h"
 
 #include <algorithm>
 #include <atomic>
+#include <condition_variable>
 #include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include <vector>
 
 class NaomiNetwork
@@ -47,6 +52,8 @@ public:
 		return std::async(std::launch::async, [this] {
 			ThreadName _("NaomiNetwork-start");
 			bool res = startNetwork();
+			if (res)
+				startIoThread();
 			emu.setNetworkState(res);
 			return res;
 		});
@@ -54,6 +61,7 @@ public:
 
 	void shutdown()
 	{
+		stopIoThread();
 		enableNetworkBroadcast(false);
 		emu.setNetworkState(false);
 		if (sock != INVALID_SOCKET)
@@ -63,19 +71,8 @@ public:
 		}
 	}
 
-	bool receive(u8 *data, u32 size, u16 *packetNumber)
-	{
-		poll();
-		if (receivedData.empty())
-			return false;
-
-		size = std::min(size, (u32)receivedData.size());
-		memcpy(data, receivedData.data(), size);
-		receivedData.erase(receivedData.begin(), receivedData.begin() + size);
-		*packetNumber = this->packetNumber;
-
-		return true;
-	}
+	// Waits up to timeoutMs for a data packet to be received
+	bool receive(u8 *data, u32 size, u16 *packetNumber, int timeoutMs = 0);
 
 	void send(u8 *data, u32 size, u16 packetNumber)
 	{
@@ -180,6 +177,11 @@ private:
 
 	bool receive(const sockaddr_in *addr, const Packet *packet, u32 size);
 
+	void startIoThread();
+	void stopIoThread();
+	void ioThreadLoop();
+	void readPackets();
+
 	void sendAck(const sockaddr_in *addr, bool ack = true)
 	{
 		Packet packet(ack ? Ack : NAck);
@@ -202,10 +204,26 @@ private:
 	MiniUPnP miniupnp;
 
 	sockaddr_in nextPeer;
-	std::vector<u8> receivedData;
-	u16 packetNumber = 0;
 	bool _startNow = false;
 
+	// Data packets received by the I/O thread. Only the latest one is read by receive().
+	// The consumer side is protected by receiveMutex so that the producer can drop the oldest packet when full.
+	struct ReceivedPacket
+	{
+		u16 packetNumber;
+		u32 size;
+		u8 payload[sizeof(Packet::data.payload)];
+	};
+	SpscRing<ReceivedPacket, 8> receivedPackets;
+	std::mutex receiveMutex;
+	std::condition_variable receiveCond;
+	std::thread ioThread;
+	std::atomic<bool> ioThreadRunning{ false };
+	std::string ioError;
+	std::atomic<bool> ioFailed{ false };
+	static constexpr unsigned BatchSize = 8;
+	std::unique_ptr<Packet[]> ioPackets;
+
 	// Server stuff
 	struct Slave
 	{
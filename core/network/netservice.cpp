@@ -59,6 +59,14 @@ int modemAvailable() {
 	verify(service != nullptr);
 	return service->modemAvailable();
 }
+void writeModem(const u8 *data, u32 len) {
+	verify(service != nullptr);
+	service->writeModem(data, len);
+}
+u32 readModem(u8 *data, u32 len) {
+	verify(service != nullptr);
+	return service->readModem(data, len);
+}
 
 void receiveEthFrame(const u8 *frame, u32 size) {
 	start();
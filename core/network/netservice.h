@@ -28,6 +28,9 @@ void stop();
 void writeModem(u8 b);
 int readModem();
 int modemAvailable();
+// Bulk modem I/O. readModem returns the number of bytes actually read.
+void writeModem(const u8 *data, u32 len);
+u32 readModem(u8 *data, u32 len);
 
 void receiveEthFrame(const u8 *frame, u32 size);
 
@@ -42,6 +45,24 @@ public:
 	virtual int readModem() = 0;
 	virtual int modemAvailable() = 0;
 
+	virtual void writeModem(const u8 *data, u32 len)
+	{
+		for (u32 i = 0; i < len; i++)
+			writeModem(data[i]);
+	}
+	virtual u32 readModem(u8 *data, u32 len)
+	{
+		u32 count = 0;
+		for (; count < len; count++)
+		{
+			int c = readModem();
+			if (c < 0)
+				break;
+			data[count] = (u8)c;
+		}
+		return count;
+	}
+
 	virtual void receiveEthFrame(const u8 *frame, u32 size) = 0;
 };
 
@@ -49,13 +49,15 @@ extern "C" {
 #include "cfg/option.h"
 #include "emulator.h"
 #include "oslib/oslib.h"
-#include "util/tsqueue.h"
+#include "util/spsc_ring.h"
 #include "util/shared_this.h"
+#include "util/task_pool.h"
 #include "hw/bba/bba.h"
 
 #include <unordered_map>
 #include <mutex>
 #include <future>
+#include <cinttypes>
 
 #define RESOLVER1_OPENDNS_COM "208.67.222.222"
 #define AFO_ORIG_IP 0x83f2fb3f		// 63.251.242.131 in network order
@@ -64,8 +66,10 @@ extern "C" {
 constexpr int PICO_TICK_MS = 5;
 static pico_device *pico_dev;
 
-static TsQueue<u8> in_buffer;
-static TsQueue<u8> out_buffer;
+// emulator <- network thread. Must be large enough for an escaped PPP frame of the maximum size.
+static SpscRing<u8, 4096> in_buffer;
+// emulator -> network thread
+static SpscRing<u8, 4096> out_buffer;
 
 static pico_ip4 dcaddr;
 static pico_ip4 dnsaddr;
@@ -175,44 +179,39 @@ static bool start_pico();
 u32 makeDnsQueryPacket(void *buf, const char *host);
 pico_ip4 parseDnsResponsePacket(const void *buf, size_t len);
 
-static int modem_read(pico_device *dev, void *data, int len)
-{
-	u8 *p = (u8 *)data;
-	int count = 0;
-	for (; !out_buffer.empty() && count < len; count++)
-		*p++ = out_buffer.pop();
-
-    return count;
+static int modem_read(pico_device *dev, void *data, int len) {
+	return (int)out_buffer.pop((u8 *)data, len);
 }
 
 static int modem_write(pico_device *dev, const void *data, int len)
 {
-	u8 *p = (u8 *)data;
-
-	for (int i = 0; i < len; i++)
+	if ((size_t)len > in_buffer.capacity())
 	{
-		while (in_buffer.size() > 1024)
-		{
-			if (!pico_thread_running)
-				return 0;
-			PICO_IDLE();
-		}
-		in_buffer.push(*p++);
+		WARN_LOG(MODEM, "PPP frame too large: %d bytes dropped", len);
+		return len;
 	}
-
-    return len;
+	// Frames are written whole or not at all. If the emulator hasn't read enough yet, the frame
+	// stays in the device queue and is sent again on the next tick.
+	if (in_buffer.capacity() - in_buffer.size() < (size_t)len)
+		return 0;
+	return (int)in_buffer.push((const u8 *)data, len);
 }
 
-static void write_pico(u8 b) {
-	out_buffer.push(b);
+static void write_pico(const u8 *data, u32 len)
+{
+	// The network thread drains the buffer every PICO_TICK_MS so it only overflows if it's stalled.
+	// Don't block the emulator in that case.
+	static u64 droppedBytes;
+	const u32 pushed = out_buffer.push(data, len);
+	if (pushed != len)
+	{
+		droppedBytes += len - pushed;
+		WARN_LOG(MODEM, "PPP output buffer overflow: %u bytes dropped (%" PRIu64 " total)", len - pushed, droppedBytes);
+	}
 }
 
-static int read_pico()
-{
-	if (in_buffer.empty())
-		return -1;
-	else
-		return in_buffer.pop();
+static u32 read_pico(u8 *data, u32 len) {
+	return in_buffer.pop(data, len);
 }
 
 static int pico_available() {
@@ -982,7 +981,7 @@ private:
 		{
 			if (upnpCmd.valid())
 				upnpCmd.get();
-			upnpCmd = std::async(std::launch::async, [this, port, udpOnly]()
+			upnpCmd = TaskPool::instance().runFuture(TaskPool::Background, [this, port, udpOnly]()
 			{
 				if (!upnp->AddPortMapping(port, false))
 					WARN_LOG(MODEM, "UPNP AddPortMapping UDP %d failed", port);
@@ -1240,10 +1239,9 @@ void PicoThread::run()
 	{
 		upnp = std::make_shared<MiniUPnP>();
 		pnpFuture = std::move(
-			std::async(std::launch::async, [this]()
+			TaskPool::instance().runFuture(TaskPool::Background, [this]()
 			{
 				// Initialize miniupnpc and map network ports
-				ThreadName _("UPNP-init");
 				if (!upnp->Init())
 					WARN_LOG(MODEM, "UPNP Init failed");
 				else
@@ -1258,10 +1256,6 @@ void PicoThread::run()
 			}));
 	}
 
-	// Empty queues
-	in_buffer.clear();
-	out_buffer.clear();
-
     // Find DNS ip address
 	{
 		std::string dnsName = config::DNS;
@@ -1409,12 +1403,13 @@ void PicoThread::run()
 		pico_dev = nullptr;
 	}
 	pico_stack_deinit();
+	if (pnpFuture.valid())
+		pnpFuture.get();
 	if (upnp)
 	{
-		std::thread pnpTerm([upnp = this->upnp]() {
+		TaskPool::instance().run(TaskPool::Background, [upnp = this->upnp]() {
 			upnp->Term();
 		});
-		pnpTerm.detach();
 		upnp.reset();
 	}
 }
@@ -1426,6 +1421,9 @@ static bool start_pico()
 	emu.setNetworkState(true);
 	if (pico_thread_running)
 		return false;
+	// Empty queues. The network thread isn't running so this is safe.
+	in_buffer.clear();
+	out_buffer.clear();
 	pico_thread_running = true;
 	pico_thread.start();
 
@@ -1471,10 +1469,21 @@ void PicoTcpService::stop() {
 }
 
 void PicoTcpService::writeModem(u8 b) {
-	write_pico(b);
+	write_pico(&b, 1);
+}
+int PicoTcpService::readModem()
+{
+	u8 b;
+	if (read_pico(&b, 1) == 0)
+		return -1;
+	else
+		return b;
+}
+void PicoTcpService::writeModem(const u8 *data, u32 len) {
+	write_pico(data, len);
 }
-int PicoTcpService::readModem() {
-	return read_pico();
+u32 PicoTcpService::readModem(u8 *data, u32 len) {
+	return read_pico(data, len);
 }
 int PicoTcpService::modemAvailable() {
 	return pico_available();
@@ -32,6 +32,8 @@ public:
 	void writeModem(u8 b) override;
 	int readModem() override;
 	int modemAvailable() override;
+	void writeModem(const u8 *data, u32 len) override;
+	u32 readModem(u8 *data, u32 len) override;
 	void receiveEthFrame(const u8 *frame, u32 size) override;
 };
 
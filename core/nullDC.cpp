@@ -16,6 +16,10 @@
 #include "lua/lua.h"
 #include "stdclass.h"
 #include "serialize.h"
+#include "profiler/benchmark.h"
+#include "profiler/metrics.h"
+#include "util/task_pool.h"
+#include <chrono>
 #include <time.h>
 
 static std::string lastStateFile;
@@ -78,12 +82,17 @@ int flycast_init(int argc, char* argv[])
 		config::Settings::instance().load(false);
 	}
 	gui_init();
-	os_CreateWindow();
-	os_SetupInput();
+	if (!benchmark::active())
+	{
+		os_CreateWindow();
+		os_SetupInput();
+	}
 
 	if(config::GDB)
 		debugger::init(config::GDBPort);
 	lua::init();
+	if (config::MetricsPort != 0)
+		metrics::init(config::MetricsPort);
 
 	if(config::ProfilerEnabled)
 		LogManager::GetInstance()->SetEnable(LogTypes::PROFILER, true);
@@ -116,11 +125,15 @@ void SaveSettings()
 void flycast_term()
 {
 	gui_cancel_load();
+	metrics::term();
 	lua::term();
 	emu.term();
-	os_DestroyWindow();
+	if (!benchmark::active())
+		os_DestroyWindow();
 	gui_term();
-	os_TermInput();
+	if (!benchmark::active())
+		os_TermInput();
+	TaskPool::instance().stop();
 }
 
 void dc_savestate(int index, const u8 *pngData, u32 pngSize)
@@ -130,6 +143,7 @@ void dc_savestate(int index, const u8 *pngData, u32 pngSize)
 
 	lastStateFile.clear();
 
+	const auto startTime = std::chrono::steady_clock::now();
 	Serializer ser;
 	dc_serialize(ser);
 
@@ -176,6 +190,7 @@ void dc_savestate(int index, const u8 *pngData, u32 pngSize)
 #endif
 
 	free(data);
+	metrics::savestateSaved(std::chrono::steady_clock::now() - startTime);
 	NOTICE_LOG(SAVESTATE, "Saved state to %s size %d", filename.c_str(), (int)ser.size());
 	os_notify("State saved", 2000);
 	return;
@@ -195,6 +210,7 @@ void dc_loadstate(int index)
 {
 	if (settings.raHardcoreMode)
 		return;
+	const auto startTime = std::chrono::steady_clock::now();
 	u32 total_size = 0;
 
 	std::string filename = hostfs::getSavestatePath(index, false);
@@ -272,6 +288,7 @@ void dc_loadstate(int index)
 	try {
 		Deserializer deser(data, total_size);
 		emu.loadstate(deser);
+		metrics::savestateLoaded(std::chrono::steady_clock::now() - startTime);
 	    NOTICE_LOG(SAVESTATE, "Loaded state ver %d from %s size %d", deser.version(), filename.c_str(), total_size);
 		if (deser.size() != total_size)
 			// Note: this isn't true for RA savestates
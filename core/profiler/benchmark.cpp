@@ -0,0 +1,391 @@
+/*
+	Copyright 2026 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "benchmark.h"
+#include "emulator.h"
+#include "cfg/cfg.h"
+#include "cfg/option.h"
+#include "hw/pvr/Renderer_if.h"
+#include "hw/sh4/sh4_if.h"
+#include "hw/sh4/sh4_sched.h"
+#include "input/gamepad_device.h"
+#include "input/movie.h"
+#include "rend/osd.h"
+#include "json.hpp"
+#include <stb_image_write.h>
+#include <cstdio>
+#include <cinttypes>
+#include <algorithm>
+#include <vector>
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+using namespace nlohmann;
+
+namespace benchmark
+{
+
+Params params;
+bool enabled;
+
+static std::chrono::steady_clock::duration sectionTimes[(int)Section::Count];
+
+struct InputEvent
+{
+	u64 time;	// SH4 cycles
+	u32 port;
+	u32 kcode;
+};
+static std::vector<InputEvent> inputEvents;
+static size_t nextInputEvent;
+static u32 vblankCount;
+static std::vector<std::chrono::steady_clock::duration> frameTimes;
+static u64 yuvMacroBlocks;
+
+void addTime(Section section, std::chrono::steady_clock::duration duration) {
+	sectionTimes[(int)section] += duration;
+}
+
+void frameRendered(std::chrono::steady_clock::duration duration)
+{
+	addTime(Section::Raster, duration);
+	frameTimes.push_back(duration);
+}
+
+void yuvConverted(u32 macroBlocks)
+{
+	if (enabled)
+		yuvMacroBlocks += macroBlocks;
+}
+
+int parseArgs(char *arg[], int cl)
+{
+	if (cl < 1)
+	{
+		WARN_LOG(COMMON, "%s : missing parameter", arg[0]);
+		return 0;
+	}
+	if (stricmp(arg[0], "-benchmark") == 0 || stricmp(arg[0], "--benchmark") == 0)
+	{
+		params.frames = atoi(arg[1]);
+		enabled = params.frames > 0;
+		if (enabled)
+		{
+			// no frame limiting, no audio, emulation and rendering on the same thread
+			cfgSetVirtual("config", "rend.ThreadedRendering", "no");
+			cfgSetVirtual("audio", "backend", "null");
+		}
+	}
+	else if (stricmp(arg[0], "-benchmark-input") == 0 || stricmp(arg[0], "--benchmark-input") == 0)
+	{
+		params.inputScript = arg[1];
+	}
+	else if (stricmp(arg[0], "-benchmark-state") == 0 || stricmp(arg[0], "--benchmark-state") == 0)
+	{
+		params.stateSlot = atoi(arg[1]);
+		cfgSetVirtual("config", "Dreamcast.AutoLoadState", "yes");
+		cfgSetVirtual("config", "Dreamcast.SavestateSlot", std::to_string(params.stateSlot));
+	}
+	else if (stricmp(arg[0], "-benchmark-renderer") == 0 || stricmp(arg[0], "--benchmark-renderer") == 0)
+	{
+		if (stricmp(arg[1], "soft") == 0)
+		{
+			params.softRenderer = true;
+			cfgSetVirtual("config", "pvr.rend", std::to_string((int)RenderType::Software));
+		}
+		else if (stricmp(arg[1], "none") == 0)
+		{
+			params.softRenderer = false;
+		}
+		else
+		{
+			WARN_LOG(COMMON, "Unknown benchmark renderer '%s'", arg[1]);
+		}
+	}
+	else if (stricmp(arg[0], "-benchmark-output") == 0 || stricmp(arg[0], "--benchmark-output") == 0)
+	{
+		params.output = arg[1];
+	}
+	else if (stricmp(arg[0], "-benchmark-dump") == 0 || stricmp(arg[0], "--benchmark-dump") == 0)
+	{
+		params.frameDump = arg[1];
+	}
+	else
+	{
+		WARN_LOG(COMMON, "Ignoring unknown command line option '%s'", arg[0]);
+		return 0;
+	}
+	return 1;
+}
+
+// Same format as the TEST_AUTOMATION input recordings: <sh4 cycles> button <port> <kcode>
+static bool loadInputScript(const std::string& path)
+{
+	FILE *f = nowide::fopen(path.c_str(), "r");
+	if (f == nullptr)
+	{
+		ERROR_LOG(COMMON, "Can't open input script %s", path.c_str());
+		return false;
+	}
+	inputEvents.clear();
+	char line[128];
+	while (fgets(line, sizeof(line), f) != nullptr)
+	{
+		InputEvent event;
+		if (sscanf(line, "%" SCNu64 " button %x %x", &event.time, &event.port, &event.kcode) != 3)
+			continue;
+		if (event.port >= std::size(kcode))
+			continue;
+		inputEvents.push_back(event);
+	}
+	fclose(f);
+	INFO_LOG(COMMON, "Loaded %d input events from %s", (int)inputEvents.size(), path.c_str());
+
+	return true;
+}
+
+static void vblankCallback(Event event, void *)
+{
+	const u64 now = sh4_sched_now64();
+	for (; nextInputEvent < inputEvents.size() && inputEvents[nextInputEvent].time <= now; nextInputEvent++)
+		kcode[inputEvents[nextInputEvent].port] = inputEvents[nextInputEvent].kcode;
+
+	if (++vblankCount >= params.frames)
+		emu.getSh4Executor()->Stop();
+}
+
+// Data TLB load misses of the calling thread, in user mode.
+// The emulation runs on the calling thread in benchmark mode.
+class TlbMissCounter
+{
+public:
+	TlbMissCounter()
+	{
+#if defined(__linux__)
+		perf_event_attr attr {};
+		attr.size = sizeof(attr);
+		attr.type = PERF_TYPE_HW_CACHE;
+		attr.config = PERF_COUNT_HW_CACHE_DTLB
+				| (PERF_COUNT_HW_CACHE_OP_READ << 8)
+				| (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+		attr.disabled = 1;
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		fd = (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+		if (fd < 0)
+			WARN_LOG(COMMON, "dTLB miss counter not available: errno %d", errno);
+#endif
+	}
+	~TlbMissCounter()
+	{
+#if defined(__linux__)
+		if (fd >= 0)
+			close(fd);
+#endif
+	}
+
+	void start()
+	{
+#if defined(__linux__)
+		if (fd >= 0)
+		{
+			ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+			ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+		}
+#endif
+	}
+
+	// Returns -1 if not available
+	int64_t stop()
+	{
+#if defined(__linux__)
+		u64 count;
+		if (fd >= 0 && ioctl(fd, PERF_EVENT_IOC_DISABLE, 0) == 0
+				&& read(fd, &count, sizeof(count)) == sizeof(count))
+			return (int64_t)count;
+#endif
+		return -1;
+	}
+
+private:
+	int fd = -1;
+};
+
+static bool dumpLastFrame(const std::string& path)
+{
+	std::vector<u8> data;
+	int width = 0;
+	int height = 0;
+	if (renderer == nullptr || !renderer->GetLastFrame(data, width, height))
+	{
+		WARN_LOG(COMMON, "No frame to save to %s", path.c_str());
+		return false;
+	}
+	std::vector<u8> png;
+	stbi_flip_vertically_on_write(0);
+	stbi_write_png_to_func([](void *context, void *data, int size) {
+		std::vector<u8>& v = *(std::vector<u8> *)context;
+		v.insert(v.end(), (const u8 *)data, (const u8 *)data + size);
+	}, &png, width, height, 3, data.data(), 0);
+	FILE *f = nowide::fopen(path.c_str(), "wb");
+	if (f == nullptr)
+	{
+		ERROR_LOG(COMMON, "Can't create %s", path.c_str());
+		return false;
+	}
+	fwrite(png.data(), 1, png.size(), f);
+	fclose(f);
+	INFO_LOG(COMMON, "Last frame saved to %s", path.c_str());
+	return true;
+}
+
+static double toMs(std::chrono::steady_clock::duration d) {
+	return std::chrono::duration<double, std::milli>(d).count();
+}
+
+int run()
+{
+	if (settings.content.path.empty())
+	{
+		fprintf(stderr, "benchmark: no content specified\n");
+		return 1;
+	}
+	if (!params.inputScript.empty() && !loadInputScript(params.inputScript))
+		return 1;
+	settings.aica.muteAudio = true;
+
+	std::chrono::steady_clock::duration elapsed{};
+	u64 cycles = 0;
+	bool moviePlayed = false;
+	TlbMissCounter tlbMissCounter;
+	int64_t tlbMisses = -1;
+	try {
+		emu.loadGame(settings.content.path.c_str());
+		rend_init_renderer();
+		EventManager::listen(Event::VBlank, vblankCallback);
+		movie::start();
+		moviePlayed = movie::isPlaying();
+		emu.start();
+
+		for (auto& t : sectionTimes)
+			t = {};
+		frameTimes.clear();
+		yuvMacroBlocks = 0;
+		vmuLcdUploadedBytes = 0;
+		vblankCount = 0;
+		nextInputEvent = 0;
+		const u64 startCycles = sh4_sched_now64();
+		const auto startTime = std::chrono::steady_clock::now();
+		tlbMissCounter.start();
+
+		while (vblankCount < params.frames && emu.running())
+			emu.render();
+
+		tlbMisses = tlbMissCounter.stop();
+		elapsed = std::chrono::steady_clock::now() - startTime;
+		cycles = sh4_sched_now64() - startCycles;
+		EventManager::unlisten(Event::VBlank, vblankCallback);
+		if (!params.frameDump.empty())
+			dumpLastFrame(params.frameDump);
+		emu.unloadGame();
+		rend_term_renderer();
+	} catch (const FlycastException& e) {
+		EventManager::unlisten(Event::VBlank, vblankCallback);
+		fprintf(stderr, "benchmark: %s\n", e.what());
+		return 1;
+	}
+
+	const double seconds = std::chrono::duration<double>(elapsed).count();
+	const auto& aica = sectionTimes[(int)Section::Aica];
+	const auto& texDecode = sectionTimes[(int)Section::TexDecode];
+	// texture decoding happens during TA parsing
+	const auto taParse = std::max(sectionTimes[(int)Section::TaParse] - texDecode, std::chrono::steady_clock::duration{});
+	const auto& raster = sectionTimes[(int)Section::Raster];
+	const auto& elan = sectionTimes[(int)Section::Elan];
+	const auto& yuvConvert = sectionTimes[(int)Section::YuvConvert];
+	const auto sh4 = std::max(elapsed - aica - taParse - texDecode - raster - elan - yuvConvert,
+			std::chrono::steady_clock::duration{});
+
+	json result = {
+		{ "game", settings.content.gameId },
+		{ "frames", vblankCount },
+		{ "wall_time_ms", toMs(elapsed) },
+		{ "fps", seconds > 0 ? vblankCount / seconds : 0.0 },
+		// Emulated SH4 clock speed. 200 means real time.
+		{ "guest_mhz", seconds > 0 ? cycles / seconds / 1000000.0 : 0.0 },
+		{ "sections_ms", {
+			{ "sh4", toMs(sh4) },
+			{ "aica", toMs(aica) },
+			{ "ta_parse", toMs(taParse) },
+			{ "texture_decode", toMs(texDecode) },
+			{ "rasterize", toMs(raster) },
+			{ "elan", toMs(elan) },
+			{ "yuv_convert", toMs(yuvConvert) },
+		} },
+	};
+	if (!frameTimes.empty())
+	{
+		std::sort(frameTimes.begin(), frameTimes.end());
+		result["render_frames"] = frameTimes.size();
+		result["render_frame_ms"] = {
+			{ "avg", toMs(raster) / frameTimes.size() },
+			{ "p95", toMs(frameTimes[(frameTimes.size() - 1) * 95 / 100]) },
+			{ "max", toMs(frameTimes.back()) },
+		};
+	}
+	if (yuvMacroBlocks != 0)
+	{
+		const double yuvSeconds = std::chrono::duration<double>(yuvConvert).count();
+		result["yuv_macroblocks"] = yuvMacroBlocks;
+		result["yuv_macroblocks_per_s"] = yuvSeconds > 0 ? yuvMacroBlocks / yuvSeconds : 0.0;
+	}
+	if (const u64 vmuBytes = vmuLcdUploadedBytes; vmuBytes != 0)
+		result["vmu_lcd_upload_bytes"] = vmuBytes;
+	if (tlbMisses >= 0)
+	{
+		result["dtlb_load_misses"] = tlbMisses;
+		result["dtlb_load_misses_per_frame"] = vblankCount > 0 ? (double)tlbMisses / vblankCount : 0.0;
+	}
+	result["huge_pages"] = (bool)config::HugePages;
+	if (moviePlayed)
+		result["movie_divergence"] = movie::getDivergence();
+	std::string out = result.dump(4);
+	if (params.output.empty())
+	{
+		printf("%s\n", out.c_str());
+	}
+	else
+	{
+		FILE *f = nowide::fopen(params.output.c_str(), "w");
+		if (f == nullptr)
+		{
+			fprintf(stderr, "benchmark: can't create %s\n", params.output.c_str());
+			return 1;
+		}
+		fprintf(f, "%s\n", out.c_str());
+		fclose(f);
+	}
+
+	return vblankCount >= params.frames ? 0 : 1;
+}
+
+}
@@ -0,0 +1,90 @@
+/*
+	Copyright 2026 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include "types.h"
+#include <chrono>
+#include <string>
+
+//
+// Headless benchmark mode.
+// Runs a fixed number of emulated frames with no renderer (or the software renderer), no audio output
+// and no frame limiting, optionally replaying an input script, then prints throughput statistics as JSON.
+//
+namespace benchmark
+{
+
+enum class Section {
+	Aica,		// ARM7 and AICA sound generation
+	TaParse,	// TA display list parsing
+	TexDecode,	// Texture decoding
+	Raster,		// Software rendering
+	Elan,		// Naomi 2 Elan vertex processing
+	YuvConvert,	// TA YUV converter
+	Count
+};
+
+struct Params
+{
+	u32 frames = 0;				// number of emulated frames (vblanks) to run
+	int stateSlot = -1;			// savestate slot to load, or -1
+	std::string inputScript;	// input script to replay
+	std::string output;			// output file. Results are printed to stdout if empty
+	bool softRenderer = false;	// render frames with the software renderer
+	std::string frameDump;		// PNG file where the last rendered frame is saved
+};
+extern Params params;
+
+// true when running a benchmark. Section timers are disabled otherwise.
+extern bool enabled;
+
+static inline bool active() {
+	return enabled;
+}
+
+void addTime(Section section, std::chrono::steady_clock::duration duration);
+// Called by the software renderer for each rendered frame
+void frameRendered(std::chrono::steady_clock::duration duration);
+// Called by the YUV converter
+void yuvConverted(u32 macroBlocks);
+
+class ScopedTimer
+{
+public:
+	ScopedTimer(Section section) : section(section) {
+		if (enabled)
+			start = std::chrono::steady_clock::now();
+	}
+	~ScopedTimer() {
+		if (enabled)
+			addTime(section, std::chrono::steady_clock::now() - start);
+	}
+
+private:
+	Section section;
+	std::chrono::steady_clock::time_point start;
+};
+
+// Parse the benchmark command line options. Returns the number of arguments consumed.
+int parseArgs(char *arg[], int cl);
+
+// Run the benchmark on the content set on the command line.
+// Returns the process exit code.
+int run();
+
+}
@@ -3,31 +3,88 @@
 #include "cfg/option.h"
 #include "imgui.h"
 #include "implot.h"
+#include "json.hpp"
 #include <cassert>
+#include <cstdio>
+
+using namespace nlohmann;
 
 namespace fc_profiler
 {
 	thread_local ProfileThread* ProfileScope::s_thread = nullptr;
 	std::vector<ProfileThread*> ProfileThread::s_allThreads;
 	std::recursive_mutex ProfileThread::s_allThreadsLock;
+	std::atomic<bool> ProfileThread::s_capturing { false };
+
+	static const u64 baseTicks = ticks();
+	static const std::chrono::steady_clock::time_point baseTime = std::chrono::steady_clock::now();
+	static std::vector<TraceEvent> captured[64];
+	static u64 captureStart;
 
-	void startThread(const std::string& threadName)
+	static double ticksPerSecond()
+	{
+#if defined(__aarch64__) && !defined(_MSC_VER)
+		u64 freq;
+		asm volatile("mrs %0, cntfrq_el0" : "=r"(freq));
+		return (double)freq;
+#elif defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+		// Calibrate the TSC against the steady clock. Accuracy improves as time goes by.
+		// Called by all profiled threads.
+		static std::atomic<double> cachedFreq { 0.0 };
+		const double cached = cachedFreq.load(std::memory_order_relaxed);
+		if (cached != 0.0)
+			return cached;
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - baseTime).count();
+		double freq = (ticks() - baseTicks) / std::max(seconds, 1e-6);
+		if (seconds >= 1.0)
+			cachedFreq.store(freq, std::memory_order_relaxed);
+		return freq;
+#else
+		return (double)std::chrono::steady_clock::period::den / std::chrono::steady_clock::period::num;
+#endif
+	}
+
+	double ticksToSeconds(u64 ticks) {
+		return ticks / ticksPerSecond();
+	}
+
+	static void drainTraces();
+
+	// Real-time threads only try to lock and skip the update if the lock is busy
+	static bool lockThreads(std::unique_lock<std::recursive_mutex>& lock, bool realtime)
+	{
+		if (realtime)
+			return lock.try_lock();
+		lock.lock();
+		return true;
+	}
+
+	void startThread(const std::string& threadName, bool realtime)
 	{
 		if (config::ProfilerEnabled)
 		{
-			if (!ProfileScope::s_thread)
+			if (!ProfileScope::s_thread || ProfileScope::s_thread->threadName != threadName)
 			{
-				std::unique_lock<std::recursive_mutex> lock(ProfileThread::s_allThreadsLock);
-				ProfileScope::s_thread = new ProfileThread();
-				ProfileThread::s_allThreads.push_back(ProfileScope::s_thread);
+				std::unique_lock<std::recursive_mutex> lock(ProfileThread::s_allThreadsLock, std::defer_lock);
+				if (lockThreads(lock, realtime))
+				{
+					if (!ProfileScope::s_thread)
+					{
+						ProfileScope::s_thread = new ProfileThread();
+						ProfileThread::s_allThreads.push_back(ProfileScope::s_thread);
+					}
+					ProfileScope::s_thread->threadName = threadName;
+					ProfileScope::s_thread->realtime = realtime;
+				}
+				else if (!ProfileScope::s_thread) {
+					return;
+				}
 			}
 
 			ProfileThread& profileThread = *ProfileScope::s_thread;
-			profileThread.scopes.clear();
-			profileThread.scopes.reserve(FC_PROFILE_SCOPE_RESERVE_SIZE);
+			profileThread.scopeCount = 0;
 			profileThread.level = 0;
-			profileThread.startTicks = std::chrono::high_resolution_clock::now();
-			profileThread.threadName = threadName;
+			profileThread.startTicks = ticks();
 		}
 	}
 
@@ -35,17 +92,28 @@ namespace fc_profiler
 	{
 		if (config::ProfilerEnabled)
 		{
-			std::unique_lock<std::recursive_mutex> lock(ProfileThread::s_allThreadsLock);
-
 			if (!ProfileScope::s_thread)
 				return;
 			ProfileThread& profileThread = *ProfileScope::s_thread;
 
-			std::chrono::high_resolution_clock::time_point endTicks = std::chrono::high_resolution_clock::now();
-			std::chrono::microseconds durationMicro = std::chrono::duration_cast<std::chrono::microseconds>(endTicks - profileThread.startTicks);
-			profileThread.cachedTime = (double)durationMicro.count() / 1000000;
+			const u64 endTicks = ticks();
+			if (ProfileThread::s_capturing)
+			{
+				profileThread.traceEvent({ "Frame", profileThread.startTicks, endTicks, 0.0, TraceEvent::Slice });
+				profileThread.traceEvent({ "Frame time (ms)", endTicks, endTicks,
+					ticksToSeconds(endTicks - profileThread.startTicks) * 1000.0, TraceEvent::Counter });
+			}
+			std::unique_lock<std::recursive_mutex> lock(ProfileThread::s_allThreadsLock, std::defer_lock);
+			if (!lockThreads(lock, profileThread.realtime))
+				return;
+
+			profileThread.endTicks = endTicks;
+			profileThread.cachedTime = ticksToSeconds(profileThread.endTicks - profileThread.startTicks);
+			// Other threads drain the rings of the real-time threads
+			if (ProfileThread::s_capturing && !profileThread.realtime)
+				drainTraces();
 
-			if (profileThread.scopes.size() > 0)
+			if (profileThread.scopeCount > 0)
 			{
 				profileThread.cachedResultTree.clear();
 				profileThread.cachedResultTree.resize(1);
@@ -54,8 +122,9 @@ namespace fc_profiler
 
 				u32 currScope = 0;
 
-				for (const ProfileSection& section : profileThread.scopes)
+				for (u32 i = 0; i < profileThread.scopeCount; i++)
 				{
+					const ProfileSection& section = profileThread.scopes[i];
 					if (section.scope == currScope)
 					{
 						parent->children.push_back(ProfileThread::ResultNode());
@@ -109,8 +178,7 @@ namespace fc_profiler
 		{
 			if (node.section.function)
 			{
-				std::chrono::microseconds scopeTimeMicro = std::chrono::duration_cast<std::chrono::microseconds>(node.section.end - node.section.start);
-				double scopeTimeS = (double)scopeTimeMicro.count() / 1000000;
+				double scopeTimeS = ticksToSeconds(node.section.end - node.section.start);
 				char text[256];
 				std::snprintf(text, 256, "%.3f : %s (%s, %i)", (float)scopeTimeS, node.section.function, node.section.file, node.section.line);
 				ImGui::TreeNode(text);
@@ -128,8 +196,7 @@ namespace fc_profiler
 
 		for (const ProfileThread::ResultNode& node : results)
 		{
-			std::chrono::microseconds scopeTimeMicro = std::chrono::duration_cast<std::chrono::microseconds>(node.section.end - node.section.start);
-			double scopeTimeS = (double)scopeTimeMicro.count() / 1000000;
+			double scopeTimeS = ticksToSeconds(node.section.end - node.section.start);
 			WARN_LOG(PROFILER, "%.4f %*s%s (%s, %i)", scopeTimeS, node.section.scope, "", node.section.function, node.section.file, node.section.line);
 			outputTTY(node.children);
 		}
@@ -158,4 +225,112 @@ namespace fc_profiler
 			ImPlot::EndPlot();
 		}
 	}
+
+	// Move the pending events of each thread to the capture buffers. Must be called with s_allThreadsLock held.
+	static void drainTraces()
+	{
+		TraceEvent events[256];
+		for (size_t i = 0; i < ProfileThread::s_allThreads.size() && i < std::size(captured); i++)
+		{
+			TraceRing *ring = ProfileThread::s_allThreads[i]->trace.load(std::memory_order_relaxed);
+			if (ring == nullptr)
+				continue;
+			size_t n;
+			while ((n = ring->pop(events, std::size(events))) != 0)
+				captured[i].insert(captured[i].end(), events, events + n);
+		}
+	}
+
+	void startCapture()
+	{
+		std::unique_lock<std::recursive_mutex> lock(ProfileThread::s_allThreadsLock);
+		// Threads that start after this point aren't traced until the next capture
+		for (ProfileThread *thread : ProfileThread::s_allThreads)
+		{
+			TraceRing *ring = thread->trace.load(std::memory_order_relaxed);
+			if (ring == nullptr)
+				thread->trace.store(new TraceRing(), std::memory_order_release);
+			else
+				ring->clear();
+			thread->droppedEvents = 0;
+		}
+		for (auto& events : captured)
+			events.clear();
+		// Traces are drained by the profiled threads at the end of their frame, so avoid reallocating there
+		for (size_t i = 0; i < ProfileThread::s_allThreads.size() && i < std::size(captured); i++)
+			captured[i].reserve(FC_PROFILE_CAPTURE_RESERVE);
+		captureStart = ticks();
+		ProfileThread::s_capturing = true;
+		INFO_LOG(PROFILER, "Trace capture started");
+	}
+
+	static double toMicros(u64 t) {
+		return ticksToSeconds(t - captureStart) * 1000000.0;
+	}
+
+	bool stopCapture(const std::string& path)
+	{
+		std::unique_lock<std::recursive_mutex> lock(ProfileThread::s_allThreadsLock);
+		if (!ProfileThread::s_capturing)
+			return false;
+		ProfileThread::s_capturing = false;
+		drainTraces();
+
+		json events = json::array();
+		for (size_t i = 0; i < ProfileThread::s_allThreads.size() && i < std::size(captured); i++)
+		{
+			const ProfileThread& thread = *ProfileThread::s_allThreads[i];
+			events.push_back({
+				{ "name", "thread_name" },
+				{ "ph", "M" },
+				{ "pid", 1 },
+				{ "tid", i },
+				{ "args", { { "name", thread.threadName } } },
+			});
+			if (thread.droppedEvents != 0)
+				WARN_LOG(PROFILER, "Thread %s: %d trace events dropped", thread.threadName.c_str(), thread.droppedEvents.load());
+			for (const TraceEvent& event : captured[i])
+			{
+				if (event.start < captureStart)
+					continue;
+				json e = {
+					{ "name", event.name },
+					{ "pid", 1 },
+					{ "tid", i },
+					{ "ts", toMicros(event.start) },
+				};
+				if (event.type == TraceEvent::Counter)
+				{
+					e["ph"] = "C";
+					e["args"] = { { "value", event.value } };
+				}
+				else
+				{
+					e["ph"] = "X";
+					e["dur"] = ticksToSeconds(event.end - event.start) * 1000000.0;
+					if (event.value != 0.0)
+						e["args"] = { { "arg", event.value } };
+				}
+				events.push_back(std::move(e));
+			}
+			captured[i].clear();
+		}
+		json trace = {
+			{ "traceEvents", events },
+			{ "displayTimeUnit", "ms" },
+		};
+
+		FILE *f = nowide::fopen(path.c_str(), "w");
+		if (f == nullptr)
+		{
+			ERROR_LOG(PROFILER, "Can't create trace file %s", path.c_str());
+			return false;
+		}
+		std::string s = trace.dump();
+		bool success = std::fwrite(s.data(), 1, s.size(), f) == s.size();
+		std::fclose(f);
+		INFO_LOG(PROFILER, "Trace saved to %s", path.c_str());
+
+		return success;
+	}
 }
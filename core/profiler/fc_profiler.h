@@ -3,11 +3,21 @@
 #if FC_PROFILER
 
 #include "types.h"
+#include "util/spsc_ring.h"
 #include <vector>
 #include <string>
 #include <chrono>
 #include <thread>
 #include <mutex>
+#include <atomic>
+#include <cstring>
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#endif
 
 #ifndef __PRETTY_FUNCTION__
 #ifdef _MSC_VER
@@ -17,11 +27,43 @@
 #endif
 #endif
 
-#define FC_PROFILE_SCOPE_RESERVE_SIZE 128
+#define FC_PROFILE_SCOPE_MAX_SIZE 256
 #define FC_PROFILE_HISTORY_MAX_SIZE 512
+#define FC_PROFILE_TRACE_RING_SIZE 32768
+// Capture buffer capacity reserved for each thread, in events
+#define FC_PROFILE_CAPTURE_RESERVE (FC_PROFILE_TRACE_RING_SIZE * 4)
 
 namespace fc_profiler
 {
+	// Raw timestamp: TSC on x86, virtual counter on arm64
+	inline static u64 ticks()
+	{
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+		return __rdtsc();
+#elif defined(__aarch64__) && !defined(_MSC_VER)
+		u64 t;
+		asm volatile("mrs %0, cntvct_el0" : "=r"(t));
+		return t;
+#else
+		return std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+	}
+	double ticksToSeconds(u64 ticks);
+
+	// Trace capture event
+	struct TraceEvent
+	{
+		enum Type : u8 {
+			Slice,
+			Counter
+		};
+		const char* name;
+		u64 start;
+		u64 end;
+		double value;	// Counter value or slice argument
+		Type type;
+	};
+
 	struct ProfileSection
 	{
 		ProfileSection()
@@ -45,30 +87,41 @@ namespace fc_profiler
 		const char* file;
 		u32 line;
 		u32 scope;
-		std::chrono::high_resolution_clock::time_point start;
-		std::chrono::high_resolution_clock::time_point end;
+		u64 start = 0;
+		u64 end = 0;
 	};
 
+	using TraceRing = SpscRing<TraceEvent, FC_PROFILE_TRACE_RING_SIZE>;
+
 	struct ProfileThread
 	{
 		ProfileThread()
 		{
-			startTicks = std::chrono::high_resolution_clock::now();
+			startTicks = ticks();
+			endTicks = startTicks;
 			level = 0;
+			scopeCount = 0;
 			historyIdx = 0;
 			cachedTime = 0.0;
-			scopes.reserve(FC_PROFILE_SCOPE_RESERVE_SIZE);
 			memset(history, 0, sizeof(history));
 		}
 
-		std::vector<ProfileSection> scopes;
-		std::chrono::high_resolution_clock::time_point startTicks;
-		std::chrono::high_resolution_clock::time_point endTicks;
+		// Sections of the current frame. Sections beyond the first FC_PROFILE_SCOPE_MAX_SIZE are only traced.
+		ProfileSection scopes[FC_PROFILE_SCOPE_MAX_SIZE];
+		u32 scopeCount;
+		u64 startTicks;
+		u64 endTicks;
 		double history[FC_PROFILE_HISTORY_MAX_SIZE];
 		u32 level;
 		u32 historyIdx;
+		// Written by the owning thread, drained by the trace exporter.
+		// Allocated by the first trace capture and then kept until the thread ends.
+		std::atomic<TraceRing*> trace { nullptr };
+		std::atomic<u32> droppedEvents { 0 };
 		std::thread::id threadId;
 		std::string threadName;
+		// Real-time threads never wait for s_allThreadsLock and don't drain the trace rings
+		bool realtime = false;
 
 		struct ResultNode
 		{
@@ -82,19 +135,33 @@ namespace fc_profiler
 		std::vector<ResultNode> cachedResultTree;
 		static std::vector<ProfileThread*> s_allThreads;
 		static std::recursive_mutex s_allThreadsLock;
+		static std::atomic<bool> s_capturing;
+
+		void traceEvent(const TraceEvent& event)
+		{
+			TraceRing *ring = trace.load(std::memory_order_acquire);
+			if (ring != nullptr && !ring->push(event))
+				droppedEvents.fetch_add(1, std::memory_order_relaxed);
+		}
 	};
 
 	struct ProfileScope
 	{
 		ProfileScope(const char* function, const char* file, int line)
-			: sectionIdx(0)
+			: function(function)
 		{
 			if (s_thread)
 			{
-				ProfileSection section(function, file, line, s_thread->level++);
-				section.start = std::chrono::high_resolution_clock::now();
-				sectionIdx = s_thread->scopes.size();
-				s_thread->scopes.push_back(section);
+				start = ticks();
+				sectionIdx = s_thread->scopeCount;
+				if (sectionIdx < FC_PROFILE_SCOPE_MAX_SIZE)
+				{
+					ProfileSection& section = s_thread->scopes[sectionIdx];
+					section = ProfileSection(function, file, line, s_thread->level);
+					section.start = start;
+					s_thread->scopeCount++;
+				}
+				s_thread->level++;
 			}
 		}
 
@@ -102,20 +169,65 @@ namespace fc_profiler
 		{
 			if (s_thread)
 			{
-				s_thread->scopes[sectionIdx].end = std::chrono::high_resolution_clock::now();
+				const u64 end = ticks();
+				if (sectionIdx < FC_PROFILE_SCOPE_MAX_SIZE)
+					s_thread->scopes[sectionIdx].end = end;
 				s_thread->level--;
+				if (ProfileThread::s_capturing.load(std::memory_order_relaxed))
+					s_thread->traceEvent({ function, start, end, 0.0, TraceEvent::Slice });
 			}
 		}
 
-		size_t sectionIdx;
+		const char* function;
+		u64 start = 0;
+		u32 sectionIdx = 0;
 		static thread_local ProfileThread* s_thread;
 	};
 
-	void startThread(const std::string& threadName);
+	// Slice that is only recorded in trace captures, for code that runs too often to be shown per frame
+	struct TraceScope
+	{
+		TraceScope(const char* name, double arg = 0.0)
+			: name(name), arg(arg)
+		{
+			if (ProfileScope::s_thread && ProfileThread::s_capturing.load(std::memory_order_relaxed))
+				start = ticks();
+		}
+
+		~TraceScope()
+		{
+			if (start != 0 && ProfileScope::s_thread && ProfileThread::s_capturing.load(std::memory_order_relaxed))
+				ProfileScope::s_thread->traceEvent({ name, start, ticks(), arg, TraceEvent::Slice });
+		}
+
+		const char* name;
+		double arg;
+		u64 start = 0;
+	};
+
+	// Record a counter value in the trace capture
+	inline static void counter(const char* name, double value)
+	{
+		if (ProfileScope::s_thread && ProfileThread::s_capturing.load(std::memory_order_relaxed))
+		{
+			const u64 now = ticks();
+			ProfileScope::s_thread->traceEvent({ name, now, now, value, TraceEvent::Counter });
+		}
+	}
+
+	void startThread(const std::string& threadName, bool realtime = false);
 	void endThread(double warningTime = 0.0);
 	void drawGUI(const std::vector<ProfileThread::ResultNode>& results);
 	void drawGraph(const ProfileThread& profileThread);
 	void outputTTY(const std::vector<ProfileThread::ResultNode>& results);
+
+	// Trace capture of all profiled threads, exported in the Chrome trace event format,
+	// which can be loaded in chrome://tracing or https://ui.perfetto.dev
+	void startCapture();
+	bool stopCapture(const std::string& path);
+	static inline bool capturing() {
+		return ProfileThread::s_capturing;
+	}
 }
 
 #define FC_PROFILE_SCOPE \
@@ -124,15 +236,20 @@ namespace fc_profiler
 #define FC_PROFILE_SCOPE_NAMED(name) \
 	fc_profiler::ProfileScope __profile__scope(name, __FILE__, __LINE__);
 
+#define FC_PROFILE_TRACE_SCOPE(name, arg) \
+	fc_profiler::TraceScope __trace__scope(name, arg);
+
 #else
 
 namespace fc_profiler
 {
-	inline static void startThread(const std::string& threadName) {}
+	inline static void startThread(const std::string& threadName, bool realtime = false) {}
 	inline static void endThread(float warningTime = 0.0) {}
+	inline static void counter(const char* name, double value) {}
 }
 
 #define FC_PROFILE_SCOPE
 #define FC_PROFILE_SCOPE_NAMED(name)
+#define FC_PROFILE_TRACE_SCOPE(name, arg)
 
 #endif
@@ -0,0 +1,375 @@
+/*
+	Copyright 2026 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "metrics.h"
+#include "emulator.h"
+#include "network/net_platform.h"
+#include "util/periodic_thread.h"
+#include "json.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace nlohmann;
+
+namespace metrics
+{
+
+Counter framesPresented;
+Counter audioUnderruns;
+Counter textureCacheHits;
+Counter textureCacheMisses;
+Gauge textureCacheSize;
+Counter jitBlocksCompiled;
+Counter jitBlocksDiscarded;
+
+// Events that happen at most a few times per frame, possibly on different threads
+struct Timing
+{
+	void add(std::chrono::steady_clock::duration duration)
+	{
+		u64 us = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+		count.fetch_add(1, std::memory_order_relaxed);
+		sumUs.fetch_add(us, std::memory_order_relaxed);
+		lastUs.store(us, std::memory_order_relaxed);
+	}
+
+	std::atomic<u64> count {};
+	std::atomic<u64> sumUs {};
+	std::atomic<u64> lastUs {};
+};
+static std::atomic<u64> dreamlinkErrors {};
+static Timing dreamlinkRtt;
+static Timing savestateSave;
+static Timing savestateLoad;
+
+void dreamlinkError() {
+	dreamlinkErrors.fetch_add(1, std::memory_order_relaxed);
+}
+void dreamlinkRoundTrip(std::chrono::steady_clock::duration duration) {
+	dreamlinkRtt.add(duration);
+}
+void savestateSaved(std::chrono::steady_clock::duration duration) {
+	savestateSave.add(duration);
+}
+void savestateLoaded(std::chrono::steady_clock::duration duration) {
+	savestateLoad.add(duration);
+}
+
+// Frame statistics, sampled at each vblank by the emu thread
+constexpr double FrameTimeBuckets[] { 0.004, 0.008, 0.012, 0.0167, 0.02, 0.025, 0.0334, 0.05, 0.1 };
+static Counter frameTimeHistogram[std::size(FrameTimeBuckets) + 1];
+static std::atomic<double> frameTimeSum {};
+static Counter vblankCount;
+static Gauge emulatedFps;
+static Gauge hostFps;
+
+static std::chrono::steady_clock::time_point lastVblank;
+static std::chrono::steady_clock::time_point lastFpsUpdate;
+static u64 lastFpsVblanks;
+static u64 lastFpsFrames;
+
+static void vblankCallback(Event event, void *)
+{
+	const auto now = std::chrono::steady_clock::now();
+	if (lastVblank.time_since_epoch().count() != 0)
+	{
+		const double frameTime = std::chrono::duration<double>(now - lastVblank).count();
+		size_t bucket = std::upper_bound(std::begin(FrameTimeBuckets), std::end(FrameTimeBuckets), frameTime)
+				- std::begin(FrameTimeBuckets);
+		frameTimeHistogram[bucket].inc();
+		frameTimeSum.store(frameTimeSum.load(std::memory_order_relaxed) + frameTime, std::memory_order_relaxed);
+	}
+	else {
+		lastFpsUpdate = now;
+	}
+	lastVblank = now;
+	vblankCount.inc();
+
+	const double elapsed = std::chrono::duration<double>(now - lastFpsUpdate).count();
+	if (elapsed >= 1.0)
+	{
+		emulatedFps.set((vblankCount.get() - lastFpsVblanks) / elapsed);
+		hostFps.set((framesPresented.get() - lastFpsFrames) / elapsed);
+		lastFpsVblanks = vblankCount.get();
+		lastFpsFrames = framesPresented.get();
+		lastFpsUpdate = now;
+	}
+}
+
+static void emuEventCallback(Event event, void *)
+{
+	// Don't count the time spent paused as a frame
+	lastVblank = {};
+	emulatedFps.set(0.0);
+	hostFps.set(0.0);
+}
+
+static std::string prometheusText()
+{
+	std::string s;
+	char line[256];
+	auto add = [&](const char *name, const char *type, const char *help, double value) {
+		snprintf(line, sizeof(line), "# HELP %s %s\n# TYPE %s %s\n%s %.17g\n", name, help, name, type, name, value);
+		s += line;
+	};
+	s += "# HELP flycast_frame_time_seconds Host time between emulated vblanks\n"
+			"# TYPE flycast_frame_time_seconds histogram\n";
+	u64 cumulative = 0;
+	for (size_t i = 0; i < std::size(frameTimeHistogram); i++)
+	{
+		cumulative += frameTimeHistogram[i].get();
+		if (i < std::size(FrameTimeBuckets))
+			snprintf(line, sizeof(line), "flycast_frame_time_seconds_bucket{le=\"%g\"} %llu\n", FrameTimeBuckets[i], (unsigned long long)cumulative);
+		else
+			snprintf(line, sizeof(line), "flycast_frame_time_seconds_bucket{le=\"+Inf\"} %llu\n", (unsigned long long)cumulative);
+		s += line;
+	}
+	snprintf(line, sizeof(line), "flycast_frame_time_seconds_sum %.17g\nflycast_frame_time_seconds_count %llu\n",
+			frameTimeSum.load(std::memory_order_relaxed), (unsigned long long)cumulative);
+	s += line;
+
+	add("flycast_emulated_fps", "gauge", "Emulated frames (vblanks) per second", emulatedFps.get());
+	add("flycast_host_fps", "gauge", "Frames presented per second", hostFps.get());
+	add("flycast_vblanks_total", "counter", "Emulated vblanks", vblankCount.get());
+	add("flycast_frames_presented_total", "counter", "Frames presented", framesPresented.get());
+	add("flycast_audio_underruns_total", "counter", "Audio output underruns", audioUnderruns.get());
+	add("flycast_texture_cache_size", "gauge", "Textures in the texture cache", textureCacheSize.get());
+	add("flycast_texture_cache_hits_total", "counter", "Texture cache hits", textureCacheHits.get());
+	add("flycast_texture_cache_misses_total", "counter", "Texture cache misses", textureCacheMisses.get());
+	add("flycast_jit_blocks_compiled_total", "counter", "SH4 blocks compiled by the dynarec", jitBlocksCompiled.get());
+	add("flycast_jit_blocks_discarded_total", "counter", "SH4 blocks discarded by the dynarec", jitBlocksDiscarded.get());
+	add("flycast_dreamlink_errors_total", "counter", "DreamLink communication errors", dreamlinkErrors.load());
+
+	auto addTiming = [&](const char *name, const char *help, const Timing& timing) {
+		snprintf(line, sizeof(line), "# HELP %s %s\n# TYPE %s summary\n%s_sum %.6f\n%s_count %llu\n",
+				name, help, name, name, timing.sumUs / 1000000.0, name, (unsigned long long)timing.count.load());
+		s += line;
+	};
+	addTiming("flycast_dreamlink_round_trip_seconds", "DreamLink request/response round-trip time", dreamlinkRtt);
+	addTiming("flycast_savestate_save_seconds", "Time to save a savestate", savestateSave);
+	addTiming("flycast_savestate_load_seconds", "Time to load a savestate", savestateLoad);
+
+	return s;
+}
+
+static json jsonTiming(const Timing& timing)
+{
+	const u64 count = timing.count;
+	return {
+		{ "count", count },
+		{ "last_ms", timing.lastUs / 1000.0 },
+		{ "avg_ms", count != 0 ? timing.sumUs / 1000.0 / count : 0.0 },
+	};
+}
+
+static std::string jsonText()
+{
+	json buckets = json::array();
+	for (size_t i = 0; i < std::size(frameTimeHistogram); i++)
+		buckets.push_back({
+			{ "le", i < std::size(FrameTimeBuckets) ? json(FrameTimeBuckets[i]) : json("+Inf") },
+			{ "count", frameTimeHistogram[i].get() },
+		});
+	const u64 hits = textureCacheHits.get();
+	const u64 misses = textureCacheMisses.get();
+	json j = {
+		{ "frame_time_histogram", buckets },
+		{ "emulated_fps", emulatedFps.get() },
+		{ "host_fps", hostFps.get() },
+		{ "vblanks", vblankCount.get() },
+		{ "frames_presented", framesPresented.get() },
+		{ "audio_underruns", audioUnderruns.get() },
+		{ "texture_cache", {
+			{ "size", textureCacheSize.get() },
+			{ "hits", hits },
+			{ "misses", misses },
+			{ "hit_rate", hits + misses != 0 ? (double)hits / (hits + misses) : 0.0 },
+		} },
+		{ "jit", {
+			{ "blocks_compiled", jitBlocksCompiled.get() },
+			{ "blocks_discarded", jitBlocksDiscarded.get() },
+		} },
+		{ "dreamlink", {
+			{ "errors", dreamlinkErrors.load() },
+			{ "round_trip", jsonTiming(dreamlinkRtt) },
+		} },
+		{ "savestate", {
+			{ "save", jsonTiming(savestateSave) },
+			{ "load", jsonTiming(savestateLoad) },
+		} },
+	};
+	return j.dump();
+}
+
+//
+// Minimal HTTP server. Requests are polled by a background thread so that scraping never stalls emulation.
+//
+class Exporter
+{
+public:
+	Exporter() : thread("MetricsExporter", &Exporter::poll, this) {
+		thread.setPeriod(100);
+	}
+
+	bool start(int port)
+	{
+		server = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+		if (server == INVALID_SOCKET)
+		{
+			WARN_LOG(NETWORK, "Metrics: socket creation failed: errno %d", get_last_error());
+			return false;
+		}
+		int option = 1;
+		setsockopt(server, SOL_SOCKET, SO_REUSEADDR, (const char *)&option, sizeof(option));
+
+		sockaddr_in saddr{};
+		saddr.sin_family = AF_INET;
+		saddr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		saddr.sin_port = htons(port);
+		if (::bind(server, (sockaddr *)&saddr, sizeof(saddr)) < 0)
+		{
+			WARN_LOG(NETWORK, "Metrics: bind to port %d failed: errno %d", port, get_last_error());
+			stop();
+			return false;
+		}
+		if (listen(server, 5) < 0)
+		{
+			WARN_LOG(NETWORK, "Metrics: listen failed: errno %d", get_last_error());
+			stop();
+			return false;
+		}
+		set_non_blocking(server);
+		thread.start();
+		INFO_LOG(COMMON, "Metrics available at http://127.0.0.1:%d/metrics", port);
+
+		return true;
+	}
+
+	void stop()
+	{
+		thread.stop();
+		for (Client& client : clients)
+			closesocket(client.sock);
+		clients.clear();
+		if (server != INVALID_SOCKET) {
+			closesocket(server);
+			server = INVALID_SOCKET;
+		}
+	}
+
+private:
+	struct Client
+	{
+		sock_t sock;
+		std::chrono::steady_clock::time_point connectTime;
+		std::string request;
+	};
+
+	void poll()
+	{
+		sockaddr_in addr{};
+		socklen_t addrLen = sizeof(addr);
+		sock_t sock;
+		while ((sock = accept(server, (sockaddr *)&addr, &addrLen)) != INVALID_SOCKET)
+		{
+			set_non_blocking(sock);
+			Client& client = clients.emplace_back();
+			client.sock = sock;
+			client.connectTime = std::chrono::steady_clock::now();
+		}
+		const auto now = std::chrono::steady_clock::now();
+		clients.erase(std::remove_if(clients.begin(), clients.end(), [now](Client& client) {
+			if (!serve(client) && now - client.connectTime < std::chrono::seconds(5))
+				return false;
+			closesocket(client.sock);
+			return true;
+		}), clients.end());
+	}
+
+	// Returns true when the client has been served or the connection is closed
+	static bool serve(Client& client)
+	{
+		char buf[1024];
+		int len = recv(client.sock, buf, sizeof(buf), 0);
+		if (len == 0)
+			return true;
+		if (len < 0)
+		{
+			int error = get_last_error();
+			return error != L_EWOULDBLOCK && error != L_EAGAIN;
+		}
+		client.request.append(buf, len);
+		if (client.request.find("\r\n\r\n") == std::string::npos && client.request.size() < 8192)
+			return false;
+
+		std::string status = "200 OK";
+		std::string contentType;
+		std::string body;
+		if (client.request.rfind("GET /metrics.json ", 0) == 0)
+		{
+			contentType = "application/json";
+			body = jsonText();
+		}
+		else if (client.request.rfind("GET /metrics ", 0) == 0 || client.request.rfind("GET / ", 0) == 0)
+		{
+			contentType = "text/plain; version=0.0.4";
+			body = prometheusText();
+		}
+		else
+		{
+			status = "404 Not Found";
+			contentType = "text/plain";
+			body = "Not found\n";
+		}
+		std::string response = "HTTP/1.0 " + status + "\r\nContent-Type: " + contentType
+				+ "\r\nContent-Length: " + std::to_string(body.size())
+				+ "\r\nConnection: close\r\n\r\n" + body;
+		// The socket is non-blocking but responses fit easily in the send buffer
+		::send(client.sock, response.data(), response.size(), 0);
+
+		return true;
+	}
+
+	PeriodicThread thread;
+	sock_t server = INVALID_SOCKET;
+	std::vector<Client> clients;
+};
+
+static Exporter exporter;
+
+void init(int port)
+{
+	if (!exporter.start(port))
+		return;
+	EventManager::listen(Event::VBlank, vblankCallback);
+	EventManager::listen(Event::Pause, emuEventCallback);
+	EventManager::listen(Event::Terminate, emuEventCallback);
+}
+
+void term()
+{
+	EventManager::unlisten(Event::VBlank, vblankCallback);
+	EventManager::unlisten(Event::Pause, emuEventCallback);
+	EventManager::unlisten(Event::Terminate, emuEventCallback);
+	exporter.stop();
+}
+
+}
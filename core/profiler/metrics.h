@@ -0,0 +1,79 @@
+/*
+	Copyright 2026 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include "types.h"
+#include <atomic>
+#include <chrono>
+
+//
+// Health metrics exported on a localhost HTTP port, in Prometheus text format (/metrics) or JSON (/metrics.json).
+// Counters are updated without locks by the emulator, frame statistics are sampled once per vblank,
+// and the exporter thread only reads them.
+//
+namespace metrics
+{
+
+// Monotonic counter. Can be updated from any thread.
+class Counter
+{
+public:
+	void inc(u64 n = 1) {
+		value.fetch_add(n, std::memory_order_relaxed);
+	}
+	u64 get() const {
+		return value.load(std::memory_order_relaxed);
+	}
+
+private:
+	std::atomic<u64> value {};
+};
+
+class Gauge
+{
+public:
+	void set(double v) {
+		value.store(v, std::memory_order_relaxed);
+	}
+	double get() const {
+		return value.load(std::memory_order_relaxed);
+	}
+
+private:
+	std::atomic<double> value {};
+};
+
+extern Counter framesPresented;
+extern Counter audioUnderruns;
+extern Counter textureCacheHits;
+extern Counter textureCacheMisses;
+extern Gauge textureCacheSize;
+extern Counter jitBlocksCompiled;
+extern Counter jitBlocksDiscarded;
+
+// These can be called from any thread
+void dreamlinkError();
+void dreamlinkRoundTrip(std::chrono::steady_clock::duration duration);
+void savestateSaved(std::chrono::steady_clock::duration duration);
+void savestateLoaded(std::chrono::steady_clock::duration duration);
+
+// Start the exporter on the given localhost port
+void init(int port);
+void term();
+
+}
@@ -23,7 +23,7 @@
 #include "cfg/option.h"
 #include "oslib/oslib.h"
 #include "stdclass.h"
-#include "util/worker_thread.h"
+#include "util/task_pool.h"
 
 #include <sstream>
 #define STB_IMAGE_IMPLEMENTATION
@@ -89,7 +89,7 @@ bool CustomTexture::init()
 					{
 						NOTICE_LOG(RENDERER, "Found custom textures directory: %s", textures_path.c_str());
 						custom_textures_available = true;
-						loaderThread = std::make_unique<WorkerThread>("CustomTexLoader");
+						loaderThread = std::make_unique<TaskQueue>("CustomTexLoader");
 						loaderThread->run([this]() {
 							loadMap();
 						});
@@ -23,7 +23,7 @@
 #include <memory>
 
 class BaseTextureCacheData;
-class WorkerThread;
+class TaskQueue;
 
 class CustomTexture
 {
@@ -44,7 +44,7 @@ private:
 	bool custom_textures_available = false;
 	std::string textures_path;
 	std::map<u32, std::string> texture_map;
-	std::unique_ptr<WorkerThread> loaderThread;
+	std::unique_ptr<TaskQueue> loaderThread;
 };
 
 extern CustomTexture custom_texture;
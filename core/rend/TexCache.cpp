@@ -18,13 +18,13 @@
 #include "deps/xbrz/xbrz.h"
 #include "hw/pvr/pvr_mem.h"
 #include "hw/mem/addrspace.h"
+#include "profiler/benchmark.h"
+#include "util/task_pool.h"
+#include "fb_convert.h"
 
 #include <mutex>
 #include <xxhash.h>
 
-#ifdef _OPENMP
-#include <omp.h>
-#endif
 
 extern bool pal_needs_update;
 
@@ -122,43 +122,14 @@ static void libCore_vramlock_Unlock_block_wb(vram_block* block)
 	delete block;
 }
 
-#ifdef _OPENMP
-static inline int getThreadCount()
-{
-	int tcount = omp_get_num_procs() - 1;
-	if (tcount < 1)
-		tcount = 1;
-	return std::min(tcount, (int)config::MaxThreads);
-}
-
-template<typename Func>
-void parallelize(Func func, int start, int end)
-{
-	int tcount = getThreadCount();
-#pragma omp parallel num_threads(tcount)
-	{
-		int num_threads = omp_get_num_threads();
-		int thread = omp_get_thread_num();
-		int chunk = (end - start) / num_threads;
-		func(start + chunk * thread,
-				num_threads == thread + 1 ? end
-						: (start + chunk * (thread + 1)));
-	}
-}
-#endif
-
 static struct xbrz::ScalerCfg xbrz_cfg;
 
 void UpscalexBRZ(int factor, u32* source, u32* dest, int width, int height, bool has_alpha)
 {
-#ifdef _OPENMP
-	parallelize([=](int start, int end) {
+	TaskPool::instance().parallelFor(0, height, [=](int start, int end) {
 		xbrz::scale(factor, source, dest, width, height, has_alpha ? xbrz::ColorFormat::ARGB : xbrz::ColorFormat::RGB,
 				xbrz_cfg, start, end);
-	}, 0, height);
-#else
-	xbrz::scale(factor, source, dest, width, height, has_alpha ? xbrz::ColorFormat::ARGB : xbrz::ColorFormat::RGB, xbrz_cfg);
-#endif
+	}, config::MaxThreads);
 }
 
 extern const u32 VQMipPoint[11] =
@@ -428,6 +399,7 @@ void BaseTextureCacheData::ComputeHash()
 
 bool BaseTextureCacheData::Update()
 {
+	benchmark::ScopedTimer _(benchmark::Section::TexDecode);
 	//texture state tracking stuff
 	Updates++;
 	dirty = 0;
@@ -695,6 +667,9 @@ void BaseTextureCacheData::SetDirectXColorOrder(bool enabled) {
 	pal_needs_update = true;
 }
 
+// Framebuffer conversions are split by lines on the task pool above this size
+constexpr u32 ParallelConvertMinPixels = 640 * 240;
+
 template<typename Packer>
 void ReadFramebuffer(const FramebufferInfo& info, PixelBuffer<u32>& pb, int& width, int& height)
 {
@@ -744,407 +719,75 @@ void ReadFramebuffer(const FramebufferInfo& info, PixelBuffer<u32>& pb, int& wid
 	u32 *dst = (u32 *)pb.data();
 	const u32 fb_concat = info.fb_r_ctrl.fb_concat;
 
+	// Pixels are read from aligned addresses
+	u32 align;
+	u32 lineBytes;
 	switch (info.fb_r_ctrl.fb_depth)
 	{
-		case fbde_0555:    // 555 RGB
-			for (int y = 0; y < height; y++)
-			{
-				for (int i = 0; i < width; i++)
-				{
-					u16 src = pvr_read32p<u16>(addr);
-					*dst++ = Packer::pack(
-							(((src >> 10) & 0x1F) << 3) | fb_concat,
-							(((src >> 5) & 0x1F) << 3) | fb_concat,
-							(((src >> 0) & 0x1F) << 3) | fb_concat,
-							0xff);
-					addr += bpp;
-				}
-				addr += modulus * bpp;
-			}
-			break;
-
-		case fbde_565:    // 565 RGB
-			for (int y = 0; y < height; y++)
-			{
-				for (int i = 0; i < width; i++)
-				{
-					u16 src = pvr_read32p<u16>(addr);
-					*dst++ = Packer::pack(
-							(((src >> 11) & 0x1F) << 3) | fb_concat,
-							(((src >> 5) & 0x3F) << 2) | (fb_concat & 3),
-							(((src >> 0) & 0x1F) << 3) | fb_concat,
-							0xFF);
-					addr += bpp;
-				}
-				addr += modulus * bpp;
-			}
+		case fbde_888:
+			align = 4;
+			lineBytes = (width * 3 + 3) & ~3;
 			break;
-		case fbde_888:		// 888 RGB
-			for (int y = 0; y < height; y++)
-			{
-				for (int i = 0; i < width; i += 4)
-				{
-					u32 src = pvr_read32p<u32>(addr);
-					*dst++ = Packer::pack(src >> 16, src >> 8, src, 0xff);
-					addr += 4;
-					if (i + 1 >= width)
-						break;
-					u32 src2 = pvr_read32p<u32>(addr);
-					*dst++ = Packer::pack(src2 >> 8, src2, src >> 24, 0xff);
-					addr += 4;
-					if (i + 2 >= width)
-						break;
-					u32 src3 = pvr_read32p<u32>(addr);
-					*dst++ = Packer::pack(src3, src2 >> 24, src2 >> 16, 0xff);
-					addr += 4;
-					if (i + 3 >= width)
-						break;
-					*dst++ = Packer::pack(src3 >> 24, src3 >> 16, src3 >> 8, 0xff);
-				}
-				addr += modulus * bpp;
-			}
+		case fbde_C888:
+			align = 4;
+			lineBytes = width * 4;
 			break;
-		case fbde_C888:     // 0888 RGB
-			for (int y = 0; y < height; y++)
-			{
-				for (int i = 0; i < width; i++)
-				{
-					u32 src = pvr_read32p<u32>(addr);
-					*dst++ = Packer::pack(src >> 16, src >> 8, src, 0xff);
-					addr += bpp;
-				}
-				addr += modulus * bpp;
-			}
+		default:
+			align = 2;
+			lineBytes = width * 2;
 			break;
 	}
-}
-template void ReadFramebuffer<RGBAPacker>(const FramebufferInfo& info, PixelBuffer<u32>& pb, int& width, int& height);
-template void ReadFramebuffer<BGRAPacker>(const FramebufferInfo& info, PixelBuffer<u32>& pb, int& width, int& height);
-
-template<int bits>
-static inline u8 roundColor(u8 in)
-{
-	u8 out = in >> (8 - bits);
-	if (out != 0xffu >> (8 - bits))
-		out += (in >> (8 - bits - 1)) & 1;
-	return out;
-}
-
-// write to 32-bit vram area (framebuffer)
-class FBPixelWriter
-{
-public:
-	FBPixelWriter(u32 dstAddr) : dstAddr(dstAddr) {}
-
-	template<typename T>
-	void write(T pixel) {
-		pvr_write32p<T, true>(dstAddr, pixel);
-		dstAddr += sizeof(T);
-	}
-
-	void advance(int bytes) {
-		dstAddr += bytes;
-	}
-
-private:
-	u32 dstAddr;
-};
-
-// write to 64-bit vram area (render to texture)
-class TexPixelWriter
-{
-public:
-	TexPixelWriter(u16 *dest) : dest(dest) {}
-
-	void write(u16 pixel) {
-		*dest++ = pixel;
-	}
-
-	void advance(int bytes) {
-		(u8 *&)dest += bytes;
-	}
-
-private:
-	u16 *dest;
-};
-
-// 0555 KRGB 16 bit  (default)	Bit 15 is the value of fb_kval[7].
-template<int Red, int Green, int Blue, int Alpha, typename PixelWriter, bool Round = false>
-class FBLineWriter0555
-{
-public:
-	FBLineWriter0555(FB_W_CTRL_type fb_w_ctrl, PixelWriter& pixWriter) : pixWriter(pixWriter) {
-		kval_bit = (fb_w_ctrl.fb_kval & 0x80) << 8;
-	}
-
-	void write(int xmin, int xmax, const u8 *& pixel, int y)
-	{
-		for (int c = xmin; c < xmax; c++)
-		{
-			u8 red, green, blue;
-			if constexpr (Round)
-			{
-				red = roundColor<5>(pixel[Red]);
-				green = roundColor<5>(pixel[Green]);
-				blue = roundColor<5>(pixel[Blue]);
-			}
-			else
-			{
-				red = pixel[Red] >> 3;
-				green = pixel[Green] >> 3;
-				blue = pixel[Blue] >> 3;
-			}
-			pixWriter.write((u16)((red << 10) | (green << 5) | blue | kval_bit));
-			pixel += 4;
-		}
-	}
-
-	static constexpr int BytesPerPixel = 2;
-
-private:
-	u16 kval_bit;
-	PixelWriter& pixWriter;
-};
-
-// 565 RGB 16 bit
-template<int Red, int Green, int Blue, int Alpha, typename PixelWriter, bool Round = false>
-class FBLineWriter565
-{
-public:
-	FBLineWriter565(FB_W_CTRL_type fb_w_ctrl, PixelWriter& pixWriter) : pixWriter(pixWriter) {}
-
-	void write(int xmin, int xmax, const u8 *& pixel, int y)
-	{
-		for (int c = xmin; c < xmax; c++)
-		{
-			u8 red, green, blue;
-			if constexpr (Round)
-			{
-				red = roundColor<5>(pixel[Red]);
-				green = roundColor<6>(pixel[Green]);
-				blue = roundColor<5>(pixel[Blue]);
-			}
-			else
-			{
-				red = pixel[Red] >> 3;
-				green = pixel[Green] >> 2;
-				blue = pixel[Blue] >> 3;
-			}
-			pixWriter.write((u16)((red << 11) | (green << 5) | blue));
-			pixel += 4;
-		}
-	}
-
-	static constexpr int BytesPerPixel = 2;
-
-private:
-	PixelWriter& pixWriter;
-};
-
-// 4444 ARGB 16 bit
-template<int Red, int Green, int Blue, int Alpha, typename PixelWriter, bool Round = false>
-class FBLineWriter4444
-{
-public:
-	FBLineWriter4444(FB_W_CTRL_type fb_w_ctrl, PixelWriter& pixWriter) : pixWriter(pixWriter) {}
-
-	void write(int xmin, int xmax, const u8 *& pixel, int y)
-	{
-		for (int c = xmin; c < xmax; c++)
-		{
-			u8 red, green, blue, alpha;
-			if constexpr (Round)
-			{
-				red = roundColor<4>(pixel[Red]);
-				green = roundColor<4>(pixel[Green]);
-				blue = roundColor<4>(pixel[Blue]);
-				alpha = roundColor<4>(pixel[Alpha]);
-			}
-			else
-			{
-				red = pixel[Red] >> 4;
-				green = pixel[Green] >> 4;
-				blue = pixel[Blue] >> 4;
-				alpha = pixel[Alpha] >> 4;
-			}
-			pixWriter.write((u16)((red << 8) | (green << 4) | blue | (alpha << 12)));
-			pixel += 4;
-		}
-	}
-
-	static constexpr int BytesPerPixel = 2;
-
-private:
-	PixelWriter& pixWriter;
-};
-
-// 1555 ARGB 16 bit    The alpha value is determined by comparison with the value of fb_alpha_threshold.
-template<int Red, int Green, int Blue, int Alpha, typename PixelWriter, bool Round = false>
-class FBLineWriter1555
-{
-public:
-	FBLineWriter1555(FB_W_CTRL_type fb_w_ctrl, PixelWriter& pixWriter) : pixWriter(pixWriter) {
-		fb_alpha_threshold = fb_w_ctrl.fb_alpha_threshold;
-	}
+	const u32 lineAdvance = lineBytes + modulus * bpp;
 
-	void write(int xmin, int xmax, const u8 *& pixel, int y)
-	{
-		for (int c = xmin; c < xmax; c++)
+	const auto& readLines = [&](int start, int end) {
+		std::vector<u8> line(lineBytes);
+		for (int y = start; y < end; y++)
 		{
-			u8 red, green, blue;
-			if constexpr (Round)
-			{
-				red = roundColor<5>(pixel[Red]);
-				green = roundColor<5>(pixel[Green]);
-				blue = roundColor<5>(pixel[Blue]);
-			}
-			else
-			{
-				red = pixel[Red] >> 3;
-				green = pixel[Green] >> 3;
-				blue = pixel[Blue] >> 3;
-			}
-			pixWriter.write((u16)((red << 10) | (green << 5) | blue
-					| (pixel[Alpha] >= fb_alpha_threshold ? 0x8000 : 0)));
-			pixel += 4;
+			pvr_read32_block((addr + y * lineAdvance) & ~(align - 1), line.data(), lineBytes);
+			fbconv::unpack<Packer>(line.data(), dst + y * width, width, info.fb_r_ctrl.fb_depth, fb_concat);
 		}
-	}
-
-	static constexpr int BytesPerPixel = 2;
-
-private:
-	PixelWriter& pixWriter;
-	u8 fb_alpha_threshold;
-};
-
-// 888 RGB 24 bit packed
-template<int Red, int Green, int Blue, int Alpha, typename PixelWriter>
-class FBLineWriter888
-{
-public:
-	FBLineWriter888(FB_W_CTRL_type fb_w_ctrl, PixelWriter& pixWriter) : pixWriter(pixWriter) {}
-
-	void write(int xmin, int xmax, const u8 *& pixel, int y)
-	{
-		for (int c = xmin; c < xmax; c++)
-		{
-			pixWriter.write(pixel[Blue]);
-			pixWriter.write(pixel[Green]);
-			pixWriter.write(pixel[Red]);
-			pixel += 4;
-		}
-	}
-
-	static constexpr int BytesPerPixel = 3;
-
-private:
-	PixelWriter& pixWriter;
-};
-
-// 0888 KRGB 32 bit (K is the value of fb_kval.)
-template<int Red, int Green, int Blue, int Alpha, typename PixelWriter>
-class FBLineWriter0888
-{
-public:
-	FBLineWriter0888(FB_W_CTRL_type fb_w_ctrl, PixelWriter& pixWriter) : pixWriter(pixWriter) {
-		fb_kval = fb_w_ctrl.fb_kval << 24;
-	}
-
-	void write(int xmin, int xmax, const u8 *& pixel, int y)
-	{
-		for (int c = xmin; c < xmax; c++)
-		{
-			pixWriter.write((u32)((pixel[Red] << 16) | (pixel[Green] << 8) | pixel[Blue] | fb_kval));
-			pixel += 4;
-		}
-	}
-
-	static constexpr int BytesPerPixel = 4;
-
-private:
-	u32 fb_kval;
-	PixelWriter& pixWriter;
-};
-
-// 8888 ARGB 32 bit
-template<int Red, int Green, int Blue, int Alpha, typename PixelWriter>
-class FBLineWriter8888
-{
-public:
-	FBLineWriter8888(FB_W_CTRL_type fb_w_ctrl, PixelWriter& pixWriter) : pixWriter(pixWriter) {}
-
-	void write(int xmin, int xmax, const u8 *& pixel, int y)
-	{
-		for (int c = xmin; c < xmax; c++)
-		{
-			pixWriter.write((u32)((pixel[Red] << 16) | (pixel[Green] << 8) | pixel[Blue] | (pixel[Alpha] << 24)));
-			pixel += 4;
-		}
-	}
-
-	static constexpr int BytesPerPixel = 4;
-
-private:
-	PixelWriter& pixWriter;
-};
+	};
+	if ((u32)(width * height) >= ParallelConvertMinPixels)
+		TaskPool::instance().parallelFor(0, height, readLines, config::MaxThreads);
+	else
+		readLines(0, height);
+}
+template void ReadFramebuffer<RGBAPacker>(const FramebufferInfo& info, PixelBuffer<u32>& pb, int& width, int& height);
+template void ReadFramebuffer<BGRAPacker>(const FramebufferInfo& info, PixelBuffer<u32>& pb, int& width, int& height);
 
-template<typename FBLineWriter>
-static void writeTexture(u32 width, u32 height, const u8 *data, u16 *dst, FB_W_CTRL_type fb_w_ctrl, u32 linestride)
+template<int Red, int Green, int Blue, int Alpha>
+void WriteTextureToVRam(u32 width, u32 height, const u8 *data, u16 *dst, FB_W_CTRL_type fb_w_ctrl, u32 linestride)
 {
+	// Only 16-bit formats are supported
+	if (fb_w_ctrl.fb_packmode > 3)
+		return;
+	// Components are truncated if dithering is enabled, rounded otherwise
+	const bool round = !(fb_w_ctrl.fb_dither && config::EmulateFramebuffer);
 	u32 padding = linestride;
 	if (padding > width * 2)
 		padding = padding - width * 2;
 	else
 		padding = 0;
-
-	TexPixelWriter pixWriter(dst);
-	FBLineWriter lineWriter(fb_w_ctrl, pixWriter);
-
-	for (u32 l = 0; l < height; l++) {
-		lineWriter.write(0, width, data, l);
-		pixWriter.advance(padding);
-	}
-}
-
-template<int Red, int Green, int Blue, int Alpha>
-void WriteTextureToVRam(u32 width, u32 height, const u8 *data, u16 *dst, FB_W_CTRL_type fb_w_ctrl, u32 linestride)
-{
-	bool dither = fb_w_ctrl.fb_dither && config::EmulateFramebuffer;
-	switch (fb_w_ctrl.fb_packmode)
-	{
-	case 0: // 0555 KRGB 16 bit  (default)
-		if (dither)
-			writeTexture<FBLineWriter0555<Red, Green, Blue, Alpha, TexPixelWriter, false>>(width, height, data, dst, fb_w_ctrl, linestride);
-		else
-			writeTexture<FBLineWriter0555<Red, Green, Blue, Alpha, TexPixelWriter, true>>(width, height, data, dst, fb_w_ctrl, linestride);
-		break;
-	case 1: // 565 RGB 16 bit
-		if (dither)
-			writeTexture<FBLineWriter565<Red, Green, Blue, Alpha, TexPixelWriter, false>>(width, height, data, dst, fb_w_ctrl, linestride);
-		else
-			writeTexture<FBLineWriter565<Red, Green, Blue, Alpha, TexPixelWriter, true>>(width, height, data, dst, fb_w_ctrl, linestride);
-		break;
-	case 2: // 4444 ARGB 16 bit
-		if (dither)
-			writeTexture<FBLineWriter4444<Red, Green, Blue, Alpha, TexPixelWriter, false>>(width, height, data, dst, fb_w_ctrl, linestride);
-		else
-			writeTexture<FBLineWriter4444<Red, Green, Blue, Alpha, TexPixelWriter, true>>(width, height, data, dst, fb_w_ctrl, linestride);
-		break;
-	case 3: // 1555 ARGB 16 bit
-		if (dither)
-			writeTexture<FBLineWriter1555<Red, Green, Blue, Alpha, TexPixelWriter, false>>(width, height, data, dst, fb_w_ctrl, linestride);
-		else
-			writeTexture<FBLineWriter1555<Red, Green, Blue, Alpha, TexPixelWriter, true>>(width, height, data, dst, fb_w_ctrl, linestride);
-		break;
-	}
+	const u32 dstStride = width * 2 + padding;
+
+	const auto& writeLines = [&](int start, int end) {
+		for (int l = start; l < end; l++)
+			fbconv::pack<Red, Green, Blue, Alpha>(data + l * width * 4, (u8 *)dst + l * dstStride, width, fb_w_ctrl, round);
+	};
+	if (width * height >= ParallelConvertMinPixels)
+		TaskPool::instance().parallelFor(0, height, writeLines, config::MaxThreads);
+	else
+		writeLines(0, height);
 }
 template void WriteTextureToVRam<0, 1, 2, 3>(u32 width, u32 height, const u8 *data, u16 *dst, FB_W_CTRL_type fb_w_ctrl, u32 linestride);
 template void WriteTextureToVRam<2, 1, 0, 3>(u32 width, u32 height, const u8 *data, u16 *dst, FB_W_CTRL_type fb_w_ctrl, u32 linestride);
 
-template<typename FBLineWriter>
-static void writeFramebufferLW(u32 width, u32 height, const u8 *data, u32 dstAddr, FB_W_CTRL_type fb_w_ctrl, u32 linestride, FB_X_CLIP_type xclip, FB_Y_CLIP_type yclip)
+template<int Red, int Green, int Blue, int Alpha>
+void WriteFramebuffer(u32 width, u32 height, const u8 *data, u32 dstAddr, FB_W_CTRL_type fb_w_ctrl, u32 linestride, FB_X_CLIP_type xclip, FB_Y_CLIP_type yclip)
 {
-	int bpp = FBLineWriter::BytesPerPixel;
+	if (fb_w_ctrl.fb_packmode > 6)
+		die("Invalid framebuffer format");
+	const u32 bpp = fbconv::bytesPerPixel(fb_w_ctrl.fb_packmode);
 
 	u32 padding = linestride;
 	if (padding > width * bpp)
@@ -1157,52 +800,27 @@ static void writeFramebufferLW(u32 width, u32 height, const u8 *data, u32 dstAdd
 
 	const u32 clipWidth = std::min(width, xclip.max + 1u);
 	height = std::min(height, yclip.max + 1u);
-
-	FBPixelWriter pixWriter(dstAddr);
-	FBLineWriter lineWriter(fb_w_ctrl, pixWriter);
-
-	for (u32 l = yclip.min; l < height; l++)
-	{
-		p += 4 * xclip.min;
-		pixWriter.advance(bpp * xclip.min);
-
-		lineWriter.write(xclip.min, clipWidth, p, l);
-
-		pixWriter.advance(padding + (width - xclip.max - 1) * bpp);
-		p += (width - xclip.max - 1) * 4;
-	}
-}
-
-template<int Red, int Green, int Blue, int Alpha>
-void WriteFramebuffer(u32 width, u32 height, const u8 *data, u32 dstAddr, FB_W_CTRL_type fb_w_ctrl, u32 linestride, FB_X_CLIP_type xclip, FB_Y_CLIP_type yclip)
-{
-	switch (fb_w_ctrl.fb_packmode)
-	{
-	case 0: // 0555 KRGB 16 bit
-		writeFramebufferLW<FBLineWriter0555<Red, Green, Blue, Alpha, FBPixelWriter>>(width, height, data, dstAddr, fb_w_ctrl, linestride, xclip, yclip);
-		break;
-	case 1: // 565 RGB 16 bit
-		writeFramebufferLW<FBLineWriter565<Red, Green, Blue, Alpha, FBPixelWriter>>(width, height, data, dstAddr, fb_w_ctrl, linestride, xclip, yclip);
-		break;
-	case 2: // 4444 ARGB 16 bit
-		writeFramebufferLW<FBLineWriter4444<Red, Green, Blue, Alpha, FBPixelWriter>>(width, height, data, dstAddr, fb_w_ctrl, linestride, xclip, yclip);
-		break;
-	case 3: // 1555 ARGB 16 bit
-		writeFramebufferLW<FBLineWriter1555<Red, Green, Blue, Alpha, FBPixelWriter>>(width, height, data, dstAddr, fb_w_ctrl, linestride, xclip, yclip);
-		break;
-	case 4: // 888 RGB 24 bit packed
-		writeFramebufferLW<FBLineWriter888<Red, Green, Blue, Alpha, FBPixelWriter>>(width, height, data, dstAddr, fb_w_ctrl, linestride, xclip, yclip);
-		break;
-	case 5: // 0888 KRGB 32 bit
-		writeFramebufferLW<FBLineWriter0888<Red, Green, Blue, Alpha, FBPixelWriter>>(width, height, data, dstAddr, fb_w_ctrl, linestride, xclip, yclip);
-		break;
-	case 6: // 8888 ARGB 32 bit
-		writeFramebufferLW<FBLineWriter8888<Red, Green, Blue, Alpha, FBPixelWriter>>(width, height, data, dstAddr, fb_w_ctrl, linestride, xclip, yclip);
-		break;
-	default:
-		die("Invalid framebuffer format");
-		break;
-	}
+	if (yclip.min >= height)
+		return;
+	const u32 count = clipWidth > xclip.min ? clipWidth - xclip.min : 0;
+	// Pixels outside the clipping area are skipped
+	const u32 lineAdvance = xclip.min + count + width - xclip.max - 1;
+	// 16 and 32-bit pixels are written to aligned addresses
+	const u32 alignMask = bpp == 3 ? ~0u : ~(bpp - 1);
+
+	const auto& writeLines = [&](int start, int end) {
+		std::vector<u8> line(count * bpp);
+		for (int l = start; l < end; l++)
+		{
+			fbconv::pack<Red, Green, Blue, Alpha>(p + 4 * (l * lineAdvance + xclip.min), line.data(), count, fb_w_ctrl, false);
+			pvr_write32_block((dstAddr + l * (lineAdvance * bpp + padding) + xclip.min * bpp) & alignMask, line.data(), count * bpp);
+		}
+	};
+	const u32 lines = height - yclip.min;
+	if (count * lines >= ParallelConvertMinPixels)
+		TaskPool::instance().parallelFor(0, lines, writeLines, config::MaxThreads);
+	else
+		writeLines(0, lines);
 }
 template void WriteFramebuffer<0, 1, 2, 3>(u32 width, u32 height, const u8 *data, u32 dstAddr, FB_W_CTRL_type fb_w_ctrl,
 		u32 linestride, FB_X_CLIP_type xclip, FB_Y_CLIP_type yclip);
@@ -20,6 +20,7 @@
 #include "cfg/option.h"
 #include "texconv.h"
 #include "CustomTexture.h"
+#include "profiler/metrics.h"
 
 #include <algorithm>
 #include <array>
@@ -201,10 +202,13 @@ public:
 			texture = &it->second;
 			// Needed if the texture is updated
 			texture->tcw.StrideSel = tcw.StrideSel;
+			metrics::textureCacheHits.inc();
 		}
 		else //create if not existing
 		{
 			texture = &cache.emplace(std::make_pair(key, Texture(tsp, tcw))).first->second;
+			metrics::textureCacheMisses.inc();
+			metrics::textureCacheSize.set(cache.size());
 		}
 
 		return texture;
@@ -254,6 +258,7 @@ public:
 			if (cache.find(id)->second.Delete())
 				cache.erase(id);
 		}
+		metrics::textureCacheSize.set(cache.size());
 	}
 
 	void Clear()
@@ -263,6 +268,7 @@ public:
 			texture.Delete();
 
 		cache.clear();
+		metrics::textureCacheSize.set(0);
 		INFO_LOG(RENDERER, "Texture cache cleared");
 	}
 
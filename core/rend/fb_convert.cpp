@@ -0,0 +1,482 @@
+/*
+	Copyright 2026 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "fb_convert.h"
+#include "texconv.h"
+#include <cstring>
+#include <type_traits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define FB_SIMD_SSE2
+#elif HOST_CPU == CPU_ARM64 || (HOST_CPU == CPU_ARM && defined(__ARM_NEON__))
+#include <arm_neon.h>
+#define FB_SIMD_NEON
+#endif
+
+namespace fbconv
+{
+
+int bytesPerPixel(u32 packMode)
+{
+	switch (packMode)
+	{
+	case 4:
+		return 3;
+	case 5:
+	case 6:
+		return 4;
+	default:
+		return 2;
+	}
+}
+
+template<int bits>
+static inline u8 roundColor(u8 in)
+{
+	u8 out = in >> (8 - bits);
+	if (out != 0xffu >> (8 - bits))
+		out += (in >> (8 - bits - 1)) & 1;
+	return out;
+}
+
+template<int bits, bool Round>
+static inline u8 reduce(u8 in)
+{
+	if constexpr (Round)
+		return roundColor<bits>(in);
+	else
+		return in >> (8 - bits);
+}
+
+template<int Red, int Green, int Blue, int Alpha, bool Round>
+static void packPixelsScalar(const u8 *pixel, u8 *dst, u32 count, FB_W_CTRL_type fb_w_ctrl)
+{
+	switch (fb_w_ctrl.fb_packmode)
+	{
+	case 0: // 0555 KRGB 16 bit. Bit 15 is the value of fb_kval[7].
+		{
+			const u16 kval_bit = (fb_w_ctrl.fb_kval & 0x80) << 8;
+			for (u32 i = 0; i < count; i++, pixel += 4, dst += 2)
+			{
+				u16 v = (reduce<5, Round>(pixel[Red]) << 10) | (reduce<5, Round>(pixel[Green]) << 5)
+						| reduce<5, Round>(pixel[Blue]) | kval_bit;
+				memcpy(dst, &v, sizeof(v));
+			}
+		}
+		break;
+	case 1: // 565 RGB 16 bit
+		for (u32 i = 0; i < count; i++, pixel += 4, dst += 2)
+		{
+			u16 v = (reduce<5, Round>(pixel[Red]) << 11) | (reduce<6, Round>(pixel[Green]) << 5)
+					| reduce<5, Round>(pixel[Blue]);
+			memcpy(dst, &v, sizeof(v));
+		}
+		break;
+	case 2: // 4444 ARGB 16 bit
+		for (u32 i = 0; i < count; i++, pixel += 4, dst += 2)
+		{
+			u16 v = (reduce<4, Round>(pixel[Red]) << 8) | (reduce<4, Round>(pixel[Green]) << 4)
+					| reduce<4, Round>(pixel[Blue]) | (reduce<4, Round>(pixel[Alpha]) << 12);
+			memcpy(dst, &v, sizeof(v));
+		}
+		break;
+	case 3: // 1555 ARGB 16 bit. The alpha value is determined by comparison with the value of fb_alpha_threshold.
+		{
+			const u8 fb_alpha_threshold = fb_w_ctrl.fb_alpha_threshold;
+			for (u32 i = 0; i < count; i++, pixel += 4, dst += 2)
+			{
+				u16 v = (reduce<5, Round>(pixel[Red]) << 10) | (reduce<5, Round>(pixel[Green]) << 5)
+						| reduce<5, Round>(pixel[Blue]) | (pixel[Alpha] >= fb_alpha_threshold ? 0x8000 : 0);
+				memcpy(dst, &v, sizeof(v));
+			}
+		}
+		break;
+	case 4: // 888 RGB 24 bit packed
+		for (u32 i = 0; i < count; i++, pixel += 4)
+		{
+			*dst++ = pixel[Blue];
+			*dst++ = pixel[Green];
+			*dst++ = pixel[Red];
+		}
+		break;
+	case 5: // 0888 KRGB 32 bit (K is the value of fb_kval.)
+		{
+			const u32 fb_kval = fb_w_ctrl.fb_kval << 24;
+			for (u32 i = 0; i < count; i++, pixel += 4, dst += 4)
+			{
+				u32 v = (pixel[Red] << 16) | (pixel[Green] << 8) | pixel[Blue] | fb_kval;
+				memcpy(dst, &v, sizeof(v));
+			}
+		}
+		break;
+	case 6: // 8888 ARGB 32 bit
+		for (u32 i = 0; i < count; i++, pixel += 4, dst += 4)
+		{
+			u32 v = (pixel[Red] << 16) | (pixel[Green] << 8) | pixel[Blue] | (pixel[Alpha] << 24);
+			memcpy(dst, &v, sizeof(v));
+		}
+		break;
+	}
+}
+
+template<int Red, int Green, int Blue, int Alpha>
+void packScalar(const u8 *src, u8 *dst, u32 count, FB_W_CTRL_type fb_w_ctrl, bool round)
+{
+	if (round)
+		packPixelsScalar<Red, Green, Blue, Alpha, true>(src, dst, count, fb_w_ctrl);
+	else
+		packPixelsScalar<Red, Green, Blue, Alpha, false>(src, dst, count, fb_w_ctrl);
+}
+
+template<typename Packer>
+void unpackScalar(const u8 *src, u32 *dst, u32 count, u32 fbDepth, u32 fb_concat)
+{
+	switch (fbDepth)
+	{
+	case fbde_0555:    // 555 RGB
+		for (u32 i = 0; i < count; i++, src += 2)
+		{
+			u16 v;
+			memcpy(&v, src, sizeof(v));
+			*dst++ = Packer::pack(
+					(((v >> 10) & 0x1F) << 3) | fb_concat,
+					(((v >> 5) & 0x1F) << 3) | fb_concat,
+					(((v >> 0) & 0x1F) << 3) | fb_concat,
+					0xff);
+		}
+		break;
+
+	case fbde_565:    // 565 RGB
+		for (u32 i = 0; i < count; i++, src += 2)
+		{
+			u16 v;
+			memcpy(&v, src, sizeof(v));
+			*dst++ = Packer::pack(
+					(((v >> 11) & 0x1F) << 3) | fb_concat,
+					(((v >> 5) & 0x3F) << 2) | (fb_concat & 3),
+					(((v >> 0) & 0x1F) << 3) | fb_concat,
+					0xFF);
+		}
+		break;
+
+	case fbde_888:		// 888 RGB
+		{
+			const auto& read = [&src]() {
+				u32 v;
+				memcpy(&v, src, sizeof(v));
+				src += 4;
+				return v;
+			};
+			for (u32 i = 0; i < count; i += 4)
+			{
+				u32 src1 = read();
+				*dst++ = Packer::pack(src1 >> 16, src1 >> 8, src1, 0xff);
+				if (i + 1 >= count)
+					break;
+				u32 src2 = read();
+				*dst++ = Packer::pack(src2 >> 8, src2, src1 >> 24, 0xff);
+				if (i + 2 >= count)
+					break;
+				u32 src3 = read();
+				*dst++ = Packer::pack(src3, src2 >> 24, src2 >> 16, 0xff);
+				if (i + 3 >= count)
+					break;
+				*dst++ = Packer::pack(src3 >> 24, src3 >> 16, src3 >> 8, 0xff);
+			}
+		}
+		break;
+
+	case fbde_C888:     // 0888 RGB
+		for (u32 i = 0; i < count; i++, src += 4)
+		{
+			u32 v;
+			memcpy(&v, src, sizeof(v));
+			*dst++ = Packer::pack(v >> 16, v >> 8, v, 0xff);
+		}
+		break;
+	}
+}
+
+#if defined(FB_SIMD_SSE2) || defined(FB_SIMD_NEON)
+
+// 4 x 32-bit unsigned integers
+struct u32x4
+{
+#ifdef FB_SIMD_SSE2
+	__m128i v;
+
+	u32x4(__m128i v) : v(v) {}
+	explicit u32x4(u32 i) : v(_mm_set1_epi32((int)i)) {}
+
+	static u32x4 load(const u8 *p) { return _mm_loadu_si128((const __m128i *)p); }
+	void store(u8 *p) const { _mm_storeu_si128((__m128i *)p, v); }
+
+	template<int N> u32x4 shr() const { return _mm_srli_epi32(v, N); }
+	template<int N> u32x4 shl() const { return _mm_slli_epi32(v, N); }
+	u32x4 operator&(const u32x4& o) const { return _mm_and_si128(v, o.v); }
+	u32x4 operator|(const u32x4& o) const { return _mm_or_si128(v, o.v); }
+	u32x4 operator+(const u32x4& o) const { return _mm_add_epi32(v, o.v); }
+	// Only valid for values less than 0x8000
+	friend u32x4 min(const u32x4& a, const u32x4& b) { return _mm_min_epi16(a.v, b.v); }
+	// All bits set if a >= b. Only valid for values less than 0x80000000
+	friend u32x4 greaterEqual(const u32x4& a, const u32x4& b) {
+		return _mm_cmpgt_epi32(a.v, _mm_sub_epi32(b.v, _mm_set1_epi32(1)));
+	}
+
+	// Store the low 16 bits of each lane of a and b
+	static void store16(u8 *p, const u32x4& a, const u32x4& b)
+	{
+		// sign extend so that the signed saturation keeps the values intact
+		const __m128i sa = _mm_srai_epi32(_mm_slli_epi32(a.v, 16), 16);
+		const __m128i sb = _mm_srai_epi32(_mm_slli_epi32(b.v, 16), 16);
+		_mm_storeu_si128((__m128i *)p, _mm_packs_epi32(sa, sb));
+	}
+	// Load 8 16-bit values
+	static void load16(const u8 *p, u32x4& lo, u32x4& hi)
+	{
+		const __m128i v = _mm_loadu_si128((const __m128i *)p);
+		lo = _mm_unpacklo_epi16(v, _mm_setzero_si128());
+		hi = _mm_unpackhi_epi16(v, _mm_setzero_si128());
+	}
+
+#else
+	uint32x4_t v;
+
+	u32x4(uint32x4_t v) : v(v) {}
+	explicit u32x4(u32 i) : v(vdupq_n_u32(i)) {}
+
+	static u32x4 load(const u8 *p) { return vld1q_u32((const u32 *)p); }
+	void store(u8 *p) const { vst1q_u32((u32 *)p, v); }
+
+	template<int N> u32x4 shr() const { return vshrq_n_u32(v, N); }
+	template<int N> u32x4 shl() const { return vshlq_n_u32(v, N); }
+	u32x4 operator&(const u32x4& o) const { return vandq_u32(v, o.v); }
+	u32x4 operator|(const u32x4& o) const { return vorrq_u32(v, o.v); }
+	u32x4 operator+(const u32x4& o) const { return vaddq_u32(v, o.v); }
+	friend u32x4 min(const u32x4& a, const u32x4& b) { return vminq_u32(a.v, b.v); }
+	friend u32x4 greaterEqual(const u32x4& a, const u32x4& b) { return vcgeq_u32(a.v, b.v); }
+
+	static void store16(u8 *p, const u32x4& a, const u32x4& b) {
+		vst1q_u16((u16 *)p, vcombine_u16(vmovn_u32(a.v), vmovn_u32(b.v)));
+	}
+	static void load16(const u8 *p, u32x4& lo, u32x4& hi)
+	{
+		const uint16x8_t v = vld1q_u16((const u16 *)p);
+		lo = vmovl_u16(vget_low_u16(v));
+		hi = vmovl_u16(vget_high_u16(v));
+	}
+#endif
+};
+
+template<int Offset>
+static inline u32x4 component(const u32x4& pixel)
+{
+	if constexpr (Offset == 3)
+		return pixel.shr<24>();
+	else
+		return pixel.shr<Offset * 8>() & u32x4(0xff);
+}
+
+// Same as roundColor(): the rounded value is clamped so that it doesn't overflow
+template<int bits, bool Round>
+static inline u32x4 reduce(const u32x4& c)
+{
+	if constexpr (Round)
+		return min((c + u32x4(1 << (7 - bits))).template shr<8 - bits>(), u32x4((1 << bits) - 1));
+	else
+		return c.template shr<8 - bits>();
+}
+
+template<u32 PackMode, bool Round, int Red, int Green, int Blue, int Alpha>
+static inline u32x4 packPixels(const u32x4& p, const u32x4& kval, const u32x4& alphaThreshold)
+{
+	const u32x4 r = component<Red>(p);
+	const u32x4 g = component<Green>(p);
+	const u32x4 b = component<Blue>(p);
+	if constexpr (PackMode == 0)
+		return reduce<5, Round>(r).template shl<10>() | reduce<5, Round>(g).template shl<5>() | reduce<5, Round>(b) | kval;
+	else if constexpr (PackMode == 1)
+		return reduce<5, Round>(r).template shl<11>() | reduce<6, Round>(g).template shl<5>() | reduce<5, Round>(b);
+	else if constexpr (PackMode == 2)
+		return reduce<4, Round>(r).template shl<8>() | reduce<4, Round>(g).template shl<4>() | reduce<4, Round>(b)
+				| reduce<4, Round>(component<Alpha>(p)).template shl<12>();
+	else if constexpr (PackMode == 3)
+		return reduce<5, Round>(r).template shl<10>() | reduce<5, Round>(g).template shl<5>() | reduce<5, Round>(b)
+				| (greaterEqual(component<Alpha>(p), alphaThreshold) & u32x4(0x8000));
+	else if constexpr (PackMode == 6)
+		return r.template shl<16>() | g.template shl<8>() | b | component<Alpha>(p).template shl<24>();
+	else
+		// 888 and 0888
+		return r.template shl<16>() | g.template shl<8>() | b | kval;
+}
+
+// Returns the number of pixels packed
+template<u32 PackMode, bool Round, int Red, int Green, int Blue, int Alpha>
+static u32 packSimd(const u8 *src, u8 *dst, u32 count, FB_W_CTRL_type fb_w_ctrl)
+{
+	const u32x4 kval(PackMode == 0 ? (fb_w_ctrl.fb_kval & 0x80) << 8 : PackMode == 5 ? fb_w_ctrl.fb_kval << 24 : 0);
+	const u32x4 alphaThreshold(fb_w_ctrl.fb_alpha_threshold);
+	u32 i = 0;
+	if constexpr (PackMode <= 3)
+	{
+		for (; i + 8 <= count; i += 8, src += 32, dst += 16)
+			u32x4::store16(dst,
+					packPixels<PackMode, Round, Red, Green, Blue, Alpha>(u32x4::load(src), kval, alphaThreshold),
+					packPixels<PackMode, Round, Red, Green, Blue, Alpha>(u32x4::load(src + 16), kval, alphaThreshold));
+	}
+	else if constexpr (PackMode == 4)
+	{
+		alignas(16) u8 tmp[16];
+		for (; i + 4 <= count; i += 4, src += 16, dst += 12)
+		{
+			packPixels<PackMode, Round, Red, Green, Blue, Alpha>(u32x4::load(src), kval, alphaThreshold).store(tmp);
+			memcpy(dst, tmp, 3);
+			memcpy(dst + 3, tmp + 4, 3);
+			memcpy(dst + 6, tmp + 8, 3);
+			memcpy(dst + 9, tmp + 12, 3);
+		}
+	}
+	else
+	{
+		for (; i + 4 <= count; i += 4, src += 16, dst += 16)
+			packPixels<PackMode, Round, Red, Green, Blue, Alpha>(u32x4::load(src), kval, alphaThreshold).store(dst);
+	}
+	return i;
+}
+
+template<bool Round, int Red, int Green, int Blue, int Alpha>
+static u32 packSimd(const u8 *src, u8 *dst, u32 count, FB_W_CTRL_type fb_w_ctrl)
+{
+	switch (fb_w_ctrl.fb_packmode)
+	{
+	case 0: return packSimd<0, Round, Red, Green, Blue, Alpha>(src, dst, count, fb_w_ctrl);
+	case 1: return packSimd<1, Round, Red, Green, Blue, Alpha>(src, dst, count, fb_w_ctrl);
+	case 2: return packSimd<2, Round, Red, Green, Blue, Alpha>(src, dst, count, fb_w_ctrl);
+	case 3: return packSimd<3, Round, Red, Green, Blue, Alpha>(src, dst, count, fb_w_ctrl);
+	// rounding only applies to 16-bit formats
+	case 4: return packSimd<4, false, Red, Green, Blue, Alpha>(src, dst, count, fb_w_ctrl);
+	case 5: return packSimd<5, false, Red, Green, Blue, Alpha>(src, dst, count, fb_w_ctrl);
+	case 6: return packSimd<6, false, Red, Green, Blue, Alpha>(src, dst, count, fb_w_ctrl);
+	default: return 0;
+	}
+}
+
+template<bool Bgra>
+static inline u32x4 packRGB(const u32x4& r, const u32x4& g, const u32x4& b)
+{
+	if constexpr (Bgra)
+		return b | g.template shl<8>() | r.template shl<16>() | u32x4(0xff000000);
+	else
+		return r | g.template shl<8>() | b.template shl<16>() | u32x4(0xff000000);
+}
+
+// Returns the number of pixels unpacked
+template<typename Packer>
+static u32 unpackSimd(const u8 *src, u32 *dst, u32 count, u32 fbDepth, u32 fbConcat)
+{
+	constexpr bool Bgra = std::is_same_v<Packer, BGRAPacker>;
+	const u32x4 concat(fbConcat);
+	const u32x4 concat2(fbConcat & 3);
+	const u32x4 mask5(0x1f);
+	u32 i = 0;
+	switch (fbDepth)
+	{
+	case fbde_0555:
+		for (; i + 8 <= count; i += 8, src += 16)
+		{
+			u32x4 v[2] { u32x4(0u), u32x4(0u) };
+			u32x4::load16(src, v[0], v[1]);
+			for (const u32x4& s : v)
+			{
+				packRGB<Bgra>((s.shr<10>() & mask5).shl<3>() | concat,
+						(s.shr<5>() & mask5).shl<3>() | concat,
+						(s & mask5).shl<3>() | concat).store((u8 *)dst);
+				dst += 4;
+			}
+		}
+		break;
+	case fbde_565:
+		for (; i + 8 <= count; i += 8, src += 16)
+		{
+			u32x4 v[2] { u32x4(0u), u32x4(0u) };
+			u32x4::load16(src, v[0], v[1]);
+			for (const u32x4& s : v)
+			{
+				packRGB<Bgra>((s.shr<11>() & mask5).shl<3>() | concat,
+						(s.shr<5>() & u32x4(0x3f)).shl<2>() | concat2,
+						(s & mask5).shl<3>() | concat).store((u8 *)dst);
+				dst += 4;
+			}
+		}
+		break;
+	case fbde_C888:
+		for (; i + 4 <= count; i += 4, src += 16, dst += 4)
+		{
+			const u32x4 s = u32x4::load(src);
+			packRGB<Bgra>(s.shr<16>() & u32x4(0xff), s.shr<8>() & u32x4(0xff), s & u32x4(0xff)).store((u8 *)dst);
+		}
+		break;
+	default:
+		// 24-bit packed pixels use the scalar path
+		break;
+	}
+	return i;
+}
+
+#endif
+
+template<int Red, int Green, int Blue, int Alpha>
+void pack(const u8 *src, u8 *dst, u32 count, FB_W_CTRL_type fb_w_ctrl, bool round)
+{
+	u32 done = 0;
+#if defined(FB_SIMD_SSE2) || defined(FB_SIMD_NEON)
+	if (round)
+		done = packSimd<true, Red, Green, Blue, Alpha>(src, dst, count, fb_w_ctrl);
+	else
+		done = packSimd<false, Red, Green, Blue, Alpha>(src, dst, count, fb_w_ctrl);
+#endif
+	if (done < count)
+		packScalar<Red, Green, Blue, Alpha>(src + done * 4, dst + done * bytesPerPixel(fb_w_ctrl.fb_packmode),
+				count - done, fb_w_ctrl, round);
+}
+
+template<typename Packer>
+void unpack(const u8 *src, u32 *dst, u32 count, u32 fbDepth, u32 fbConcat)
+{
+	u32 done = 0;
+#if defined(FB_SIMD_SSE2) || defined(FB_SIMD_NEON)
+	done = unpackSimd<Packer>(src, dst, count, fbDepth, fbConcat);
+#endif
+	if (done < count)
+	{
+		const u32 srcBpp = fbDepth == fbde_C888 ? 4 : 2;
+		unpackScalar<Packer>(src + done * srcBpp, dst + done, count - done, fbDepth, fbConcat);
+	}
+}
+
+template void pack<0, 1, 2, 3>(const u8 *src, u8 *dst, u32 count, FB_W_CTRL_type fb_w_ctrl, bool round);
+template void pack<2, 1, 0, 3>(const u8 *src, u8 *dst, u32 count, FB_W_CTRL_type fb_w_ctrl, bool round);
+template void packScalar<0, 1, 2, 3>(const u8 *src, u8 *dst, u32 count, FB_W_CTRL_type fb_w_ctrl, bool round);
+template void packScalar<2, 1, 0, 3>(const u8 *src, u8 *dst, u32 count, FB_W_CTRL_type fb_w_ctrl, bool round);
+template void unpack<RGBAPacker>(const u8 *src, u32 *dst, u32 count, u32 fbDepth, u32 fbConcat);
+template void unpack<BGRAPacker>(const u8 *src, u32 *dst, u32 count, u32 fbDepth, u32 fbConcat);
+template void unpackScalar<RGBAPacker>(const u8 *src, u32 *dst, u32 count, u32 fbDepth, u32 fbConcat);
+template void unpackScalar<BGRAPacker>(const u8 *src, u32 *dst, u32 count, u32 fbDepth, u32 fbConcat);
+
+}
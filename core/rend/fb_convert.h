@@ -0,0 +1,48 @@
+/*
+	Copyright 2026 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include "types.h"
+#include "hw/pvr/pvr_regs.h"
+
+//
+// Framebuffer pixel format conversion, one line at a time.
+// pack() and unpack() use SSE2 or NEON when available. The scalar versions are the reference implementation.
+//
+namespace fbconv
+{
+
+// Size of a pixel for the given fb_packmode
+int bytesPerPixel(u32 packMode);
+
+// Pack count 32-bit pixels into the fb_w_ctrl.fb_packmode format.
+// Red, Green, Blue and Alpha are the byte offsets of the components in the source pixels.
+// If round is true, the components of 16-bit formats are rounded to the nearest value instead of truncated.
+template<int Red, int Green, int Blue, int Alpha>
+void pack(const u8 *src, u8 *dst, u32 count, FB_W_CTRL_type fb_w_ctrl, bool round);
+template<int Red, int Green, int Blue, int Alpha>
+void packScalar(const u8 *src, u8 *dst, u32 count, FB_W_CTRL_type fb_w_ctrl, bool round);
+
+// Unpack count pixels of the fb_depth format into 32-bit pixels.
+// 888 (packed 24-bit) pixels are read as whole 32-bit words.
+template<typename Packer>
+void unpack(const u8 *src, u32 *dst, u32 count, u32 fbDepth, u32 fbConcat);
+template<typename Packer>
+void unpackScalar(const u8 *src, u32 *dst, u32 count, u32 fbDepth, u32 fbConcat);
+
+}
@@ -18,6 +18,7 @@
 */
 #include "gl4.h"
 #include "rend/gles/glcache.h"
+#include "rend/oit_buffer_sizer.h"
 
 #include <memory>
 
@@ -29,6 +30,15 @@ static gl4PipelineShader g_abuffer_clear_shader;
 static gl4PipelineShader g_abuffer_tr_modvol_shaders[ModeCount];
 static int maxLayers;
 static int64_t pixelBufferSize;
+static OitBufferSizer pixelBufferSizer;
+// Asynchronous readbacks of the number of fragments used by the previous frames
+struct CounterReadback
+{
+	GLuint buffer = 0;
+	GLsync fence = nullptr;
+};
+static CounterReadback counterReadbacks[3];
+static u32 counterReadbackIndex;
 static std::unique_ptr<GlBuffer> g_quadBuffer;
 static std::unique_ptr<GlBuffer> g_quadIndexBuffer;
 
@@ -326,6 +336,19 @@ static void compileFinalAndModVolShaders()
 	}
 }
 
+static void allocPixelBuffer()
+{
+	// Create the buffer
+	if (pixels_buffer == 0)
+		glGenBuffers(1, &pixels_buffer);
+	// Bind it
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, pixels_buffer);
+	// Declare storage
+	glBufferData(GL_SHADER_STORAGE_BUFFER, pixelBufferSizer.getSize(), NULL, GL_DYNAMIC_COPY);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, pixels_buffer);
+	glCheck();
+}
+
 static void makePixelBuffer()
 {
 	if (pixels_buffer == 0 || pixelBufferSize != config::PixelBufferSize)
@@ -334,17 +357,71 @@ static void makePixelBuffer()
 		GLint64 maxSize;
 		glGetInteger64v(GL_MAX_SHADER_STORAGE_BLOCK_SIZE, &maxSize);
 		pixelBufferSize = config::PixelBufferSize;
-		GLsizeiptr pixel_buffer_size = std::min<int64_t>(pixelBufferSize, maxSize);
+		pixelBufferSizer.reset(std::min<int64_t>(pixelBufferSize, maxSize));
+		allocPixelBuffer();
+	}
+}
 
-		// Create the buffer
-		if (pixels_buffer == 0)
-			glGenBuffers(1, &pixels_buffer);
-		// Bind it
-		glBindBuffer(GL_SHADER_STORAGE_BUFFER, pixels_buffer);
-		// Declare storage
-		glBufferData(GL_SHADER_STORAGE_BUFFER, pixel_buffer_size, NULL, GL_DYNAMIC_COPY);
-		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, pixels_buffer);
-		glCheck();
+static void termCounterReadbacks()
+{
+	for (CounterReadback& readback : counterReadbacks)
+	{
+		if (readback.fence != nullptr)
+			glDeleteSync(readback.fence);
+		readback.fence = nullptr;
+		if (readback.buffer != 0)
+			glDeleteBuffers(1, &readback.buffer);
+		readback.buffer = 0;
+	}
+}
+
+// Copy the fragment counter of the current frame.
+// The counter is only reset by checkOverflowAndReset() at the start of the frame and all the passes
+// append to the same pixel buffer, so it holds the fragments of all the passes.
+static void readFragmentCount()
+{
+	CounterReadback& readback = counterReadbacks[counterReadbackIndex];
+	if (readback.fence != nullptr)
+		// Not read yet. Skip this frame
+		return;
+	if (readback.buffer == 0)
+	{
+		glGenBuffers(1, &readback.buffer);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, readback.buffer);
+		glBufferData(GL_COPY_WRITE_BUFFER, sizeof(GLuint), nullptr, GL_STREAM_READ);
+	}
+	glBindBuffer(GL_COPY_READ_BUFFER, atomic_buffer);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, readback.buffer);
+	glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+	glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, sizeof(GLuint));
+	readback.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	counterReadbackIndex = (counterReadbackIndex + 1) % std::size(counterReadbacks);
+	glCheck();
+}
+
+// Resize the pixel buffer according to the completed readbacks
+static void adaptPixelBuffer()
+{
+	bool resize = false;
+	for (u32 i = 0; i < std::size(counterReadbacks); i++)
+	{
+		// oldest first
+		CounterReadback& readback = counterReadbacks[(counterReadbackIndex + i) % std::size(counterReadbacks)];
+		if (readback.fence == nullptr)
+			continue;
+		if (glClientWaitSync(readback.fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+			break;
+		glDeleteSync(readback.fence);
+		readback.fence = nullptr;
+		GLuint fragments;
+		glBindBuffer(GL_COPY_READ_BUFFER, readback.buffer);
+		glGetBufferSubData(GL_COPY_READ_BUFFER, 0, sizeof(fragments), &fragments);
+		resize = pixelBufferSizer.frameDone(fragments) || resize;
+	}
+	if (resize)
+	{
+		DEBUG_LOG(RENDERER, "Resizing A-buffer to %d MB", (int)(pixelBufferSizer.getSize() / 1_MB));
+		allocPixelBuffer();
 	}
 }
 
@@ -443,6 +520,7 @@ void termABuffer()
 		glDeleteBuffers(1, &atomic_buffer);
 		atomic_buffer = 0;
 	}
+	termCounterReadbacks();
 	g_quadVertexArray.term();
 	g_quadBuffer.reset();
 	g_quadIndexBuffer.reset();
@@ -549,31 +627,11 @@ void DrawTranslucentModVols(int first, int count, bool useOpaqueGeom)
 
 void checkOverflowAndReset()
 {
-	// Using atomic counter
-	GLuint max_pixel_index = 0;
-//	glGetBufferSubData(GL_ATOMIC_COUNTER_BUFFER, 0, sizeof(GLuint), &max_pixel_index);
-////	printf("ABUFFER %d pixels used\n", max_pixel_index);
-//	if ((max_pixel_index + 1) * 32 - 1 >= pixel_buffer_size)
-//	{
-//		GLint64 size;
-//		glGetInteger64v(GL_MAX_SHADER_STORAGE_BLOCK_SIZE, &size);
-//		if (pixel_buffer_size == size)
-//			printf("A-buffer overflow: %d pixels. Buffer size already maxed out\n", max_pixel_index);
-//		else
-//		{
-//			pixel_buffer_size = (GLuint)min(2 * (GLint64)pixel_buffer_size, size);
-//
-//			printf("A-buffer overflow: %d pixels. Resizing buffer to %d MB\n", max_pixel_index, pixel_buffer_size / 1024 / 1024);
-//
-//			glBindBuffer(GL_SHADER_STORAGE_BUFFER, pixels_buffer);
-//			glBufferData(GL_SHADER_STORAGE_BUFFER, pixel_buffer_size, NULL, GL_DYNAMIC_COPY);
-//			glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, pixels_buffer);
-//			glCheck();
-//		}
-//	}
+	adaptPixelBuffer();
 	// Reset counter
-	max_pixel_index = 0;
- 	glBufferSubData(GL_ATOMIC_COUNTER_BUFFER, 0 , sizeof(GLuint), &max_pixel_index);
+	GLuint zero = 0;
+	glBindBuffer(GL_ATOMIC_COUNTER_BUFFER, atomic_buffer);
+	glBufferSubData(GL_ATOMIC_COUNTER_BUFFER, 0, sizeof(GLuint), &zero);
 }
 
 void renderABuffer(bool lastPass)
@@ -617,6 +675,8 @@ void renderABuffer(bool lastPass)
 
 	glActiveTexture(GL_TEXTURE0);
 
+	if (lastPass)
+		readFragmentCount();
 	makePixelBuffer();
 	glCheck();
 }
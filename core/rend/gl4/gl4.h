@@ -138,12 +138,12 @@ struct gl4_ctx
 
 	struct
 	{
-		std::unique_ptr<GlBuffer> geometry[2];
-		std::unique_ptr<GlBuffer> modvols[2];
-		std::unique_ptr<GlBuffer> idxs[2];
-		Gl4MainVertexArray main_vao[2];
-		Gl4ModvolVertexArray modvol_vao[2];
-		std::unique_ptr<GlBuffer> tr_poly_params[2];
+		std::unique_ptr<GlBuffer> geometry[3];
+		std::unique_ptr<GlBuffer> modvols[3];
+		std::unique_ptr<GlBuffer> idxs[3];
+		Gl4MainVertexArray main_vao[3];
+		Gl4ModvolVertexArray modvol_vao[3];
+		std::unique_ptr<GlBuffer> tr_poly_params[3];
 		int bufferIndex = 0;
 
 		GlBuffer *getVertexBuffer() {
@@ -164,7 +164,13 @@ struct gl4_ctx
 		Gl4ModvolVertexArray& getModVolVAO() {
 			return modvol_vao[bufferIndex];
 		}
-		void nextBuffer() {
+		void nextBuffer()
+		{
+			// the gpu may still be using the current buffers
+			geometry[bufferIndex]->fence();
+			modvols[bufferIndex]->fence();
+			idxs[bufferIndex]->fence();
+			tr_poly_params[bufferIndex]->fence();
 			bufferIndex = (bufferIndex + 1) % std::size(geometry);
 		}
 	} vbo;
@@ -659,11 +659,12 @@ static void gl_create_resources()
 	//create vbos
 	for (u32 i = 0; i < std::size(gl4.vbo.geometry); i++)
 	{
-		gl4.vbo.geometry[i] = std::make_unique<GlBuffer>(GL_ARRAY_BUFFER);
-		gl4.vbo.modvols[i] = std::make_unique<GlBuffer>(GL_ARRAY_BUFFER);
-		gl4.vbo.idxs[i] = std::make_unique<GlBuffer>(GL_ELEMENT_ARRAY_BUFFER);
+		// Buffer sets are used in turn, so each one is only rewritten every third frame
+		gl4.vbo.geometry[i] = std::make_unique<GlBuffer>(GL_ARRAY_BUFFER, GL_STREAM_DRAW, 1);
+		gl4.vbo.modvols[i] = std::make_unique<GlBuffer>(GL_ARRAY_BUFFER, GL_STREAM_DRAW, 1);
+		gl4.vbo.idxs[i] = std::make_unique<GlBuffer>(GL_ELEMENT_ARRAY_BUFFER, GL_STREAM_DRAW, 1);
 		// Create the buffer for Translucent poly params
-		gl4.vbo.tr_poly_params[i] = std::make_unique<GlBuffer>(GL_SHADER_STORAGE_BUFFER);
+		gl4.vbo.tr_poly_params[i] = std::make_unique<GlBuffer>(GL_SHADER_STORAGE_BUFFER, GL_STREAM_DRAW, 1);
 		gl4.vbo.bufferIndex = i;
 		gl4SetupMainVBO();
 		gl4SetupModvolVBO();
@@ -890,6 +891,7 @@ bool OpenGL4Renderer::renderFrame(int width, int height)
 
 	//Main VBO
 	//move vertex to gpu
+	const auto uploadStart = std::chrono::steady_clock::now();
 	gl4.vbo.getVertexBuffer()->update(pvrrc.verts.data(), pvrrc.verts.size() * sizeof(decltype(*pvrrc.verts.data())));
 	gl4.vbo.getIndexBuffer()->update(pvrrc.idx.data(), pvrrc.idx.size() * sizeof(decltype(*pvrrc.idx.data())));
 
@@ -911,6 +913,7 @@ bool OpenGL4Renderer::renderFrame(int width, int height)
 		// Declare storage
 		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, gl4.vbo.getPolyParamBuffer()->getName());
 	}
+	reportGeometryUpload(std::chrono::steady_clock::now() - uploadStart);
 	glCheck();
 
 	if (is_rtt || !config::Widescreen || matrices.IsClipped() || config::Rotate90 || config::EmulateFramebuffer)
@@ -900,26 +900,40 @@ bool OpenGLRenderer::GetLastFrame(std::vector<u8>& data, int& width, int& height
 	return true;
 }
 
-static GLuint vmuTextureId[8] {};
+static GLuint vmuAtlasId {};
 static GLuint lightgunTextureId {};
-static u64 vmuLastUpdated[8] {};
+static VmuAtlasUpdater vmuAtlasUpdater;
 
-static void updateVmuTexture(int vmuIndex)
+static void updateVmuAtlas()
 {
-	if (vmuTextureId[vmuIndex] == 0)
+	if (vmuAtlasId == 0)
 	{
-		vmuTextureId[vmuIndex] = glcache.GenTexture();
-		glcache.BindTexture(GL_TEXTURE_2D, vmuTextureId[vmuIndex]);
+		vmuAtlasId = glcache.GenTexture();
+		glcache.BindTexture(GL_TEXTURE_2D, vmuAtlasId);
 		glcache.TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
 		glcache.TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, VmuLcdWidth, VmuLcdHeight * VmuLcdCount, 0, GL_RGBA, GL_UNSIGNED_BYTE, vmu_lcd_data);
+		vmuAtlasUpdater.reset();
+		vmuAtlasUpdater.changedScreens();
+		return;
+	}
+	u32 changed = vmuAtlasUpdater.changedScreens();
+	if (changed == 0)
+		return;
+	glcache.BindTexture(GL_TEXTURE_2D, vmuAtlasId);
+	// Upload each run of consecutive screens at once
+	for (int i = 0; i < VmuLcdCount; )
+	{
+		if ((changed & (1 << i)) == 0) {
+			i++;
+			continue;
+		}
+		int count = 1;
+		while (i + count < VmuLcdCount && (changed & (1 << (i + count))))
+			count++;
+		glTexSubImage2D(GL_TEXTURE_2D, 0, 0, VmuLcdHeight * i, VmuLcdWidth, VmuLcdHeight * count, GL_RGBA, GL_UNSIGNED_BYTE, vmu_lcd_data[i]);
+		i += count;
 	}
-	else
-		glcache.BindTexture(GL_TEXTURE_2D, vmuTextureId[vmuIndex]);
-
-	const u32 *data = vmu_lcd_data[vmuIndex];
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 48, 32, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-
-	vmuLastUpdated[vmuIndex] = vmuLastChanged[vmuIndex];
 }
 
 static void drawVmuTexture(u8 vmuIndex, int width, int height)
@@ -985,22 +999,22 @@ static void drawVmuTexture(u8 vmuIndex, int width, int height)
 	}
 #endif
 
-	if (vmuLastChanged[vmuIndex] != vmuLastUpdated[vmuIndex]  || vmuTextureId[vmuIndex] == 0)
-		updateVmuTexture(vmuIndex);
-
 	float x1 = (x + w) * 2 / width - 1;
 	float y1 = -(y + h) * 2 / height + 1;
 	x = x * 2 / width - 1;
 	y = -y * 2 / height + 1;
+	// Rows of this screen in the atlas
+	const float v0 = (float)vmuIndex / VmuLcdCount;
+	const float v1 = (float)(vmuIndex + 1) / VmuLcdCount;
 	float vertices[20] = {
-		x,  y1, 1.f, 0.f, 0.f,
-		x,  y,  1.f, 0.f, 1.f,
-		x1, y1, 1.f, 1.f, 0.f,
-		x1, y,  1.f, 1.f, 1.f,
+		x,  y1, 1.f, 0.f, v0,
+		x,  y,  1.f, 0.f, v1,
+		x1, y1, 1.f, 1.f, v0,
+		x1, y,  1.f, 1.f, v1,
 	};
 	glcache.Enable(GL_BLEND);
 	glcache.BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-	gl.quad->draw(vmuTextureId[vmuIndex], false, false, vertices, color);
+	gl.quad->draw(vmuAtlasId, false, false, vertices, color);
 }
 
 static void updateLightGunTexture()
@@ -1064,7 +1078,8 @@ void drawVmusAndCrosshairs(int width, int height)
 
 	if (settings.platform.isConsole() && showVmus)
 	{
-		for (int i = 0; i < 8 ; i++)
+		updateVmuAtlas();
+		for (int i = 0; i < VmuLcdCount; i++)
 			if (vmu_lcd_status[i])
 				drawVmuTexture(i, width, height);
 	}
@@ -1077,8 +1092,8 @@ void drawVmusAndCrosshairs(int width, int height)
 
 void termVmuLightgun()
 {
-	glcache.DeleteTextures(std::size(vmuTextureId), vmuTextureId);
-	memset(vmuTextureId, 0, sizeof(vmuTextureId));
+	glcache.DeleteTextures(1, &vmuAtlasId);
+	vmuAtlasId = 0;
 	glcache.DeleteTextures(1, &lightgunTextureId);
 	lightgunTextureId = 0;
 }
@@ -399,6 +399,125 @@ void os_VideoRoutingTermGL();
 GLCache glcache;
 gl_ctx gl;
 
+GlBuffer::GlBuffer(GLenum type, GLenum usage, u32 ringSize)
+	: type(type), usage(usage), size(0)
+{
+	if (ringSize > 0 && gl.buffer_storage_supported)
+	{
+		ring.resize(ringSize);
+		// Vertex arrays need a valid buffer before the first update
+		for (MappedBuffer& buffer : ring)
+			allocate(buffer, 256_KB);
+	}
+	else {
+		glGenBuffers(1, &name);
+	}
+}
+
+GlBuffer::~GlBuffer()
+{
+	glDeleteBuffers(1, &name);
+#ifndef GLES2
+	for (MappedBuffer& buffer : ring)
+	{
+		if (buffer.fence != nullptr)
+			glDeleteSync(buffer.fence);
+		glDeleteBuffers(1, &buffer.name);
+	}
+#endif
+}
+
+void GlBuffer::update(const void *data, GLsizeiptr size)
+{
+#ifndef GLES2
+	if (!ring.empty())
+	{
+		ringIndex = (ringIndex + 1) % ring.size();
+		MappedBuffer& buffer = ring[ringIndex];
+		if (size > buffer.size)
+		{
+			// Storage is immutable so a new buffer is needed. The old one is released once the gpu is done with it.
+			allocate(buffer, size + size / 2);
+		}
+		else if (buffer.fence != nullptr)
+		{
+			GLenum rc;
+			do {
+				rc = glClientWaitSync(buffer.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 100'000'000);
+			} while (rc == GL_TIMEOUT_EXPIRED);
+			if (rc == GL_WAIT_FAILED)
+				WARN_LOG(RENDERER, "glClientWaitSync failed");
+			glDeleteSync(buffer.fence);
+			buffer.fence = nullptr;
+		}
+		// The mapping is coherent: no flush needed
+		memcpy(buffer.data, data, size);
+		bind();
+		return;
+	}
+#endif
+	bind();
+	if (size > this->size)
+	{
+		glBufferData(type, size, data, usage);
+		this->size = size;
+	}
+	else
+	{
+		glBufferSubData(type, 0, size, data);
+	}
+}
+
+void GlBuffer::fence()
+{
+#ifndef GLES2
+	if (ring.empty())
+		return;
+	MappedBuffer& buffer = ring[ringIndex];
+	if (buffer.fence != nullptr)
+		glDeleteSync(buffer.fence);
+	buffer.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+#endif
+}
+
+void GlBuffer::allocate(MappedBuffer& buffer, GLsizeiptr size)
+{
+#if !defined(GLES2) && defined(GLAD_GL_H_)
+	if (buffer.fence != nullptr)
+	{
+		glDeleteSync(buffer.fence);
+		buffer.fence = nullptr;
+	}
+	glDeleteBuffers(1, &buffer.name);
+	glGenBuffers(1, &buffer.name);
+	glBindBuffer(type, buffer.name);
+	const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+	if (gl.is_gles)
+		glBufferStorageEXT(type, size, nullptr, flags);
+	else
+		glBufferStorage(type, size, nullptr, flags);
+	buffer.data = (u8 *)glMapBufferRange(type, 0, size, flags);
+	verify(buffer.data != nullptr);
+	buffer.size = size;
+	glCheck();
+#endif
+}
+
+void reportGeometryUpload(std::chrono::steady_clock::duration duration)
+{
+	static std::chrono::steady_clock::duration total;
+	static u32 frames;
+	total += duration;
+	if (++frames == 600)
+	{
+		DEBUG_LOG(RENDERER, "Geometry upload: %.3f ms/frame (%s)",
+				std::chrono::duration<double, std::milli>(total).count() / frames,
+				gl.buffer_storage_supported ? "persistent mapping" : "glBufferSubData");
+		total = {};
+		frames = 0;
+	}
+}
+
 GLuint fogTextureId;
 GLuint paletteTextureId;
 
@@ -567,6 +686,13 @@ void findGLVersion()
     	gl.highp_float_supported = true;
     	gl.border_clamp_supported = true;
 	}
+	gl.buffer_storage_supported = false;
+#if !defined(GLES2) && defined(GLAD_GL_H_)
+	if (gl.is_gles)
+		gl.buffer_storage_supported = GLAD_GL_EXT_buffer_storage;
+	else
+		gl.buffer_storage_supported = GLAD_GL_VERSION_4_4 || GLAD_GL_ARB_buffer_storage;
+#endif
 	gl.max_anisotropy = 1.f;
 #if !defined(GLES2)
 	if (gl.gl_major >= 3)
@@ -912,9 +1038,9 @@ static void gl_create_resources()
 #endif
 
 	//create vbos
-	gl.vbo.geometry = std::make_unique<GlBuffer>(GL_ARRAY_BUFFER);
-	gl.vbo.modvols = std::make_unique<GlBuffer>(GL_ARRAY_BUFFER);
-	gl.vbo.idxs = std::make_unique<GlBuffer>(GL_ELEMENT_ARRAY_BUFFER);
+	gl.vbo.geometry = std::make_unique<GlBuffer>(GL_ARRAY_BUFFER, GL_STREAM_DRAW, 3);
+	gl.vbo.modvols = std::make_unique<GlBuffer>(GL_ARRAY_BUFFER, GL_STREAM_DRAW, 3);
+	gl.vbo.idxs = std::make_unique<GlBuffer>(GL_ELEMENT_ARRAY_BUFFER, GL_STREAM_DRAW, 3);
 
 	gl.quad = std::make_unique<GlQuadDrawer>();
 }
@@ -1235,6 +1361,7 @@ bool OpenGLRenderer::renderFrame(int width, int height)
 		glClear(GL_COLOR_BUFFER_BIT);
 	//move vertex to gpu
 	//Main VBO
+	const auto uploadStart = std::chrono::steady_clock::now();
 	gl.vbo.geometry->update(&pvrrc.verts[0], pvrrc.verts.size() * sizeof(decltype(pvrrc.verts[0])));
 
 	upload_vertex_indices();
@@ -1242,6 +1369,7 @@ bool OpenGLRenderer::renderFrame(int width, int height)
 	//Modvol VBO
 	if (!pvrrc.modtrig.empty())
 		gl.vbo.modvols->update(&pvrrc.modtrig[0], pvrrc.modtrig.size() * sizeof(decltype(pvrrc.modtrig[0])));
+	reportGeometryUpload(std::chrono::steady_clock::now() - uploadStart);
 
 	if (!wide_screen_on)
 	{
@@ -1327,6 +1455,9 @@ bool OpenGLRenderer::renderFrame(int width, int height)
 		renderLastFrame();
 #endif
 	}
+	gl.vbo.geometry->fence();
+	gl.vbo.modvols->fence();
+	gl.vbo.idxs->fence();
 	GlVertexArray::unbind();
 
 	return !is_rtt;
@@ -11,6 +11,7 @@
 #endif
 
 #include <unordered_map>
+#include <chrono>
 #include <glm/glm.hpp>
 
 #ifndef GL_TEXTURE_MAX_ANISOTROPY
@@ -124,42 +125,44 @@ struct PipelineShader
 class GlBuffer
 {
 public:
-	GlBuffer(GLenum type, GLenum usage =  GL_STREAM_DRAW)
-		: type(type), usage(usage), size(0) {
-		glGenBuffers(1, &name);
-	}
-
-	~GlBuffer() {
-		glDeleteBuffers(1, &name);
-	}
+	// Buffers with a non-zero ringSize are rewritten by the cpu every frame.
+	// When buffer storage is supported, they are made of ringSize persistently mapped buffers
+	// that are used in turn. A buffer is only rewritten once the gpu is done with it (see fence()).
+	GlBuffer(GLenum type, GLenum usage = GL_STREAM_DRAW, u32 ringSize = 0);
+	~GlBuffer();
 
 	void bind() const {
-		glBindBuffer(type, name);
+		glBindBuffer(type, getName());
 	}
 
 	GLuint getName() const {
-		return name;
+		return ring.empty() ? name : ring[ringIndex].name;
 	}
 
-	void update(const void *data, GLsizeiptr size)
-	{
-		bind();
-		if (size > this->size)
-		{
-			glBufferData(type, size, data, usage);
-			this->size = size;
-		}
-		else
-		{
-			glBufferSubData(type, 0, size, data);
-		}
-	}
+	void update(const void *data, GLsizeiptr size);
+
+	// Must be called once the draw calls using the last update have been submitted.
+	// Streaming buffers only.
+	void fence();
 
 private:
+	struct MappedBuffer
+	{
+		GLuint name = 0;
+		GLsizeiptr size = 0;
+		u8 *data = nullptr;
+#ifndef GLES2
+		GLsync fence = nullptr;
+#endif
+	};
+	void allocate(MappedBuffer& buffer, GLsizeiptr size);
+
 	GLenum type;
 	GLenum usage;
 	GLsizeiptr size;
-	GLuint name;
+	GLuint name = 0;
+	std::vector<MappedBuffer> ring;
+	u32 ringIndex = 0;
 };
 
 class GlFramebuffer
@@ -209,6 +212,7 @@ protected:
 private:
 	static void bindVertexArray(GLuint vao);
 	GLuint vertexArray = 0;
+	GLuint vertexBuffer = 0;	// buffer used by the vertex attributes
 };
 
 class MainVertexArray final : public GlVertexArray
@@ -312,6 +316,7 @@ struct gl_ctx
 	bool prim_restart_supported;
 	bool prim_restart_fixed_supported;
 	bool bogusBlitFramebuffer;
+	bool buffer_storage_supported;
 
 	size_t get_index_size() { return index_type == GL_UNSIGNED_INT ? sizeof(u32) : sizeof(u16); }
 };
@@ -343,6 +348,7 @@ inline void GlVertexArray::bind(GlBuffer *buffer, GlBuffer *indexBuffer)
 		else
 			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 		defineVtxAttribs();
+		vertexBuffer = buffer->getName();
 	}
 	else
 	{
@@ -352,6 +358,12 @@ inline void GlVertexArray::bind(GlBuffer *buffer, GlBuffer *indexBuffer)
 			indexBuffer->bind();
 		else
 			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+		// Streaming buffers change from one frame to the next
+		if (buffer->getName() != vertexBuffer)
+		{
+			defineVtxAttribs();
+			vertexBuffer = buffer->getName();
+		}
 	}
 }
 
@@ -373,6 +385,8 @@ enum ModifierVolumeMode { Xor, Or, Inclusion, Exclusion, ModeCount };
 
 void termGLCommon();
 void findGLVersion();
+// Accumulates the time spent uploading the frame geometry and logs its average periodically
+void reportGeometryUpload(std::chrono::steady_clock::duration duration);
 
 void SetCull(u32 CullMode);
 void SetMVS_Mode(ModifierVolumeMode mv_mode, ISP_Modvol ispc);
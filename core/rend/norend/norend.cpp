@@ -1,22 +1,65 @@
 #include "hw/pvr/ta.h"
 #include "hw/pvr/ta_ctx.h"
 #include "hw/pvr/Renderer_if.h"
+#include "rend/TexCache.h"
+#include "rend/osd.h"
+#include "profiler/benchmark.h"
+
+// Textures are decoded but never uploaded
+class NoTexture final : public BaseTextureCacheData
+{
+public:
+	NoTexture(TSP tsp, TCW tcw) : BaseTextureCacheData(tsp, tcw) {
+	}
+	NoTexture(NoTexture&& other) : BaseTextureCacheData(std::move(other)) {
+	}
+
+	std::string GetId() override { return ""; }
+	void UploadToGPU(int width, int height, const u8 *temp_tex_buffer, bool mipmapped, bool mipmapsIncluded = false) override { }
+};
+
+class NoTextureCache final : public BaseTextureCache<NoTexture>
+{
+};
 
 struct norend : Renderer
 {
 	bool Init() override {
 		return true;
 	}
-	void Term() override { }
+	void Term() override {
+		texCache.Clear();
+	}
 
 	void Process(TA_context* ctx) override {
 		ta_parse(ctx, true);
 	}
 
 	bool Render() override {
+		if (benchmark::active())
+		{
+			texCache.CollectCleanup();
+			// Account for the VMU screens that would be uploaded to the atlas texture
+			vmuAtlasUpdater.changedScreens();
+		}
 		return !pvrrc.isRTT;
 	}
 	void RenderFramebuffer(const FramebufferInfo& info) override { }
+
+	BaseTextureCacheData *GetTexture(TSP tsp, TCW tcw) override
+	{
+		// Only decode textures when benchmarking, to account for their cost
+		if (!benchmark::active())
+			return nullptr;
+		NoTexture *texture = texCache.getTextureCacheData(tsp, tcw);
+		if (texture->NeedsUpdate() && !texture->Update())
+			return nullptr;
+		return texture;
+	}
+
+private:
+	NoTextureCache texCache;
+	VmuAtlasUpdater vmuAtlasUpdater;
 };
 
 Renderer *rend_norend() {
@@ -0,0 +1,108 @@
+/*
+	Copyright 2026 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include "types.h"
+#include <algorithm>
+
+//
+// Adaptive size of the OIT pixel buffer.
+// The buffer starts at the maximum size (rend.PixelBufferSize). Fragment counts are only known a few frames
+// later, so a frame that overflows the buffer can't be rendered again. To keep overflows rare:
+// - the buffer goes back to the maximum size as soon as a frame overflows it, and grows to Margin times
+//   the usage when a frame uses more than half of it,
+// - it only shrinks after being used at less than 1/Margin for ShrinkDelay frames, to Margin times
+//   the peak usage of that period, and by half at most.
+//
+class OitBufferSizer
+{
+public:
+	static constexpr u64 PixelSize = 16;		// sizeof(Pixel) in the OIT shaders
+	static constexpr u64 Granularity = 4_MB;
+	static constexpr u64 MinSize = 16_MB;
+	static constexpr u64 Margin = 4;
+	static constexpr u32 ShrinkDelay = 300;		// frames
+
+	void reset(u64 maxSize)
+	{
+		this->maxSize = std::max<u64>(maxSize / Granularity * Granularity, Granularity);
+		size = this->maxSize;
+		peak = 0;
+		lowFrames = 0;
+	}
+
+	// Called with the number of fragments a frame tried to store, including the ones that didn't fit.
+	// Returns true if the buffer should be resized to getSize().
+	bool frameDone(u64 fragments)
+	{
+		const u64 used = fragments * PixelSize;
+		if (used > size)
+		{
+			// Fragments have been lost and the following frames are likely to overflow too
+			lowFrames = 0;
+			peak = 0;
+			return resize(maxSize);
+		}
+		if (used > size / 2)
+		{
+			lowFrames = 0;
+			peak = 0;
+			return resize(used * Margin);
+		}
+		if (used * Margin < size)
+		{
+			peak = std::max(peak, used);
+			if (++lowFrames >= ShrinkDelay)
+			{
+				const u64 target = std::max(peak * Margin, size / 2);
+				lowFrames = 0;
+				peak = 0;
+				return resize(target);
+			}
+		}
+		else
+		{
+			lowFrames = 0;
+			peak = 0;
+		}
+		return false;
+	}
+
+	u64 getSize() const {
+		return size;
+	}
+	u64 getMaxSize() const {
+		return maxSize;
+	}
+
+private:
+	bool resize(u64 newSize)
+	{
+		newSize = (newSize + Granularity - 1) / Granularity * Granularity;
+		newSize = std::clamp<u64>(newSize, std::min(MinSize, maxSize), maxSize);
+		if (newSize == size)
+			return false;
+		size = newSize;
+		return true;
+	}
+
+	u64 maxSize = 0;
+	u64 size = 0;
+	u64 peak = 0;		// largest usage since the buffer was last mostly used
+	u32 lowFrames = 0;
+};
@@ -20,24 +20,78 @@
 #include "vmu_xhair.h"
 #endif
 
-u32 vmu_lcd_data[8][48 * 32];
-bool vmu_lcd_status[8];
-u64 vmuLastChanged[8];
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define VMU_SIMD_SSE2
+#elif HOST_CPU == CPU_ARM64 || (HOST_CPU == CPU_ARM && defined(__ARM_NEON__))
+#include <arm_neon.h>
+#define VMU_SIMD_NEON
+#endif
+
+u32 vmu_lcd_data[VmuLcdCount][VmuLcdWidth * VmuLcdHeight];
+bool vmu_lcd_status[VmuLcdCount];
+u64 vmuLastChanged[VmuLcdCount];
+std::atomic<u64> vmuLcdUploadedBytes;
+
+void expandVmuLcdScalar(const u8 *src, u32 *dst, int count, u32 onColor, u32 offColor)
+{
+	for (int i = 0; i < count; i++)
+		dst[i] = src[i] != 0 ? onColor : offColor;
+}
+
+void expandVmuLcd(const u8 *src, u32 *dst, int count, u32 onColor, u32 offColor)
+{
+	int i = 0;
+#if defined(VMU_SIMD_SSE2)
+	const __m128i on = _mm_set1_epi32((int)onColor);
+	const __m128i off = _mm_set1_epi32((int)offColor);
+	const __m128i zero = _mm_setzero_si128();
+	for (; i + 16 <= count; i += 16)
+	{
+		// 0xff for pixels that are off
+		const __m128i mask8 = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)&src[i]), zero);
+		const __m128i mask16lo = _mm_unpacklo_epi8(mask8, mask8);
+		const __m128i mask16hi = _mm_unpackhi_epi8(mask8, mask8);
+		const __m128i masks[4] {
+			_mm_unpacklo_epi16(mask16lo, mask16lo), _mm_unpackhi_epi16(mask16lo, mask16lo),
+			_mm_unpacklo_epi16(mask16hi, mask16hi), _mm_unpackhi_epi16(mask16hi, mask16hi)
+		};
+		for (int j = 0; j < 4; j++)
+			_mm_storeu_si128((__m128i *)&dst[i + j * 4],
+					_mm_or_si128(_mm_and_si128(masks[j], off), _mm_andnot_si128(masks[j], on)));
+	}
+#elif defined(VMU_SIMD_NEON)
+	const uint32x4_t on = vdupq_n_u32(onColor);
+	const uint32x4_t off = vdupq_n_u32(offColor);
+	for (; i + 16 <= count; i += 16)
+	{
+		// 0xff for pixels that are off
+		const uint8x16_t mask8 = vceqq_u8(vld1q_u8(&src[i]), vdupq_n_u8(0));
+		const uint8x16x2_t mask16 = vzipq_u8(mask8, mask8);
+		const uint16x8x2_t masklo = vzipq_u16(vreinterpretq_u16_u8(mask16.val[0]), vreinterpretq_u16_u8(mask16.val[0]));
+		const uint16x8x2_t maskhi = vzipq_u16(vreinterpretq_u16_u8(mask16.val[1]), vreinterpretq_u16_u8(mask16.val[1]));
+		vst1q_u32(&dst[i], vbslq_u32(vreinterpretq_u32_u16(masklo.val[0]), off, on));
+		vst1q_u32(&dst[i + 4], vbslq_u32(vreinterpretq_u32_u16(masklo.val[1]), off, on));
+		vst1q_u32(&dst[i + 8], vbslq_u32(vreinterpretq_u32_u16(maskhi.val[0]), off, on));
+		vst1q_u32(&dst[i + 12], vbslq_u32(vreinterpretq_u32_u16(maskhi.val[1]), off, on));
+	}
+#endif
+	expandVmuLcdScalar(&src[i], &dst[i], count - i, onColor, offColor);
+}
 
 void push_vmu_screen(int bus_id, int bus_port, u8* buffer)
 {
 	int vmu_id = bus_id * 2 + bus_port;
 	if (vmu_id < 0 || vmu_id >= (int)std::size(vmu_lcd_data))
 		return;
-	u32 *p = &vmu_lcd_data[vmu_id][0];
-	for (int i = 0; i < (int)std::size(vmu_lcd_data[vmu_id]); i++, buffer++)
 #ifdef LIBRETRO
-		*p++ = (*buffer != 0
-				? vmu_screen_params[bus_id].vmu_pixel_on_R | (vmu_screen_params[bus_id].vmu_pixel_on_G << 8) | (vmu_screen_params[bus_id].vmu_pixel_on_B << 16)
-				: vmu_screen_params[bus_id].vmu_pixel_off_R | (vmu_screen_params[bus_id].vmu_pixel_off_G << 8) | (vmu_screen_params[bus_id].vmu_pixel_off_B << 16))
-				  | (vmu_screen_params[bus_id].vmu_screen_opacity << 24);
+	const auto& params = vmu_screen_params[bus_id];
+	const u32 opacity = (u32)params.vmu_screen_opacity << 24;
+	expandVmuLcd(buffer, vmu_lcd_data[vmu_id], std::size(vmu_lcd_data[vmu_id]),
+			params.vmu_pixel_on_R | (params.vmu_pixel_on_G << 8) | (params.vmu_pixel_on_B << 16) | opacity,
+			params.vmu_pixel_off_R | (params.vmu_pixel_off_G << 8) | (params.vmu_pixel_off_B << 16) | opacity);
 #else
-		*p++ = *buffer != 0 ? 0xFFFFFFFFu : 0xFF000000u;
+	expandVmuLcd(buffer, vmu_lcd_data[vmu_id], std::size(vmu_lcd_data[vmu_id]), 0xFFFFFFFFu, 0xFF000000u);
 #endif
 #ifndef LIBRETRO
 	vmu_lcd_status[vmu_id] = true;
@@ -18,14 +18,67 @@
 
 #include "types.h"
 #include "cfg/option.h"
+#include <atomic>
 
 // VMUs
-extern u32 vmu_lcd_data[8][48 * 32];
-extern bool vmu_lcd_status[8];
-extern u64 vmuLastChanged[8];
+constexpr int VmuLcdWidth = 48;
+constexpr int VmuLcdHeight = 32;
+constexpr int VmuLcdCount = 8;
+
+// The VMU screens form a single 48 x 256 image: screen i occupies rows 32 * i to 32 * i + 31.
+// Renderers keep it in a single texture and only upload the screens that have changed.
+extern u32 vmu_lcd_data[VmuLcdCount][VmuLcdWidth * VmuLcdHeight];
+extern bool vmu_lcd_status[VmuLcdCount];
+extern u64 vmuLastChanged[VmuLcdCount];
+// Number of bytes of VMU screen data uploaded to the GPU. Updated by the render thread.
+extern std::atomic<u64> vmuLcdUploadedBytes;
 
 void push_vmu_screen(int bus_id, int bus_port, u8* buffer);
 
+// Converts count LCD pixels (one byte per pixel, non-zero if set) to RGBA
+void expandVmuLcd(const u8 *src, u32 *dst, int count, u32 onColor, u32 offColor);
+// Reference implementation
+void expandVmuLcdScalar(const u8 *src, u32 *dst, int count, u32 onColor, u32 offColor);
+
+// Tracks the VMU screens that need to be uploaded to the renderer atlas texture
+class VmuAtlasUpdater
+{
+public:
+	// Returns the bit mask of the displayed screens that have changed since the last call,
+	// or all screens after a reset, and records their upload.
+	u32 changedScreens()
+	{
+		u32 mask = 0;
+		for (int i = 0; i < VmuLcdCount; i++)
+		{
+			if (valid && (!vmu_lcd_status[i] || lastChanged[i] == vmuLastChanged[i]))
+				continue;
+			mask |= 1 << i;
+			lastChanged[i] = vmuLastChanged[i];
+		}
+		valid = true;
+		vmuLcdUploadedBytes += (u64)countScreens(mask) * sizeof(vmu_lcd_data[0]);
+		return mask;
+	}
+
+	// Forces the upload of all screens, when the texture is (re)created
+	void reset() {
+		valid = false;
+	}
+
+	static int countScreens(u32 mask)
+	{
+		int count = 0;
+		for (; mask != 0; mask &= mask - 1)
+			count++;
+		return count;
+	}
+
+private:
+	u64 lastChanged[VmuLcdCount] {};
+	bool valid = false;
+};
+
 // Crosshair
 const u32 *getCrosshairTextureData();
 std::pair<float, float> getCrosshairPosition(int playerNum);
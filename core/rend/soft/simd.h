@@ -0,0 +1,198 @@
+/*
+	Copyright 2026 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include "types.h"
+#include <algorithm>
+#include <cstring>
+
+#if HOST_CPU == CPU_X86 || HOST_CPU == CPU_X64
+#include <xmmintrin.h>
+#define SOFT_SIMD_SSE
+#elif HOST_CPU == CPU_ARM64 || (HOST_CPU == CPU_ARM && defined(__ARM_NEON__))
+#include <arm_neon.h>
+#define SOFT_SIMD_NEON
+#endif
+
+namespace soft
+{
+
+//
+// 4-wide float vector used by the software renderer for edge functions (4 pixels at a time)
+// and for color math (one RGBA pixel).
+// Only SSE1 is used on x86 since SSE2 isn't guaranteed on 32-bit builds.
+//
+struct alignas(16) f32x4
+{
+#if defined(SOFT_SIMD_SSE)
+	__m128 v;
+
+	f32x4() = default;
+	f32x4(__m128 v) : v(v) {}
+	explicit f32x4(float f) : v(_mm_set1_ps(f)) {}
+	f32x4(float x, float y, float z, float w) : v(_mm_setr_ps(x, y, z, w)) {}
+
+	static f32x4 load(const float *p) { return _mm_load_ps(p); }
+	static f32x4 loadu(const float *p) { return _mm_loadu_ps(p); }
+	void store(float *p) const { _mm_store_ps(p, v); }
+	void storeu(float *p) const { _mm_storeu_ps(p, v); }
+
+	f32x4 operator+(const f32x4& o) const { return _mm_add_ps(v, o.v); }
+	f32x4 operator-(const f32x4& o) const { return _mm_sub_ps(v, o.v); }
+	f32x4 operator*(const f32x4& o) const { return _mm_mul_ps(v, o.v); }
+	f32x4 operator&(const f32x4& o) const { return _mm_and_ps(v, o.v); }
+
+	// Comparisons return a lane mask
+	f32x4 operator>=(const f32x4& o) const { return _mm_cmpge_ps(v, o.v); }
+	f32x4 operator>(const f32x4& o) const { return _mm_cmpgt_ps(v, o.v); }
+	f32x4 operator<(const f32x4& o) const { return _mm_cmplt_ps(v, o.v); }
+
+	// One bit per lane of a comparison mask
+	int mask() const { return _mm_movemask_ps(v); }
+
+	friend f32x4 min(const f32x4& a, const f32x4& b) { return _mm_min_ps(a.v, b.v); }
+	friend f32x4 max(const f32x4& a, const f32x4& b) { return _mm_max_ps(a.v, b.v); }
+
+	float operator[](int i) const {
+		alignas(16) float f[4];
+		_mm_store_ps(f, v);
+		return f[i];
+	}
+
+#elif defined(SOFT_SIMD_NEON)
+	float32x4_t v;
+
+	f32x4() = default;
+	f32x4(float32x4_t v) : v(v) {}
+	explicit f32x4(float f) : v(vdupq_n_f32(f)) {}
+	f32x4(float x, float y, float z, float w) {
+		alignas(16) const float f[4] { x, y, z, w };
+		v = vld1q_f32(f);
+	}
+
+	static f32x4 load(const float *p) { return vld1q_f32(p); }
+	static f32x4 loadu(const float *p) { return vld1q_f32(p); }
+	void store(float *p) const { vst1q_f32(p, v); }
+	void storeu(float *p) const { vst1q_f32(p, v); }
+
+	f32x4 operator+(const f32x4& o) const { return vaddq_f32(v, o.v); }
+	f32x4 operator-(const f32x4& o) const { return vsubq_f32(v, o.v); }
+	f32x4 operator*(const f32x4& o) const { return vmulq_f32(v, o.v); }
+	f32x4 operator&(const f32x4& o) const {
+		return vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(v), vreinterpretq_u32_f32(o.v)));
+	}
+
+	f32x4 operator>=(const f32x4& o) const { return vreinterpretq_f32_u32(vcgeq_f32(v, o.v)); }
+	f32x4 operator>(const f32x4& o) const { return vreinterpretq_f32_u32(vcgtq_f32(v, o.v)); }
+	f32x4 operator<(const f32x4& o) const { return vreinterpretq_f32_u32(vcltq_f32(v, o.v)); }
+
+	int mask() const
+	{
+		const uint32x4_t u = vshrq_n_u32(vreinterpretq_u32_f32(v), 31);
+		return vgetq_lane_u32(u, 0) | (vgetq_lane_u32(u, 1) << 1)
+				| (vgetq_lane_u32(u, 2) << 2) | (vgetq_lane_u32(u, 3) << 3);
+	}
+
+	friend f32x4 min(const f32x4& a, const f32x4& b) { return vminq_f32(a.v, b.v); }
+	friend f32x4 max(const f32x4& a, const f32x4& b) { return vmaxq_f32(a.v, b.v); }
+
+	float operator[](int i) const {
+		alignas(16) float f[4];
+		vst1q_f32(f, v);
+		return f[i];
+	}
+
+#else
+	float v[4];
+
+	f32x4() = default;
+	explicit f32x4(float f) : v{ f, f, f, f } {}
+	f32x4(float x, float y, float z, float w) : v{ x, y, z, w } {}
+
+	static f32x4 load(const float *p) { return f32x4(p[0], p[1], p[2], p[3]); }
+	static f32x4 loadu(const float *p) { return load(p); }
+	void store(float *p) const { std::copy(v, v + 4, p); }
+	void storeu(float *p) const { store(p); }
+
+	template<typename Op>
+	f32x4 apply(const f32x4& o, Op op) const {
+		return f32x4(op(v[0], o.v[0]), op(v[1], o.v[1]), op(v[2], o.v[2]), op(v[3], o.v[3]));
+	}
+	static float fromBool(bool b) {
+		u32 u = b ? ~0u : 0u;
+		float f;
+		memcpy(&f, &u, sizeof(f));
+		return f;
+	}
+	static u32 bits(float f) {
+		u32 u;
+		memcpy(&u, &f, sizeof(u));
+		return u;
+	}
+
+	f32x4 operator+(const f32x4& o) const { return apply(o, [](float a, float b) { return a + b; }); }
+	f32x4 operator-(const f32x4& o) const { return apply(o, [](float a, float b) { return a - b; }); }
+	f32x4 operator*(const f32x4& o) const { return apply(o, [](float a, float b) { return a * b; }); }
+	f32x4 operator&(const f32x4& o) const {
+		return apply(o, [](float a, float b) { return fromBool((bits(a) & bits(b)) != 0); });
+	}
+
+	f32x4 operator>=(const f32x4& o) const { return apply(o, [](float a, float b) { return fromBool(a >= b); }); }
+	f32x4 operator>(const f32x4& o) const { return apply(o, [](float a, float b) { return fromBool(a > b); }); }
+	f32x4 operator<(const f32x4& o) const { return apply(o, [](float a, float b) { return fromBool(a < b); }); }
+
+	int mask() const {
+		return (bits(v[0]) >> 31) | ((bits(v[1]) >> 31) << 1) | ((bits(v[2]) >> 31) << 2) | ((bits(v[3]) >> 31) << 3);
+	}
+
+	friend f32x4 min(const f32x4& a, const f32x4& b) { return a.apply(b, [](float x, float y) { return std::min(x, y); }); }
+	friend f32x4 max(const f32x4& a, const f32x4& b) { return a.apply(b, [](float x, float y) { return std::max(x, y); }); }
+
+	float operator[](int i) const {
+		return v[i];
+	}
+#endif
+
+	f32x4& operator+=(const f32x4& o) { return *this = *this + o; }
+	f32x4& operator*=(const f32x4& o) { return *this = *this * o; }
+
+	f32x4 clamp(float lo, float hi) const {
+		return min(max(*this, f32x4(lo)), f32x4(hi));
+	}
+	// a + (b - a) * t
+	static f32x4 lerp(const f32x4& a, const f32x4& b, const f32x4& t) {
+		return a + (b - a) * t;
+	}
+};
+
+// Unpack a RGBA8888 pixel (R in the lowest byte) into [0, 1] components
+static inline f32x4 unpackColor(u32 c)
+{
+	constexpr float k = 1.f / 255.f;
+	return f32x4((float)(c & 0xff), (float)((c >> 8) & 0xff), (float)((c >> 16) & 0xff), (float)(c >> 24)) * f32x4(k);
+}
+
+// Pack [0, 1] components into a RGBA8888 pixel
+static inline u32 packColor(const f32x4& c)
+{
+	alignas(16) float f[4];
+	(c.clamp(0.f, 1.f) * f32x4(255.f) + f32x4(0.5f)).store(f);
+	return (u32)f[0] | ((u32)f[1] << 8) | ((u32)f[2] << 16) | ((u32)f[3] << 24);
+}
+
+}
@@ -0,0 +1,1025 @@
+/*
+	Copyright 2026 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "softrend.h"
+#include "hw/pvr/ta.h"
+#include "hw/pvr/pvr_mem.h"
+#include "rend/texconv.h"
+#include "util/task_pool.h"
+#include "profiler/benchmark.h"
+#include "cfg/option.h"
+#include <cmath>
+#include <memory>
+
+namespace soft
+{
+
+constexpr float PI = 3.1415926f;
+constexpr int MaxDimension = 2048;
+
+static inline f32x4 withAlpha(const f32x4& c, float a) {
+	return c * f32x4(1.f, 1.f, 1.f, 0.f) + f32x4(0.f, 0.f, 0.f, a);
+}
+
+static inline f32x4 vertexColor(const u8 col[4])
+{
+	u32 c;
+	memcpy(&c, col, sizeof(c));
+	return unpackColor(c);
+}
+
+static inline bool depthTest(u32 mode, float z, float stored)
+{
+	// Larger 1/w is closer
+	switch (mode)
+	{
+	case 0: return false;
+	case 1: return z < stored;
+	case 2: return z == stored;
+	case 3: return z <= stored;
+	case 4: return z > stored;
+	case 5: return z != stored;
+	case 6: return z >= stored;
+	default: return true;
+	}
+}
+
+static inline f32x4 blendFactor(u32 instr, bool srcFactor, const f32x4& src, const f32x4& dst)
+{
+	switch (instr)
+	{
+	case 0: return f32x4(0.f);
+	case 1: return f32x4(1.f);
+	case 2: return srcFactor ? dst : src;
+	case 3: return f32x4(1.f) - (srcFactor ? dst : src);
+	case 4: return f32x4(src[3]);
+	case 5: return f32x4(1.f - src[3]);
+	case 6: return f32x4(dst[3]);
+	default: return f32x4(1.f - dst[3]);
+	}
+}
+
+static inline f32x4 blend(const f32x4& src, const f32x4& dst, u32 srcInstr, u32 dstInstr)
+{
+	return (src * blendFactor(srcInstr, true, src, dst) + dst * blendFactor(dstInstr, false, src, dst)).clamp(0.f, 1.f);
+}
+
+static inline int edgeMask(const f32x4& e, bool topLeft)
+{
+	// Pixels exactly on an edge belong to the triangle only for top and left edges
+	return topLeft ? (e >= f32x4(0.f)).mask() : (e > f32x4(0.f)).mask();
+}
+
+// Calls pixel(index, z) for each pixel of the tile covered by the triangle.
+// Edge functions and depth are evaluated for 4 pixels at a time.
+template<typename Func>
+static void rasterize(const RasterTriangle& tri, int tileX, int tileY, Func pixel)
+{
+	const int tx0 = tileX * TileSize;
+	const int ty0 = tileY * TileSize;
+	const int minX = std::max(tri.minX - tx0, 0);
+	const int maxX = std::min(tri.maxX - tx0, TileSize - 1);
+	const int minY = std::max(tri.minY - ty0, 0);
+	const int maxY = std::min(tri.maxY - ty0, TileSize - 1);
+	if (minX > maxX || minY > maxY)
+		return;
+
+	alignas(16) float ea[4], eb[4], ec[4];
+	tri.edgeA.store(ea);
+	tri.edgeB.store(eb);
+	tri.edgeC.store(ec);
+	const f32x4 a0(ea[0]), a1(ea[1]), a2(ea[2]);
+	const f32x4 za(tri.zA);
+	const bool tl0 = tri.topLeft & 1;
+	const bool tl1 = tri.topLeft & 2;
+	const bool tl2 = tri.topLeft & 4;
+	const int startX = minX & ~3;
+	const f32x4 px0 = f32x4((float)(tx0 + startX)) + f32x4(0.5f, 1.5f, 2.5f, 3.5f);
+
+	for (int y = minY; y <= maxY; y++)
+	{
+		const float py = (float)(ty0 + y) + 0.5f;
+		const f32x4 c0(eb[0] * py + ec[0]);
+		const f32x4 c1(eb[1] * py + ec[1]);
+		const f32x4 c2(eb[2] * py + ec[2]);
+		const f32x4 cz(tri.zB * py + tri.zC);
+		f32x4 px = px0;
+		for (int x = startX; x <= maxX; x += 4, px += f32x4(4.f))
+		{
+			int mask = edgeMask(a0 * px + c0, tl0) & edgeMask(a1 * px + c1, tl1) & edgeMask(a2 * px + c2, tl2);
+			if (x < minX)
+				mask &= 0xf << (minX - x);
+			if (x + 3 > maxX)
+				mask &= 0xf >> (x + 3 - maxX);
+			if (mask == 0)
+				continue;
+			alignas(16) float z[4];
+			(za * px + cz).store(z);
+			const int index = y * TileSize + x;
+			for (int l = 0; l < 4; l++)
+				if (mask & (1 << l))
+					pixel(index + l, z[l]);
+		}
+	}
+}
+
+bool SoftRenderer::Init()
+{
+	INFO_LOG(RENDERER, "Software renderer initialized");
+	return true;
+}
+
+void SoftRenderer::Term()
+{
+	texCache.Clear();
+	framebuffer = {};
+	triangles = {};
+	mvTriangles = {};
+	tileTriangles = {};
+	tileMvTriangles = {};
+	lastFrame = {};
+}
+
+void SoftRenderer::Process(TA_context *ctx)
+{
+	if (resetTextureCache) {
+		texCache.Clear();
+		resetTextureCache = false;
+	}
+	if (updatePalette) {
+		memcpy(palette, palette32_ram, sizeof(palette));
+		updatePalette = false;
+	}
+	if (updateFogTable) {
+		MakeFogTexture(fogTable.data());
+		updateFogTable = false;
+	}
+	ta_parse(ctx, true);
+}
+
+BaseTextureCacheData *SoftRenderer::GetTexture(TSP tsp, TCW tcw)
+{
+	Texture *texture = texCache.getTextureCacheData(tsp, tcw);
+	if (texture->NeedsUpdate())
+	{
+		if (!texture->Update())
+			texture = nullptr;
+	}
+	else if (texture->IsCustomTextureAvailable())
+	{
+		texture->CheckCustomTexture();
+	}
+	return texture;
+}
+
+bool SoftRenderer::setupEdges(RasterTriangle& tri, const float x[3], const float y[3], float area) const
+{
+	float fminX = std::min({ x[0], x[1], x[2] });
+	float fmaxX = std::max({ x[0], x[1], x[2] });
+	float fminY = std::min({ y[0], y[1], y[2] });
+	float fmaxY = std::max({ y[0], y[1], y[2] });
+	// Pixels are covered if their center is inside
+	tri.minX = std::max((int)std::ceil(std::max(fminX - 0.5f, -1.f)), clipMinX);
+	tri.maxX = std::min((int)std::floor(std::min(fmaxX - 0.5f, (float)MaxDimension)), clipMaxX);
+	tri.minY = std::max((int)std::ceil(std::max(fminY - 0.5f, -1.f)), clipMinY);
+	tri.maxY = std::min((int)std::floor(std::min(fmaxY - 0.5f, (float)MaxDimension)), clipMaxY);
+	if (tri.minX > tri.maxX || tri.minY > tri.maxY)
+		return false;
+
+	// Orient the edges so that the inside is positive
+	const float sign = area > 0.f ? 1.f : -1.f;
+	alignas(16) float ea[4] {}, eb[4] {}, ec[4] {};
+	tri.topLeft = 0;
+	for (int i = 0; i < 3; i++)
+	{
+		const int j = (i + 1) % 3;
+		ea[i] = (y[i] - y[j]) * sign;
+		eb[i] = (x[j] - x[i]) * sign;
+		ec[i] = -(ea[i] * x[i] + eb[i] * y[i]);
+		// y axis is pointing down
+		if (ea[i] > 0.f || (ea[i] == 0.f && eb[i] > 0.f))
+			tri.topLeft |= 1 << i;
+	}
+	tri.edgeA = f32x4::load(ea);
+	tri.edgeB = f32x4::load(eb);
+	tri.edgeC = f32x4::load(ec);
+
+	return true;
+}
+
+void SoftRenderer::setupTriangle(const PolyParam& pp, const Vertex& v0, const Vertex& v1, const Vertex& v2, u32 parity)
+{
+	// Also rejects NaNs
+	if (!(v0.z > 0.f && v1.z > 0.f && v2.z > 0.f))
+		return;
+	const float dx1 = v1.x - v0.x;
+	const float dy1 = v1.y - v0.y;
+	const float dx2 = v2.x - v0.x;
+	const float dy2 = v2.y - v0.y;
+	const float area = dx1 * dy2 - dx2 * dy1;
+	if (area == 0.f || std::isnan(area))
+		return;
+	// Culling
+	const u32 cullMode = pp.isp.CullMode;
+	if (cullMode != 0)
+	{
+		if (std::abs(area) < cullValue)
+			return;
+		if (cullMode >= 2)
+		{
+			const u32 mode = parity ^ (cullMode & 1);
+			if ((mode == 0 && area < 0.f) || (mode == 1 && area > 0.f))
+				return;
+		}
+	}
+
+	Triangle tri;
+	const float x[3] { v0.x, v1.x, v2.x };
+	const float y[3] { v0.y, v1.y, v2.y };
+	if (!setupEdges(tri, x, y, area))
+		return;
+
+	// Tile clipping
+	tri.clipInside = false;
+	const u32 clipMode = pp.tileclip >> 28;
+	if (config::Clipping && clipMode >= 2)
+	{
+		const int csx = (pp.tileclip & 63) * 32;
+		const int cex = (((pp.tileclip >> 6) & 63) + 1) * 32;
+		const int csy = ((pp.tileclip >> 12) & 31) * 32;
+		const int cey = (((pp.tileclip >> 17) & 31) + 1) * 32;
+		if (clipMode & 1)
+		{
+			// Pixels inside the region are discarded
+			tri.clipInside = true;
+			tri.clipRect[0] = csx;
+			tri.clipRect[1] = csy;
+			tri.clipRect[2] = cex;
+			tri.clipRect[3] = cey;
+		}
+		else
+		{
+			// Only pixels inside the region are rendered
+			tri.minX = std::max(tri.minX, csx);
+			tri.maxX = std::min(tri.maxX, cex - 1);
+			tri.minY = std::max(tri.minY, csy);
+			tri.maxY = std::min(tri.maxY, cey - 1);
+			if (tri.minX > tri.maxX || tri.minY > tri.maxY)
+				return;
+		}
+	}
+
+	// Attribute planes
+	const float invArea = 1.f / area;
+	const f32x4 fdx1(dx1), fdy1(dy1), fdx2(dx2), fdy2(dy2), fInvArea(invArea);
+	const f32x4 fx0(v0.x), fy0(v0.y);
+	auto plane = [&](const f32x4& f0, const f32x4& f1, const f32x4& f2, f32x4& a, f32x4& b, f32x4& c)
+	{
+		const f32x4 d1 = f1 - f0;
+		const f32x4 d2 = f2 - f0;
+		a = (d1 * fdy2 - d2 * fdy1) * fInvArea;
+		b = (d2 * fdx1 - d1 * fdx2) * fInvArea;
+		c = f0 - a * fx0 - b * fy0;
+	};
+	const f32x4 z0(v0.z), z1(v1.z), z2(v2.z);
+	f32x4 za, zb, zc;
+	plane(f32x4(v0.z, v0.u * v0.z, v0.v * v0.z, 0.f), f32x4(v1.z, v1.u * v1.z, v1.v * v1.z, 0.f),
+			f32x4(v2.z, v2.u * v2.z, v2.v * v2.z, 0.f), za, zb, zc);
+	tri.zA = za[0];
+	tri.zB = zb[0];
+	tri.zC = zc[0];
+	tri.uvA = za;
+	tri.uvB = zb;
+	tri.uvC = zc;
+	if (pp.pcw.Gouraud)
+	{
+		plane(vertexColor(v0.col) * z0, vertexColor(v1.col) * z1, vertexColor(v2.col) * z2, tri.colA, tri.colB, tri.colC);
+		plane(vertexColor(v0.spc) * z0, vertexColor(v1.spc) * z1, vertexColor(v2.spc) * z2, tri.spcA, tri.spcB, tri.spcC);
+	}
+	else
+	{
+		// Flat shading uses the last vertex. color/w is proportional to 1/w.
+		const f32x4 col = vertexColor(v2.col);
+		const f32x4 spc = vertexColor(v2.spc);
+		const f32x4 fza(tri.zA), fzb(tri.zB), fzc(tri.zC);
+		tri.colA = col * fza;
+		tri.colB = col * fzb;
+		tri.colC = col * fzc;
+		tri.spcA = spc * fza;
+		tri.spcB = spc * fzb;
+		tri.spcC = spc * fzc;
+	}
+
+	tri.pp = &pp;
+	tri.texture = nullptr;
+	tri.mipLevel = 0;
+	tri.palette = palette;
+	if (pp.pcw.Texture && pp.texture != nullptr)
+	{
+		const Texture *texture = static_cast<const Texture *>(pp.texture);
+		if (texture->getLevelCount() > 0)
+		{
+			tri.texture = texture;
+			if (pp.tcw.PixelFmt == PixelPal4)
+				tri.palette = &palette[pp.tcw.PalSelect << 4];
+			else if (pp.tcw.PixelFmt == PixelPal8)
+				tri.palette = &palette[(pp.tcw.PalSelect >> 4) << 8];
+			if (texture->getLevelCount() > 1)
+			{
+				// One mipmap level per triangle, from the ratio of texel to pixel area
+				const float du1 = (v1.u - v0.u) * texture->getWidth();
+				const float dv1 = (v1.v - v0.v) * texture->getHeight();
+				const float du2 = (v2.u - v0.u) * texture->getWidth();
+				const float dv2 = (v2.v - v0.v) * texture->getHeight();
+				const float texArea = std::abs(du1 * dv2 - du2 * dv1);
+				if (texArea > 0.f)
+				{
+					const float lod = 0.5f * std::log2(texArea / std::abs(area)) + D_Adjust_LoD_Bias[pp.tsp.MipMapD];
+					tri.mipLevel = (u8)std::clamp((int)std::lround(lod), 0, (int)texture->getLevelCount() - 1);
+				}
+			}
+		}
+	}
+	triangles.push_back(tri);
+}
+
+void SoftRenderer::setupPolys(const std::vector<PolyParam>& polys, u32 first, u32 count)
+{
+	const Vertex *verts = pvrrc.verts.data();
+	const u32 *idx = pvrrc.idx.data();
+	for (u32 i = first; i < first + count; i++)
+	{
+		const PolyParam& pp = polys[i];
+		// Naomi 2 geometry is transformed on the GPU
+		if (pp.count < 3 || pp.isNaomi2())
+			continue;
+		u32 parity = 0;
+		u32 n = 0;
+		u32 a = 0, b = 0;
+		for (u32 j = pp.first; j < pp.first + pp.count; j++)
+		{
+			const u32 k = idx[j];
+			if (k == ~0u)
+			{
+				// primitive restart
+				n = 0;
+				parity = 0;
+				continue;
+			}
+			if (n >= 2)
+			{
+				setupTriangle(pp, verts[a], verts[b], verts[k], parity);
+				parity ^= 1;
+			}
+			a = b;
+			b = k;
+			n++;
+		}
+	}
+}
+
+void SoftRenderer::setupModVolTriangle(const ModTriangle& mt, u32 cullMode, ModVolTriangle& tri)
+{
+	if (!(mt.z0 > 0.f && mt.z1 > 0.f && mt.z2 > 0.f))
+		return;
+	const float dx1 = mt.x1 - mt.x0;
+	const float dy1 = mt.y1 - mt.y0;
+	const float dx2 = mt.x2 - mt.x0;
+	const float dy2 = mt.y2 - mt.y0;
+	const float area = dx1 * dy2 - dx2 * dy1;
+	if (area == 0.f || std::isnan(area))
+		return;
+	const float x[3] { mt.x0, mt.x1, mt.x2 };
+	const float y[3] { mt.y0, mt.y1, mt.y2 };
+	if (!setupEdges(tri, x, y, area))
+	{
+		tri.minX = 1;
+		tri.maxX = 0;
+		return;
+	}
+	const float dz1 = mt.z1 - mt.z0;
+	const float dz2 = mt.z2 - mt.z0;
+	tri.zA = (dz1 * dy2 - dz2 * dy1) / area;
+	tri.zB = (dz2 * dx1 - dz1 * dx2) / area;
+	tri.zC = mt.z0 - tri.zA * mt.x0 - tri.zB * mt.y0;
+	tri.culled = cullMode >= 2 && (((cullMode & 1) == 0 && area < 0.f) || ((cullMode & 1) == 1 && area > 0.f));
+}
+
+void SoftRenderer::setupModVols()
+{
+	mvTriangles.resize(pvrrc.modtrig.size());
+	for (ModVolTriangle& tri : mvTriangles)
+	{
+		// not rasterized
+		tri.minX = 1;
+		tri.maxX = 0;
+	}
+	if (!config::ModifierVolumes)
+		return;
+	for (const auto *list : { &pvrrc.global_param_mvo, &pvrrc.global_param_mvo_tr })
+		for (const ModifierVolumeParam& param : *list)
+		{
+			if (param.isNaomi2())
+				continue;
+			for (u32 i = param.first; i < param.first + param.count && i < mvTriangles.size(); i++)
+				setupModVolTriangle(pvrrc.modtrig[i], param.isp.CullMode, mvTriangles[i]);
+		}
+}
+
+template<typename T>
+static void binTriangles(const std::vector<T>& triangles, std::vector<std::vector<u32>>& tiles, int tilesX)
+{
+	for (auto& list : tiles)
+		list.clear();
+	for (u32 i = 0; i < triangles.size(); i++)
+	{
+		const RasterTriangle& tri = triangles[i];
+		if (tri.minX > tri.maxX)
+			continue;
+		alignas(16) float ea[4], eb[4], ec[4];
+		tri.edgeA.store(ea);
+		tri.edgeB.store(eb);
+		tri.edgeC.store(ec);
+		for (int ty = tri.minY / TileSize; ty <= tri.maxY / TileSize; ty++)
+		{
+			const float y0 = ty * TileSize + 0.5f;
+			const float y1 = y0 + TileSize - 1;
+			for (int tx = tri.minX / TileSize; tx <= tri.maxX / TileSize; tx++)
+			{
+				// Reject the tile if all its pixels are outside of one edge
+				const float x0 = tx * TileSize + 0.5f;
+				const float x1 = x0 + TileSize - 1;
+				bool outside = false;
+				for (int e = 0; e < 3 && !outside; e++)
+					outside = ea[e] * (ea[e] > 0.f ? x1 : x0) + eb[e] * (eb[e] > 0.f ? y1 : y0) + ec[e] < 0.f;
+				if (!outside)
+					tiles[ty * tilesX + tx].push_back(i);
+			}
+		}
+	}
+}
+
+void SoftRenderer::binTriangles()
+{
+	const size_t tileCount = tilesX * tilesY;
+	tileTriangles.resize(tileCount);
+	tileMvTriangles.resize(tileCount);
+	soft::binTriangles(triangles, tileTriangles, tilesX);
+	soft::binTriangles(mvTriangles, tileMvTriangles, tilesX);
+}
+
+float SoftRenderer::fogFactor(float invW) const
+{
+	const float z = std::clamp(fogDensity * invW, 1.f, 255.9999f);
+	int exp;
+	std::frexp(z, &exp);
+	exp--;	// floor(log2(z))
+	const float m = std::ldexp(z, 4 - exp) - 16.f;
+	const int idx = std::min((int)m + exp * 16, 127);
+	// Interpolate between the 2 values of the table entry like the GPU renderers do
+	const float frac = m - std::floor(m);
+	return (fogTable[idx + 128] + (fogTable[idx] - fogTable[idx + 128]) * frac) / 255.f;
+}
+
+template<bool AlphaTest>
+bool SoftRenderer::shadePixel(const Triangle& tri, float x, float y, float z, f32x4& color) const
+{
+	const f32x4 fx(x);
+	const f32x4 fy(y);
+	const float w = 1.f / z;
+	const f32x4 fw(w);
+	const PolyParam& pp = *tri.pp;
+	const TSP tsp = pp.tsp;
+	const u32 fogCtrl = fogEnabled ? tsp.FogCtrl : 2;
+	const bool bumpMap = tri.texture != nullptr && pp.tcw.PixelFmt == PixelBumpMap;
+	const bool offset = pp.pcw.Offset && !bumpMap;
+
+	color = (tri.colA * fx + tri.colB * fy + tri.colC) * fw;
+	f32x4 offsetColor(0.f);
+	if (pp.pcw.Offset)
+		offsetColor = (tri.spcA * fx + tri.spcB * fy + tri.spcC) * fw;
+	if (!tsp.UseAlpha)
+		color = withAlpha(color, 1.f);
+	if (fogCtrl == 3)
+		color = withAlpha(fogColRam, fogFactor(z));
+
+	if (tri.texture != nullptr)
+	{
+		alignas(16) float uv[4];
+		((tri.uvA * fx + tri.uvB * fy + tri.uvC) * fw).store(uv);
+		f32x4 texcol = tri.texture->sample(uv[1], uv[2], tri.mipLevel, tsp, tri.palette);
+		if (bumpMap)
+		{
+			alignas(16) float tc[4], oc[4];
+			texcol.store(tc);
+			offsetColor.store(oc);
+			const float s = PI / 2.f * (tc[3] * 15.f * 16.f + tc[0] * 15.f) / 255.f;
+			const float r = 2.f * PI * (tc[1] * 15.f * 16.f + tc[2] * 15.f) / 255.f;
+			const float a = std::clamp(oc[3] + oc[0] * std::sin(s) + oc[1] * std::cos(s) * std::cos(r - 2.f * PI * oc[2]), 0.f, 1.f);
+			texcol = f32x4(1.f, 1.f, 1.f, a);
+		}
+		else if (tsp.IgnoreTexA)
+		{
+			texcol = withAlpha(texcol, 1.f);
+		}
+		switch (tsp.ShadInstr)
+		{
+		case 0:	// decal
+			color = texcol;
+			break;
+		case 1:	// modulate
+			color = withAlpha(color * texcol, texcol[3]);
+			break;
+		case 2:	// decal alpha
+			{
+				const float ta = texcol[3];
+				color = f32x4::lerp(color, texcol, f32x4(ta, ta, ta, 0.f));
+			}
+			break;
+		case 3:	// modulate alpha
+			color *= texcol;
+			break;
+		}
+		if (offset)
+			color += offsetColor * f32x4(1.f, 1.f, 1.f, 0.f);
+	}
+
+	if (tsp.ColorClamp)
+		color = min(max(color, fogClampMin), fogClampMax);
+
+	if (fogCtrl == 0)
+	{
+		const float f = fogFactor(z);
+		color = f32x4::lerp(color, fogColRam, f32x4(f, f, f, 0.f));
+	}
+	else if (fogCtrl == 1 && offset)
+	{
+		const float f = offsetColor[3];
+		color = f32x4::lerp(color, fogColVert, f32x4(f, f, f, 0.f));
+	}
+
+	if (AlphaTest)
+	{
+		if (std::floor(color[3] * 255.f + 0.5f) < ptAlphaRef)
+			return false;
+		color = withAlpha(color, 1.f);
+	}
+	color = color.clamp(0.f, 1.f);
+
+	return true;
+}
+
+template<u32 ListType>
+void SoftRenderer::drawTriangle(const Triangle& tri, int tileX, int tileY, TileBuffer& tile) const
+{
+	const PolyParam& pp = *tri.pp;
+	// Z write disable is ignored for punch-through
+	const u32 depthMode = ListType == ListType_Punch_Through ? 6 : pp.isp.DepthMode;
+	const bool zwrite = ListType == ListType_Punch_Through || !pp.isp.ZWriteDis;
+	const u8 shadow = pp.pcw.Shadow ? 0x80 : 0;
+	const int tx0 = tileX * TileSize;
+	const int ty0 = tileY * TileSize;
+
+	rasterize(tri, tileX, tileY, [&](int index, float z)
+	{
+		if (!depthTest(depthMode, z, tile.depth[index]))
+			return;
+		const int x = tx0 + index % TileSize;
+		const int y = ty0 + index / TileSize;
+		if (tri.clipInside && x >= tri.clipRect[0] && x < tri.clipRect[2] && y >= tri.clipRect[1] && y < tri.clipRect[3])
+			return;
+		f32x4 color;
+		if (!shadePixel<ListType == ListType_Punch_Through>(tri, x + 0.5f, y + 0.5f, z, color))
+			return;
+		if (ListType == ListType_Translucent)
+			color = blend(color, unpackColor(tile.color[index]), pp.tsp.SrcInstr, pp.tsp.DstInstr);
+		else
+			tile.stencil[index] = (tile.stencil[index] & 0x7f) | shadow;
+		tile.color[index] = packColor(color);
+		if (zwrite)
+			tile.depth[index] = z;
+	});
+}
+
+void SoftRenderer::drawSortedTriangle(const Triangle& tri, int tileX, int tileY, TileBuffer& tile) const
+{
+	const PolyParam& pp = *tri.pp;
+	const u8 shadow = pp.pcw.Shadow ? 0x80 : 0;
+	const int tx0 = tileX * TileSize;
+	const int ty0 = tileY * TileSize;
+
+	rasterize(tri, tileX, tileY, [&](int index, float z)
+	{
+		// Depth test against the opaque geometry only
+		if (z < tile.depth[index])
+			return;
+		const int x = tx0 + index % TileSize;
+		const int y = ty0 + index / TileSize;
+		if (tri.clipInside && x >= tri.clipRect[0] && x < tri.clipRect[2] && y >= tri.clipRect[1] && y < tri.clipRect[3])
+			return;
+		f32x4 color;
+		if (!shadePixel<false>(tri, x + 0.5f, y + 0.5f, z, color))
+			return;
+		tile.fragments.push_back(Fragment{ z, packColor(color), tile.fragHead[index], (u8)pp.tsp.SrcInstr, (u8)pp.tsp.DstInstr, shadow });
+		tile.fragHead[index] = (u32)tile.fragments.size() - 1;
+	});
+}
+
+void SoftRenderer::resolveFragments(TileBuffer& tile) const
+{
+	const std::vector<Fragment>& fragments = tile.fragments;
+	std::vector<u32>& list = tile.sortList;
+	for (int index = 0; index < TilePixels; index++)
+	{
+		if (tile.fragHead[index] == NoFragment)
+			continue;
+		list.clear();
+		for (u32 f = tile.fragHead[index]; f != NoFragment; f = fragments[f].next)
+			list.push_back(f);
+		// Fragments are linked newest first. Sort them back to front, keeping the submission order for equal depths.
+		std::reverse(list.begin(), list.end());
+		std::stable_sort(list.begin(), list.end(), [&fragments](u32 a, u32 b) {
+			return fragments[a].z < fragments[b].z;
+		});
+		const f32x4 scale(shadowScale, shadowScale, shadowScale, 1.f);
+		f32x4 color = unpackColor(tile.color[index]);
+		for (u32 f : list)
+		{
+			const Fragment& frag = fragments[f];
+			f32x4 src = unpackColor(frag.color);
+			// Shadowed fragment inside a translucent modifier volume
+			if ((frag.stencil & 0x81) == 0x81)
+				src = src * scale;
+			color = blend(src, color, frag.srcInstr, frag.dstInstr);
+		}
+		tile.color[index] = packColor(color);
+	}
+}
+
+// Same logic as the OpenGL stencil implementation:
+// bit 1 is set if the stencil is inside the current volume, bit 0 if it's inside the summed volumes.
+// forEachStencil(index, func) calls func(stencil, depth) for each stencil of the pixel: one for the opaque
+// geometry, one per fragment for translucent polygons.
+template<typename ForEach>
+void SoftRenderer::drawModVols(const ModifierVolumeParam *params, u32 count, const std::vector<u32>& mvTris, size_t& cursor,
+		int tileX, int tileY, TileBuffer& tile, ForEach forEachStencil) const
+{
+	size_t volumeStart = cursor;
+	bool volumeStarted = false;
+	for (u32 i = 0; i < count; i++)
+	{
+		const ModifierVolumeParam& param = params[i];
+		if (param.count == 0)
+			continue;
+		while (cursor < mvTris.size() && mvTris[cursor] < param.first)
+			cursor++;
+		if (!volumeStarted)
+		{
+			volumeStart = cursor;
+			volumeStarted = true;
+		}
+		const u32 mode = param.isp.DepthMode;
+		const bool orMode = !param.isp.VolumeLast && mode > 0;	// open volume or quad
+		for (; cursor < mvTris.size() && mvTris[cursor] < param.first + param.count; cursor++)
+		{
+			const ModVolTriangle& tri = mvTriangles[mvTris[cursor]];
+			if (tri.culled)
+				continue;
+			// Count the triangles in front
+			rasterize(tri, tileX, tileY, [&](int index, float z) {
+				forEachStencil(index, [z, orMode](u8& s, float depth) {
+					if (z > depth)
+						s = orMode ? s | 2 : s ^ 2;
+				});
+			});
+		}
+		if (mode == 1 || mode == 2)
+		{
+			// Sum the area covered by the volume
+			std::fill(std::begin(tile.coverage), std::end(tile.coverage), false);
+			for (size_t c = volumeStart; c < cursor; c++)
+				rasterize(mvTriangles[mvTris[c]], tileX, tileY, [&](int index, float) {
+					tile.coverage[index] = true;
+				});
+			for (int index = 0; index < TilePixels; index++)
+			{
+				if (!tile.coverage[index])
+					continue;
+				forEachStencil(index, [mode](u8& s, float) {
+					const bool inside = s & 2;
+					const bool result = mode == 1 ? inside || (s & 1) : !inside && (s & 1);
+					s = (s & 0x80) | (result ? 1 : 0);
+				});
+			}
+			volumeStarted = false;
+		}
+	}
+}
+
+void SoftRenderer::renderTile(int tileX, int tileY, TileBuffer& tile) const
+{
+	const int x0 = tileX * TileSize;
+	const int y0 = tileY * TileSize;
+	const int w = std::min(TileSize, width - x0);
+	const int h = std::min(TileSize, height - y0);
+	for (int y = 0; y < h; y++)
+		memcpy(&tile.color[y * TileSize], &framebuffer[(y0 + y) * width + x0], w * sizeof(u32));
+	std::fill(std::begin(tile.depth), std::end(tile.depth), 0.f);
+	std::fill(std::begin(tile.stencil), std::end(tile.stencil), 0);
+
+	const std::vector<u32>& tris = tileTriangles[tileY * tilesX + tileX];
+	const std::vector<u32>& mvTris = tileMvTriangles[tileY * tilesX + tileX];
+	size_t cursor = 0;
+	size_t mvCursor = 0;
+	size_t mvTrCursor = 0;
+	for (size_t p = 0; p < passes.size(); p++)
+	{
+		const PassInfo& pass = passes[p];
+		size_t sharedCursor = mvCursor;
+		if (p > 0 && pass.zClear)
+			std::fill(std::begin(tile.depth), std::end(tile.depth), 0.f);
+
+		for (; cursor < tris.size() && tris[cursor] < pass.opEnd; cursor++)
+			drawTriangle<ListType_Opaque>(triangles[tris[cursor]], tileX, tileY, tile);
+		for (; cursor < tris.size() && tris[cursor] < pass.ptEnd; cursor++)
+			drawTriangle<ListType_Punch_Through>(triangles[tris[cursor]], tileX, tileY, tile);
+
+		if (pass.mvCount > 0 && config::ModifierVolumes)
+		{
+			drawModVols(&pvrrc.global_param_mvo[pass.mvFirst], pass.mvCount, mvTris, mvCursor, tileX, tileY, tile,
+				[&tile](int index, auto func) {
+					func(tile.stencil[index], tile.depth[index]);
+				});
+			// Darken the shadowed polygons inside the volumes
+			const f32x4 scale(shadowScale, shadowScale, shadowScale, 1.f);
+			for (int index = 0; index < TilePixels; index++)
+			{
+				if ((tile.stencil[index] & 0x81) == 0x81)
+					tile.color[index] = packColor(unpackColor(tile.color[index]) * scale);
+				tile.stencil[index] &= 0x80;
+			}
+		}
+
+		if (pass.autosort)
+		{
+			std::fill(std::begin(tile.fragHead), std::end(tile.fragHead), NoFragment);
+			tile.fragments.clear();
+			for (; cursor < tris.size() && tris[cursor] < pass.trEnd; cursor++)
+				drawSortedTriangle(triangles[tris[cursor]], tileX, tileY, tile);
+			if (!tile.fragments.empty())
+			{
+				const u32 mvTrCount = pass.mvTrShared ? pass.mvCount : pass.mvTrCount;
+				if (mvTrCount > 0 && config::ModifierVolumes)
+				{
+					const ModifierVolumeParam *params = pass.mvTrShared ? &pvrrc.global_param_mvo[pass.mvFirst]
+							: &pvrrc.global_param_mvo_tr[pass.mvTrFirst];
+					// Volume triangles are visited again if they're shared with the opaque volumes
+					size_t& trCursor = pass.mvTrShared ? sharedCursor : mvTrCursor;
+					drawModVols(params, mvTrCount, mvTris, trCursor, tileX, tileY, tile,
+						[&tile](int index, auto func) {
+							for (u32 f = tile.fragHead[index]; f != NoFragment; f = tile.fragments[f].next)
+								func(tile.fragments[f].stencil, tile.fragments[f].z);
+						});
+				}
+				resolveFragments(tile);
+			}
+		}
+		else
+		{
+			for (; cursor < tris.size() && tris[cursor] < pass.trEnd; cursor++)
+				drawTriangle<ListType_Translucent>(triangles[tris[cursor]], tileX, tileY, tile);
+		}
+	}
+
+	// Tiles don't overlap so they can be written concurrently
+	u32 *dst = const_cast<u32 *>(&framebuffer[y0 * width + x0]);
+	for (int y = 0; y < h; y++)
+		memcpy(&dst[y * width], &tile.color[y * TileSize], w * sizeof(u32));
+}
+
+bool SoftRenderer::Render()
+{
+	const auto startTime = std::chrono::steady_clock::now();
+	texCache.CollectCleanup();
+
+	if (pvrrc.isRTT)
+	{
+		width = pvrrc.getFramebufferWidth();
+		height = pvrrc.getFramebufferHeight();
+		clipMinX = pvrrc.getFramebufferMinX();
+		clipMinY = pvrrc.getFramebufferMinY();
+		clipMaxX = width - 1;
+		clipMaxY = height - 1;
+	}
+	else
+	{
+		width = (pvrrc.ta_GLOB_TILE_CLIP.tile_x_num + 1) * TileSize;
+		height = (pvrrc.ta_GLOB_TILE_CLIP.tile_y_num + 1) * TileSize;
+		clipMinX = pvrrc.fb_X_CLIP.min;
+		clipMinY = pvrrc.fb_Y_CLIP.min;
+		clipMaxX = std::min<int>(pvrrc.fb_X_CLIP.max, width - 1);
+		clipMaxY = std::min<int>(pvrrc.fb_Y_CLIP.max, height - 1);
+	}
+	if (width <= 0 || height <= 0 || width > MaxDimension || height > MaxDimension)
+	{
+		WARN_LOG(RENDERER, "Software renderer: invalid frame size %d x %d", width, height);
+		return false;
+	}
+	tilesX = (width + TileSize - 1) / TileSize;
+	tilesY = (height + TileSize - 1) / TileSize;
+
+	// The background polygon clears the rest
+	if (pvrrc.isRTT)
+		framebuffer.assign(width * height, 0);
+	else if (pvrrc.clearFramebuffer || framebuffer.size() != (size_t)(width * height))
+		framebuffer.assign(width * height, (u32)VO_BORDER_COL._red | (VO_BORDER_COL._green << 8) | (VO_BORDER_COL._blue << 16) | 0xff000000);
+
+	// Frame-constant state
+	float rgba[4];
+	FOG_COL_RAM.getRGBColor(rgba);
+	fogColRam = f32x4(rgba[0], rgba[1], rgba[2], 1.f);
+	FOG_COL_VERT.getRGBColor(rgba);
+	fogColVert = f32x4(rgba[0], rgba[1], rgba[2], 1.f);
+	pvrrc.fog_clamp_min.getRGBAColor(rgba);
+	fogClampMin = f32x4::loadu(rgba);
+	pvrrc.fog_clamp_max.getRGBAColor(rgba);
+	fogClampMax = f32x4::loadu(rgba);
+	fogDensity = FOG_DENSITY.get() * config::ExtraDepthScale;
+	fogEnabled = config::Fog;
+	ptAlphaRef = (float)(PT_ALPHA_REF & 0xff);
+	shadowScale = FPU_SHAD_SCALE.scale_factor / 256.f;
+	cullValue = FPU_CULL_VAL;
+
+	// Triangle setup. Triangles are stored in drawing order.
+	triangles.clear();
+	passes.clear();
+	RenderPass previousPass {};
+	for (const RenderPass& pass : pvrrc.render_passes)
+	{
+		PassInfo info {};
+		setupPolys(pvrrc.global_param_op, previousPass.op_count, pass.op_count - previousPass.op_count);
+		info.opEnd = triangles.size();
+		setupPolys(pvrrc.global_param_pt, previousPass.pt_count, pass.pt_count - previousPass.pt_count);
+		info.ptEnd = triangles.size();
+		setupPolys(pvrrc.global_param_tr, previousPass.tr_count, pass.tr_count - previousPass.tr_count);
+		info.trEnd = triangles.size();
+		info.mvFirst = previousPass.mvo_count;
+		info.mvCount = pass.mvo_count - previousPass.mvo_count;
+		info.mvTrFirst = previousPass.mvo_tr_count;
+		info.mvTrCount = pass.mvo_tr_count - previousPass.mvo_tr_count;
+		info.mvTrShared = pass.mv_op_tr_shared;
+		info.autosort = pass.autosort;
+		info.zClear = pass.z_clear;
+		passes.push_back(info);
+		previousPass = pass;
+	}
+	setupModVols();
+	binTriangles();
+
+	TaskPool::instance().parallelFor(0, tilesX * tilesY, [this](int start, int end)
+	{
+		thread_local std::unique_ptr<TileBuffer> tile;
+		if (tile == nullptr)
+			tile = std::make_unique<TileBuffer>();
+		for (int t = start; t < end; t++)
+			renderTile(t % tilesX, t / tilesX, *tile);
+	});
+
+	writeOutput();
+	if (benchmark::active())
+		benchmark::frameRendered(std::chrono::steady_clock::now() - startTime);
+
+	return !pvrrc.isRTT;
+}
+
+void SoftRenderer::writeOutput()
+{
+	if (pvrrc.isRTT)
+	{
+		u32 linestride = pvrrc.fb_W_LINESTRIDE * 8;
+		if (linestride == 0)
+			linestride = width * 2;
+		const u32 texAddr = pvrrc.fb_W_SOF1 & VRAM_MASK;
+		WriteTextureToVRam(width, height, (const u8 *)framebuffer.data(), (u16 *)&vram[texAddr], pvrrc.fb_W_CTRL, linestride);
+		return;
+	}
+
+	// Apply the horizontal and vertical scaling
+	const bool halfWidth = pvrrc.scaler_ctl.hscale == 1;
+	float yscale = 1024.f / pvrrc.scaler_ctl.vscalefactor;
+	if (std::abs(yscale - 1.f) < 0.01f)
+		yscale = 1.f;
+	const int outWidth = halfWidth ? width / 2 : width;
+	const int outHeight = (int)(height * yscale);
+	lastFrame.resize(outWidth * outHeight);
+	for (int y = 0; y < outHeight; y++)
+	{
+		const u32 *src = &framebuffer[std::min((int)(y / yscale), height - 1) * width];
+		u32 *dst = &lastFrame[y * outWidth];
+		if (halfWidth)
+		{
+			for (int x = 0; x < outWidth; x++)
+				dst[x] = packColor((unpackColor(src[x * 2]) + unpackColor(src[x * 2 + 1])) * f32x4(0.5f));
+		}
+		else
+		{
+			memcpy(dst, src, outWidth * sizeof(u32));
+		}
+	}
+	lastFrameWidth = outWidth;
+	lastFrameHeight = outHeight;
+
+	if (config::EmulateFramebuffer)
+	{
+		FB_X_CLIP_type xClip = pvrrc.fb_X_CLIP;
+		FB_Y_CLIP_type yClip = pvrrc.fb_Y_CLIP;
+		// FB_Y_CLIP is applied before vscalefactor if > 1
+		if (yscale > 1.f)
+		{
+			yClip.min = std::round(yClip.min * yscale);
+			yClip.max = std::round(yClip.max * yscale);
+		}
+		xClip.min = std::min<u32>(xClip.min, outWidth - 1);
+		xClip.max = std::min<u32>(xClip.max, outWidth - 1);
+		yClip.min = std::min<u32>(yClip.min, outHeight - 1);
+		yClip.max = std::min<u32>(yClip.max, outHeight - 1);
+		const u32 texAddr = pvrrc.fb_W_SOF1 & VRAM_MASK;
+		WriteFramebuffer(outWidth, outHeight, (const u8 *)lastFrame.data(), texAddr, pvrrc.fb_W_CTRL,
+				pvrrc.fb_W_LINESTRIDE * 8, xClip, yClip);
+	}
+}
+
+void SoftRenderer::RenderFramebuffer(const FramebufferInfo& info)
+{
+	PixelBuffer<u32> pb;
+	int w, h;
+	ReadFramebuffer(info, pb, w, h);
+	lastFrame.assign(pb.data(), pb.data() + w * h);
+	lastFrameWidth = w;
+	lastFrameHeight = h;
+}
+
+bool SoftRenderer::GetLastFrame(std::vector<u8>& data, int& width, int& height)
+{
+	if (lastFrame.empty())
+		return false;
+	const bool rotate = config::Rotate90;
+	const int srcW = rotate ? lastFrameHeight : lastFrameWidth;
+	const int srcH = rotate ? lastFrameWidth : lastFrameHeight;
+	const float aspectRatio = rotate ? 3.f / 4.f : 4.f / 3.f;
+	if (width != 0) {
+		height = width / aspectRatio;
+	}
+	else if (height != 0) {
+		width = aspectRatio * height;
+	}
+	else
+	{
+		width = srcW;
+		height = srcH;
+		// Square pixels
+		const int w = aspectRatio * height;
+		if (width > w)
+			height = width / aspectRatio;
+		else
+			width = w;
+	}
+	data.resize(width * height * 3);
+	u8 *dst = data.data();
+	for (int y = 0; y < height; y++)
+	{
+		const int sy = y * srcH / height;
+		for (int x = 0; x < width; x++)
+		{
+			const int sx = x * srcW / width;
+			// Rotate 90 degrees counterclockwise
+			const u32 pixel = rotate ? lastFrame[sx * lastFrameWidth + lastFrameWidth - 1 - sy]
+					: lastFrame[sy * lastFrameWidth + sx];
+			*dst++ = pixel & 0xff;
+			*dst++ = (pixel >> 8) & 0xff;
+			*dst++ = (pixel >> 16) & 0xff;
+		}
+	}
+	return true;
+}
+
+}
+
+Renderer *rend_Software() {
+	return new soft::SoftRenderer();
+}
@@ -0,0 +1,238 @@
+/*
+	Copyright 2026 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include "hw/pvr/Renderer_if.h"
+#include "rend/TexCache.h"
+#include "simd.h"
+#include <array>
+#include <vector>
+
+//
+// Multithreaded tile-based software renderer.
+// The frame is split into 32x32 tiles like the PVR2 does. Triangles are set up and binned to the tiles
+// they overlap, then tiles are rasterized in parallel on the task pool.
+// Translucent polygons of auto-sorted passes are sorted per pixel.
+//
+// It can only be selected by the headless benchmark (-benchmark-renderer soft) and measures a live
+// emulation run, not replayed TA data. Frames are rendered to vram (render to texture or emulated
+// framebuffer) and the last one can be saved with -benchmark-dump.
+// Not supported:
+// - translucent modifier volumes in pre-sorted passes. They are only applied to per-pixel sorted fragments.
+// - Naomi 2 polygons and modifier volumes, which are skipped
+// - the secondary accumulation buffer
+// - upscaling: frames are rendered at native resolution
+//
+namespace soft
+{
+
+constexpr int TileSize = 32;
+constexpr int TilePixels = TileSize * TileSize;
+
+class Texture final : public BaseTextureCacheData
+{
+public:
+	Texture(TSP tsp, TCW tcw) : BaseTextureCacheData(tsp, tcw) {
+	}
+	Texture(Texture&& other) : BaseTextureCacheData(std::move(other))
+	{
+		std::swap(pixels32, other.pixels32);
+		std::swap(pixels8, other.pixels8);
+		texWidth = other.texWidth;
+		texHeight = other.texHeight;
+		levelCount = other.levelCount;
+		levelOffset = other.levelOffset;
+	}
+
+	std::string GetId() override { return ""; }
+	void UploadToGPU(int width, int height, const u8 *temp_tex_buffer, bool mipmapped, bool mipmapsIncluded = false) override;
+	bool Force32BitTexture(TextureType type) const override {
+		// Only palette indices are kept as is. Everything else is decoded to RGBA8888.
+		return type != TextureType::_8;
+	}
+	bool Delete() override;
+
+	// Returns the RGBA color in [0, 1] at the given normalized coordinates.
+	// palette is only used by palette index textures.
+	f32x4 sample(float u, float v, u32 level, TSP tsp, const u32 *palette) const;
+
+	u32 getWidth() const { return texWidth; }
+	u32 getHeight() const { return texHeight; }
+	u32 getLevelCount() const { return levelCount; }
+
+private:
+	u32 texel(int x, int y, u32 level, const u32 *palette) const
+	{
+		const u32 idx = levelOffset[level] + y * std::max(1u, texWidth >> level) + x;
+		if (!pixels8.empty())
+			return palette[pixels8[idx]];
+		else
+			return pixels32[idx];
+	}
+
+	std::vector<u32> pixels32;
+	std::vector<u8> pixels8;		// palette indices
+	u32 texWidth = 0;
+	u32 texHeight = 0;
+	u32 levelCount = 0;				// level 0 is the largest mipmap
+	std::array<u32, 11> levelOffset {};	// offset of each mipmap level in pixels
+};
+
+class TextureCache final : public BaseTextureCache<Texture>
+{
+};
+
+// Edge functions, depth plane and bounds of a triangle set up for rasterization
+struct RasterTriangle
+{
+	// Edge functions: a * x + b * y + c >= 0 inside the triangle. One edge per lane.
+	f32x4 edgeA;
+	f32x4 edgeB;
+	f32x4 edgeC;
+	// 1/w plane
+	float zA, zB, zC;
+	int minX, minY, maxX, maxY;	// bounding box in pixels, inclusive
+	u8 topLeft;					// bit i set if edge i is a top or left edge
+};
+
+struct Triangle : RasterTriangle
+{
+	// Attribute planes. Attributes are interpolated as value/w and multiplied by w at each pixel.
+	f32x4 colA, colB, colC;		// base color
+	f32x4 spcA, spcB, spcC;		// offset color
+	f32x4 uvA, uvB, uvC;		// u/w, v/w
+	int clipRect[4];			// x, y, x2, y2 of the tile clipping region, if pixels inside are discarded
+	bool clipInside;
+	u8 mipLevel;
+	const PolyParam *pp;
+	const Texture *texture;
+	const u32 *palette;
+};
+
+struct ModVolTriangle : RasterTriangle
+{
+	bool culled;	// only used for the volume area, not for the in/out test
+};
+
+// Triangle index ranges of a render pass
+struct PassInfo
+{
+	u32 opEnd;
+	u32 ptEnd;
+	u32 trEnd;
+	u32 mvFirst;	// modifier volume params
+	u32 mvCount;
+	u32 mvTrFirst;	// translucent modifier volume params
+	u32 mvTrCount;
+	bool mvTrShared;	// translucent modifier volumes use the opaque ones
+	bool autosort;
+	bool zClear;
+};
+
+class SoftRenderer final : public Renderer
+{
+public:
+	bool Init() override;
+	void Term() override;
+
+	void Process(TA_context *ctx) override;
+	bool Render() override;
+	void RenderFramebuffer(const FramebufferInfo& info) override;
+	bool GetLastFrame(std::vector<u8>& data, int& width, int& height) override;
+
+	BaseTextureCacheData *GetTexture(TSP tsp, TCW tcw) override;
+
+private:
+	struct Fragment
+	{
+		float z;
+		u32 color;
+		u32 next;
+		u8 srcInstr;
+		u8 dstInstr;
+		u8 stencil;		// same as TileBuffer::stencil
+	};
+	// Per-thread tile buffers
+	struct TileBuffer
+	{
+		alignas(16) float depth[TilePixels];
+		u32 color[TilePixels];
+		// bit 0: modifier volume result, bit 1: inside current volume, bit 7: shadowed polygon
+		u8 stencil[TilePixels];
+		bool coverage[TilePixels];			// pixels covered by the current modifier volume
+		u32 fragHead[TilePixels];
+		std::vector<Fragment> fragments;
+		std::vector<u32> sortList;
+	};
+	static constexpr u32 NoFragment = ~0u;
+
+	void setupPolys(const std::vector<PolyParam>& polys, u32 first, u32 count);
+	void setupTriangle(const PolyParam& pp, const Vertex& v0, const Vertex& v1, const Vertex& v2, u32 parity);
+	void setupModVols();
+	void setupModVolTriangle(const ModTriangle& mt, u32 cullMode, ModVolTriangle& tri);
+	bool setupEdges(RasterTriangle& tri, const float x[3], const float y[3], float area) const;
+	void binTriangles();
+	void renderTile(int tileX, int tileY, TileBuffer& tile) const;
+	template<u32 ListType>
+	void drawTriangle(const Triangle& tri, int tileX, int tileY, TileBuffer& tile) const;
+	void drawSortedTriangle(const Triangle& tri, int tileX, int tileY, TileBuffer& tile) const;
+	void resolveFragments(TileBuffer& tile) const;
+	template<typename ForEach>
+	void drawModVols(const ModifierVolumeParam *params, u32 count, const std::vector<u32>& mvTris, size_t& cursor,
+			int tileX, int tileY, TileBuffer& tile, ForEach forEachStencil) const;
+	template<bool AlphaTest>
+	bool shadePixel(const Triangle& tri, float x, float y, float z, f32x4& color) const;
+	float fogFactor(float invW) const;
+	void writeOutput();
+
+	TextureCache texCache;
+	u32 palette[1024];
+	std::array<u8, 256> fogTable;
+
+	int width = 0;
+	int height = 0;
+	int tilesX = 0;
+	int tilesY = 0;
+	int clipMinX = 0;
+	int clipMinY = 0;
+	int clipMaxX = 0;
+	int clipMaxY = 0;
+	std::vector<u32> framebuffer;		// RGBA8888
+	std::vector<Triangle> triangles;
+	std::vector<ModVolTriangle> mvTriangles;
+	std::vector<PassInfo> passes;
+	std::vector<std::vector<u32>> tileTriangles;
+	std::vector<std::vector<u32>> tileMvTriangles;
+
+	// Frame-constant shading state
+	f32x4 fogColRam;
+	f32x4 fogColVert;
+	f32x4 fogClampMin;
+	f32x4 fogClampMax;
+	float fogDensity = 0.f;
+	float ptAlphaRef = 0.f;		// in [0, 255]
+	float shadowScale = 1.f;
+	float cullValue = 0.f;
+	bool fogEnabled = true;
+
+	std::vector<u32> lastFrame;
+	int lastFrameWidth = 0;
+	int lastFrameHeight = 0;
+};
+
+}
@@ -0,0 +1,158 @@
+/*
+	Copyright 2026 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "softrend.h"
+#include <cmath>
+
+namespace soft
+{
+
+// 16-bit textures only happen when the format has no 32-bit decoder. Same layout as the OpenGL formats.
+static u32 convert16(u16 c, TextureType type)
+{
+	auto expand = [](u32 v, int bits) {
+		return (v << (8 - bits)) | (v >> (2 * bits - 8));
+	};
+	switch (type)
+	{
+	case TextureType::_565:
+		return expand(c >> 11, 5) | (expand((c >> 5) & 0x3f, 6) << 8) | (expand(c & 0x1f, 5) << 16) | 0xff000000;
+	case TextureType::_5551:
+		return expand(c >> 11, 5) | (expand((c >> 6) & 0x1f, 5) << 8) | (expand((c >> 1) & 0x1f, 5) << 16)
+				| ((c & 1) ? 0xff000000 : 0);
+	case TextureType::_4444:
+	default:
+		return ((c >> 12) * 0x11) | (((c >> 8) & 0xf) * 0x1100) | (((c >> 4) & 0xf) * 0x110000) | ((c & 0xf) * 0x11000000);
+	}
+}
+
+void Texture::UploadToGPU(int width, int height, const u8 *temp_tex_buffer, bool mipmapped, bool mipmapsIncluded)
+{
+	texWidth = width;
+	texHeight = height;
+	// Mipmaps are only used when provided by the texture cache. They are stored smallest first.
+	size_t pixelCount = (size_t)width * height;
+	if (mipmapsIncluded)
+	{
+		levelCount = 0;
+		for (int dim = width; dim != 0; dim >>= 1)
+			levelCount++;
+		levelCount = std::min<u32>(levelCount, levelOffset.size());
+		u32 offset = 0;
+		for (u32 i = 0; i < levelCount; i++)
+		{
+			levelOffset[levelCount - i - 1] = offset;
+			offset += 1 << (2 * i);
+		}
+		pixelCount = offset;
+	}
+	else
+	{
+		levelCount = 1;
+		levelOffset[0] = 0;
+	}
+
+	pixels8.clear();
+	pixels32.clear();
+	switch (tex_type)
+	{
+	case TextureType::_8:
+		pixels8.assign(temp_tex_buffer, temp_tex_buffer + pixelCount);
+		break;
+	case TextureType::_8888:
+		pixels32.resize(pixelCount);
+		memcpy(pixels32.data(), temp_tex_buffer, pixelCount * sizeof(u32));
+		break;
+	default:
+		{
+			pixels32.resize(pixelCount);
+			const u16 *src = (const u16 *)temp_tex_buffer;
+			for (size_t i = 0; i < pixelCount; i++)
+				pixels32[i] = convert16(src[i], tex_type);
+		}
+		break;
+	}
+}
+
+bool Texture::Delete()
+{
+	if (!BaseTextureCacheData::Delete())
+		return false;
+	pixels32 = {};
+	pixels8 = {};
+	return true;
+}
+
+static inline int wrapCoord(int c, int size, bool clamp, bool flip)
+{
+	if (clamp)
+		return std::clamp(c, 0, size - 1);
+	if ((size & (size - 1)) == 0)
+	{
+		// power of 2
+		if (flip)
+		{
+			c &= size * 2 - 1;
+			return c < size ? c : size * 2 - 1 - c;
+		}
+		return c & (size - 1);
+	}
+	if (flip)
+	{
+		c %= size * 2;
+		if (c < 0)
+			c += size * 2;
+		return c < size ? c : size * 2 - 1 - c;
+	}
+	c %= size;
+	return c < 0 ? c + size : c;
+}
+
+f32x4 Texture::sample(float u, float v, u32 level, TSP tsp, const u32 *palette) const
+{
+	if (levelCount == 0)
+		return f32x4(1.f);
+	level = std::min(level, levelCount - 1);
+	const int w = std::max(1u, texWidth >> level);
+	const int h = std::max(1u, texHeight >> level);
+	// Keep huge coordinates in the int range
+	float fu = std::clamp(u * w, -1e6f, 1e6f);
+	float fv = std::clamp(v * h, -1e6f, 1e6f);
+	if (tsp.FilterMode == 0)
+	{
+		const int x = wrapCoord((int)std::floor(fu), w, tsp.ClampU, tsp.FlipU);
+		const int y = wrapCoord((int)std::floor(fv), h, tsp.ClampV, tsp.FlipV);
+		return unpackColor(texel(x, y, level, palette));
+	}
+	// Bilinear
+	fu -= 0.5f;
+	fv -= 0.5f;
+	const float iu = std::floor(fu);
+	const float iv = std::floor(fv);
+	const int x0 = wrapCoord((int)iu, w, tsp.ClampU, tsp.FlipU);
+	const int x1 = wrapCoord((int)iu + 1, w, tsp.ClampU, tsp.FlipU);
+	const int y0 = wrapCoord((int)iv, h, tsp.ClampV, tsp.FlipV);
+	const int y1 = wrapCoord((int)iv + 1, h, tsp.ClampV, tsp.FlipV);
+	const f32x4 tu(fu - iu);
+	const f32x4 tv(fv - iv);
+	const f32x4 top = f32x4::lerp(unpackColor(texel(x0, y0, level, palette)), unpackColor(texel(x1, y0, level, palette)), tu);
+	const f32x4 bottom = f32x4::lerp(unpackColor(texel(x0, y1, level, palette)), unpackColor(texel(x1, y1, level, palette)), tu);
+	return f32x4::lerp(top, bottom, tv);
+}
+
+}
@@ -44,13 +44,7 @@ void CommandPool::Init(size_t chainSize)
 
 void CommandPool::Term()
 {
-	if (!fences.empty())
-	{
-		std::vector<vk::Fence> allFences = vk::uniqueToRaw(fences);
-		vk::Result res = device.waitForFences(allFences, true, UINT64_MAX);
-		if (res != vk::Result::eSuccess)
-			WARN_LOG(RENDERER, "CommandPool::Term: waitForFences failed %d", (int)res);
-	}
+	Flush();
 	inFlightObjects.clear();
 	freeBuffers.clear();
 	inFlightBuffers.clear();
@@ -58,6 +52,20 @@ void CommandPool::Term()
 	commandPools.clear();
 }
 
+void CommandPool::Flush()
+{
+	if (fences.empty())
+		return;
+	std::vector<vk::Fence> allFences = vk::uniqueToRaw(fences);
+	vk::Result res = device.waitForFences(allFences, true, UINT64_MAX);
+	if (res != vk::Result::eSuccess)
+		WARN_LOG(RENDERER, "CommandPool::Flush: waitForFences failed %d", (int)res);
+	for (size_t i = 0; i < inFlightObjects.size(); i++)
+		// the objects of the current frame aren't submitted yet
+		if (!frameStarted || (int)i != index)
+			inFlightObjects[i].clear();
+}
+
 void CommandPool::BeginFrame()
 {
 	if (frameStarted)
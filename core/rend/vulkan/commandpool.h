@@ -29,6 +29,8 @@ class CommandPool : public FlightManager
 public:
 	void Init(size_t chainSize = 2);
 	void Term();
+	// Waits for the submitted frames and destroys their in-flight objects
+	void Flush();
 	void BeginFrame();
 	void EndFrame();
 	void EndFrameAndWait();
@@ -21,6 +21,7 @@
 #pragma once
 #include "../buffer.h"
 #include "../texture.h"
+#include "rend/oit_buffer_sizer.h"
 
 #include <memory>
 
@@ -39,13 +40,14 @@ public:
 		if (!pixelBuffer)
 		{
 			pixelBufferSize = config::PixelBufferSize;
-			pixelBuffer = std::make_unique<BufferData>(std::min<vk::DeviceSize>(pixelBufferSize, context->GetMaxMemoryAllocationSize()),
-					vk::BufferUsageFlagBits::eStorageBuffer, vk::MemoryPropertyFlagBits::eDeviceLocal);
+			sizer.reset(std::min<vk::DeviceSize>(pixelBufferSize, context->GetMaxMemoryAllocationSize()));
+			allocPixelBuffer();
 		}
 		if (!pixelCounter)
 		{
 			pixelCounter = std::make_unique<BufferData>(4,
-					vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst, vk::MemoryPropertyFlagBits::eDeviceLocal);
+					vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferSrc | vk::BufferUsageFlagBits::eTransferDst,
+					vk::MemoryPropertyFlagBits::eDeviceLocal);
 			pixelCounterReset = std::make_unique<BufferData>(4, vk::BufferUsageFlagBits::eTransferSrc);
 			const int zero = 0;
 			pixelCounterReset->upload(sizeof(zero), &zero);
@@ -71,15 +73,49 @@ public:
 		writeDescSets.emplace_back(descSet, 9, 0, vk::DescriptorType::eStorageBuffer, nullptr, abufferPointerInfo);
 	}
 
-	void OnNewFrame(vk::CommandBuffer commandBuffer)
+	void OnNewFrame(FlightManager *flightManager)
 	{
 		firstFrameAfterInit = false;
 		if (pixelBufferSize != config::PixelBufferSize)
 		{
 			pixelBufferSize = config::PixelBufferSize;
-			pixelBuffer = std::make_unique<BufferData>(std::min<vk::DeviceSize>(pixelBufferSize, VulkanContext::Instance()->GetMaxMemoryAllocationSize()),
-					vk::BufferUsageFlagBits::eStorageBuffer, vk::MemoryPropertyFlagBits::eDeviceLocal);
+			sizer.reset(std::min<vk::DeviceSize>(pixelBufferSize, VulkanContext::Instance()->GetMaxMemoryAllocationSize()));
+			resizePending = true;
 		}
+		if (resizePending)
+		{
+			resizePending = false;
+			allocPixelBuffer();
+		}
+		// Keep the pixel buffer alive until the frame has completed, so that a resize doesn't have to wait for the GPU
+		flightManager->addToFlight(new Deleter(std::shared_ptr<BufferData>(pixelBuffer)));
+	}
+
+	// Called with the number of fragments used by a completed frame
+	void FrameDone(u32 fragments)
+	{
+		if (sizer.frameDone(fragments))
+			resizePending = true;
+	}
+
+	vk::DeviceSize GetPixelBufferSize() const {
+		return pixelBuffer->bufferSize;
+	}
+
+	// Copy the pixel counter of the render pass that just ended to the given host-visible buffer
+	void SavePixelCounter(vk::CommandBuffer commandBuffer, const BufferData& readback, u32 offset)
+	{
+		vk::BufferMemoryBarrier barrier(vk::AccessFlagBits::eShaderWrite, vk::AccessFlagBits::eTransferRead,
+				VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, *pixelCounter->buffer, 0, 4);
+		commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eFragmentShader, vk::PipelineStageFlagBits::eTransfer,
+				{}, nullptr, barrier, nullptr);
+		vk::BufferCopy copy(0, offset, sizeof(u32));
+		commandBuffer.copyBuffer(*pixelCounter->buffer, *readback.buffer, copy);
+		// Make the copy visible to the host, and complete before the counter is reset by the next render pass
+		vk::BufferMemoryBarrier hostBarrier(vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eHostRead,
+				VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, *readback.buffer, offset, sizeof(u32));
+		commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eTransfer | vk::PipelineStageFlagBits::eHost,
+				{}, nullptr, hostBarrier, nullptr);
 	}
 
 	void ResetPixelCounter(vk::CommandBuffer commandBuffer)
@@ -99,7 +135,15 @@ public:
 	bool isFirstFrameAfterInit() const { return firstFrameAfterInit; }
 
 private:
-	std::unique_ptr<BufferData> pixelBuffer;
+	void allocPixelBuffer()
+	{
+		// The previous buffer is deleted once the frames using it have completed
+		pixelBuffer = std::make_shared<BufferData>(sizer.getSize(),
+				vk::BufferUsageFlagBits::eStorageBuffer, vk::MemoryPropertyFlagBits::eDeviceLocal);
+		DEBUG_LOG(RENDERER, "OIT pixel buffer size %d MB", (int)(sizer.getSize() / 1_MB));
+	}
+
+	std::shared_ptr<BufferData> pixelBuffer;
 	std::unique_ptr<BufferData> pixelCounter;
 	std::unique_ptr<BufferData> pixelCounterReset;
 	std::unique_ptr<BufferData> abufferPointer;
@@ -107,4 +151,6 @@ private:
 	int maxWidth = 0;
 	int maxHeight = 0;
 	int64_t pixelBufferSize = 0;
+	OitBufferSizer sizer;
+	bool resizePending = false;
 };
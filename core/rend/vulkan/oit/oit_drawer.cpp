@@ -304,8 +304,6 @@ bool OITDrawer::Draw(const Texture *fogTexture, const Texture *paletteTexture)
 
 	OITDescriptorSets::FragmentShaderUniforms fragUniforms = MakeFragmentUniforms<OITDescriptorSets::FragmentShaderUniforms>();
 	fragUniforms.shade_scale_factor = FPU_SHAD_SCALE.scale_factor / 256.f;
-	// sizeof(Pixel) == 16
-	fragUniforms.pixelBufferSize = std::min<u64>(config::PixelBufferSize, GetContext()->GetMaxMemoryAllocationSize()) / 16;
 	fragUniforms.viewportWidth = maxWidth;
 	dithering = config::EmulateFramebuffer && pvrrc.fb_W_CTRL.fb_dither && pvrrc.fb_W_CTRL.fb_packmode <= 3;
 	if (dithering)
@@ -332,7 +330,10 @@ bool OITDrawer::Draw(const Texture *fogTexture, const Texture *paletteTexture)
 	currentScissor = vk::Rect2D();
 
 	bool firstFrameAfterInit = oitBuffers->isFirstFrameAfterInit();
-	oitBuffers->OnNewFrame(cmdBuffer);
+	oitBuffers->OnNewFrame(commandPool);
+	// sizeof(Pixel) == 16
+	fragUniforms.pixelBufferSize = oitBuffers->GetPixelBufferSize() / 16;
+	BufferData *counterReadback = GetCounterReadback(pvrrc.render_passes.size());
 
 	if (VulkanContext::Instance()->hasProvokingVertex())
 	{
@@ -472,6 +473,7 @@ bool OITDrawer::Draw(const Texture *fogTexture, const Texture *paletteTexture)
 		}
 
 		cmdBuffer.endRenderPass();
+		oitBuffers->SavePixelCounter(cmdBuffer, *counterReadback, render_pass * sizeof(u32));
 		previous_pass = current_pass;
     }
     curMainBuffer = nullptr;
@@ -479,6 +481,53 @@ bool OITDrawer::Draw(const Texture *fogTexture, const Texture *paletteTexture)
 	return !pvrrc.isRTT;
 }
 
+BufferData *OITDrawer::GetCounterReadback(u32 passCount)
+{
+	const u32 size = std::max(passCount, 1u) * sizeof(u32);
+	BufferData *buffer = nullptr;
+	if (!counterReadbacks.empty())
+	{
+		buffer = counterReadbacks.back().release();
+		counterReadbacks.pop_back();
+		if (buffer->bufferSize < size)
+		{
+			// Not in use anymore
+			delete buffer;
+			buffer = nullptr;
+		}
+	}
+	if (buffer == nullptr)
+		buffer = new BufferData(std::max<u32>(16 * sizeof(u32), size), vk::BufferUsageFlagBits::eTransferDst);
+
+	// Reports the number of fragments used by the frame to OITBuffers once it has completed
+	class CounterReadbackHolder : public Deletable
+	{
+	public:
+		CounterReadbackHolder(BufferData *buffer, u32 passCount, OITDrawer *drawer)
+			: buffer(buffer), passCount(passCount), drawer(drawer) {}
+
+		~CounterReadbackHolder() override
+		{
+			if (passCount > 0)
+			{
+				const u32 *counters = (const u32 *)buffer->MapMemory();
+				const u32 fragments = *std::max_element(counters, counters + passCount);
+				buffer->UnmapMemory();
+				drawer->oitBuffers->FrameDone(fragments);
+			}
+			drawer->counterReadbacks.emplace_back(buffer);
+		}
+
+	private:
+		BufferData *buffer;
+		u32 passCount;
+		OITDrawer *drawer;
+	};
+	commandPool->addToFlight(new CounterReadbackHolder(buffer, passCount, this));
+
+	return buffer;
+}
+
 void OITDrawer::MakeBuffers(int width, int height, vk::ImageUsageFlags colorUsage)
 {
 	oitBuffers->Init(width, height);
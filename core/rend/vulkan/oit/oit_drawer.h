@@ -67,6 +67,7 @@ protected:
 		depthAttachments[0].reset();
 		depthAttachments[1].reset();
 		mainBuffers.clear();
+		counterReadbacks.clear();
 		descriptorSets.term();
 		maxWidth = 0;
 		maxHeight = 0;
@@ -104,6 +105,7 @@ private:
 	void DrawModifierVolumes(const vk::CommandBuffer& cmdBuffer, int first, int count, const ModifierVolumeParam *modVolParams);
 	void UploadMainBuffer(const OITDescriptorSets::VertexShaderUniforms& vertexUniforms,
 			const OITDescriptorSets::FragmentShaderUniforms& fragmentUniforms);
+	BufferData *GetCounterReadback(u32 passCount);
 
 	struct {
 		vk::DeviceSize indexOffset = 0;
@@ -130,6 +132,8 @@ private:
 	vk::Buffer curMainBuffer;
 	bool dithering = false;
 	vk::ImageUsageFlags currentBufferUsage {};
+	// Host-visible copies of the pixel counter of each render pass
+	std::vector<std::unique_ptr<BufferData>> counterReadbacks;
 };
 
 class OITScreenDrawer : public OITDrawer
@@ -53,6 +53,7 @@ public:
 	{
 		DEBUG_LOG(RENDERER, "OITVulkanRenderer::Term");
 		GetContext()->WaitIdle();
+		// The in-flight counter readbacks report to the drawers and OIT buffers when destroyed
 		texCommandPool.Term();
 		screenDrawer.Term();
 		textureDrawer.Term();
@@ -68,6 +69,7 @@ public:
 		{
 			screenDrawer.EndFrame();
 			VulkanContext::Instance()->WaitIdle();
+			texCommandPool.Flush();
 			screenDrawer.Term();
 			screenDrawer.Init(&samplerManager, &oitShaderManager, &oitBuffers, viewport);
 			BaseInit(screenDrawer.GetRenderPass(), 2);
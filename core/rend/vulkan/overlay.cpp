@@ -41,7 +41,6 @@ void VulkanOverlay::Init(QuadPipeline *pipeline)
 	}
 	xhairDrawer = std::make_unique<QuadDrawer>();
 	xhairDrawer->Init(pipeline);
-	vmuLastChanged.fill({});
 }
 
 void VulkanOverlay::Term()
@@ -50,8 +49,7 @@ void VulkanOverlay::Term()
 	for (auto& drawer : drawers)
 		drawer.reset();
 	xhairDrawer.reset();
-	for (auto& tex : vmuTextures)
-		tex.reset();
+	vmuAtlas.reset();
 	xhairTexture.reset();
 }
 
@@ -66,32 +64,52 @@ std::unique_ptr<Texture> VulkanOverlay::createTexture(vk::CommandBuffer commandB
 	return texture;
 }
 
+void VulkanOverlay::updateVmuAtlas(vk::CommandBuffer commandBuffer)
+{
+	const u32 changed = vmuAtlasUpdater.changedScreens();
+	if (changed == 0)
+		return;
+	// The atlas may still be in use by the previous frames so a new staging buffer is needed
+	constexpr u32 ScreenSize = sizeof(vmu_lcd_data[0]);
+	auto stagingBuffer = std::make_unique<BufferData>(VmuAtlasUpdater::countScreens(changed) * ScreenSize,
+			vk::BufferUsageFlagBits::eTransferSrc);
+	u8 *data = (u8 *)stagingBuffer->MapMemory();
+	std::vector<vk::BufferImageCopy> regions;
+	for (int i = 0; i < VmuLcdCount; i++)
+	{
+		if ((changed & (1 << i)) == 0)
+			continue;
+		const u32 offset = (u32)regions.size() * ScreenSize;
+		memcpy(data + offset, vmu_lcd_data[i], ScreenSize);
+		regions.emplace_back(offset, VmuLcdWidth, VmuLcdHeight, vk::ImageSubresourceLayers(vk::ImageAspectFlagBits::eColor, 0, 0, 1),
+				vk::Offset3D(0, VmuLcdHeight * i, 0), vk::Extent3D(VmuLcdWidth, VmuLcdHeight, 1));
+	}
+	stagingBuffer->UnmapMemory();
+
+	setImageLayout(commandBuffer, vmuAtlas->GetImage(), vk::Format::eR8G8B8A8Unorm, 1, vk::ImageLayout::eShaderReadOnlyOptimal,
+			vk::ImageLayout::eTransferDstOptimal);
+	commandBuffer.copyBufferToImage(stagingBuffer->buffer.get(), vmuAtlas->GetImage(), vk::ImageLayout::eTransferDstOptimal, regions);
+	setImageLayout(commandBuffer, vmuAtlas->GetImage(), vk::Format::eR8G8B8A8Unorm, 1, vk::ImageLayout::eTransferDstOptimal,
+			vk::ImageLayout::eShaderReadOnlyOptimal);
+	VulkanContext::Instance()->addToFlight(new Deleter(std::move(stagingBuffer)));
+}
+
 void VulkanOverlay::Prepare(vk::CommandBuffer cmdBuffer, bool vmu, bool crosshair)
 {
 	if (vmu)
 	{
-		for (size_t i = 0; i < vmuTextures.size(); i++)
+		if (!vmuAtlas)
 		{
-			std::unique_ptr<Texture>& texture = vmuTextures[i];
-			if (!vmu_lcd_status[i])
-			{
-				if (texture)
-				{
-					texture->deferDeleteResource(VulkanContext::Instance());
-					texture.reset();
-				}
-				continue;
-			}
-			if (texture != nullptr && ::vmuLastChanged[i] == this->vmuLastChanged[i])
-				continue;
-
-			if (texture)
-				texture->deferDeleteResource(VulkanContext::Instance());
-			texture = createTexture(cmdBuffer, 48, 32, (u8*)vmu_lcd_data[i]);
+			vmuAtlas = createTexture(cmdBuffer, VmuLcdWidth, VmuLcdHeight * VmuLcdCount, (u8 *)vmu_lcd_data);
 #ifdef VK_DEBUG
-			VulkanContext::Instance()->setObjectName(texture->GetImageView(), "VMU " + std::to_string(i));
+			VulkanContext::Instance()->setObjectName(vmuAtlas->GetImageView(), "VMU atlas");
 #endif
-			this->vmuLastChanged[i] = ::vmuLastChanged[i];
+			vmuAtlasUpdater.reset();
+			vmuAtlasUpdater.changedScreens();
+		}
+		else
+		{
+			updateVmuAtlas(cmdBuffer);
 		}
 	}
 	if (crosshair && !xhairTexture)
@@ -154,9 +172,9 @@ void VulkanOverlay::Draw(vk::CommandBuffer commandBuffer, vk::Extent2D viewport,
 		vmu_width /= config::ScreenStretching / 100.f;
 #endif
 
-		for (size_t i = 0; i < vmuTextures.size(); i++)
+		for (size_t i = 0; i < drawers.size(); i++)
 		{
-			if (!vmuTextures[i])
+			if (!vmuAtlas || !vmu_lcd_status[i])
 				continue;
 			float x;
 			float y;
@@ -209,7 +227,16 @@ void VulkanOverlay::Draw(vk::CommandBuffer commandBuffer, vk::Extent2D viewport,
 			commandBuffer.setViewport(0, viewport);
 			commandBuffer.setScissor(0, vk::Rect2D(vk::Offset2D(x, y), vk::Extent2D(w, h)));
 
-			drawers[i]->Draw(commandBuffer, vmuTextures[i]->GetImageView(), vtx, true, color);
+			// Rows of this screen in the atlas
+			const float v0 = (float)i / VmuLcdCount;
+			const float v1 = (float)(i + 1) / VmuLcdCount;
+			QuadVertex vmuVtx[] {
+				{ -1.f, -1.f, 0.f, 0.f, v1 },
+				{  1.f, -1.f, 0.f, 1.f, v1 },
+				{ -1.f,  1.f, 0.f, 0.f, v0 },
+				{  1.f,  1.f, 0.f, 1.f, v0 },
+			};
+			drawers[i]->Draw(commandBuffer, vmuAtlas->GetImageView(), vmuVtx, true, color);
 		}
 	}
 	if (crosshair)
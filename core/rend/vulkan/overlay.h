@@ -20,6 +20,7 @@
 */
 #pragma once
 #include "quad.h"
+#include "rend/osd.h"
 
 #include <array>
 #include <memory>
@@ -41,11 +42,13 @@ public:
 
 private:
 	std::unique_ptr<Texture> createTexture(vk::CommandBuffer commandBuffer, int width, int height, const u8 *data);
+	void updateVmuAtlas(vk::CommandBuffer commandBuffer);
 
-	std::array<std::unique_ptr<Texture>, 8> vmuTextures;
+	// All VMU screens
+	std::unique_ptr<Texture> vmuAtlas;
+	VmuAtlasUpdater vmuAtlasUpdater;
 	std::vector<vk::UniqueCommandBuffer> commandBuffers;
-	std::array<std::unique_ptr<QuadDrawer>, 8> drawers;
-	std::array<u64, 8> vmuLastChanged {};
+	std::array<std::unique_ptr<QuadDrawer>, VmuLcdCount> drawers;
 	QuadPipeline *pipeline = nullptr;
 
 	std::unique_ptr<Texture> xhairTexture;
@@ -21,6 +21,7 @@
 #ifdef USE_DREAMCASTCONTROLLER
 #include "hw/maple/maple_devs.h"
 #include "ui/gui.h"
+#include "profiler/metrics.h"
 #include <cfg/option.h>
 #include <SDL.h>
 #include <asio.hpp>
@@ -95,6 +96,7 @@ bool DreamConn::send_no_lock(const MapleMsg& msg) {
 	else
 		return false;
 	if (ec) {
+		metrics::dreamlinkError();
 		maple_io_connected = false;
 		WARN_LOG(INPUT, "DreamcastController[%d] send failed: %s", bus, ec.message().c_str());
 		disconnect();
@@ -106,10 +108,16 @@ bool DreamConn::send_no_lock(const MapleMsg& msg) {
 bool DreamConn::send(const MapleMsg& txMsg, MapleMsg& rxMsg) {
 	std::lock_guard<std::mutex> lock(send_mutex); // Ensure thread safety for send operations
 
+	const auto startTime = std::chrono::steady_clock::now();
 	if (!send_no_lock(txMsg)) {
 		return false;
 	}
-	return receiveMsg(rxMsg, iostream);
+	if (!receiveMsg(rxMsg, iostream)) {
+		metrics::dreamlinkError();
+		return false;
+	}
+	metrics::dreamlinkRoundTrip(std::chrono::steady_clock::now() - startTime);
+	return true;
 }
 
 void DreamConn::changeBus(int newBus) {
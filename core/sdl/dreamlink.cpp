@@ -23,7 +23,9 @@
 
 #include "dreamconn.h"
 #include "dreampicoport.h"
+#include "dreamlink_mux.h"
 #include "hw/maple/maple_devs.h"
+#include "cfg/cfg.h"
 #include "ui/gui.h"
 #include <cfg/option.h>
 #include <SDL.h>
@@ -137,6 +139,14 @@ DreamLinkGamepad::DreamLinkGamepad(int maple_port, int joystick_idx, SDL_Joystic
 
     // DreamConn VID:4457 PID:4443
     // Dreamcast Controller USB VID:1209 PID:2f07
+#if !defined(_WIN32)
+    // The physical device is owned by another flycast process
+    const std::string socketPath = cfgLoadStr("input", "DreamLinkClientSocket", "");
+    if (!socketPath.empty()) {
+        dreamlink = std::make_shared<DreamLinkClient>(socketPath, maple_port);
+    }
+    else
+#endif
     // TODO hack: assume the connected gamepad is a DreamConn.
     if (true || memcmp(DreamConn::VID_PID_GUID, guid_str + 8, 16) == 0) {
         // TODO: can't we just attempt to make a DreamConn elsewhere, in order to decouple the concept from gamepad
@@ -300,6 +310,37 @@ void DreamLinkGamepad::checkKeyCombo() {
 }
 
 // SDL Manager Implementation
+#if !defined(_WIN32)
+//! Shares the devices of this process with other flycast processes
+static std::unique_ptr<DreamLinkServer> dreamLinkServer;
+#endif
+
+void SDLDreamLinkManager::addDreamLink(std::shared_ptr<DreamLink> link) {
+    DreamLinkManager::addDreamLink(link);
+#if !defined(_WIN32)
+    if (!link || std::dynamic_pointer_cast<DreamLinkClient>(link)) {
+        return;
+    }
+    if (!dreamLinkServer) {
+        const std::string socketPath = cfgLoadStr("input", "DreamLinkServerSocket", "");
+        if (socketPath.empty()) {
+            return;
+        }
+        dreamLinkServer = std::make_unique<DreamLinkServer>(socketPath);
+    }
+    dreamLinkServer->addLink(link);
+#endif
+}
+
+void SDLDreamLinkManager::removeDreamLink(std::shared_ptr<DreamLink> link) {
+#if !defined(_WIN32)
+    if (dreamLinkServer) {
+        dreamLinkServer->removeLink(link);
+    }
+#endif
+    DreamLinkManager::removeDreamLink(link);
+}
+
 void SDLDreamLinkManager::processVblank() {
     // Check for configuration reloads
     for (auto& link : getDreamLinks()) {
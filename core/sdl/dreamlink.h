@@ -208,6 +208,8 @@ extern std::unique_ptr<DreamLinkManager> g_dreamlink_manager;
     
     class SDLDreamLinkManager : public DreamLinkManager {
     public:
+        void addDreamLink(std::shared_ptr<DreamLink> link) override;
+        void removeDreamLink(std::shared_ptr<DreamLink> link) override;
         void processVblank() override;
         void handleReconnect() override;
         void reloadAllConfigurations() override;
@@ -0,0 +1,521 @@
+/*
+	Copyright 2026 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "dreamlink_mux.h"
+
+#if defined(USE_DREAMCASTCONTROLLER) && !defined(_WIN32)
+#include "hw/maple/maple_if.h"
+#include <chrono>
+#include <cstring>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+using namespace dreamlink_mux;
+
+//! How long to wait for a response
+static constexpr std::chrono::milliseconds ResponseTimeout = std::chrono::seconds(1);
+//! Large enough for many pipelined frames
+static constexpr size_t BufferSize = 64 * 1024;
+
+static int openSocket(const std::string& path, sockaddr_un& addr)
+{
+	if (path.size() >= sizeof(addr.sun_path))
+	{
+		WARN_LOG(INPUT, "DreamLink socket path too long: %s", path.c_str());
+		return -1;
+	}
+	int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (fd < 0)
+	{
+		WARN_LOG(INPUT, "DreamLink socket creation failed: errno %d", errno);
+		return -1;
+	}
+#ifdef SO_NOSIGPIPE
+	int one = 1;
+	setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strcpy(addr.sun_path, path.c_str());
+	return fd;
+}
+
+static bool writeAll(int fd, const u8 *data, size_t size)
+{
+	while (size > 0)
+	{
+		ssize_t n = ::send(fd, data, size, MSG_NOSIGNAL);
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n <= 0)
+			return false;
+		data += n;
+		size -= n;
+	}
+	return true;
+}
+
+//! Reads from the socket and calls handler for each complete frame. Returns when the connection is closed.
+template<typename Handler>
+static void readFrames(int fd, Handler handler)
+{
+	std::vector<u8> buffer(BufferSize);
+	size_t used = 0;
+	while (true)
+	{
+		ssize_t n = recv(fd, &buffer[used], buffer.size() - used, 0);
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n <= 0)
+			return;
+		used += n;
+		size_t offset = 0;
+		while (used - offset >= sizeof(FrameHeader))
+		{
+			FrameHeader header;
+			memcpy(&header, &buffer[offset], sizeof(header));
+			if (header.size > sizeof(MapleMsg)) {
+				WARN_LOG(INPUT, "DreamLink: invalid frame size %d", header.size);
+				return;
+			}
+			if (used - offset < sizeof(header) + header.size)
+				break;
+			if (!handler(header, &buffer[offset + sizeof(header)]))
+				return;
+			offset += sizeof(header) + header.size;
+		}
+		if (offset != 0)
+		{
+			memmove(&buffer[0], &buffer[offset], used - offset);
+			used -= offset;
+		}
+	}
+}
+
+static bool readMapleMsg(const FrameHeader& header, const u8 *payload, MapleMsg& msg)
+{
+	if (header.size < 4)
+		return false;
+	msg.command = payload[0];
+	msg.destAP = payload[1];
+	msg.originAP = payload[2];
+	msg.size = payload[3];
+	if (wireSize(msg) != header.size)
+		return false;
+	memcpy(msg.data, payload + 4, msg.getDataSize());
+	return true;
+}
+
+static void appendFrame(std::vector<u8>& out, const FrameHeader& header, const void *payload)
+{
+	const u8 *p = (const u8 *)&header;
+	out.insert(out.end(), p, p + sizeof(header));
+	p = (const u8 *)payload;
+	out.insert(out.end(), p, p + header.size);
+}
+
+//! @return true if another server accepts connections on this socket
+static bool serverRunning(const std::string& path)
+{
+	sockaddr_un addr;
+	int fd = openSocket(path, addr);
+	if (fd < 0)
+		return false;
+	const bool running = ::connect(fd, (sockaddr *)&addr, sizeof(addr)) == 0;
+	close(fd);
+	return running;
+}
+
+DreamLinkServer::DreamLinkServer(const std::string& socketPath) : socketPath(socketPath)
+{
+	if (serverRunning(socketPath))
+	{
+		WARN_LOG(INPUT, "DreamLink server: %s is already in use", socketPath.c_str());
+		return;
+	}
+	sockaddr_un addr;
+	listenFd = openSocket(socketPath, addr);
+	if (listenFd < 0)
+		return;
+	// Remove a stale socket left by a previous server
+	unlink(socketPath.c_str());
+	if (bind(listenFd, (sockaddr *)&addr, sizeof(addr)) != 0 || listen(listenFd, 16) != 0)
+	{
+		WARN_LOG(INPUT, "DreamLink server: can't listen on %s: errno %d", socketPath.c_str(), errno);
+		close(listenFd);
+		listenFd = -1;
+		return;
+	}
+	NOTICE_LOG(INPUT, "DreamLink server listening on %s", socketPath.c_str());
+	acceptThread = std::thread(&DreamLinkServer::acceptLoop, this);
+}
+
+DreamLinkServer::~DreamLinkServer()
+{
+	if (listenFd < 0)
+		return;
+	stopping = true;
+	acceptThread.join();
+	for (Client& client : clients)
+	{
+		shutdown(client.fd, SHUT_RDWR);
+		client.thread.join();
+		close(client.fd);
+	}
+	close(listenFd);
+	unlink(socketPath.c_str());
+}
+
+void DreamLinkServer::addLink(std::shared_ptr<DreamLink> link)
+{
+	std::lock_guard<std::mutex> _(linksMutex);
+	if (std::find(links.begin(), links.end(), link) == links.end())
+		links.push_back(link);
+}
+
+void DreamLinkServer::removeLink(std::shared_ptr<DreamLink> link)
+{
+	std::lock_guard<std::mutex> _(linksMutex);
+	links.erase(std::remove(links.begin(), links.end(), link), links.end());
+}
+
+std::shared_ptr<DreamLink> DreamLinkServer::findLink(int bus)
+{
+	// The bus of a device can be changed by the user at any time
+	std::lock_guard<std::mutex> _(linksMutex);
+	for (const auto& link : links)
+		if (link->getBus() == bus)
+			return link;
+	return nullptr;
+}
+
+void DreamLinkServer::acceptLoop()
+{
+	while (!stopping)
+	{
+		pollfd pfd { listenFd, POLLIN, 0 };
+		if (poll(&pfd, 1, 100) <= 0)
+			continue;
+		int fd = accept(listenFd, nullptr, nullptr);
+		if (fd < 0)
+			continue;
+		DEBUG_LOG(INPUT, "DreamLink server: client connected");
+		std::lock_guard<std::mutex> _(clientsMutex);
+		clients.remove_if([](Client& client) {
+			if (!client.done)
+				return false;
+			client.thread.join();
+			close(client.fd);
+			return true;
+		});
+		Client& client = clients.emplace_back();
+		client.fd = fd;
+		client.thread = std::thread(&DreamLinkServer::serve, this, std::ref(client));
+	}
+}
+
+void DreamLinkServer::serve(Client& client)
+{
+	const int fd = client.fd;
+	std::vector<u8> out;
+	readFrames(fd, [&](const FrameHeader& header, const u8 *payload) {
+		process(header, payload, out);
+		// Responses to pipelined requests are sent together
+		if (!out.empty())
+		{
+			if (!writeAll(fd, out.data(), out.size()))
+				return false;
+			out.clear();
+		}
+		return true;
+	});
+	DEBUG_LOG(INPUT, "DreamLink server: client disconnected");
+	client.done = true;
+}
+
+void DreamLinkServer::process(const FrameHeader& header, const u8 *payload, std::vector<u8>& out)
+{
+	std::shared_ptr<DreamLink> link = findLink(header.busOrStatus);
+	FrameHeader response { header.id, header.type, NoLink, 0 };
+	switch (header.type)
+	{
+	case Send:
+		{
+			MapleMsg msg;
+			if (link != nullptr && readMapleMsg(header, payload, msg))
+				link->send(msg);
+		}
+		break;
+
+	case Transfer:
+		{
+			MapleMsg msg;
+			MapleMsg rxMsg;
+			if (link == nullptr)
+				appendFrame(out, response, nullptr);
+			else if (!readMapleMsg(header, payload, msg) || !link->send(msg, rxMsg))
+			{
+				response.busOrStatus = Failed;
+				appendFrame(out, response, nullptr);
+			}
+			else
+			{
+				response.busOrStatus = Ok;
+				response.size = wireSize(rxMsg);
+				appendFrame(out, response, &rxMsg);
+			}
+		}
+		break;
+
+	case Describe:
+		if (link == nullptr)
+			appendFrame(out, response, nullptr);
+		else
+		{
+			std::vector<u8> data(sizeof(Description));
+			Description& desc = *(Description *)data.data();
+			for (int port = 0; port < 2; port++)
+			{
+				desc.functionCodes[port] = link->getFunctionCode(port + 1);
+				std::array<u32, 3> defs = link->getFunctionDefinitions(port + 1);
+				std::copy(defs.begin(), defs.end(), desc.functionDefinitions[port]);
+			}
+			std::string name = link->getName();
+			data.insert(data.end(), name.begin(), name.end());
+			response.busOrStatus = Ok;
+			response.size = data.size();
+			appendFrame(out, response, data.data());
+		}
+		break;
+
+	default:
+		response.busOrStatus = Failed;
+		appendFrame(out, response, nullptr);
+		break;
+	}
+}
+
+DreamLinkClient::DreamLinkClient(const std::string& socketPath, int bus)
+	: socketPath(socketPath), bus(bus)
+{
+}
+
+DreamLinkClient::~DreamLinkClient() {
+	disconnect();
+}
+
+bool DreamLinkClient::openConnection()
+{
+	if (fd >= 0)
+		return true;
+	// The read thread of a previous connection has ended
+	if (readThread.joinable())
+		readThread.join();
+	sockaddr_un addr;
+	int sock = openSocket(socketPath, addr);
+	if (sock < 0)
+		return false;
+	if (::connect(sock, (sockaddr *)&addr, sizeof(addr)) != 0)
+	{
+		DEBUG_LOG(INPUT, "DreamLink client: can't connect to %s: errno %d", socketPath.c_str(), errno);
+		close(sock);
+		return false;
+	}
+	fd = sock;
+	readThread = std::thread(&DreamLinkClient::readLoop, this);
+	return true;
+}
+
+void DreamLinkClient::connect()
+{
+	active = true;
+	if (!openConnection())
+	{
+		WARN_LOG(INPUT, "DreamLink client: can't connect to %s", socketPath.c_str());
+		return;
+	}
+	describe();
+	NOTICE_LOG(INPUT, "DreamLink client[%d] connected to %s", bus, getName().c_str());
+}
+
+void DreamLinkClient::disconnect()
+{
+	active = false;
+	{
+		std::lock_guard<std::mutex> _(writeMutex);
+		if (fd >= 0)
+			shutdown(fd, SHUT_RDWR);
+	}
+	// The read thread closes the socket
+	if (readThread.joinable())
+		readThread.join();
+	std::lock_guard<std::mutex> _(descriptionMutex);
+	description = {};
+	name.clear();
+}
+
+void DreamLinkClient::changeBus(int newBus) {
+	bus = newBus;
+}
+
+bool DreamLinkClient::writeFrame(const FrameHeader& header, const MapleMsg *msg)
+{
+	// A single write per frame
+	u8 buffer[sizeof(FrameHeader) + sizeof(MapleMsg)];
+	memcpy(buffer, &header, sizeof(header));
+	if (msg != nullptr)
+		memcpy(buffer + sizeof(header), msg, header.size);
+	std::lock_guard<std::mutex> _(writeMutex);
+	return fd >= 0 && writeAll(fd, buffer, sizeof(header) + header.size);
+}
+
+bool DreamLinkClient::request(FrameType type, const MapleMsg *msg, Response& response)
+{
+	FrameHeader header { 0, type, (u8)bus, (u16)(msg != nullptr ? wireSize(*msg) : 0) };
+	{
+		std::lock_guard<std::mutex> _(pendingMutex);
+		header.id = nextId++;
+		pending[header.id] = &response;
+	}
+	if (!writeFrame(header, msg))
+	{
+		std::lock_guard<std::mutex> _(pendingMutex);
+		pending.erase(header.id);
+		return false;
+	}
+	std::unique_lock<std::mutex> lock(pendingMutex);
+	if (!pendingCond.wait_for(lock, ResponseTimeout, [&response]() { return response.done; }))
+	{
+		pending.erase(header.id);
+		WARN_LOG(INPUT, "DreamLink client[%d]: request timed out", bus);
+		return false;
+	}
+	return response.status == Ok;
+}
+
+void DreamLinkClient::readLoop()
+{
+	readFrames(fd, [this](const FrameHeader& header, const u8 *payload) {
+		std::lock_guard<std::mutex> _(pendingMutex);
+		auto it = pending.find(header.id);
+		// Ignore responses to timed out requests
+		if (it != pending.end())
+		{
+			Response& response = *it->second;
+			response.status = (Status)header.busOrStatus;
+			response.payload.assign(payload, payload + header.size);
+			response.done = true;
+			pending.erase(it);
+			pendingCond.notify_all();
+		}
+		return true;
+	});
+	// Connection closed. It is reopened by the next refresh if the server comes back.
+	{
+		std::lock_guard<std::mutex> _(writeMutex);
+		close(fd);
+		fd = -1;
+	}
+	// Fail all the pending requests
+	std::lock_guard<std::mutex> _(pendingMutex);
+	for (auto& [id, response] : pending)
+		response->done = true;
+	pending.clear();
+	pendingCond.notify_all();
+}
+
+bool DreamLinkClient::send(const MapleMsg& msg)
+{
+	FrameHeader header { 0, Send, (u8)bus, (u16)wireSize(msg) };
+	return writeFrame(header, &msg);
+}
+
+bool DreamLinkClient::send(const MapleMsg& txMsg, MapleMsg& rxMsg)
+{
+	Response response;
+	if (!request(Transfer, &txMsg, response))
+		return false;
+	FrameHeader header { 0, Transfer, Ok, (u16)response.payload.size() };
+	return readMapleMsg(header, response.payload.data(), rxMsg);
+}
+
+bool DreamLinkClient::describe()
+{
+	Response response;
+	Description desc {};
+	std::string newName;
+	if (request(Describe, nullptr, response) && response.payload.size() >= sizeof(Description))
+	{
+		memcpy(&desc, response.payload.data(), sizeof(desc));
+		newName.assign(response.payload.begin() + sizeof(desc), response.payload.end());
+	}
+	std::lock_guard<std::mutex> _(descriptionMutex);
+	const bool changed = memcmp(&desc, &description, sizeof(desc)) != 0;
+	description = desc;
+	name = newName;
+	return changed;
+}
+
+void DreamLinkClient::reloadConfigurationIfNeeded()
+{
+	// The server may connect its devices later, they can be swapped, or the server can be restarted:
+	// refresh about once a second
+	if (!active || --describeCountdown > 0)
+		return;
+	describeCountdown = 60;
+	openConnection();
+	if (describe())
+	{
+		if (g_dreamlink_manager) {
+			g_dreamlink_manager->markForReconnect(shared_from_this());
+		}
+		maple_ReconnectDevices();
+	}
+}
+
+u32 DreamLinkClient::getFunctionCode(int forPort) const
+{
+	if (forPort < 1 || forPort > 2)
+		return 0;
+	std::lock_guard<std::mutex> _(descriptionMutex);
+	return description.functionCodes[forPort - 1];
+}
+
+std::array<u32, 3> DreamLinkClient::getFunctionDefinitions(int forPort) const
+{
+	std::array<u32, 3> defs {};
+	if (forPort < 1 || forPort > 2)
+		return defs;
+	std::lock_guard<std::mutex> _(descriptionMutex);
+	std::copy(std::begin(description.functionDefinitions[forPort - 1]), std::end(description.functionDefinitions[forPort - 1]), defs.begin());
+	return defs;
+}
+
+std::string DreamLinkClient::getName() const
+{
+	std::lock_guard<std::mutex> _(descriptionMutex);
+	return name.empty() ? "DreamLink" : name;
+}
+
+#endif // USE_DREAMCASTCONTROLLER && !_WIN32
@@ -0,0 +1,190 @@
+/*
+	Copyright 2026 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include "dreamlink.h"
+
+#if defined(USE_DREAMCASTCONTROLLER) && !defined(_WIN32)
+
+#include <atomic>
+#include <condition_variable>
+#include <list>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+//
+// Sharing of DreamLink devices between flycast processes.
+// The process that owns the physical devices runs a DreamLinkServer on a local (Unix) socket
+// (input:DreamLinkServerSocket). Other processes use a DreamLinkClient for each maple bus instead
+// of opening the device (input:DreamLinkClientSocket).
+//
+// All frames start with the same 8-byte header. Requests can be pipelined: a client can send
+// any number of requests without waiting, responses are sent back in order and carry the request id.
+//
+namespace dreamlink_mux
+{
+
+enum FrameType : u8
+{
+	Send,		//!< Maple message, no response
+	Transfer,	//!< Maple message, the response is a maple message
+	Describe,	//!< No payload, the response is a Description
+};
+
+enum Status : u8
+{
+	Ok,
+	NoLink,		//!< No device on this bus
+	Failed,		//!< The device didn't respond
+};
+
+struct FrameHeader
+{
+	u32 id;			//!< Request id, echoed in the response
+	FrameType type;
+	u8 busOrStatus;	//!< Maple bus in requests, Status in responses
+	u16 size;		//!< Payload size in bytes
+};
+static_assert(sizeof(FrameHeader) == 8);
+
+struct Description
+{
+	u32 functionCodes[2];
+	u32 functionDefinitions[2][3];
+	// Followed by the device name
+};
+
+//! Size of a maple message on the wire: 4-byte header followed by the data
+inline u32 wireSize(const MapleMsg& msg) {
+	return 4 + msg.getDataSize();
+}
+
+}
+
+//! Serves the DreamLink devices of this process on a local socket
+class DreamLinkServer
+{
+public:
+	DreamLinkServer(const std::string& socketPath);
+	~DreamLinkServer();
+
+	//! @return true if the server is listening
+	bool isRunning() const {
+		return listenFd >= 0;
+	}
+
+	//! Serves the given device on its current bus
+	void addLink(std::shared_ptr<DreamLink> link);
+	void removeLink(std::shared_ptr<DreamLink> link);
+
+private:
+	struct Client
+	{
+		int fd = -1;
+		std::thread thread;
+		std::atomic<bool> done {};
+	};
+
+	std::shared_ptr<DreamLink> findLink(int bus);
+	void acceptLoop();
+	void serve(Client& client);
+	void process(const dreamlink_mux::FrameHeader& header, const u8 *payload, std::vector<u8>& out);
+
+	std::string socketPath;
+	int listenFd = -1;
+	std::atomic<bool> stopping {};
+	std::thread acceptThread;
+	std::list<Client> clients;
+	std::mutex clientsMutex;
+
+	std::vector<std::shared_ptr<DreamLink>> links;
+	std::mutex linksMutex;
+};
+
+//! DreamLink device owned by another process
+class DreamLinkClient : public DreamLink
+{
+public:
+	DreamLinkClient(const std::string& socketPath, int bus);
+	~DreamLinkClient();
+
+	bool send(const MapleMsg& msg) override;
+
+	bool send(const MapleMsg& txMsg, MapleMsg& rxMsg) override;
+
+	u32 getFunctionCode(int forPort) const override;
+
+	std::array<u32, 3> getFunctionDefinitions(int forPort) const override;
+
+	int getBus() const override {
+		return bus;
+	}
+
+	void changeBus(int newBus) override;
+
+	std::string getName() const override;
+
+	void reloadConfigurationIfNeeded() override;
+
+	void connect() override;
+
+	void disconnect() override;
+
+	bool isConnected() const {
+		return fd >= 0;
+	}
+
+private:
+	struct Response
+	{
+		bool done = false;
+		dreamlink_mux::Status status = dreamlink_mux::Failed;
+		std::vector<u8> payload;
+	};
+
+	bool openConnection();
+	bool request(dreamlink_mux::FrameType type, const MapleMsg *msg, Response& response);
+	bool writeFrame(const dreamlink_mux::FrameHeader& header, const MapleMsg *msg);
+	bool describe();
+	void readLoop();
+
+	const std::string socketPath;
+	int bus;
+	//! Closed by the read thread when the server goes away
+	std::atomic<int> fd { -1 };
+	//! Set between connect() and disconnect()
+	bool active = false;
+	std::thread readThread;
+	std::mutex writeMutex;
+
+	u32 nextId = 0;
+	std::map<u32, Response *> pending;
+	std::mutex pendingMutex;
+	std::condition_variable pendingCond;
+
+	dreamlink_mux::Description description {};
+	std::string name;
+	mutable std::mutex descriptionMutex;
+	//! vblanks until the next description refresh
+	int describeCountdown = 0;
+};
+
+#endif // USE_DREAMCASTCONTROLLER && !_WIN32
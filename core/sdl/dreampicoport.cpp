@@ -21,7 +21,10 @@
 
 #ifdef USE_DREAMCASTCONTROLLER
 #include "hw/maple/maple_devs.h"
+#include "hw/maple/maple_if.h"
 #include "ui/gui.h"
+#include "profiler/metrics.h"
+#include "util/task_pool.h"
 #include <cfg/option.h>
 #include <SDL.h>
 #include <asio.hpp>
@@ -37,6 +40,9 @@
 #include <atomic>
 #include <locale>
 #include <codecvt>
+#include <fstream>
+#include <map>
+#include <algorithm>
 
 #if defined(__linux__) || (defined(__APPLE__) && defined(TARGET_OS_MAC))
 #include <dirent.h>
@@ -45,6 +51,7 @@
 #if defined(_WIN32)
 #include <windows.h>
 #include <setupapi.h>
+#include <cfgmgr32.h>
 #endif
 
 class DreamPicoPortSerialHandler
@@ -88,36 +95,17 @@ class DreamPicoPortSerialHandler
 	std::mutex send_mutex;
 
 public:
-	DreamPicoPortSerialHandler() {
-
-		// the serial port isn't ready at this point, so we need to sleep briefly
-		// we probably should have a better way to handle this
-		std::this_thread::sleep_for(std::chrono::milliseconds(500));
-
-		serial_handler = asio::serial_port(io_context);
-		io_context.reset();
-
-		std::string serial_device = "";
-
-		// use user-configured serial device if available, fallback to first available
-		serial_device = cfgLoadStr("input", "DreamPicoPortSerialDevice", "");
-		if (!serial_device.empty())
-		{
-			NOTICE_LOG(INPUT, "DreamPicoPort connecting to user-configured serial device: %s", serial_device.c_str());
-		} else {
-			serial_device = getFirstSerialDevice();
-			NOTICE_LOG(INPUT, "DreamPicoPort connecting to autoselected serial device: %s", serial_device.c_str());
-		}
-
+	explicit DreamPicoPortSerialHandler(const std::string& serial_device)
+	{
 		asio::error_code ec;
 		serial_handler.open(serial_device, ec);
 
 		if (ec || !serial_handler.is_open()) {
-			WARN_LOG(INPUT, "DreamPicoPort serial connection failed: %s", ec.message().c_str());
+			DEBUG_LOG(INPUT, "DreamPicoPort serial connection to %s failed: %s", serial_device.c_str(), ec.message().c_str());
 			disconnect();
-		} else {
-			NOTICE_LOG(INPUT, "DreamPicoPort serial connection successful!");
+			return;
 		}
+		NOTICE_LOG(INPUT, "DreamPicoPort serial connection to %s successful!", serial_device.c_str());
 
 		// This must be done before the io_context is run because it will keep io_context from returning immediately
 		startSerialRead();
@@ -127,7 +115,9 @@ public:
 
 	~DreamPicoPortSerialHandler() {
 		disconnect();
-		io_context_thread->join();
+		if (io_context_thread) {
+			io_context_thread->join();
+		}
 	}
 
 	bool is_open() const {
@@ -196,45 +186,22 @@ public:
 		return transmit(cmd, false, expiration);
 	}
 
-private:
-	void disconnect()
+	struct SerialDevice
 	{
-		io_context.stop();
+		std::string path;
+		//! USB serial number of the device, if known
+		std::string serialNumber;
+	};
 
-		if (serial_handler.is_open()) {
-			try
-			{
-				serial_handler.cancel();
-			}
-			catch(const asio::system_error&)
-			{
-				// Ignore cancel errors
-			}
-		}
-
-		try
-		{
-			serial_handler.close();
-		}
-		catch(const asio::system_error&)
-		{
-			// Ignore closing errors
-		}
-	}
+	//! @return all the serial devices that may be a DreamPicoPort
+	static std::vector<SerialDevice> getSerialDevices() {
+		std::vector<SerialDevice> devices;
 
-	void contextThreadEnty()
-	{
-		// This context should never exit until disconnect due to read handler automatically rearming
-		io_context.run();
-	}
-
-	static std::string getFirstSerialDevice() {
-
-		// On Windows, we get the first serial device matching our VID/PID
+		// On Windows, we get the serial devices matching our VID/PID
 #if defined(_WIN32)
 		HDEVINFO deviceInfoSet = SetupDiGetClassDevs(NULL, "USB", NULL, DIGCF_PRESENT | DIGCF_ALLCLASSES);
 		if (deviceInfoSet == INVALID_HANDLE_VALUE) {
-			return "";
+			return devices;
 		}
 
 		SP_DEVINFO_DATA deviceInfoData;
@@ -254,9 +221,19 @@ private:
 							char portName[256];
 							DWORD portNameSize = sizeof(portName);
 							if (RegQueryValueEx(deviceKey, "PortName", NULL, NULL, (LPBYTE)portName, &portNameSize) == ERROR_SUCCESS) {
-								RegCloseKey(deviceKey);
-								SetupDiDestroyDeviceInfoList(deviceInfoSet);
-								return std::string(portName);
+								SerialDevice& device = devices.emplace_back();
+								device.path = portName;
+								// The serial interface is a child of the composite USB device,
+								// whose instance ID is USB\VID_1209&PID_2F07\<serial number>
+								DEVINST parent;
+								char instanceId[MAX_DEVICE_ID_LEN];
+								if (CM_Get_Parent(&parent, deviceInfoData.DevInst, 0) == CR_SUCCESS
+										&& CM_Get_Device_ID(parent, instanceId, sizeof(instanceId), 0) == CR_SUCCESS) {
+									const char *serial = strrchr(instanceId, '\\');
+									if (serial != nullptr) {
+										device.serialNumber = serial + 1;
+									}
+								}
 							}
 							RegCloseKey(deviceKey);
 						}
@@ -266,11 +243,10 @@ private:
 		}
 
 		SetupDiDestroyDeviceInfoList(deviceInfoSet);
-		return "";
 #endif
 
 #if defined(__linux__) || (defined(__APPLE__) && defined(TARGET_OS_MAC))
-	// On MacOS/Linux, we get the first serial device matching the device prefix
+	// On MacOS/Linux, we get the serial devices matching the device prefix
 	std::string device_prefix = "";
 
 #if defined(__linux__)
@@ -284,16 +260,57 @@ private:
 		struct dirent *ent;
 		if ((dir = opendir(path.c_str())) != NULL) {
 			while ((ent = readdir(dir)) != NULL) {
-				std::string device = ent->d_name;
-				if (device.find(device_prefix) != std::string::npos) {
-					closedir(dir);
-					return path + device;
+				std::string name = ent->d_name;
+				if (name.find(device_prefix) != std::string::npos) {
+					SerialDevice& device = devices.emplace_back();
+					device.path = path + name;
+#if defined(__linux__)
+					// The parent of the tty interface is the USB device
+					std::ifstream serialFile("/sys/class/tty/" + name + "/device/../serial");
+					std::getline(serialFile, device.serialNumber);
+#endif
 				}
 			}
 			closedir(dir);
 		}
-		return "";
+		// readdir order is unspecified
+		std::sort(devices.begin(), devices.end(), [](const SerialDevice& a, const SerialDevice& b) {
+			return a.path < b.path;
+		});
 #endif
+		return devices;
+	}
+
+private:
+	void disconnect()
+	{
+		io_context.stop();
+
+		if (serial_handler.is_open()) {
+			try
+			{
+				serial_handler.cancel();
+			}
+			catch(const asio::system_error&)
+			{
+				// Ignore cancel errors
+			}
+		}
+
+		try
+		{
+			serial_handler.close();
+		}
+		catch(const asio::system_error&)
+		{
+			// Ignore closing errors
+		}
+	}
+
+	void contextThreadEnty()
+	{
+		// This context should never exit until disconnect due to read handler automatically rearming
+		io_context.run();
 	}
 
 	asio::error_code transmit(
@@ -634,9 +651,14 @@ private:
 	}
 };
 
-// Define the static instances here
-std::unique_ptr<DreamPicoPortSerialHandler> DreamPicoPort::serial;
-std::atomic<std::uint32_t> DreamPicoPort::connected_dev_count = 0;
+//! Serial ports by device path. Each one is shared by all the interfaces of its device.
+static std::map<std::string, std::weak_ptr<DreamPicoPortSerialHandler>> serialHandlers;
+//! Serializes access to serialHandlers
+static std::mutex serialHandlersMutex;
+//! Timeout while establishing connection
+static constexpr std::chrono::milliseconds ConnectTimeout = std::chrono::seconds(1);
+//! How long to wait for the serial device to be usable once the controller is plugged in
+static constexpr std::chrono::milliseconds SerialDeviceTimeout = std::chrono::seconds(2);
 
 DreamPicoPort::DreamPicoPort(int bus, int joystick_idx, SDL_Joystick* sdl_joystick) :
 	software_bus(bus)
@@ -661,6 +683,8 @@ DreamPicoPort::~DreamPicoPort() {
 bool DreamPicoPort::send(const MapleMsg& msg) {
 	if (serial) {
 		asio::error_code ec = serial->sendMsg(msg, hardware_bus, timeout_ms);
+		if (ec)
+			metrics::dreamlinkError();
 		return !ec;
 	}
 
@@ -669,7 +693,12 @@ bool DreamPicoPort::send(const MapleMsg& msg) {
 
 bool DreamPicoPort::send(const MapleMsg& txMsg, MapleMsg& rxMsg) {
 	if (serial) {
+		const auto startTime = std::chrono::steady_clock::now();
 		asio::error_code ec = serial->sendMsg(txMsg, hardware_bus, rxMsg, timeout_ms);
+		if (ec)
+			metrics::dreamlinkError();
+		else
+			metrics::dreamlinkRoundTrip(std::chrono::steady_clock::now() - startTime);
 		return !ec;
 	}
 
@@ -778,46 +807,79 @@ std::string DreamPicoPort::getName(std::string separator) const {
 
 void DreamPicoPort::reloadConfigurationIfNeeded() {
 	// TODO: implementing this method may also help to support hot plugging of VMUs/rumble packs here.
+	if (!handshake_ready.exchange(false)) {
+		return;
+	}
+	if (applyHandshake()) {
+		if (g_dreamlink_manager) {
+			g_dreamlink_manager->markForReconnect(shared_from_this());
+		}
+		maple_ReconnectDevices();
+	}
 }
 
 void DreamPicoPort::connect() {
-	// Timeout is 1 second while establishing connection
-	timeout_ms = std::chrono::seconds(1);
-
-	if (connection_established && serial) {
+	if (connection_established) {
+		if (!serial) {
+			// Handshake in progress
+			return;
+		}
 		if (serial->is_open()) {
 			sendPort();
-		} else {
-			disconnect();
 			return;
 		}
+		disconnect();
 	}
 
-	++connected_dev_count;
 	connection_established = true;
-	if (!serial) {
-		serial = std::make_unique<DreamPicoPortSerialHandler>();
-	}
+	const u32 generation = ++connect_generation;
+	std::weak_ptr<DreamLink> weakThis = weak_from_this();
+	const int hardwareBus = hardware_bus;
+	const std::string serialNumber = serial_number;
+	// The handshakes of different devices run concurrently, away from the emulation and UI threads
+	TaskPool::instance().run(TaskPool::Background, [weakThis, generation, hardwareBus, serialNumber]()
+	{
+		std::unique_ptr<Handshake> result = std::make_unique<Handshake>();
+		if (!handshake(serialNumber, hardwareBus, *result)) {
+			result.reset();
+		}
+		std::shared_ptr<DreamLink> link = weakThis.lock();
+		if (link) {
+			static_cast<DreamPicoPort *>(link.get())->handshakeDone(generation, std::move(result));
+		}
+	});
+}
 
-	if (serial && serial->is_open()) {
-		sendPort();
-	} else {
-		disconnect();
+void DreamPicoPort::handshakeDone(u32 generation, std::unique_ptr<Handshake> handshake) {
+	std::lock_guard<std::mutex> lock(handshake_mutex);
+	if (generation != connect_generation) {
+		// Disconnected or reconnected in the meantime
 		return;
 	}
+	pending_handshake = std::move(handshake);
+	handshake_ready = true;
+}
 
-	if (!queryInterfaceVersion()) {
-		disconnect();
-		return;
+bool DreamPicoPort::applyHandshake() {
+	std::unique_ptr<Handshake> handshake;
+	{
+		std::lock_guard<std::mutex> lock(handshake_mutex);
+		handshake = std::move(pending_handshake);
 	}
-
-	if (!queryPeripherals()) {
+	if (!connection_established) {
+		return false;
+	}
+	if (!handshake) {
+		WARN_LOG(INPUT, "DreamPicoPort[%d] connection failed", software_bus);
 		disconnect();
-		return;
+		return false;
 	}
-
+	serial = std::move(handshake->serial);
+	interface_version = handshake->interface_version;
+	peripherals = std::move(handshake->peripherals);
 	// Timeout is extended to 5 seconds for all other communication after connection
 	timeout_ms = std::chrono::seconds(5);
+	sendPort();
 
 	int vmuCount = 0;
 	int vibrationCount = 0;
@@ -845,16 +907,96 @@ void DreamPicoPort::connect() {
 	}
 
 	NOTICE_LOG(INPUT, "Connected to DreamcastController[%d]: Type:%s, VMU:%d, Rumble Pack:%d", software_bus, getName().c_str(), vmuCount, vibrationCount);
+	return true;
 }
 
-void DreamPicoPort::disconnect() {
-	if (connection_established) {
-		connection_established = false;
-		if (--connected_dev_count == 0) {
-			// serial is no longer needed
-			serial.reset();
+std::string DreamPicoPort::findSerialDevice(const std::string& serialNumber) {
+	// use user-configured serial device if available
+	std::string device;
+	if (!serialNumber.empty()) {
+		device = cfgLoadStr("input", "DreamPicoPortSerialDevice." + serialNumber, "");
+	}
+	if (device.empty()) {
+		device = cfgLoadStr("input", "DreamPicoPortSerialDevice", "");
+	}
+	if (!device.empty()) {
+		return device;
+	}
+
+	const std::vector<DreamPicoPortSerialHandler::SerialDevice> devices = DreamPicoPortSerialHandler::getSerialDevices();
+	if (!serialNumber.empty()) {
+		for (const auto& dev : devices) {
+			// The serial number is part of the device name on macOS
+			if (dev.serialNumber == serialNumber
+					|| (dev.serialNumber.empty() && dev.path.find(serialNumber) != std::string::npos)) {
+				return dev.path;
+			}
+		}
+	}
+	// fallback to the only available device. With several devices, this could be the serial port of another one.
+	if (serialNumber.empty() ? !devices.empty() : devices.size() == 1) {
+		return devices[0].path;
+	}
+	return {};
+}
+
+//! @return the serial port of the given device, opened if needed, or null if it can't be opened
+static std::shared_ptr<DreamPicoPortSerialHandler> openSerial(const std::string& device) {
+	std::lock_guard<std::mutex> lock(serialHandlersMutex);
+	for (auto it = serialHandlers.begin(); it != serialHandlers.end(); ) {
+		if (it->second.expired()) {
+			it = serialHandlers.erase(it);
+		} else {
+			++it;
 		}
 	}
+	std::shared_ptr<DreamPicoPortSerialHandler> serial = serialHandlers[device].lock();
+	if (serial && serial->is_open()) {
+		return serial;
+	}
+	serial = std::make_shared<DreamPicoPortSerialHandler>(device);
+	if (!serial->is_open()) {
+		return nullptr;
+	}
+	serialHandlers[device] = serial;
+	return serial;
+}
+
+bool DreamPicoPort::handshake(const std::string& serialNumber, int hardwareBus, Handshake& handshake) {
+	// The serial device may take a while to show up and be usable once the controller is plugged in
+	const auto expiration = std::chrono::steady_clock::now() + SerialDeviceTimeout;
+	while (true)
+	{
+		const std::string device = findSerialDevice(serialNumber);
+		if (!device.empty()) {
+			handshake.serial = openSerial(device);
+			if (handshake.serial) {
+				NOTICE_LOG(INPUT, "DreamPicoPort %s bus %d using serial device %s", serialNumber.c_str(), hardwareBus, device.c_str());
+				break;
+			}
+		}
+		if (std::chrono::steady_clock::now() >= expiration) {
+			WARN_LOG(INPUT, "DreamPicoPort serial connection failed: %s", device.empty() ? "no serial device found" : device.c_str());
+			return false;
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	}
+
+	return queryInterfaceVersion(handshake, hardwareBus)
+			&& queryPeripherals(handshake, hardwareBus);
+}
+
+void DreamPicoPort::disconnect() {
+	// Discard any pending handshake
+	{
+		std::lock_guard<std::mutex> lock(handshake_mutex);
+		++connect_generation;
+		pending_handshake.reset();
+		handshake_ready = false;
+	}
+	connection_established = false;
+	// The serial port is closed once no interface uses it
+	serial.reset();
 }
 
 void DreamPicoPort::sendPort() {
@@ -984,24 +1126,24 @@ void DreamPicoPort::determineHardwareBus(int joystick_idx, SDL_Joystick* sdl_joy
 	}
 }
 
-bool DreamPicoPort::queryInterfaceVersion() {
+bool DreamPicoPort::queryInterfaceVersion(Handshake& handshake, int hardware_bus) {
 	std::string buffer;
-	asio::error_code error = serial->sendCmd("XV\n", buffer, timeout_ms);
+	asio::error_code error = handshake.serial->sendCmd("XV\n", buffer, ConnectTimeout);
 	if (error) {
-		WARN_LOG(INPUT, "DreamPicoPort[%d] send(XV) failed: %s", software_bus, error.message().c_str());
+		WARN_LOG(INPUT, "DreamPicoPort[%d] send(XV) failed: %s", hardware_bus, error.message().c_str());
 		return false;
 	}
 
 	if (0 == strncmp("*failed", buffer.c_str(), 7) || 0 == strncmp("0: failed", buffer.c_str(), 9)) {
 		// Using a version of firmware before "XV" was available
-		interface_version = 0.0;
+		handshake.interface_version = 0.0;
 	}
 	else {
 		try {
-			interface_version = std::stod(buffer);
+			handshake.interface_version = std::stod(buffer);
 		}
 		catch(const std::exception&) {
-			WARN_LOG(INPUT, "DreamPicoPort[%d] command XV received invalid response: %s", software_bus, buffer.c_str());
+			WARN_LOG(INPUT, "DreamPicoPort[%d] command XV received invalid response: %s", hardware_bus, buffer.c_str());
 			return false;
 		}
 	}
@@ -1009,9 +1151,9 @@ bool DreamPicoPort::queryInterfaceVersion() {
 	return true;
 }
 
-bool DreamPicoPort::queryPeripherals() {
+bool DreamPicoPort::queryPeripherals(Handshake& handshake, int hardware_bus) {
+	std::vector<std::vector<std::array<uint32_t, 2>>>& peripherals = handshake.peripherals;
 	peripherals.clear();
-	expansionDevs = 0;
 
 	MapleMsg msg;
 	msg.command = MDCF_GetCondition;
@@ -1019,21 +1161,21 @@ bool DreamPicoPort::queryPeripherals() {
 	msg.originAP = hardware_bus << 6;
 	msg.setData(MFID_0_Input);
 
-	asio::error_code error = serial->sendMsg(msg, hardware_bus, msg, timeout_ms);
+	asio::error_code error = handshake.serial->sendMsg(msg, hardware_bus, msg, ConnectTimeout);
 	if (error)
 	{
-		WARN_LOG(INPUT, "DreamPicoPort[%d] send(condition) failed: %s", software_bus, error.message().c_str());
+		WARN_LOG(INPUT, "DreamPicoPort[%d] send(condition) failed: %s", hardware_bus, error.message().c_str());
 		return true; // assume simply controller not connected yet
 	}
 
-	expansionDevs = msg.originAP & 0x1f;
+	const u8 expansionDevs = msg.originAP & 0x1f;
 
-	if (interface_version >= 1.0) {
+	if (handshake.interface_version >= 1.0) {
 		// Can just use X?
 		std::string buffer;
-		error = serial->sendCmd("X?" + std::to_string(hardware_bus) + "\n", buffer, timeout_ms);
+		error = handshake.serial->sendCmd("X?" + std::to_string(hardware_bus) + "\n", buffer, ConnectTimeout);
 		if (error) {
-			WARN_LOG(INPUT, "DreamPicoPort[%d] send(X?) failed: %s", software_bus, error.message().c_str());
+			WARN_LOG(INPUT, "DreamPicoPort[%d] send(X?) failed: %s", hardware_bus, error.message().c_str());
 			return false;
 		}
 
@@ -1087,14 +1229,14 @@ bool DreamPicoPort::queryPeripherals() {
 				msg.originAP = hardware_bus << 6;
 				msg.size = 0;
 
-				error = serial->sendMsg(msg, hardware_bus, msg, timeout_ms);
+				error = handshake.serial->sendMsg(msg, hardware_bus, msg, ConnectTimeout);
 				if (error) {
-					WARN_LOG(INPUT, "DreamPicoPort[%d] send(query) failed: %s", software_bus, error.message().c_str());
+					WARN_LOG(INPUT, "DreamPicoPort[%d] send(query) failed: %s", hardware_bus, error.message().c_str());
 					return false;
 				}
 
 				if (msg.size < 4) {
-					WARN_LOG(INPUT, "DreamPicoPort[%d] read(query) failed: invalid size %d", software_bus, msg.size);
+					WARN_LOG(INPUT, "DreamPicoPort[%d] read(query) failed: invalid size %d", hardware_bus, msg.size);
 					return false;
 				}
 
@@ -26,6 +26,9 @@
 
 #include <atomic>
 #include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
 #include <vector>
 #include <array>
 
@@ -35,12 +38,8 @@ class DreamPicoPortSerialHandler;
 //! See: https://github.com/OrangeFox86/DreamPicoPort
 class DreamPicoPort : public DreamLink
 {
-	u8 expansionDevs = 0;
-
-	//! The one and only serial port
-	static std::unique_ptr<DreamPicoPortSerialHandler> serial;
-	//! Number of devices using the above serial
-	static std::atomic<std::uint32_t> connected_dev_count;
+	//! Serial port of the device, shared by all its interfaces
+	std::shared_ptr<DreamPicoPortSerialHandler> serial;
 	//! Current timeout in milliseconds
 	std::chrono::milliseconds timeout_ms;
 	//! The bus ID dictated by flycast
@@ -51,7 +50,7 @@ class DreamPicoPort : public DreamLink
 	bool is_single_device = true;
 	//! True when initial enumeration failed
 	bool is_hardware_bus_implied = true;
-	//! True once connection is established
+	//! True once connection is requested, until disconnected
 	bool connection_established = false;
     //! The queried interface version
     double interface_version = 0.0;
@@ -62,6 +61,25 @@ class DreamPicoPort : public DreamLink
 	//! If set, the determined unique ID of this device. If not set, the serial could not be parsed.
 	std::string unique_id;
 
+public:
+	//! Result of the connection handshake
+	struct Handshake
+	{
+		std::shared_ptr<DreamPicoPortSerialHandler> serial;
+		double interface_version = 0.0;
+		std::vector<std::vector<std::array<uint32_t, 2>>> peripherals;
+	};
+
+private:
+	//! Incremented on each connection request to discard the results of outdated handshakes
+	std::atomic<u32> connect_generation = 0;
+	//! Set by the connection task when pending_handshake is available
+	std::atomic<bool> handshake_ready = false;
+	//! Result of the last handshake. Null if it failed.
+	std::unique_ptr<Handshake> pending_handshake;
+	//! Serializes access to pending_handshake
+	std::mutex handshake_mutex;
+
 public:
     //! Dreamcast Controller USB VID:1209 PID:2f07
     static constexpr const std::uint16_t VID = 0x1209;
@@ -97,8 +115,11 @@ public:
 
 	std::string getName() const override;
 
+	//! Applies the result of the connection handshake, if any.
+	//! Called at each vblank, so that the maple devices are swapped at a frame boundary.
 	void reloadConfigurationIfNeeded() override;
 
+	//! Starts the connection handshake in the background. Doesn't block.
 	void connect() override;
 
 	void disconnect() override;
@@ -111,6 +132,12 @@ public:
 
 	bool isSingleDevice() const;
 
+	//! Opens the serial device, or reuses the one already opened, and queries the interface version and the peripherals
+	//! connected to the given hardware bus. Blocks until done or timed out.
+	//! @param[in] serialNumber The USB serial number of the device or an empty string to autoselect
+	//! @return true if successful
+	static bool handshake(const std::string& serialNumber, int hardwareBus, Handshake& handshake);
+
 private:
 	std::string getName(std::string separator) const;
 
@@ -120,8 +147,15 @@ private:
     asio::error_code receiveCmd(std::string& cmd);
     asio::error_code receiveMsg(MapleMsg& msg);
 	void determineHardwareBus(int joystick_idx, SDL_Joystick* sdl_joystick);
-    bool queryInterfaceVersion();
-    bool queryPeripherals();
+	//! @return the path of the serial device with the given USB serial number. If not found, the path of the
+	//! first device if serialNumber is empty or the only device found, otherwise an empty string.
+	static std::string findSerialDevice(const std::string& serialNumber);
+	void handshakeDone(u32 generation, std::unique_ptr<Handshake> handshake);
+	bool applyHandshake();
+    static bool queryInterfaceVersion(Handshake& handshake, int hardwareBus);
+    static bool queryPeripherals(Handshake& handshake, int hardwareBus);
+
+	friend class DreamPicoPortTest_ConcurrentDevices_Test;
 };
 
 #endif // USE_DREAMCASTCONTROLLER
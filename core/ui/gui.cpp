@@ -28,6 +28,7 @@
 #include "network/ice.h"
 #include "wsi/context.h"
 #include "input/gamepad_device.h"
+#include "input/movie.h"
 #include "gui_util.h"
 #include "game_scanner.h"
 #include "version.h"
@@ -45,6 +46,7 @@
 #endif
 #include "boxart/boxart.h"
 #include "profiler/fc_profiler.h"
+#include "util/task_pool.h"
 #include "hw/naomi/card_reader.h"
 #include "oslib/resources.h"
 #include "achievements/achievements.h"
@@ -1649,6 +1651,44 @@ static void gui_debug_tab()
 		ImGui::InputText("Log Server", &config::LogServer.get(), ImGuiInputTextFlags_CharsNoBlank, nullptr, nullptr);
         ImGui::SameLine();
         ShowHelpMarker("Log to this hostname[:port] with UDP. Default port is 31667.");
+#ifdef ASYNC_LOG
+		ImGui::Text("Dropped messages: %llu", (unsigned long long)AsyncLog::DroppedCount());
+#endif
+	}
+	ImGui::Spacing();
+	header("Task Pool");
+	{
+		TaskPool& pool = TaskPool::instance();
+		ImGui::Text("Workers: %d", pool.threadCount());
+		static const char *priorities[] = { "High", "Normal", "Background" };
+		if (ImGui::BeginTable("taskpool", 6, ImGuiTableFlags_Borders | ImGuiTableFlags_SizingStretchSame))
+		{
+			ImGui::TableSetupColumn("Priority");
+			ImGui::TableSetupColumn("Submitted");
+			ImGui::TableSetupColumn("Completed");
+			ImGui::TableSetupColumn("Stolen");
+			ImGui::TableSetupColumn("Run time (ms)");
+			ImGui::TableSetupColumn("Max wait (ms)");
+			ImGui::TableHeadersRow();
+			for (int i = 0; i < TaskPool::PriorityCount; i++)
+			{
+				TaskPool::Stats stats = pool.getStats((TaskPool::Priority)i);
+				ImGui::TableNextRow();
+				ImGui::TableNextColumn();
+				ImGui::Text("%s", priorities[i]);
+				ImGui::TableNextColumn();
+				ImGui::Text("%llu", (unsigned long long)stats.submitted);
+				ImGui::TableNextColumn();
+				ImGui::Text("%llu", (unsigned long long)stats.completed);
+				ImGui::TableNextColumn();
+				ImGui::Text("%llu", (unsigned long long)stats.stolen);
+				ImGui::TableNextColumn();
+				ImGui::Text("%.1f", stats.runTimeUs / 1000.0);
+				ImGui::TableNextColumn();
+				ImGui::Text("%.1f", stats.maxWaitUs / 1000.0);
+			}
+			ImGui::EndTable();
+		}
 	}
 #if FC_PROFILER
 	ImGui::Spacing();
@@ -1664,6 +1704,22 @@ static void gui_debug_tab()
 		OptionCheckbox("Display", config::ProfilerDrawToGUI, "Draw the profiler output in an overlay.");
 		OptionCheckbox("Output to terminal", config::ProfilerOutputTTY, "Write the profiler output to the terminal");
 		// TODO frame warning time
+		if (!fc_profiler::capturing())
+		{
+			if (ImGui::Button("Start Trace Capture"))
+				fc_profiler::startCapture();
+		}
+		else if (ImGui::Button("Save Trace Capture"))
+		{
+			std::string path = get_writable_data_path("flycast-trace.json");
+			if (fc_profiler::stopCapture(path))
+				os_notify("Trace saved", 2000, path.c_str());
+			else
+				os_notify("Trace capture failed", 5000);
+		}
+		ImGui::SameLine();
+		ShowHelpMarker("Record the profiled sections of all threads and save them in the Chrome trace format. "
+				"The trace can be opened in chrome://tracing or ui.perfetto.dev");
 		if (!config::ProfilerEnabled)
 		{
 			ImGui::PopItemFlag();
@@ -2442,6 +2498,8 @@ static void gui_settings_video()
 
     	OptionArrowButtons("Frame Skipping", config::SkipFrame, 0, 6,
     			"Number of frames to skip between two actually rendered frames");
+    	OptionArrowButtons("Fast-Forward Rendering", config::FastForwardFrames, 0, 10,
+    			"Render one frame out of N when fast-forwarding. 0 renders as many frames as the display can show");
     	OptionCheckbox("Shadows", config::ModifierVolumes,
     			"Enable modifier volumes, usually used for shadows");
     	OptionCheckbox("Fog", config::Fog, "Enable fog effects");
@@ -2513,14 +2571,12 @@ static void gui_settings_video()
 	ImGui::Spacing();
     header("Texture Upscaling");
     {
-#ifdef _OPENMP
     	OptionArrowButtons("Texture Upscaling", config::TextureUpscale, 1, 8,
     			"Upscale textures with the xBRZ algorithm. Only on fast platforms and for certain 2D games", "x%d");
     	OptionSlider("Texture Max Size", config::MaxFilteredTextureSize, 8, 1024,
     			"Textures larger than this dimension squared will not be upscaled");
     	OptionArrowButtons("Max Threads", config::MaxThreads, 1, 8,
     			"Maximum number of threads to use for texture upscaling. Recommended: number of physical cores minus one");
-#endif
     }
 #ifdef VIDEO_ROUTING
 #ifdef __APPLE__
@@ -2732,13 +2788,40 @@ static void gui_settings_network()
 		if (config::GGPOEnable)
 		{
 			config::NetworkEnable = false;
-			OptionCheckbox("Play as Player 1", config::ActAsServer,
-					"Deselect to play as player 2");
-			ImGui::InputText("Peer", &config::NetworkServer.get(), ImGuiInputTextFlags_CharsNoBlank, nullptr, nullptr);
-			ImGui::SameLine();
-			ShowHelpMarker("Your peer IP address and optional port");
-			OptionSlider("Frame Delay", config::GGPODelay, 0, 20,
-				"Sets Frame Delay, advisable for sessions with ping >100 ms");
+			OptionCheckbox("Spectate", config::GGPOSpectate,
+					"Watch a game instead of playing");
+			if (config::GGPOSpectate)
+			{
+				ImGui::InputText("Host", &config::NetworkServer.get(), ImGuiInputTextFlags_CharsNoBlank, nullptr, nullptr);
+				ImGui::SameLine();
+				ShowHelpMarker("The IP address and optional port of player 1 or of a relay");
+				char localPort[256];
+				snprintf(localPort, sizeof(localPort), "%d", (int)config::LocalPort);
+				ImGui::InputText("Local Port", localPort, sizeof(localPort), ImGuiInputTextFlags_CharsDecimal, nullptr, nullptr);
+				ImGui::SameLine();
+				ShowHelpMarker("The local UDP port to use");
+				config::LocalPort.set(atoi(localPort));
+			}
+			else
+			{
+				OptionCheckbox("Play as Player 1", config::ActAsServer,
+						"Deselect to play as player 2");
+				ImGui::InputText("Peer", &config::NetworkServer.get(), ImGuiInputTextFlags_CharsNoBlank, nullptr, nullptr);
+				ImGui::SameLine();
+				ShowHelpMarker("Your peer IP address and optional port");
+				OptionSlider("Frame Delay", config::GGPODelay, 0, 20,
+					"Sets Frame Delay, advisable for sessions with ping >100 ms");
+			}
+			if (config::GGPOSpectate || config::ActAsServer)
+			{
+				ImGui::InputText("Spectators", &config::GGPOSpectators.get(), ImGuiInputTextFlags_CharsNoBlank, nullptr, nullptr);
+				ImGui::SameLine();
+				ShowHelpMarker("Comma-separated list of spectator IP addresses and optional ports. "
+						"When spectating, this instance relays the game to them");
+				if (config::GGPOSpectate && !config::GGPOSpectators.get().empty())
+					OptionSlider("Relay Delay", config::GGPORelayDelay, 0, 600,
+						"Number of frames the inputs are held before being sent to spectators");
+			}
 
 			ImGui::Text("Left Thumbstick:");
 			OptionRadioButton<int>("Disabled##analogaxis", config::GGPOAnalogAxes, 0, "Left thumbstick not used");
@@ -2944,6 +3027,11 @@ static void gui_settings_advanced()
     	OptionCheckbox("HLE BIOS", config::UseReios, "Force high-level BIOS emulation");
         OptionCheckbox("Multi-threaded emulation", config::ThreadedRendering,
         		"Run the emulated CPU and GPU on different threads");
+#if defined(__linux__) || defined(_WIN32)
+        OptionCheckbox("Dedicated CPU Cores", config::PinThreads,
+        		"Run the emulation and render threads on their own cores, and background tasks on the remaining ones. "
+        		"Requires at least 4 cores and a restart");
+#endif
 #if !defined(__ANDROID) && !defined(GDB_SERVER)
         OptionCheckbox("Serial Console", config::SerialConsole,
         		"Dump the Dreamcast serial console to stdout");
@@ -2952,6 +3040,11 @@ static void gui_settings_advanced()
 			DisabledScope scope(game_started);
 			OptionCheckbox("Dreamcast 32MB RAM Mod", config::RamMod32MB,
 				"Enables 32MB RAM Mod for Dreamcast. May affect compatibility");
+#if defined(__linux__) && !defined(__ANDROID__)
+			OptionCheckbox("Huge Pages", config::HugePages,
+				"Use transparent huge pages for the emulated RAM. Reduces TLB misses. "
+				"Requires /sys/kernel/mm/transparent_hugepage/shmem_enabled to be set to advise");
+#endif
 		}
         OptionCheckbox("Dump Textures", config::DumpTextures,
         		"Dump all textures into data/texdump/<game id>");
@@ -3642,6 +3735,7 @@ static void gui_display_loadscreen()
 				}
 				else
 				{
+					movie::start();
 					gui_setState(GuiState::Closed);
 					ImGui::Text("%s", label);
 				}
@@ -3891,6 +3985,7 @@ void fatal_error(const char* text, ...)
     vsnprintf(temp, sizeof(temp), text, args);
     va_end(args);
     ERROR_LOG(COMMON, "%s", temp);
+    LogManager::Flush();
 
     os_notify("Fatal Error", 20000, temp);
 }
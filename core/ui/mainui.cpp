@@ -26,6 +26,7 @@
 #include "emulator.h"
 #include "imgui_driver.h"
 #include "profiler/fc_profiler.h"
+#include "util/task_pool.h"
 
 #include <chrono>
 #include <thread>
@@ -81,6 +82,7 @@ void mainui_term()
 void mainui_loop(bool forceStart)
 {
 	ThreadName _("Flycast-rend");
+	TaskPool::setThreadRole(TaskPool::ThreadRole::Render);
 	if (forceStart)
 		mainui_enabled = true;
 	mainui_init();
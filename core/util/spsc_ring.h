@@ -0,0 +1,124 @@
+/*
+	Copyright 2026 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include <atomic>
+#include <algorithm>
+#include <cstddef>
+
+//
+// Lock-free single-producer single-consumer ring buffer.
+// push() must only be called by the producer thread, pop() and clear() by the consumer thread.
+// Capacity must be a power of 2.
+//
+template<typename T, size_t Capacity>
+class SpscRing
+{
+	static_assert(Capacity != 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of 2");
+
+public:
+	// Returns the number of elements pushed, which may be less than len if the ring is full
+	size_t push(const T *data, size_t len)
+	{
+		const size_t tail = writeIdx.load(std::memory_order_relaxed);
+		const size_t head = readIdx.load(std::memory_order_acquire);
+		len = std::min(len, Capacity - (tail - head));
+		const size_t pos = tail & Mask;
+		const size_t first = std::min(len, Capacity - pos);
+		std::copy(data, data + first, buffer + pos);
+		std::copy(data + first, data + len, buffer);
+		writeIdx.store(tail + len, std::memory_order_release);
+
+		return len;
+	}
+
+	bool push(const T& t) {
+		return push(&t, 1) == 1;
+	}
+
+	// Returns the number of elements popped, which may be less than len if the ring doesn't hold enough
+	size_t pop(T *data, size_t len)
+	{
+		const size_t head = readIdx.load(std::memory_order_relaxed);
+		const size_t tail = writeIdx.load(std::memory_order_acquire);
+		len = std::min(len, tail - head);
+		const size_t pos = head & Mask;
+		const size_t first = std::min(len, Capacity - pos);
+		// pos + first can be the end of the buffer
+		std::copy(buffer + pos, buffer + pos + first, data);
+		std::copy(buffer, buffer + len - first, data + first);
+		readIdx.store(head + len, std::memory_order_release);
+
+		return len;
+	}
+
+	bool pop(T& t) {
+		return pop(&t, 1) == 1;
+	}
+
+	// Zero-copy producer access: returns the next free slot, or nullptr if the ring is full.
+	// The element is published by calling commit().
+	T *reserve()
+	{
+		const size_t tail = writeIdx.load(std::memory_order_relaxed);
+		if (tail - readIdx.load(std::memory_order_acquire) == Capacity)
+			return nullptr;
+		return &buffer[tail & Mask];
+	}
+	void commit() {
+		writeIdx.store(writeIdx.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+	}
+
+	// Zero-copy consumer access: returns the oldest element, or nullptr if the ring is empty.
+	// The element is released by calling popFront().
+	T *front()
+	{
+		const size_t head = readIdx.load(std::memory_order_relaxed);
+		if (writeIdx.load(std::memory_order_acquire) == head)
+			return nullptr;
+		return &buffer[head & Mask];
+	}
+	void popFront() {
+		readIdx.store(readIdx.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+	}
+
+	size_t size() const {
+		return writeIdx.load(std::memory_order_acquire) - readIdx.load(std::memory_order_acquire);
+	}
+	bool empty() const {
+		return size() == 0;
+	}
+	bool full() const {
+		return size() == Capacity;
+	}
+	static constexpr size_t capacity() {
+		return Capacity;
+	}
+
+	// Discard all elements. Consumer only.
+	void clear() {
+		readIdx.store(writeIdx.load(std::memory_order_acquire), std::memory_order_release);
+	}
+
+private:
+	static constexpr size_t Mask = Capacity - 1;
+
+	T buffer[Capacity];
+	alignas(64) std::atomic<size_t> writeIdx { 0 };
+	alignas(64) std::atomic<size_t> readIdx { 0 };
+};
@@ -0,0 +1,381 @@
+/*
+	Copyright 2026 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "task_pool.h"
+#include "oslib/oslib.h"
+#include "cfg/option.h"
+#include "log/Log.h"
+#include <algorithm>
+#include <stdexcept>
+
+#if defined(__linux__) || defined(__ANDROID__)
+#include <sched.h>
+#elif defined(_WIN32)
+#include <windows.h>
+#endif
+
+static thread_local int workerIndex = -1;
+
+// Core allocation when threads are pinned:
+// last core: emulator thread, second to last: render thread, other cores: pool workers.
+// At least 4 cores are needed.
+constexpr unsigned MinPinnedCores = 4;
+
+static unsigned cpuCount() {
+	return std::max(1u, std::thread::hardware_concurrency());
+}
+
+static bool setThreadAffinity(u64 mask)
+{
+#if defined(__linux__) || defined(__ANDROID__)
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	for (unsigned i = 0; i < 64; i++)
+		if (mask & (1ull << i))
+			CPU_SET(i, &set);
+	return sched_setaffinity(0, sizeof(set), &set) == 0;
+#elif defined(_WIN32)
+	return SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)mask) != 0;
+#else
+	(void)mask;
+	return false;
+#endif
+}
+
+static u64 allCores()
+{
+	unsigned count = std::min(cpuCount(), 64u);
+	return count == 64 ? ~0ull : (1ull << count) - 1;
+}
+
+static bool pinningEnabled() {
+	return config::PinThreads && cpuCount() >= MinPinnedCores && cpuCount() <= 64;
+}
+
+void TaskPool::setThreadRole(ThreadRole role)
+{
+	static thread_local bool pinned;
+	if (!pinningEnabled())
+	{
+		// Undo a previous pinning
+		if (pinned && setThreadAffinity(allCores()))
+			pinned = false;
+		return;
+	}
+	const unsigned core = role == ThreadRole::Emulator ? cpuCount() - 1 : cpuCount() - 2;
+	if (setThreadAffinity(1ull << core))
+	{
+		pinned = true;
+		DEBUG_LOG(COMMON, "%s thread pinned to core %d", role == ThreadRole::Emulator ? "Emulator" : "Render", core);
+	}
+	else {
+		WARN_LOG(COMMON, "Can't set the affinity of the %s thread", role == ThreadRole::Emulator ? "emulator" : "render");
+	}
+}
+
+TaskPool& TaskPool::instance()
+{
+	static TaskPool pool;
+	return pool;
+}
+
+void TaskPool::start()
+{
+	std::lock_guard<std::mutex> _(startMutex);
+	if (started)
+		return;
+	if (workers.empty())
+	{
+		// Leave a core to the emulator and render threads, but keep at least 2 workers
+		computeGroup.first = 0;
+		computeGroup.count = std::max(2, (int)cpuCount() - 2);
+		ioGroup.first = computeGroup.count;
+		ioGroup.count = IoWorkerCount;
+		for (int i = 0; i < computeGroup.count + ioGroup.count; i++)
+			workers.push_back(std::make_unique<Worker>());
+	}
+	const bool pin = pinningEnabled();
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+		stopping = false;
+	}
+	for (int i = 0; i < (int)workers.size(); i++)
+	{
+		workers[i]->thread = std::thread([this, i, pin]() {
+			ThreadName _(i < ioGroup.first ? "TaskPool" : "TaskPool-IO");
+			if (pin)
+				// all the cores but the emulator and render ones
+				setThreadAffinity((1ull << (cpuCount() - 2)) - 1);
+			workerLoop(i);
+		});
+	}
+	INFO_LOG(COMMON, "Task pool started with %d workers and %d I/O workers", computeGroup.count, ioGroup.count);
+	started = true;
+}
+
+void TaskPool::stop()
+{
+	std::lock_guard<std::mutex> _(startMutex);
+	if (!started)
+		return;
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+		stopping = true;
+	}
+	computeGroup.cv.notify_all();
+	ioGroup.cv.notify_all();
+	for (auto& worker : workers)
+		if (worker->thread.joinable())
+			worker->thread.join();
+	// Run the tasks submitted while the workers were exiting
+	while (true)
+	{
+		{
+			std::lock_guard<std::mutex> lock(sleepMutex);
+			if (computeGroup.pending == 0 && ioGroup.pending == 0)
+			{
+				// run() restarts the pool if it queues a task from now on
+				started = false;
+				break;
+			}
+		}
+		for (Group *group : { &computeGroup, &ioGroup })
+		{
+			Task task;
+			Priority priority;
+			if (popTask(group->first, task, priority))
+			{
+				{
+					std::lock_guard<std::mutex> lock(sleepMutex);
+					group->pending--;
+				}
+				execute(task, priority);
+			}
+		}
+	}
+}
+
+int TaskPool::threadCount() const {
+	return started ? computeGroup.count : 0;
+}
+
+void TaskPool::run(Priority priority, Function&& task)
+{
+	if (!started)
+		start();
+	Group& group = priority == Background ? ioGroup : computeGroup;
+	Task t { std::move(task), the_clock::now() };
+	// Tasks submitted by a worker go to its own queue
+	int index = workerIndex;
+	if (index < group.first || index >= group.first + group.count)
+		index = group.first + nextWorker++ % group.count;
+	{
+		Worker& worker = *workers[index];
+		std::lock_guard<std::mutex> _(worker.mutex);
+		worker.queues[priority].push_back(std::move(t));
+	}
+	stats[priority].submitted++;
+	bool stopped;
+	{
+		std::lock_guard<std::mutex> _(sleepMutex);
+		group.pending++;
+		stopped = !started;
+	}
+	if (stopped)
+		// stop() returned before seeing this task
+		start();
+	else
+		group.cv.notify_one();
+}
+
+bool TaskPool::popTask(int index, Task& task, Priority& priority)
+{
+	const Group& group = groupOf(index);
+	const bool io = &group == &ioGroup;
+	for (int prio = io ? Background : High; prio < (io ? PriorityCount : Background); prio++)
+	{
+		// Newest task of our own queue first
+		{
+			Worker& worker = *workers[index];
+			std::lock_guard<std::mutex> _(worker.mutex);
+			auto& queue = worker.queues[prio];
+			if (!queue.empty())
+			{
+				task = std::move(queue.back());
+				queue.pop_back();
+				priority = (Priority)prio;
+				return true;
+			}
+		}
+		// Then steal the oldest task of another worker of the group
+		for (int i = 1; i < group.count; i++)
+		{
+			Worker& victim = *workers[group.first + (index - group.first + i) % group.count];
+			std::lock_guard<std::mutex> _(victim.mutex);
+			auto& queue = victim.queues[prio];
+			if (!queue.empty())
+			{
+				task = std::move(queue.front());
+				queue.pop_front();
+				priority = (Priority)prio;
+				stats[prio].stolen++;
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+void TaskPool::execute(Task& task, Priority priority)
+{
+	AtomicStats& st = stats[priority];
+	const the_clock::time_point startTime = the_clock::now();
+	const u64 waitUs = std::chrono::duration_cast<std::chrono::microseconds>(startTime - task.queuedTime).count();
+	u64 maxWait = st.maxWaitUs.load(std::memory_order_relaxed);
+	while (waitUs > maxWait && !st.maxWaitUs.compare_exchange_weak(maxWait, waitUs))
+		;
+	try {
+		task.func();
+	} catch (const std::runtime_error& e) {
+		ERROR_LOG(COMMON, "TaskPool: runtime error %s", e.what());
+	} catch (...) {
+		ERROR_LOG(COMMON, "TaskPool: unknown exception");
+	}
+	task.func = nullptr;
+	st.runTimeUs += std::chrono::duration_cast<std::chrono::microseconds>(the_clock::now() - startTime).count();
+	st.completed++;
+}
+
+void TaskPool::workerLoop(int index)
+{
+	workerIndex = index;
+	Group& group = groupOf(index);
+	while (true)
+	{
+		Task task;
+		Priority priority;
+		if (popTask(index, task, priority))
+		{
+			{
+				std::lock_guard<std::mutex> _(sleepMutex);
+				group.pending--;
+			}
+			execute(task, priority);
+			continue;
+		}
+		std::unique_lock<std::mutex> lock(sleepMutex);
+		// Pending tasks are always run before exiting
+		if (group.pending == 0 && stopping)
+			break;
+		group.cv.wait(lock, [this, &group]() { return group.pending > 0 || stopping; });
+	}
+	workerIndex = -1;
+}
+
+TaskPool::Stats TaskPool::getStats(Priority priority) const
+{
+	const AtomicStats& st = stats[priority];
+	return Stats { st.submitted, st.completed, st.stolen, st.runTimeUs, st.maxWaitUs };
+}
+
+void TaskPool::parallelFor(int start, int end, const std::function<void(int, int)>& func, int maxThreads)
+{
+	if (!started)
+		this->start();
+	const int count = end - start;
+	int chunks = std::min(count, threadCount() + 1);
+	if (maxThreads > 0)
+		chunks = std::min(chunks, maxThreads);
+	if (chunks <= 1)
+	{
+		if (count > 0)
+			func(start, end);
+		return;
+	}
+	struct Job
+	{
+		std::atomic<int> next {};
+		int done = 0;
+		std::mutex mutex;
+		std::condition_variable cv;
+	};
+	auto job = std::make_shared<Job>();
+	// func is only used while the caller is waiting for the chunks to complete
+	auto work = [job, &func, start, count, chunks]()
+	{
+		int chunk;
+		while ((chunk = job->next++) < chunks)
+		{
+			func(start + count * chunk / chunks, start + count * (chunk + 1) / chunks);
+			std::lock_guard<std::mutex> _(job->mutex);
+			if (++job->done == chunks)
+				job->cv.notify_all();
+		}
+	};
+	for (int i = 1; i < chunks; i++)
+		run(High, work);
+	work();
+	std::unique_lock<std::mutex> lock(job->mutex);
+	job->cv.wait(lock, [&job, chunks]() { return job->done == chunks; });
+}
+
+void TaskQueue::run(Function&& task)
+{
+	{
+		std::lock_guard<std::mutex> _(state->mutex);
+		state->tasks.push_back(std::move(task));
+		if (state->scheduled)
+			return;
+		state->scheduled = true;
+	}
+	TaskPool::instance().run(priority, [name = this->name, state = this->state]() {
+		drain(name, state);
+	});
+}
+
+void TaskQueue::drain(const char *name, const std::shared_ptr<State>& state)
+{
+	while (true)
+	{
+		Function func;
+		{
+			std::lock_guard<std::mutex> _(state->mutex);
+			if (state->tasks.empty())
+			{
+				state->scheduled = false;
+				state->idleCv.notify_all();
+				return;
+			}
+			func = std::move(state->tasks.front());
+			state->tasks.pop_front();
+		}
+		try {
+			func();
+		} catch (const std::runtime_error& e) {
+			ERROR_LOG(COMMON, "TaskQueue %s: runtime error %s", name, e.what());
+		} catch (...) {
+			ERROR_LOG(COMMON, "TaskQueue %s: unknown exception", name);
+		}
+	}
+}
+
+void TaskQueue::stop()
+{
+	std::unique_lock<std::mutex> lock(state->mutex);
+	state->idleCv.wait(lock, [this]() { return !state->scheduled; });
+}
@@ -0,0 +1,205 @@
+/*
+	Copyright 2026 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include "types.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//
+// Work-stealing thread pool shared by all background work.
+// Each worker has its own task deques, one per priority. A worker runs the newest task of its own deques
+// and steals the oldest task of the other workers when it has nothing to do.
+// Higher priority tasks are always picked first.
+// Background tasks may block on I/O, so they run on a separate group of workers and never delay the others.
+//
+class TaskPool
+{
+public:
+	using Function = std::function<void()>;
+
+	enum Priority {
+		High,			// Latency sensitive work the emulation or render thread is waiting for
+		Normal,			// Asset loading
+		Background,		// Long running or blocking I/O work
+		PriorityCount
+	};
+
+	enum class ThreadRole {
+		Emulator,
+		Render
+	};
+
+	struct Stats
+	{
+		u64 submitted;
+		u64 completed;
+		u64 stolen;
+		u64 runTimeUs;		// total execution time
+		u64 maxWaitUs;		// longest time spent in queue
+	};
+
+	static TaskPool& instance();
+
+	~TaskPool() {
+		stop();
+	}
+
+	void run(Priority priority, Function&& task);
+
+	template<class F, class... Args>
+	auto runFuture(Priority priority, F&& f, Args&&... args) -> std::future<typename std::result_of<F(Args...)>::type>
+	{
+		using return_type = typename std::result_of<F(Args...)>::type;
+		auto task = std::make_shared<std::packaged_task<return_type()>>(
+				std::bind(std::forward<F>(f), std::forward<Args>(args)...));
+
+		run(priority, [task]() {
+			(*task)();
+		});
+		return task->get_future();
+	}
+
+	// Split [start, end) into at most maxThreads ranges processed in parallel.
+	// The calling thread takes part in the work and returns once all ranges are done.
+	void parallelFor(int start, int end, const std::function<void(int, int)>& func, int maxThreads = 0);
+
+	// Run all pending tasks and terminate the workers. The pool is restarted by the next submitted task.
+	void stop();
+
+	// Number of workers running High and Normal tasks, 0 if the pool isn't started
+	int threadCount() const;
+	Stats getStats(Priority priority) const;
+
+	// Pin the calling thread to its dedicated core if config::PinThreads is enabled
+	static void setThreadRole(ThreadRole role);
+
+private:
+	using the_clock = std::chrono::steady_clock;
+
+	struct Task
+	{
+		Function func;
+		the_clock::time_point queuedTime;
+	};
+
+	struct Worker
+	{
+		std::mutex mutex;
+		std::deque<Task> queues[PriorityCount];
+		std::thread thread;
+	};
+
+	// Workers sharing the same tasks
+	struct Group
+	{
+		int first = 0;		// index of the first worker
+		int count = 0;
+		int pending = 0;	// number of queued tasks, protected by sleepMutex
+		std::condition_variable cv;
+	};
+
+	struct AtomicStats
+	{
+		std::atomic<u64> submitted {};
+		std::atomic<u64> completed {};
+		std::atomic<u64> stolen {};
+		std::atomic<u64> runTimeUs {};
+		std::atomic<u64> maxWaitUs {};
+	};
+
+	static constexpr int IoWorkerCount = 4;
+
+	TaskPool() = default;
+	void start();
+	void workerLoop(int index);
+	bool popTask(int index, Task& task, Priority& priority);
+	void execute(Task& task, Priority priority);
+	Group& groupOf(int index) {
+		return index >= ioGroup.first ? ioGroup : computeGroup;
+	}
+
+	std::mutex startMutex;
+	// Created by the first start() and only destroyed with the pool, so that run() can use it
+	// while the pool is being stopped
+	std::vector<std::unique_ptr<Worker>> workers;
+	std::atomic<bool> started { false };
+	bool stopping = false;
+
+	std::mutex sleepMutex;
+	Group computeGroup;		// High and Normal tasks
+	Group ioGroup;			// Background tasks
+
+	std::atomic<u32> nextWorker {};
+	AtomicStats stats[PriorityCount];
+};
+
+//
+// Runs tasks sequentially, in submission order, on the shared task pool
+//
+class TaskQueue
+{
+public:
+	using Function = TaskPool::Function;
+
+	TaskQueue(const char *name, TaskPool::Priority priority = TaskPool::Normal)
+		: name(name), priority(priority), state(std::make_shared<State>()) {
+	}
+	~TaskQueue() {
+		stop();
+	}
+
+	void run(Function&& task);
+
+	template<class F, class... Args>
+	auto runFuture(F&& f, Args&&... args) -> std::future<typename std::result_of<F(Args...)>::type>
+	{
+		using return_type = typename std::result_of<F(Args...)>::type;
+		auto task = std::make_shared<std::packaged_task<return_type()>>(
+				std::bind(std::forward<F>(f), std::forward<Args>(args)...));
+
+		run([task]() {
+			(*task)();
+		});
+		return task->get_future();
+	}
+
+	// Wait until all the queued tasks have been executed
+	void stop();
+
+private:
+	struct State
+	{
+		std::mutex mutex;
+		std::condition_variable idleCv;
+		std::deque<Function> tasks;
+		bool scheduled = false;
+	};
+	static void drain(const char *name, const std::shared_ptr<State>& state);
+
+	const char * const name;
+	const TaskPool::Priority priority;
+	std::shared_ptr<State> state;
+};
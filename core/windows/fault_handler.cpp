@@ -20,6 +20,7 @@
 #include "rend/TexCache.h"
 #include "hw/mem/addrspace.h"
 #include "hw/mem/mem_watch.h"
+#include "log/LogManager.h"
 #include <windows.h>
 
 static PVOID vectoredHandler;
@@ -113,6 +114,7 @@ static LONG WINAPI exceptionHandler(EXCEPTION_POINTERS *ep)
 
 	if (dwCode != EXCEPTION_ACCESS_VIOLATION)
 	{
+		LogManager::Flush();
 		// Call the previous unhandled exception handler (presumably Breakpad) if any and terminate
 	    if (prevExceptionHandler != nullptr)
 	    {
@@ -154,6 +156,7 @@ static LONG WINAPI exceptionHandler(EXCEPTION_POINTERS *ep)
 #endif
 
 	ERROR_LOG(COMMON, "[GPF] Thread:%s PC %p unhandled access to %p", getThreadName(), (void *)context.pc, address);
+	LogManager::Flush();
 	if (prevExceptionHandler != nullptr)
 		prevExceptionHandler(ep);
 
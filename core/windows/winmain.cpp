@@ -38,6 +38,7 @@
 #include "ui/mainui.h"
 #include "oslib/directory.h"
 #include "dynlink.h"
+#include "profiler/benchmark.h"
 #ifdef USE_BREAKPAD
 #include "breakpad/client/windows/handler/exception_handler.h"
 #include "version.h"
@@ -359,12 +360,16 @@ int main(int argc, char* argv[])
 #endif
 	os_InstallFaultHandler();
 
-	mainui_loop();
+	int rc = 0;
+	if (benchmark::active())
+		rc = benchmark::run();
+	else
+		mainui_loop();
 
 	flycast_term();
 	os_UninstallFaultHandler();
 
-	return 0;
+	return rc;
 }
 
 [[noreturn]] void os_DebugBreak()
@@ -0,0 +1,260 @@
+#include "gtest/gtest.h"
+#include "types.h"
+
+#if defined(USE_DREAMCASTCONTROLLER) && !defined(_WIN32)
+#include "hw/maple/maple_devs.h"
+#include "sdl/dreamlink_mux.h"
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include <stdlib.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace std::chrono_literals;
+
+//
+// Loopback device: returns the data it receives
+//
+class LoopbackDreamLink : public DreamLink
+{
+public:
+	LoopbackDreamLink(int bus) : bus(bus) {}
+
+	bool send(const MapleMsg& msg) override {
+		sent++;
+		return true;
+	}
+
+	bool send(const MapleMsg& txMsg, MapleMsg& rxMsg) override
+	{
+		transfers++;
+		rxMsg.command = MDRS_DataTransfer;
+		rxMsg.destAP = txMsg.originAP;
+		rxMsg.originAP = txMsg.destAP;
+		rxMsg.size = txMsg.size;
+		memcpy(rxMsg.data, txMsg.data, txMsg.getDataSize());
+		return true;
+	}
+
+	u32 getFunctionCode(int forPort) const override {
+		return forPort == 1 ? MFID_1_Storage : forPort == 2 ? MFID_8_Vibration : 0;
+	}
+
+	std::array<u32, 3> getFunctionDefinitions(int forPort) const override {
+		return { (u32)forPort, 2, 3 };
+	}
+
+	int getBus() const override {
+		return bus;
+	}
+
+	void changeBus(int newBus) override {
+		bus = newBus;
+	}
+
+	std::string getName() const override {
+		return "Loopback";
+	}
+
+	void reloadConfigurationIfNeeded() override {}
+	void connect() override {}
+	void disconnect() override {}
+
+	std::atomic<int> sent {};
+	std::atomic<int> transfers {};
+
+private:
+	int bus;
+};
+
+class DreamLinkMuxTest : public ::testing::Test
+{
+protected:
+	void SetUp() override {
+		socketPath = "/tmp/flycast-dreamlink-test-" + std::to_string(getpid());
+	}
+
+	static MapleMsg makeMsg(u32 value)
+	{
+		MapleMsg msg;
+		msg.command = MDCF_BlockRead;
+		msg.destAP = 0x01;
+		msg.originAP = 0x00;
+		msg.setWord(value, 0);
+		msg.setWord(~value, 1);
+		return msg;
+	}
+
+	static bool checkTransfer(DreamLinkClient& client, u32 value)
+	{
+		MapleMsg rxMsg;
+		if (!client.send(makeMsg(value), rxMsg))
+			return false;
+		u32 data[2];
+		memcpy(data, rxMsg.data, sizeof(data));
+		return rxMsg.command == MDRS_DataTransfer && rxMsg.size == 2 && data[0] == value && data[1] == ~value;
+	}
+
+	std::string socketPath;
+};
+
+TEST_F(DreamLinkMuxTest, Describe)
+{
+	DreamLinkServer server(socketPath);
+	ASSERT_TRUE(server.isRunning());
+	auto link = std::make_shared<LoopbackDreamLink>(1);
+	server.addLink(link);
+
+	DreamLinkClient client(socketPath, 1);
+	client.connect();
+	ASSERT_TRUE(client.isConnected());
+	ASSERT_EQ((u32)MFID_1_Storage, client.getFunctionCode(1));
+	ASSERT_EQ((u32)MFID_8_Vibration, client.getFunctionCode(2));
+	ASSERT_EQ(2u, client.getFunctionDefinitions(2)[0]);
+	ASSERT_EQ(3u, client.getFunctionDefinitions(2)[2]);
+	ASSERT_EQ("Loopback", client.getName());
+
+	// No device on this bus
+	DreamLinkClient client2(socketPath, 2);
+	client2.connect();
+	ASSERT_TRUE(client2.isConnected());
+	ASSERT_EQ(0u, client2.getFunctionCode(1));
+	MapleMsg rxMsg;
+	ASSERT_FALSE(client2.send(makeMsg(1), rxMsg));
+
+	// The device bus is changed
+	link->changeBus(2);
+	client2.connect();
+	ASSERT_EQ((u32)MFID_1_Storage, client2.getFunctionCode(1));
+	ASSERT_TRUE(checkTransfer(client2, 1));
+}
+
+TEST_F(DreamLinkMuxTest, NoServer)
+{
+	DreamLinkClient client(socketPath, 0);
+	client.connect();
+	ASSERT_FALSE(client.isConnected());
+	ASSERT_FALSE(client.send(makeMsg(0)));
+	ASSERT_EQ(0u, client.getFunctionCode(1));
+}
+
+TEST_F(DreamLinkMuxTest, Pipelining)
+{
+	DreamLinkServer server(socketPath);
+	auto link = std::make_shared<LoopbackDreamLink>(0);
+	server.addLink(link);
+	DreamLinkClient client(socketPath, 0);
+	client.connect();
+
+	// Messages without response are not acknowledged
+	for (int i = 0; i < 100; i++)
+		ASSERT_TRUE(client.send(makeMsg(i)));
+
+	// Concurrent requests on the same connection get their own response
+	constexpr int ThreadCount = 8;
+	constexpr int Transfers = 1000;
+	std::vector<std::thread> threads;
+	std::atomic<int> successes {};
+	for (int i = 0; i < ThreadCount; i++)
+		threads.emplace_back([&client, &successes, i]() {
+			for (int j = 0; j < Transfers; j++)
+				if (checkTransfer(client, i * Transfers + j))
+					successes++;
+		});
+	for (auto& thread : threads)
+		thread.join();
+	ASSERT_EQ(ThreadCount * Transfers, successes);
+	ASSERT_EQ(ThreadCount * Transfers, link->transfers);
+	ASSERT_EQ(100, link->sent);
+}
+
+TEST_F(DreamLinkMuxTest, ServerGone)
+{
+	auto server = std::make_unique<DreamLinkServer>(socketPath);
+	server->addLink(std::make_shared<LoopbackDreamLink>(0));
+	DreamLinkClient client(socketPath, 0);
+	client.connect();
+	ASSERT_TRUE(checkTransfer(client, 42));
+
+	server.reset();
+	const auto start = std::chrono::steady_clock::now();
+	ASSERT_FALSE(checkTransfer(client, 42));
+	// Pending requests fail immediately
+	ASSERT_LT(std::chrono::steady_clock::now() - start, 500ms);
+	for (int retry = 0; retry < 100 && client.isConnected(); retry++)
+		std::this_thread::sleep_for(10ms);
+	ASSERT_FALSE(client.isConnected());
+
+	// The client reconnects to a restarted server on the next refresh
+	server = std::make_unique<DreamLinkServer>(socketPath);
+	ASSERT_TRUE(server->isRunning());
+	server->addLink(std::make_shared<LoopbackDreamLink>(0));
+	for (int i = 0; i < 120 && !client.isConnected(); i++)
+		client.reloadConfigurationIfNeeded();
+	ASSERT_TRUE(client.isConnected());
+	ASSERT_EQ((u32)MFID_1_Storage, client.getFunctionCode(1));
+	ASSERT_TRUE(checkTransfer(client, 43));
+}
+
+TEST_F(DreamLinkMuxTest, ServerInUse)
+{
+	DreamLinkServer server(socketPath);
+	ASSERT_TRUE(server.isRunning());
+	server.addLink(std::make_shared<LoopbackDreamLink>(0));
+
+	// The socket of a running server is left alone
+	DreamLinkServer server2(socketPath);
+	ASSERT_FALSE(server2.isRunning());
+	DreamLinkClient client(socketPath, 0);
+	client.connect();
+	ASSERT_TRUE(checkTransfer(client, 42));
+}
+
+TEST_F(DreamLinkMuxTest, MultipleProcesses)
+{
+	constexpr int ProcessCount = 4;
+	constexpr int Transfers = 1000;
+	std::vector<pid_t> children;
+	for (int i = 0; i < ProcessCount; i++)
+	{
+		pid_t pid = fork();
+		ASSERT_NE(-1, pid);
+		if (pid == 0)
+		{
+			// Client process. Half of them use each bus.
+			DreamLinkClient client(socketPath, i % 2);
+			// Wait for the server
+			for (int retry = 0; retry < 500 && client.getFunctionCode(1) == 0; retry++)
+			{
+				std::this_thread::sleep_for(10ms);
+				client.connect();
+			}
+			bool success = client.getFunctionCode(1) == MFID_1_Storage;
+			for (int j = 0; j < Transfers && success; j++)
+				success = checkTransfer(client, j);
+			client.disconnect();
+			_exit(success ? 0 : 1);
+		}
+		children.push_back(pid);
+	}
+	DreamLinkServer server(socketPath);
+	auto link0 = std::make_shared<LoopbackDreamLink>(0);
+	auto link1 = std::make_shared<LoopbackDreamLink>(1);
+	server.addLink(link0);
+	server.addLink(link1);
+
+	for (pid_t pid : children)
+	{
+		int status;
+		ASSERT_EQ(pid, waitpid(pid, &status, 0));
+		ASSERT_TRUE(WIFEXITED(status));
+		ASSERT_EQ(0, WEXITSTATUS(status));
+	}
+	ASSERT_EQ(ProcessCount / 2 * Transfers, link0->transfers);
+	ASSERT_EQ(ProcessCount / 2 * Transfers, link1->transfers);
+}
+
+#endif
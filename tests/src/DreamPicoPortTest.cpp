@@ -0,0 +1,313 @@
+#include "gtest/gtest.h"
+#include "types.h"
+
+#if defined(USE_DREAMCASTCONTROLLER) && defined(__linux__)
+#include "hw/mem/addrspace.h"
+#include "emulator.h"
+#include "cfg/cfg.h"
+#include "cfg/option.h"
+#include "hw/maple/maple_devs.h"
+#include "sdl/dreampicoport.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+using namespace std::chrono_literals;
+
+//
+// Fake DreamPicoPort firmware on a pseudo-terminal
+//
+class FakeDreamPicoPort
+{
+public:
+	FakeDreamPicoPort(std::chrono::milliseconds delay = {}) : delay(delay)
+	{
+		master = posix_openpt(O_RDWR | O_NOCTTY);
+		if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0)
+			die("Can't create pty");
+		path = ptsname(master);
+		thread = std::thread([this]() { run(); });
+	}
+
+	~FakeDreamPicoPort()
+	{
+		stopping = true;
+		release();
+		thread.join();
+		close(master);
+	}
+
+	// Peripheral queries aren't answered until release() is called
+	void hold() {
+		std::lock_guard<std::mutex> _(mutex);
+		holding = true;
+	}
+	void release()
+	{
+		{
+			std::lock_guard<std::mutex> _(mutex);
+			holding = false;
+		}
+		cv.notify_all();
+	}
+
+	std::string path;
+	std::atomic<int> peripheralQueries {};
+	// Peripheral queries received and waiting to be released
+	std::atomic<int> heldQueries {};
+	std::atomic<int> peripheralAnswers {};
+
+private:
+	void run()
+	{
+		std::string line;
+		while (!stopping)
+		{
+			pollfd pfd { master, POLLIN, 0 };
+			if (poll(&pfd, 1, 10) <= 0)
+				continue;
+			char c;
+			if (read(master, &c, 1) != 1)
+			{
+				// slave not opened yet or closed
+				std::this_thread::sleep_for(10ms);
+				continue;
+			}
+			if (c != '\n') {
+				line += c;
+				continue;
+			}
+			// Commands are echoed back
+			std::string response = line + "\r\n";
+			if (line == "XV")
+				response += "1.00\r\n";
+			else if (line == "X?0")
+			{
+				// Controller, VMU and rumble pack
+				response += "{{00000001,fe060f00}};{{0000000e,7e7e3f40},{00000004,00051000},{00000008,000f4100}};{{00000100,01010000}}\r\n";
+				peripheralQueries++;
+				std::unique_lock<std::mutex> lock(mutex);
+				heldQueries++;
+				cv.wait_for(lock, 5s, [this]() { return !holding; });
+				heldQueries--;
+			}
+			else if (line.substr(0, 4) == "X 09")
+				// Get condition response with both expansion devices
+				response += "08000303 01000000 00000000 00000000\r\n";
+			std::this_thread::sleep_for(delay);
+			if (write(master, response.data(), response.size()) < 0)
+				break;
+			if (line == "X?0")
+				peripheralAnswers++;
+			line.clear();
+		}
+	}
+
+	int master = -1;
+	std::chrono::milliseconds delay;
+	std::thread thread;
+	std::atomic<bool> stopping {};
+	std::mutex mutex;
+	std::condition_variable cv;
+	bool holding = false;
+};
+
+class DreamPicoPortTest : public ::testing::Test
+{
+protected:
+	void SetUp() override
+	{
+		if (!addrspace::reserve())
+			die("addrspace::reserve failed");
+		emu.init();
+		emu.dc_reset(true);
+		config::MapleExpansionDevices[0][0] = MDT_None;
+		config::MapleExpansionDevices[0][1] = MDT_None;
+	}
+
+	void TearDown() override
+	{
+		cfgSetVirtual("input", "DreamPicoPortSerialDevice", "");
+		for (const std::string& serialNumber : serialNumbers)
+			cfgSetVirtual("input", "DreamPicoPortSerialDevice." + serialNumber, "");
+	}
+
+	// Map the given serial number to a fake device
+	void addDevice(const std::string& serialNumber, const std::string& path)
+	{
+		cfgSetVirtual("input", "DreamPicoPortSerialDevice." + serialNumber, path);
+		serialNumbers.push_back(serialNumber);
+	}
+
+	std::vector<std::string> serialNumbers;
+};
+
+TEST_F(DreamPicoPortTest, Handshake)
+{
+	FakeDreamPicoPort fake;
+	addDevice("A", fake.path);
+	DreamPicoPort::Handshake handshake;
+	ASSERT_TRUE(DreamPicoPort::handshake("A", 0, handshake));
+	ASSERT_NE(nullptr, handshake.serial);
+	ASSERT_EQ(1.0, handshake.interface_version);
+	ASSERT_EQ(3u, handshake.peripherals.size());
+	ASSERT_EQ(3u, handshake.peripherals[1].size());
+	ASSERT_EQ(0x0000000eu, handshake.peripherals[1][0][0]);
+	ASSERT_EQ(0x7e7e3f40u, handshake.peripherals[1][0][1]);
+	ASSERT_EQ(1u, handshake.peripherals[2].size());
+	ASSERT_EQ(0x00000100u, handshake.peripherals[2][0][0]);
+
+	// The serial port is shared
+	DreamPicoPort::Handshake handshake2;
+	ASSERT_TRUE(DreamPicoPort::handshake("A", 0, handshake2));
+	ASSERT_EQ(handshake.serial, handshake2.serial);
+}
+
+TEST_F(DreamPicoPortTest, NoDevice)
+{
+	addDevice("A", "/dev/null/DreamPicoPort");
+	DreamPicoPort::Handshake handshake;
+	ASSERT_FALSE(DreamPicoPort::handshake("A", 0, handshake));
+	ASSERT_EQ(nullptr, handshake.serial);
+}
+
+TEST_F(DreamPicoPortTest, MultipleDevices)
+{
+	FakeDreamPicoPort fakeA;
+	FakeDreamPicoPort fakeB;
+	addDevice("A", fakeA.path);
+	addDevice("B", fakeB.path);
+
+	DreamPicoPort::Handshake handshakeA;
+	ASSERT_TRUE(DreamPicoPort::handshake("A", 0, handshakeA));
+	DreamPicoPort::Handshake handshakeB;
+	ASSERT_TRUE(DreamPicoPort::handshake("B", 0, handshakeB));
+	ASSERT_NE(handshakeA.serial, handshakeB.serial);
+	ASSERT_EQ(1, fakeA.peripheralQueries);
+	ASSERT_EQ(1, fakeB.peripheralQueries);
+
+	DreamPicoPort::Handshake handshakeA2;
+	ASSERT_TRUE(DreamPicoPort::handshake("A", 0, handshakeA2));
+	ASSERT_EQ(handshakeA.serial, handshakeA2.serial);
+	ASSERT_EQ(2, fakeA.peripheralQueries);
+	ASSERT_EQ(1, fakeB.peripheralQueries);
+}
+
+TEST_F(DreamPicoPortTest, ConcurrentDevices)
+{
+	constexpr int DeviceCount = 3;
+	std::vector<std::unique_ptr<FakeDreamPicoPort>> fakes;
+	for (int i = 0; i < DeviceCount; i++)
+	{
+		fakes.push_back(std::make_unique<FakeDreamPicoPort>());
+		addDevice(std::to_string(i), fakes.back()->path);
+	}
+	// Open the serial ports
+	std::vector<DreamPicoPort::Handshake> handshakes(DeviceCount);
+	for (int i = 0; i < DeviceCount; i++)
+		ASSERT_TRUE(DreamPicoPort::handshake(std::to_string(i), 0, handshakes[i]));
+	DreamPicoPort::Handshake handshake;
+	ASSERT_TRUE(DreamPicoPort::handshake("0", 0, handshake));
+
+	std::vector<std::shared_ptr<DreamPicoPort>> ports;
+	for (int i = 0; i < DeviceCount; i++)
+	{
+		ports.push_back(std::make_shared<DreamPicoPort>(i, i, nullptr));
+		ports.back()->serial_number = std::to_string(i);
+	}
+	for (auto& fake : fakes)
+		fake->hold();
+	for (auto& port : ports)
+		port->connect();
+	// The handshakes of different devices don't wait for each other:
+	// at least 2 devices are queried before any of them answers
+	auto expiration = std::chrono::steady_clock::now() + 5s;
+	int held = 0;
+	while (held < 2 && std::chrono::steady_clock::now() < expiration)
+	{
+		std::this_thread::sleep_for(5ms);
+		held = 0;
+		for (auto& fake : fakes)
+			held += fake->heldQueries;
+	}
+	ASSERT_LE(2, held);
+	for (auto& fake : fakes)
+		fake->release();
+
+	expiration = std::chrono::steady_clock::now() + 5s;
+	int connected = 0;
+	while (connected < DeviceCount && std::chrono::steady_clock::now() < expiration)
+	{
+		std::this_thread::sleep_for(5ms);
+		connected = 0;
+		for (auto& port : ports)
+		{
+			port->reloadConfigurationIfNeeded();
+			if (port->getFunctionCode(1) != 0)
+				connected++;
+		}
+	}
+	ASSERT_EQ(DeviceCount, connected);
+	// Each port uses its own device
+	for (int i = 0; i < DeviceCount; i++)
+		ASSERT_EQ(i == 0 ? 3 : 2, fakes[i]->peripheralQueries) << "device " << i;
+}
+
+TEST_F(DreamPicoPortTest, BackgroundConnect)
+{
+	// The device doesn't answer until released
+	FakeDreamPicoPort fake;
+	fake.hold();
+	cfgSetVirtual("input", "DreamPicoPortSerialDevice", fake.path);
+	std::shared_ptr<DreamPicoPort> port = std::make_shared<DreamPicoPort>(0, 0, nullptr);
+
+	// connect() returns before the handshake completes
+	port->connect();
+	ASSERT_EQ(0, fake.peripheralAnswers);
+	port->reloadConfigurationIfNeeded();
+	ASSERT_EQ(0u, port->getFunctionCode(1));
+	fake.release();
+
+	// The handshake result is applied at a frame boundary
+	const auto expiration = std::chrono::steady_clock::now() + 5s;
+	while (port->getFunctionCode(1) == 0 && std::chrono::steady_clock::now() < expiration)
+	{
+		std::this_thread::sleep_for(10ms);
+		port->reloadConfigurationIfNeeded();
+	}
+	ASSERT_EQ((u32)MFID_1_Storage, port->getFunctionCode(1) & MFID_1_Storage);
+	ASSERT_EQ((u32)MFID_8_Vibration, port->getFunctionCode(2));
+	ASSERT_EQ(MDT_SegaVMU, config::MapleExpansionDevices[0][0].get());
+	ASSERT_EQ(MDT_PurupuruPack, config::MapleExpansionDevices[0][1].get());
+}
+
+TEST_F(DreamPicoPortTest, DisconnectWhileConnecting)
+{
+	FakeDreamPicoPort fake(100ms);
+	cfgSetVirtual("input", "DreamPicoPortSerialDevice", fake.path);
+	std::shared_ptr<DreamPicoPort> port = std::make_shared<DreamPicoPort>(0, 0, nullptr);
+
+	port->connect();
+	port->disconnect();
+	const auto expiration = std::chrono::steady_clock::now() + 5s;
+	while (fake.peripheralQueries == 0 && std::chrono::steady_clock::now() < expiration)
+		std::this_thread::sleep_for(10ms);
+	ASSERT_EQ(1, fake.peripheralQueries);
+	// Let the handshake complete
+	std::this_thread::sleep_for(500ms);
+
+	// The handshake result is discarded
+	port->reloadConfigurationIfNeeded();
+	ASSERT_EQ(0u, port->getFunctionCode(1));
+	ASSERT_EQ(MDT_None, config::MapleExpansionDevices[0][0].get());
+}
+
+#endif
@@ -0,0 +1,83 @@
+#include "gtest/gtest.h"
+#include "types.h"
+#include "rend/fb_convert.h"
+#include "rend/texconv.h"
+#include <random>
+#include <vector>
+
+class FbConvertTest : public ::testing::Test
+{
+protected:
+	void SetUp() override
+	{
+		std::mt19937 rng(42);
+		pixels.resize(MaxCount * 4);
+		for (u8& b : pixels)
+			b = (u8)rng();
+	}
+
+	// odd sizes to test the scalar tail of the SIMD kernels
+	static constexpr u32 Counts[] { 1, 7, 8, 13, 640, 643 };
+	static constexpr u32 MaxCount = 643;
+	std::vector<u8> pixels;
+};
+
+TEST_F(FbConvertTest, PackRounding)
+{
+	// 565
+	FB_W_CTRL_type ctrl{};
+	ctrl.fb_packmode = 1;
+	const u8 src[] { 0x04, 0x02, 0xff, 0xff,  0x03, 0x01, 0xfb, 0xff };
+	u16 dst[2];
+	fbconv::pack<0, 1, 2, 3>(src, (u8 *)dst, 2, ctrl, true);
+	ASSERT_EQ((1 << 11) | (1 << 5) | 0x1f, dst[0]);
+	ASSERT_EQ(0x1f, dst[1]);
+	fbconv::pack<0, 1, 2, 3>(src, (u8 *)dst, 2, ctrl, false);
+	ASSERT_EQ(0x1f, dst[0]);
+	ASSERT_EQ(0x1f, dst[1]);
+}
+
+TEST_F(FbConvertTest, Pack)
+{
+	std::mt19937 rng(1);
+	for (u32 count : Counts)
+		for (u32 packMode = 0; packMode <= 6; packMode++)
+			for (bool round : { false, true })
+			{
+				SCOPED_TRACE("count " + std::to_string(count) + " packmode " + std::to_string(packMode)
+						+ " round " + std::to_string(round));
+				FB_W_CTRL_type ctrl{};
+				ctrl.fb_packmode = packMode;
+				ctrl.fb_kval = rng();
+				ctrl.fb_alpha_threshold = rng();
+				std::vector<u8> reference(count * 4 + 16, 0xcc);
+				std::vector<u8> actual(count * 4 + 16, 0xcc);
+				fbconv::packScalar<0, 1, 2, 3>(pixels.data(), reference.data(), count, ctrl, round);
+				fbconv::pack<0, 1, 2, 3>(pixels.data(), actual.data(), count, ctrl, round);
+				ASSERT_EQ(reference, actual);
+
+				fbconv::packScalar<2, 1, 0, 3>(pixels.data(), reference.data(), count, ctrl, round);
+				fbconv::pack<2, 1, 0, 3>(pixels.data(), actual.data(), count, ctrl, round);
+				ASSERT_EQ(reference, actual);
+			}
+}
+
+TEST_F(FbConvertTest, Unpack)
+{
+	for (u32 count : Counts)
+		for (u32 depth = fbde_0555; depth <= fbde_C888; depth++)
+			for (u32 concat = 0; concat < 8; concat++)
+			{
+				SCOPED_TRACE("count " + std::to_string(count) + " depth " + std::to_string(depth)
+						+ " concat " + std::to_string(concat));
+				std::vector<u32> reference(count + 4, 0xcccccccc);
+				std::vector<u32> actual(count + 4, 0xcccccccc);
+				fbconv::unpackScalar<RGBAPacker>(pixels.data(), reference.data(), count, depth, concat);
+				fbconv::unpack<RGBAPacker>(pixels.data(), actual.data(), count, depth, concat);
+				ASSERT_EQ(reference, actual);
+
+				fbconv::unpackScalar<BGRAPacker>(pixels.data(), reference.data(), count, depth, concat);
+				fbconv::unpack<BGRAPacker>(pixels.data(), actual.data(), count, depth, concat);
+				ASSERT_EQ(reference, actual);
+			}
+}
@@ -0,0 +1,161 @@
+/*
+	Copyright 2026 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "gtest/gtest.h"
+#include "types.h"
+#include "hw/mem/addrspace.h"
+#include "hw/maple/maple_cfg.h"
+#include "hw/sh4/sh4_mem.h"
+#include "emulator.h"
+#include "input/movie.h"
+#include <nowide/cstdio.hpp>
+#include <vector>
+
+class MovieTest : public ::testing::Test
+{
+protected:
+	void SetUp() override
+	{
+		if (!addrspace::reserve())
+			die("addrspace::reserve failed");
+		emu.init();
+		emu.dc_reset(true);
+		settings.content.gameId = "MOVIE TEST";
+		nowide::remove(path);
+	}
+
+	void TearDown() override
+	{
+		movie::stop();
+		nowide::remove(path);
+	}
+
+	static MapleInputState inputFor(u32 poll)
+	{
+		MapleInputState state;
+		state.kcode = ~(poll * 0x10001);
+		state.fullAxes[0] = (int16_t)(poll * 3);
+		state.halfAxes[1] = (u16)(poll * 7);
+		return state;
+	}
+
+	// A stand-in for the game: the emulator state only depends on the inputs it reads
+	static void runFrame(u32 poll, const MapleInputState inputs[4])
+	{
+		const u32 offset = (poll * 8) % RAM_SIZE;
+		memcpy(&mem_b[offset], &inputs[0].kcode, 4);
+		memcpy(&mem_b[offset + 4], &inputs[0].fullAxes[0], 2);
+	}
+
+	static constexpr const char *path = "movie_test.flm";
+	static constexpr u32 PollCount = 200;
+};
+
+TEST_F(MovieTest, RecordReplay)
+{
+	mem_b[0x1234] = 0x42;
+	movie::record(path);
+	// Nothing happens until the movie is started
+	ASSERT_FALSE(movie::active());
+	movie::start();
+	ASSERT_TRUE(movie::isRecording());
+
+	std::vector<MapleInputState> recorded;
+	for (u32 poll = 0; poll < PollCount; poll++)
+	{
+		MapleInputState inputs[4];
+		inputs[0] = inputFor(poll);
+		inputs[2] = inputFor(poll + 1000);
+		movie::processInput(inputs);
+		runFrame(poll, inputs);
+		recorded.push_back(inputs[0]);
+		recorded.push_back(inputs[2]);
+	}
+	movie::stop();
+	ASSERT_FALSE(movie::active());
+
+	// Start the replay from a different state
+	memset(&mem_b[0], 0xff, RAM_SIZE);
+	movie::play(path);
+	movie::start();
+	ASSERT_TRUE(movie::isPlaying());
+	// The recorded state is restored
+	ASSERT_EQ(0x42, mem_b[0x1234]);
+
+	for (u32 poll = 0; poll < PollCount; poll++)
+	{
+		// Live inputs are replaced by the recorded ones
+		MapleInputState inputs[4];
+		inputs[0] = inputFor(poll + 5000);
+		movie::processInput(inputs);
+		runFrame(poll, inputs);
+		ASSERT_EQ(recorded[poll * 2].kcode, inputs[0].kcode) << "poll " << poll;
+		ASSERT_EQ(recorded[poll * 2].fullAxes[0], inputs[0].fullAxes[0]) << "poll " << poll;
+		ASSERT_EQ(recorded[poll * 2].halfAxes[1], inputs[0].halfAxes[1]) << "poll " << poll;
+		ASSERT_EQ(recorded[poll * 2 + 1].kcode, inputs[2].kcode) << "poll " << poll;
+		ASSERT_EQ(~0u, inputs[1].kcode);
+	}
+	ASSERT_EQ(-1, movie::getDivergence());
+	// The playback ends with the recorded inputs
+	MapleInputState inputs[4];
+	inputs[0] = inputFor(9999);
+	movie::processInput(inputs);
+	ASSERT_FALSE(movie::active());
+	ASSERT_EQ(inputFor(9999).kcode, inputs[0].kcode);
+}
+
+TEST_F(MovieTest, Divergence)
+{
+	movie::record(path);
+	movie::start();
+	for (u32 poll = 0; poll < PollCount; poll++)
+	{
+		MapleInputState inputs[4];
+		inputs[0] = inputFor(poll);
+		movie::processInput(inputs);
+		runFrame(poll, inputs);
+	}
+	movie::stop();
+
+	movie::play(path);
+	movie::start();
+	ASSERT_TRUE(movie::isPlaying());
+	for (u32 poll = 0; poll < PollCount; poll++)
+	{
+		MapleInputState inputs[4];
+		movie::processInput(inputs);
+		runFrame(poll, inputs);
+		if (poll == 70)
+			// Non-deterministic state change
+			mem_b[RAM_SIZE - 1] ^= 1;
+	}
+	// Detected by the next savestate hash
+	ASSERT_EQ(120, movie::getDivergence());
+}
+
+TEST_F(MovieTest, InvalidFile)
+{
+	FILE *f = nowide::fopen(path, "wb");
+	ASSERT_NE(nullptr, f);
+	std::fputs("not a movie", f);
+	std::fclose(f);
+
+	movie::play(path);
+	movie::start();
+	ASSERT_FALSE(movie::active());
+}
@@ -0,0 +1,75 @@
+#include "gtest/gtest.h"
+#include "types.h"
+#include "rend/oit_buffer_sizer.h"
+
+class OitBufferSizerTest : public ::testing::Test
+{
+protected:
+	void SetUp() override {
+		sizer.reset(512_MB);
+	}
+
+	static u64 fragments(u64 bytes) {
+		return bytes / OitBufferSizer::PixelSize;
+	}
+
+	OitBufferSizer sizer;
+};
+
+TEST_F(OitBufferSizerTest, StartsAtMaxSize)
+{
+	ASSERT_EQ(512_MB, sizer.getSize());
+	ASSERT_EQ(512_MB, sizer.getMaxSize());
+}
+
+TEST_F(OitBufferSizerTest, Shrink)
+{
+	for (u32 i = 0; i < OitBufferSizer::ShrinkDelay - 1; i++)
+		ASSERT_FALSE(sizer.frameDone(fragments(i == 10 ? 20_MB : 10_MB)));
+	ASSERT_TRUE(sizer.frameDone(fragments(10_MB)));
+	// halved at most
+	ASSERT_EQ(256_MB, sizer.getSize());
+	for (u32 i = 0; i < OitBufferSizer::ShrinkDelay; i++)
+		sizer.frameDone(fragments(i == 10 ? 20_MB : 10_MB));
+	ASSERT_EQ(128_MB, sizer.getSize());
+	for (u32 i = 0; i < OitBufferSizer::ShrinkDelay; i++)
+		sizer.frameDone(fragments(i == 10 ? 20_MB : 10_MB));
+	// margin over the peak usage
+	ASSERT_EQ(80_MB, sizer.getSize());
+
+	// stable
+	for (u32 i = 0; i < OitBufferSizer::ShrinkDelay * 2; i++)
+		ASSERT_FALSE(sizer.frameDone(fragments(20_MB)));
+	ASSERT_EQ(80_MB, sizer.getSize());
+}
+
+TEST_F(OitBufferSizerTest, MinSize)
+{
+	for (u32 i = 0; i < OitBufferSizer::ShrinkDelay * 10; i++)
+		sizer.frameDone(0);
+	ASSERT_EQ(OitBufferSizer::MinSize, sizer.getSize());
+}
+
+TEST_F(OitBufferSizerTest, Grow)
+{
+	for (u32 i = 0; i < OitBufferSizer::ShrinkDelay * 3; i++)
+		sizer.frameDone(0);
+	ASSERT_EQ(64_MB, sizer.getSize());
+
+	// more than half used
+	ASSERT_TRUE(sizer.frameDone(fragments(40_MB)));
+	ASSERT_EQ(160_MB, sizer.getSize());
+	ASSERT_FALSE(sizer.frameDone(fragments(80_MB)));
+	// overflow
+	ASSERT_TRUE(sizer.frameDone(fragments(200_MB)));
+	ASSERT_EQ(512_MB, sizer.getSize());
+	ASSERT_FALSE(sizer.frameDone(fragments(1000_MB)));
+}
+
+TEST_F(OitBufferSizerTest, NoShrinkWhenBusy)
+{
+	// A single busy frame restarts the shrink delay
+	for (u32 i = 0; i < OitBufferSizer::ShrinkDelay * 2; i++)
+		ASSERT_FALSE(sizer.frameDone(fragments(i % 100 == 0 ? 200_MB : 10_MB)));
+	ASSERT_EQ(512_MB, sizer.getSize());
+}
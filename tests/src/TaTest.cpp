@@ -0,0 +1,238 @@
+#include "gtest/gtest.h"
+#include "types.h"
+#include "hw/mem/addrspace.h"
+#include "emulator.h"
+#include "hw/pvr/ta.h"
+#include "hw/pvr/ta_ctx.h"
+#include "hw/pvr/Renderer_if.h"
+#include <random>
+#include <vector>
+
+extern u8 ta_fsm[2049];
+extern u32 ta_fsm_cl;
+
+class TaTest : public ::testing::Test
+{
+protected:
+	void SetUp() override
+	{
+		if (!addrspace::reserve())
+			die("addrspace::reserve failed");
+		emu.init();
+		emu.dc_reset(true);
+	}
+
+	void add(u32 pcw)
+	{
+		SQBuffer& sq = stream.emplace_back();
+		std::mt19937 rng(stream.size());
+		for (u8& b : sq.data)
+			b = (u8)rng();
+		memcpy(sq.data, &pcw, sizeof(pcw));
+	}
+
+	static constexpr u32 pcw(u32 paraType, u32 listType, u32 objCtrl = 0, bool endOfStrip = false) {
+		return (paraType << 29) | (endOfStrip ? 1 << 28 : 0) | (listType << 24) | objCtrl;
+	}
+
+	u32 addVertices(u32 listType, u32 count, u32 size)
+	{
+		for (u32 i = 0; i < count; i++)
+		{
+			add(pcw(ParamType_Vertex_Parameter, listType, 0, i == count - 1));
+			// Second half of 64B vertices: random data
+			if (size == 2)
+				add(rngStream());
+		}
+		return count;
+	}
+
+	// A stream with long runs of 32B and 64B vertices, modifier volumes and sprites
+	void makeStream()
+	{
+		constexpr u32 Opaque = 0;
+		constexpr u32 OpaqueModVol = 1;
+		constexpr u32 Translucent = 2;
+		for (int i = 0; i < 20; i++)
+		{
+			// Non-textured, packed color: 32B vertices
+			add(pcw(ParamType_Polygon_or_Modifier_Volume, Opaque, 0));
+			stripVertices += addVertices(Opaque, 1 + rngStream() % 200, 1);
+			// Textured, floating color: 64B vertices
+			add(pcw(ParamType_Polygon_or_Modifier_Volume, Opaque, 0x08 | 0x10));
+			stripVertices += addVertices(Opaque, 1 + rngStream() % 200, 2);
+			// Textured, intensity with offset color: 64B polygon parameter
+			add(pcw(ParamType_Polygon_or_Modifier_Volume, Opaque, 0x20 | 0x08 | 0x04));
+			add(rngStream());
+			stripVertices += addVertices(Opaque, 1 + rngStream() % 50, 1);
+		}
+		add(pcw(ParamType_End_Of_List, Opaque));
+
+		add(pcw(ParamType_Polygon_or_Modifier_Volume, OpaqueModVol));
+		modVolVertices += addVertices(OpaqueModVol, 300, 2);
+		add(pcw(ParamType_End_Of_List, OpaqueModVol));
+
+		for (int i = 0; i < 10; i++)
+		{
+			add(pcw(ParamType_Sprite, Translucent));
+			spriteVertices += addVertices(Translucent, 1 + rngStream() % 20, 2);
+		}
+		add(pcw(ParamType_End_Of_List, Translucent));
+	}
+
+	struct Result
+	{
+		std::vector<u8> data;
+		u8 state;
+	};
+
+	Result result()
+	{
+		return { std::vector<u8>(ta_tad.thd_root, ta_tad.thd_data), ta_fsm[2048] };
+	}
+
+	// Parses the given TA data into ctx
+	void parse(const std::vector<u8>& data, TA_context& ctx)
+	{
+		ctx.Alloc();
+		memcpy(ctx.tad.thd_root, data.data(), data.size());
+		ctx.tad.thd_data = ctx.tad.thd_root + data.size();
+		ParseRenderer parseRenderer;
+		Renderer *savedRenderer = renderer;
+		renderer = &parseRenderer;
+		ta_parse(&ctx, false);
+		renderer = savedRenderer;
+	}
+
+	static void comparePolys(const std::vector<PolyParam>& ref, const std::vector<PolyParam>& list, const char *name)
+	{
+		ASSERT_EQ(ref.size(), list.size()) << name;
+		for (size_t i = 0; i < ref.size(); i++)
+		{
+			ASSERT_EQ(ref[i].first, list[i].first) << name << " " << i;
+			ASSERT_EQ(ref[i].count, list[i].count) << name << " " << i;
+			ASSERT_EQ(ref[i].pcw.full, list[i].pcw.full) << name << " " << i;
+			ASSERT_EQ(ref[i].isp.full, list[i].isp.full) << name << " " << i;
+			ASSERT_EQ(ref[i].tsp.full, list[i].tsp.full) << name << " " << i;
+			ASSERT_EQ(ref[i].tcw.full, list[i].tcw.full) << name << " " << i;
+			ASSERT_EQ(ref[i].tileclip, list[i].tileclip) << name << " " << i;
+		}
+	}
+
+	static void compareModVols(const std::vector<ModifierVolumeParam>& ref, const std::vector<ModifierVolumeParam>& list, const char *name)
+	{
+		ASSERT_EQ(ref.size(), list.size()) << name;
+		for (size_t i = 0; i < ref.size(); i++)
+		{
+			ASSERT_EQ(ref[i].first, list[i].first) << name << " " << i;
+			ASSERT_EQ(ref[i].count, list[i].count) << name << " " << i;
+			ASSERT_EQ(ref[i].isp.full, list[i].isp.full) << name << " " << i;
+			ASSERT_EQ(ref[i].tileclip, list[i].tileclip) << name << " " << i;
+		}
+	}
+
+	// Byte comparison so that NaNs from the random vertex data compare equal
+	template<typename T>
+	static bool sameBytes(const std::vector<T>& a, const std::vector<T>& b) {
+		return a.size() == b.size() && memcmp(a.data(), b.data(), a.size() * sizeof(T)) == 0;
+	}
+
+	class ParseRenderer : public Renderer
+	{
+		bool Init() override { return true; }
+		void Term() override {}
+		void Process(TA_context *ctx) override {}
+		bool Render() override { return true; }
+		void RenderFramebuffer(const FramebufferInfo& info) override {}
+	};
+
+	std::vector<SQBuffer> stream;
+	std::mt19937 rngStream { 42 };
+	// Vertex parameters sent by makeStream()
+	u32 stripVertices = 0;
+	u32 spriteVertices = 0;
+	u32 modVolVertices = 0;
+};
+
+TEST_F(TaTest, BulkIngestion)
+{
+	makeStream();
+
+	// Reference: one 32B packet at a time
+	ta_vtx_ListInit(false);
+	std::vector<std::pair<u8, u32>> states;
+	for (const SQBuffer& sq : stream)
+	{
+		ta_vtx_data32(&sq);
+		states.emplace_back(ta_fsm[2048], ta_fsm_cl);
+	}
+	const Result reference = result();
+	ASSERT_EQ(stream.size() * sizeof(SQBuffer), reference.data.size());
+
+	// Whole stream in a single burst
+	ta_vtx_ListInit(false);
+	ta_vtx_data(stream.data(), stream.size());
+	Result bulk = result();
+	ASSERT_EQ(reference.state, bulk.state);
+	ASSERT_EQ(reference.data, bulk.data);
+
+	// Random burst sizes. 64B vertices can be split across bursts.
+	ta_vtx_ListInit(false);
+	std::mt19937 rng(1234);
+	for (size_t i = 0; i < stream.size(); )
+	{
+		u32 size = std::min<u32>(1 + rng() % 64, stream.size() - i);
+		ta_vtx_data(&stream[i], size);
+		i += size;
+		ASSERT_EQ(states[i - 1].first, ta_fsm[2048]) << "packet " << i - 1;
+		ASSERT_EQ(states[i - 1].second, ta_fsm_cl) << "packet " << i - 1;
+	}
+	bulk = result();
+	ASSERT_EQ(reference.data, bulk.data);
+}
+
+TEST_F(TaTest, BulkIngestionParse)
+{
+	makeStream();
+
+	// Reference: one 32B packet at a time
+	ta_vtx_ListInit(false);
+	for (const SQBuffer& sq : stream)
+		ta_vtx_data32(&sq);
+	const Result reference = result();
+
+	// Random burst sizes
+	ta_vtx_ListInit(false);
+	std::mt19937 rng(5678);
+	for (size_t i = 0; i < stream.size(); )
+	{
+		u32 size = std::min<u32>(1 + rng() % 64, stream.size() - i);
+		ta_vtx_data(&stream[i], size);
+		i += size;
+	}
+	const Result bulk = result();
+
+	TA_context refCtx;
+	parse(reference.data, refCtx);
+	TA_context bulkCtx;
+	parse(bulk.data, bulkCtx);
+	const rend_context& ref = refCtx.rend;
+	const rend_context& rc = bulkCtx.rend;
+
+	// 4 vertices per sprite, a triangle per modifier volume vertex parameter. Plus the background polygon.
+	ASSERT_EQ(4 + stripVertices + spriteVertices * 4, ref.verts.size());
+	ASSERT_EQ(modVolVertices, ref.modtrig.size());
+	ASSERT_EQ(1u + 60, ref.global_param_op.size());
+	ASSERT_EQ(1u, ref.global_param_mvo.size());
+	ASSERT_EQ(modVolVertices, ref.global_param_mvo[0].count);
+	ASSERT_FALSE(ref.global_param_tr.empty());
+
+	ASSERT_TRUE(sameBytes(ref.verts, rc.verts));
+	ASSERT_EQ(ref.idx, rc.idx);
+	ASSERT_TRUE(sameBytes(ref.modtrig, rc.modtrig));
+	comparePolys(ref.global_param_op, rc.global_param_op, "op");
+	comparePolys(ref.global_param_pt, rc.global_param_pt, "pt");
+	comparePolys(ref.global_param_tr, rc.global_param_tr, "tr");
+	compareModVols(ref.global_param_mvo, rc.global_param_mvo, "mvo");
+	compareModVols(ref.global_param_mvo_tr, rc.global_param_mvo_tr, "mvo_tr");
+}
@@ -0,0 +1,204 @@
+#include "gtest/gtest.h"
+#include "types.h"
+#include "hw/maple/vmu_file.h"
+#include <nowide/cstdio.hpp>
+#include <chrono>
+#include <filesystem>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <vector>
+
+class VmuFileTest : public ::testing::Test
+{
+protected:
+	void SetUp() override
+	{
+		nowide::remove(path);
+		flash = std::make_unique<u8[]>(VmuFile::Size);
+		memset(flash.get(), 0x55, VmuFile::Size);
+		file = std::make_unique<VmuFile>();
+	}
+
+	void TearDown() override
+	{
+		file.reset();
+		nowide::remove(path);
+		std::error_code ec;
+		std::filesystem::remove_all(tmpPath, ec);
+	}
+
+	std::vector<u8> readFile(const char *filePath)
+	{
+		std::vector<u8> data;
+		FILE *f = nowide::fopen(filePath, "rb");
+		if (f == nullptr)
+			return data;
+		data.resize(VmuFile::Size + 1);
+		data.resize(std::fread(data.data(), 1, data.size(), f));
+		std::fclose(f);
+		return data;
+	}
+
+	bool fileMatches() {
+		return readFile(path) == std::vector<u8>(flash.get(), flash.get() + VmuFile::Size);
+	}
+
+	static constexpr const char *path = "vmu_file_test.bin";
+	static constexpr const char *tmpPath = "vmu_file_test.bin.tmp";
+	std::unique_ptr<u8[]> flash;
+	std::unique_ptr<VmuFile> file;
+};
+
+TEST_F(VmuFileTest, Create)
+{
+	bool created;
+	ASSERT_TRUE(file->open(path, flash.get(), created));
+	ASSERT_TRUE(created);
+	ASSERT_TRUE(file->isOpen());
+	// Nothing is written until the first write
+	ASSERT_EQ(0u, readFile(path).size());
+
+	ASSERT_TRUE(file->write(flash.get(), 0, VmuFile::Size));
+	ASSERT_TRUE(file->flush());
+	ASSERT_TRUE(fileMatches());
+	ASSERT_EQ(0u, readFile(tmpPath).size());
+
+	file->close();
+	ASSERT_FALSE(file->isOpen());
+	ASSERT_FALSE(file->write(flash.get(), 0, VmuFile::BlockSize));
+	ASSERT_TRUE(file->open(path, flash.get(), created));
+	ASSERT_FALSE(created);
+}
+
+TEST_F(VmuFileTest, PartialWrites)
+{
+	bool created;
+	ASSERT_TRUE(file->open(path, flash.get(), created));
+	// Block writes are split into 4 phases
+	for (u32 block = 10; block < 20; block++)
+		for (u32 phase = 0; phase < 4; phase++)
+		{
+			const u32 offset = block * VmuFile::BlockSize + phase * 128;
+			memset(&flash[offset], block + phase, 128);
+			ASSERT_TRUE(file->write(flash.get(), offset, 128));
+		}
+	// Not written to the file
+	flash[0] = 0;
+	file->close();
+	flash[0] = 0x55;
+	ASSERT_TRUE(fileMatches());
+
+	const VmuFile::Stats stats = file->getStats();
+	ASSERT_EQ(40u, stats.writes);
+	ASSERT_LE(stats.commits, stats.writes);
+	ASSERT_GE(stats.blocks, 10u);
+}
+
+TEST_F(VmuFileTest, OpenError)
+{
+	bool created;
+	ASSERT_FALSE(file->open("no/such/dir/vmu.bin", flash.get(), created));
+	ASSERT_FALSE(file->isOpen());
+	ASSERT_FALSE(file->write(flash.get(), 0, VmuFile::BlockSize));
+}
+
+TEST_F(VmuFileTest, CommitError)
+{
+	bool created;
+	ASSERT_TRUE(file->open(path, flash.get(), created));
+	ASSERT_TRUE(file->write(flash.get(), 0, VmuFile::Size));
+	ASSERT_TRUE(file->flush());
+	ASSERT_EQ(1u, file->getStats().commits);
+
+	// A non-empty directory in place of the temporary file makes the commits fail
+	std::filesystem::create_directory(tmpPath);
+	FILE *f = nowide::fopen((std::string(tmpPath) + "/file").c_str(), "wb");
+	ASSERT_NE(nullptr, f);
+	std::fclose(f);
+	memset(&flash[VmuFile::BlockSize * 3], 0xaa, VmuFile::BlockSize);
+	file->write(flash.get(), VmuFile::BlockSize * 3, VmuFile::BlockSize);
+	ASSERT_FALSE(file->flush());
+	ASSERT_FALSE(fileMatches());
+	// Still failing
+	ASSERT_FALSE(file->flush());
+	ASSERT_FALSE(file->write(flash.get(), VmuFile::BlockSize * 4, 128));
+	ASSERT_FALSE(file->flush());
+	ASSERT_EQ(1u, file->getStats().commits);
+
+	// The failed blocks are committed once the error is gone
+	std::filesystem::remove_all(tmpPath);
+	ASSERT_TRUE(file->flush());
+	ASSERT_TRUE(fileMatches());
+	VmuFile::Stats stats = file->getStats();
+	ASSERT_EQ(2u, stats.commits);
+	ASSERT_EQ(VmuFile::Size / VmuFile::BlockSize + 2, stats.blocks);
+
+	// and when the file is closed
+	std::filesystem::create_directory(tmpPath);
+	f = nowide::fopen((std::string(tmpPath) + "/file").c_str(), "wb");
+	ASSERT_NE(nullptr, f);
+	std::fclose(f);
+	memset(&flash[VmuFile::BlockSize * 5], 0xbb, VmuFile::BlockSize);
+	file->write(flash.get(), VmuFile::BlockSize * 5, VmuFile::BlockSize);
+	ASSERT_FALSE(file->flush());
+	std::filesystem::remove_all(tmpPath);
+	file->close();
+	ASSERT_TRUE(fileMatches());
+}
+
+// Replays the maple block writes of a game saving repeatedly and counts the frames
+// where the emulation thread is blocked by file I/O.
+TEST_F(VmuFileTest, SaveTraceHitches)
+{
+	using the_clock = std::chrono::steady_clock;
+	constexpr int Saves = 20;
+	constexpr u32 BlocksPerSave = 40;		// file data, FAT and directory
+	constexpr u32 PhasesPerFrame = 2;
+	// A quarter of a 60 Hz frame
+	constexpr auto HitchThreshold = std::chrono::microseconds(4167);
+
+	bool created;
+	ASSERT_TRUE(file->open(path, flash.get(), created));
+	std::mt19937 rng(42);
+	int frames = 0;
+	int hitches = 0;
+	the_clock::duration maxFrameTime {};
+	u32 writes = 0;
+	for (int save = 0; save < Saves; save++)
+	{
+		const u32 firstBlock = rng() % (256 - BlocksPerSave);
+		u32 phases = 0;
+		while (phases < BlocksPerSave * 4)
+		{
+			// One frame
+			const auto start = the_clock::now();
+			for (u32 i = 0; i < PhasesPerFrame && phases < BlocksPerSave * 4; i++, phases++)
+			{
+				const u32 offset = (firstBlock + phases / 4) * VmuFile::BlockSize + (phases % 4) * 128;
+				for (u32 j = 0; j < 128; j++)
+					flash[offset + j] = (u8)rng();
+				ASSERT_TRUE(file->write(flash.get(), offset, 128));
+				writes++;
+			}
+			const auto frameTime = the_clock::now() - start;
+			frames++;
+			maxFrameTime = std::max(maxFrameTime, frameTime);
+			if (frameTime > HitchThreshold)
+				hitches++;
+		}
+	}
+	ASSERT_TRUE(file->flush());
+	ASSERT_TRUE(fileMatches());
+
+	const VmuFile::Stats stats = file->getStats();
+	const u64 maxFrameUs = std::chrono::duration_cast<std::chrono::microseconds>(maxFrameTime).count();
+	printf("VMU save trace: %d frames, %d writes, %d commits, %d hitches, max frame I/O time %d us\n",
+			frames, (int)writes, (int)stats.commits, hitches, (int)maxFrameUs);
+	RecordProperty("hitches", hitches);
+	RecordProperty("commits", (int)stats.commits);
+	RecordProperty("maxFrameUs", (int)maxFrameUs);
+	ASSERT_EQ(writes, stats.writes);
+	// Allow for the odd preemption of the test thread
+	ASSERT_LE(hitches, frames / 100);
+}
@@ -0,0 +1,105 @@
+#include "gtest/gtest.h"
+#include "types.h"
+#include "rend/osd.h"
+#include <random>
+#include <vector>
+
+class VmuLcdTest : public ::testing::Test
+{
+protected:
+	void SetUp() override
+	{
+		memset(vmu_lcd_data, 0, sizeof(vmu_lcd_data));
+		memset(vmu_lcd_status, 0, sizeof(vmu_lcd_status));
+		memset(vmuLastChanged, 0, sizeof(vmuLastChanged));
+		vmuLcdUploadedBytes = 0;
+	}
+
+	static constexpr u32 OnColor = 0xBF102030;
+	static constexpr u32 OffColor = 0xBFC0D0E0;
+	static constexpr u32 ScreenSize = sizeof(vmu_lcd_data[0]);
+};
+
+TEST_F(VmuLcdTest, Expand)
+{
+	std::mt19937 rng(42);
+	constexpr int MaxCount = VmuLcdWidth * VmuLcdHeight + 15;
+	std::vector<u8> src(MaxCount);
+	for (u8& b : src)
+		// Mostly off pixels, and any non-zero value is on
+		b = rng() % 3 == 0 ? (u8)rng() : 0;
+	// odd sizes to test the scalar tail of the SIMD kernels
+	for (int count : { 1, 15, 16, 17, 48, VmuLcdWidth * VmuLcdHeight, MaxCount })
+	{
+		std::vector<u32> simd(count + 1, 0x12345678);
+		std::vector<u32> scalar(count + 1, 0x12345678);
+		expandVmuLcd(src.data(), simd.data(), count, OnColor, OffColor);
+		expandVmuLcdScalar(src.data(), scalar.data(), count, OnColor, OffColor);
+		ASSERT_EQ(scalar, simd) << "count " << count;
+		// Nothing written past the end
+		ASSERT_EQ(0x12345678u, simd[count]);
+	}
+	for (int i = 0; i < MaxCount; i++)
+	{
+		u32 pixel;
+		expandVmuLcdScalar(&src[i], &pixel, 1, OnColor, OffColor);
+		ASSERT_EQ(src[i] != 0 ? OnColor : OffColor, pixel);
+	}
+}
+
+TEST_F(VmuLcdTest, PushScreen)
+{
+	u8 screen[VmuLcdWidth * VmuLcdHeight] {};
+	screen[0] = 1;
+	screen[47] = 0xff;
+	push_vmu_screen(1, 1, screen);
+	ASSERT_TRUE(vmu_lcd_status[3]);
+	ASSERT_NE(0u, vmuLastChanged[3]);
+	ASSERT_EQ(0xFFFFFFFFu, vmu_lcd_data[3][0]);
+	ASSERT_EQ(0xFF000000u, vmu_lcd_data[3][1]);
+	ASSERT_EQ(0xFFFFFFFFu, vmu_lcd_data[3][47]);
+	ASSERT_EQ(0u, vmu_lcd_data[2][0]);
+
+	// Invalid port
+	push_vmu_screen(4, 0, screen);
+}
+
+TEST_F(VmuLcdTest, AtlasUpdates)
+{
+	VmuAtlasUpdater updater;
+	// All screens are uploaded initially
+	ASSERT_EQ(0xffu, updater.changedScreens());
+	ASSERT_EQ(VmuLcdCount * ScreenSize, vmuLcdUploadedBytes.load());
+	ASSERT_EQ(0u, updater.changedScreens());
+
+	// Only the changed screens that are displayed
+	vmu_lcd_status[0] = vmu_lcd_status[5] = true;
+	vmuLastChanged[0] = 10;
+	vmuLastChanged[5] = 10;
+	vmuLastChanged[6] = 10;
+	vmuLcdUploadedBytes = 0;
+	ASSERT_EQ(0x21u, updater.changedScreens());
+	ASSERT_EQ(2 * ScreenSize, vmuLcdUploadedBytes.load());
+	ASSERT_EQ(0u, updater.changedScreens());
+
+	// A hidden screen is uploaded once displayed
+	vmu_lcd_status[6] = true;
+	ASSERT_EQ(0x40u, updater.changedScreens());
+
+	// Animating all screens every frame
+	vmuLcdUploadedBytes = 0;
+	for (int frame = 1; frame <= 60; frame++)
+	{
+		for (int i = 0; i < VmuLcdCount; i++)
+		{
+			vmu_lcd_status[i] = true;
+			vmuLastChanged[i] = 100 + frame;
+		}
+		ASSERT_EQ(0xffu, updater.changedScreens());
+	}
+	ASSERT_EQ(60 * sizeof(vmu_lcd_data), vmuLcdUploadedBytes.load());
+
+	updater.reset();
+	ASSERT_EQ(0xffu, updater.changedScreens());
+	ASSERT_EQ(3, VmuAtlasUpdater::countScreens(0x61));
+}
@@ -0,0 +1,62 @@
+#include "gtest/gtest.h"
+#include "types.h"
+#include "hw/pvr/yuv_convert.h"
+#include <random>
+#include <vector>
+
+class YuvConvertTest : public ::testing::Test
+{
+protected:
+	static constexpr u32 Blocks = 5;
+	// wider than the converted blocks to check that nothing is written past them
+	static constexpr u32 Stride = (Blocks + 1) * 16 * 2;
+
+	void SetUp() override
+	{
+		std::mt19937 rng(42);
+		input.resize(Blocks * yuv::MacroBlockSize);
+		for (u8& b : input)
+			b = (u8)rng();
+	}
+
+	std::vector<u8> convert(yuv::ConvertFunc func, u32 count)
+	{
+		std::vector<u8> out(Stride * 16, 0xcc);
+		func(input.data(), out.data(), Stride, count);
+		return out;
+	}
+
+	std::vector<u8> input;
+};
+
+TEST_F(YuvConvertTest, Scalar)
+{
+	std::vector<u8> out = convert(yuv::convertScalar, 1);
+	const u8 *u = &input[0];
+	const u8 *v = &input[64];
+	const u8 *y = &input[128];
+	for (int line = 0; line < 16; line++)
+		for (int x = 0; x < 16; x += 2)
+		{
+			const u8 *texel = &out[line * Stride + x * 2];
+			const int uv = (line / 2) * 8 + x / 2;
+			// Y blocks: top left, top right, bottom left, bottom right
+			const int yofs = (line / 8) * 128 + (x / 8) * 64 + (line % 8) * 8 + x % 8;
+			ASSERT_EQ(u[uv], texel[0]);
+			ASSERT_EQ(y[yofs], texel[1]);
+			ASSERT_EQ(v[uv], texel[2]);
+			ASSERT_EQ(y[yofs + 1], texel[3]);
+		}
+	for (int line = 0; line < 16; line++)
+		ASSERT_EQ(0xcc, out[line * Stride + 16 * 2]);
+}
+
+TEST_F(YuvConvertTest, Simd)
+{
+	const std::vector<u8> reference = convert(yuv::convertScalar, Blocks);
+	for (const yuv::Converter& converter : yuv::converters())
+	{
+		SCOPED_TRACE(converter.name);
+		ASSERT_EQ(reference, convert(converter.convert, Blocks));
+	}
+}
@@ -0,0 +1,130 @@
+#include "gtest/gtest.h"
+#include "types.h"
+#include "util/spsc_ring.h"
+#include <future>
+#include <thread>
+
+class SpscRingTest : public ::testing::Test
+{
+};
+
+TEST_F(SpscRingTest, Basic)
+{
+	SpscRing<int, 4> ring;
+	ASSERT_TRUE(ring.empty());
+	ASSERT_EQ(0, ring.size());
+	ASSERT_TRUE(ring.push(42));
+	ASSERT_FALSE(ring.empty());
+	ASSERT_EQ(1, ring.size());
+	int v;
+	ASSERT_TRUE(ring.pop(v));
+	ASSERT_EQ(42, v);
+	ASSERT_FALSE(ring.pop(v));
+
+	ASSERT_TRUE(ring.push(1));
+	ASSERT_TRUE(ring.push(2));
+	ASSERT_TRUE(ring.push(3));
+	ASSERT_TRUE(ring.push(4));
+	ASSERT_TRUE(ring.full());
+	ASSERT_FALSE(ring.push(5));
+	for (int i = 1; i <= 4; i++)
+	{
+		ASSERT_TRUE(ring.pop(v));
+		ASSERT_EQ(i, v);
+	}
+	ASSERT_TRUE(ring.empty());
+}
+
+TEST_F(SpscRingTest, Bulk)
+{
+	SpscRing<u8, 8> ring;
+	const u8 in[] { 1, 2, 3, 4, 5, 6 };
+	ASSERT_EQ(6, ring.push(in, sizeof(in)));
+	u8 out[8] {};
+	ASSERT_EQ(4, ring.pop(out, 4));
+	// wraps around
+	ASSERT_EQ(6, ring.push(in, sizeof(in)));
+	ASSERT_EQ(8, ring.size());
+	ASSERT_EQ(0, ring.push(in, sizeof(in)));
+	ASSERT_EQ(8, ring.pop(out, sizeof(out)));
+	const u8 expected[] { 5, 6, 1, 2, 3, 4, 5, 6 };
+	ASSERT_EQ(0, memcmp(expected, out, sizeof(out)));
+	ASSERT_EQ(0, ring.pop(out, sizeof(out)));
+}
+
+TEST_F(SpscRingTest, Clear)
+{
+	SpscRing<int, 4> ring;
+	ring.push(1);
+	ring.push(2);
+	ring.clear();
+	ASSERT_TRUE(ring.empty());
+	ring.push(3);
+	int v;
+	ASSERT_TRUE(ring.pop(v));
+	ASSERT_EQ(3, v);
+}
+
+TEST_F(SpscRingTest, ZeroCopy)
+{
+	SpscRing<int, 2> ring;
+	ASSERT_EQ(nullptr, ring.front());
+	int *slot = ring.reserve();
+	ASSERT_NE(nullptr, slot);
+	*slot = 1;
+	// not published yet
+	ASSERT_EQ(nullptr, ring.front());
+	ring.commit();
+	slot = ring.reserve();
+	ASSERT_NE(nullptr, slot);
+	*slot = 2;
+	ring.commit();
+	ASSERT_EQ(nullptr, ring.reserve());
+
+	int *elem = ring.front();
+	ASSERT_NE(nullptr, elem);
+	ASSERT_EQ(1, *elem);
+	ring.popFront();
+	elem = ring.front();
+	ASSERT_NE(nullptr, elem);
+	ASSERT_EQ(2, *elem);
+	ring.popFront();
+	ASSERT_EQ(nullptr, ring.front());
+	ASSERT_TRUE(ring.empty());
+}
+
+TEST_F(SpscRingTest, MultiThread)
+{
+	SpscRing<u32, 64> ring;
+	constexpr u32 Count = 100'000;
+	std::future<void> producer = std::async(std::launch::async, [&]() {
+		u32 buf[7];
+		u32 next = 0;
+		while (next < Count)
+		{
+			u32 n = std::min<u32>(std::size(buf), Count - next);
+			for (u32 i = 0; i < n; i++)
+				buf[i] = next + i;
+			u32 pushed = 0;
+			while (pushed < n)
+			{
+				pushed += ring.push(buf + pushed, n - pushed);
+				if (pushed < n)
+					std::this_thread::yield();
+			}
+			next += n;
+		}
+	});
+	u32 expected = 0;
+	u32 buf[13];
+	while (expected < Count)
+	{
+		size_t n = ring.pop(buf, std::size(buf));
+		if (n == 0)
+			std::this_thread::yield();
+		for (size_t i = 0; i < n; i++)
+			ASSERT_EQ(expected++, buf[i]);
+	}
+	producer.get();
+	ASSERT_TRUE(ring.empty());
+}
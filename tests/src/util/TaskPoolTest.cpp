@@ -0,0 +1,136 @@
+#include "gtest/gtest.h"
+#include "util/task_pool.h"
+#include <atomic>
+#include <future>
+#include <vector>
+
+class TaskPoolTest : public ::testing::Test
+{
+};
+
+TEST_F(TaskPoolTest, Basic)
+{
+	TaskPool& pool = TaskPool::instance();
+	std::atomic<int> counter = 0;
+	for (int i = 0; i < 100; i++)
+		pool.run(TaskPool::Normal, [&]() {
+			++counter;
+		});
+	// stop runs all pending tasks
+	pool.stop();
+	ASSERT_EQ(100, counter);
+	ASSERT_EQ(0, pool.threadCount());
+
+	// test restart
+	std::future<int> f = pool.runFuture(TaskPool::High, [](int v) { return v; }, 42);
+	ASSERT_EQ(42, f.get());
+	ASSERT_GE(pool.threadCount(), 2);
+}
+
+TEST_F(TaskPoolTest, MultiThread)
+{
+	TaskPool& pool = TaskPool::instance();
+	std::atomic<int> counter = 0;
+	const auto& consumer = [&]() {
+		for (int i = 0; i < 100; i++)
+			pool.run((TaskPool::Priority)(i % TaskPool::PriorityCount), [&]() {
+				// Tasks submitted by workers go to their own queue
+				pool.run(TaskPool::Normal, [&]() {
+					++counter;
+				});
+			});
+	};
+	std::future<void> futures[4];
+	for (auto& f : futures)
+		f = std::async(std::launch::async, consumer);
+	for (auto& f : futures)
+		f.get();
+	pool.stop();
+	ASSERT_EQ(std::size(futures) * 100, counter);
+}
+
+TEST_F(TaskPoolTest, ParallelFor)
+{
+	std::vector<int> values(1000);
+	TaskPool::instance().parallelFor(0, (int)values.size(), [&](int start, int end) {
+		for (int i = start; i < end; i++)
+			values[i]++;
+	});
+	for (int v : values)
+		ASSERT_EQ(1, v);
+
+	// single range
+	int calls = 0;
+	TaskPool::instance().parallelFor(10, 20, [&](int start, int end) {
+		ASSERT_EQ(10, start);
+		ASSERT_EQ(20, end);
+		calls++;
+	}, 1);
+	ASSERT_EQ(1, calls);
+}
+
+TEST_F(TaskPoolTest, BlockedBackground)
+{
+	TaskPool& pool = TaskPool::instance();
+	// Block more background tasks than there are workers
+	std::promise<void> release;
+	std::shared_future<void> released = release.get_future().share();
+	std::atomic<int> done = 0;
+	const int blocked = 16;
+	for (int i = 0; i < blocked; i++)
+		pool.run(TaskPool::Background, [released, &done]() {
+			released.wait();
+			++done;
+		});
+	std::vector<int> values(100);
+	pool.parallelFor(0, (int)values.size(), [&](int start, int end) {
+		for (int i = start; i < end; i++)
+			values[i]++;
+	});
+	for (int v : values)
+		ASSERT_EQ(1, v);
+	std::future<int> f = pool.runFuture(TaskPool::Normal, [](int v) { return v; }, 3);
+	ASSERT_EQ(3, f.get());
+
+	release.set_value();
+	pool.stop();
+	ASSERT_EQ(blocked, done);
+}
+
+TEST_F(TaskPoolTest, RunWhileStopping)
+{
+	TaskPool& pool = TaskPool::instance();
+	std::atomic<int> counter = 0;
+	const auto& producer = [&]() {
+		for (int i = 0; i < 1000; i++)
+			pool.run((TaskPool::Priority)(i % TaskPool::PriorityCount), [&]() {
+				++counter;
+			});
+	};
+	std::future<void> futures[2];
+	for (auto& f : futures)
+		f = std::async(std::launch::async, producer);
+	for (int i = 0; i < 20; i++)
+		pool.stop();
+	for (auto& f : futures)
+		f.get();
+	pool.stop();
+	ASSERT_EQ(std::size(futures) * 1000, counter);
+}
+
+TEST_F(TaskPoolTest, Queue)
+{
+	TaskQueue queue("Test");
+	std::vector<int> order;
+	for (int i = 0; i < 100; i++)
+		queue.run([&order, i]() {
+			order.push_back(i);
+		});
+	queue.stop();
+	ASSERT_EQ(100u, order.size());
+	for (int i = 0; i < 100; i++)
+		ASSERT_EQ(i, order[i]);
+
+	std::future<int> f = queue.runFuture([](int v) { return v; }, 7);
+	ASSERT_EQ(7, f.get());
+}